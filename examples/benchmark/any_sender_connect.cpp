@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Connects, starts and destroys type-erased senders as fast as possible, to
+// compare the allocators that their operation states can be allocated with:
+//
+//   new        std::allocator, i.e. the global heap
+//   recycling  the default: per-thread caches of recycled operation states
+//   tbb        tbb::scalable_allocator
+//
+// In the "local" variants every thread frees the operation states that it
+// allocated. In the "remote" variants the threads work in pairs, and one
+// thread of each pair frees the operation states that the other one
+// allocated; with an odd number of threads the last one works alone. The
+// variants are named allocator-mode, e.g. recycling-remote. The latency of an
+// operation is the time to connect and start it.
+
+#include "./common.hpp"
+#include <exec/any_sender_of.hpp>
+#include <exec/env.hpp>
+#include <stdexec/execution.hpp>
+
+#include <tbb/scalable_allocator.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+using any_sender =
+  exec::any_receiver_ref<stdexec::completion_signatures<stdexec::set_value_t()>>::any_sender<>;
+
+// A sender whose operation state is too large to be stored inline.
+struct padded_sender {
+  using sender_concept = stdexec::sender_t;
+  using completion_signatures = stdexec::completion_signatures<stdexec::set_value_t()>;
+
+  template <class Receiver>
+  struct operation {
+    Receiver rcvr_;
+    char padding_[96];
+
+    friend void tag_invoke(stdexec::start_t, operation& self) noexcept {
+      stdexec::set_value((Receiver&&) self.rcvr_);
+    }
+  };
+
+  template <class Receiver>
+  friend operation<Receiver> tag_invoke(stdexec::connect_t, padded_sender, Receiver rcvr) {
+    return {(Receiver&&) rcvr, {}};
+  }
+};
+
+template <class Env>
+struct sink_receiver {
+  using receiver_concept = stdexec::receiver_t;
+  Env env_;
+
+  friend void tag_invoke(stdexec::set_value_t, sink_receiver&&) noexcept {
+  }
+
+  friend Env tag_invoke(stdexec::get_env_t, const sink_receiver& self) noexcept {
+    return self.env_;
+  }
+};
+
+// The environment that makes the operation states use Allocator, or the
+// default recycling allocator for void.
+template <class Allocator>
+auto make_alloc_env() {
+  if constexpr (std::same_as<Allocator, void>) {
+    return stdexec::empty_env{};
+  } else {
+    return exec::make_env(exec::with(stdexec::get_allocator, Allocator{}));
+  }
+}
+
+template <class Allocator>
+using env_t = decltype(make_alloc_env<Allocator>());
+
+template <class Allocator>
+using op_t = stdexec::connect_result_t<any_sender, sink_receiver<env_t<Allocator>>>;
+
+template <class Allocator>
+void connect_into(std::optional<op_t<Allocator>>& op, latency_recorder& latency) {
+  auto sample = latency.start();
+  op.emplace(stdexec::__conv{[] {
+    return stdexec::connect(
+      any_sender{padded_sender{}}, sink_receiver<env_t<Allocator>>{make_alloc_env<Allocator>()});
+  }});
+  stdexec::start(*op);
+  latency.stop(sample);
+}
+
+inline constexpr std::size_t batch_size = 256;
+
+// A batch of operation states that a thread has connected and that the other
+// thread of its pair destroys.
+template <class Allocator>
+struct batch {
+  std::array<std::optional<op_t<Allocator>>, batch_size> ops_;
+  std::size_t count_{0};
+  std::atomic<bool> full_{false};
+};
+
+template <class Allocator>
+void produce(std::size_t count, batch<Allocator> (&batches)[2], latency_recorder& latency) {
+  for (std::size_t i = 0; count > 0; ++i) {
+    batch<Allocator>& b = batches[i % 2];
+    b.full_.wait(true);
+    b.count_ = std::min(count, batch_size);
+    for (std::size_t j = 0; j < b.count_; ++j) {
+      connect_into<Allocator>(b.ops_[j], latency);
+    }
+    count -= b.count_;
+    b.full_.store(true);
+    b.full_.notify_one();
+  }
+}
+
+template <class Allocator>
+void consume(std::size_t count, batch<Allocator> (&batches)[2]) {
+  for (std::size_t i = 0; count > 0; ++i) {
+    batch<Allocator>& b = batches[i % 2];
+    b.full_.wait(false);
+    for (std::size_t j = 0; j < b.count_; ++j) {
+      b.ops_[j].reset();
+    }
+    count -= b.count_;
+    b.full_.store(false);
+    b.full_.notify_one();
+  }
+}
+
+template <class Allocator, bool Remote>
+struct run_connect {
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_connects,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    std::size_t nthreads = pool.available_parallelism();
+    // The threads of a pair share the connects of one worker.
+    std::size_t nworkers = Remote ? (nthreads + 1) / 2 : nthreads;
+    std::size_t worker = Remote ? tid / 2 : tid;
+    bool paired = Remote && (tid ^ 1) < nthreads;
+    static auto pairs = std::make_unique<batch<Allocator>[][2]>(Remote ? nthreads / 2 : 0);
+    std::optional<op_t<Allocator>> op;
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_connects, worker, nworkers);
+      if (!paired) {
+        for (std::size_t i = start; i < end; ++i) {
+          connect_into<Allocator>(op, latency);
+          op.reset();
+        }
+      } else if (tid % 2 == 0) {
+        produce<Allocator>(end - start, pairs[worker], latency);
+      } else {
+        consume<Allocator>(end - start, pairs[worker]);
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+struct new_local : run_connect<std::allocator<std::byte>, false> {
+  static constexpr std::string_view name = "new-local";
+};
+
+struct recycling_local : run_connect<void, false> {
+  static constexpr std::string_view name = "recycling-local";
+};
+
+struct tbb_local : run_connect<tbb::scalable_allocator<std::byte>, false> {
+  static constexpr std::string_view name = "tbb-local";
+};
+
+struct new_remote : run_connect<std::allocator<std::byte>, true> {
+  static constexpr std::string_view name = "new-remote";
+};
+
+struct recycling_remote : run_connect<void, true> {
+  static constexpr std::string_view name = "recycling-remote";
+};
+
+struct tbb_remote : run_connect<tbb::scalable_allocator<std::byte>, true> {
+  static constexpr std::string_view name = "tbb-remote";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<
+    exec::static_thread_pool,
+    recycling_local,
+    new_local,
+    tbb_local,
+    recycling_remote,
+    new_remote,
+    tbb_remote>(argc, argv);
+}
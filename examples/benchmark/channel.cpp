@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Passes values through an exec::channel of capacity 64. Every thread of the
+// benchmark produces its share of the values, and a run ends once all of
+// them have been consumed. The latencies are the times that the values spent
+// in the channel.
+//
+//   spsc  every thread sends to a channel of its own, whose consumer runs on
+//         a single_thread_context
+//   mpmc  all threads send to one channel, and as many consumers as there
+//         are threads run on the static_thread_pool
+
+#include "./common.hpp"
+#include <exec/async_scope.hpp>
+#include <exec/sequence/channel.hpp>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/single_thread_context.hpp>
+#include <exec/static_thread_pool.hpp>
+#include <exec/task.hpp>
+#include <stdexec/execution.hpp>
+
+// The latency sample of a value, which its consumer completes.
+struct sample {
+  latency_recorder::clock::time_point start;
+  latency_recorder* latency;
+};
+
+using channel_type = exec::channel<sample>;
+
+inline constexpr std::size_t capacity = 64;
+
+exec::task<void> produce(channel_type& ch, std::size_t count, latency_recorder& latency) {
+  for (std::size_t i = 0; i < count; ++i) {
+    co_await ch.send(sample{latency.start(), &latency});
+  }
+}
+
+auto consume(channel_type& ch, std::atomic<std::size_t>& consumed) {
+  return ch.receive()
+       | exec::transform_each(stdexec::then([&consumed](sample s) {
+           s.latency->stop(s.start);
+           consumed.fetch_add(1, std::memory_order_release);
+         }))
+       | exec::ignore_all_values();
+}
+
+void wait_for(const std::atomic<std::size_t>& consumed, std::size_t target) {
+  while (consumed.load(std::memory_order_acquire) < target) {
+    std::this_thread::yield();
+  }
+}
+
+struct spsc {
+  static constexpr std::string_view name = "spsc";
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_values,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    channel_type ch{capacity};
+    std::atomic<std::size_t> consumed{0};
+    exec::single_thread_context consumer_ctx;
+    exec::async_scope scope;
+    scope.spawn(stdexec::on(consumer_ctx.get_scheduler(), consume(ch, consumed)));
+    std::size_t produced = 0;
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_values, tid, pool.available_parallelism());
+      stdexec::sync_wait(produce(ch, end - start, latency));
+      produced += end - start;
+      wait_for(consumed, produced);
+      barrier.arrive_and_wait();
+    }
+    ch.close();
+    stdexec::sync_wait(scope.on_empty());
+  }
+};
+
+struct mpmc {
+  static constexpr std::string_view name = "mpmc";
+
+  inline static channel_type ch{capacity};
+  inline static std::atomic<std::size_t> consumed{0};
+  inline static exec::async_scope consumers{};
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_values,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    // The other threads wait for the first one at the barrier.
+    if (tid == 0) {
+      for (std::size_t i = 0; i < pool.available_parallelism(); ++i) {
+        consumers.spawn(stdexec::on(pool.get_scheduler(), consume(ch, consumed)));
+      }
+    }
+    // Every run consumes all values of all threads.
+    for (std::size_t run = 1;; ++run) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_values, tid, pool.available_parallelism());
+      stdexec::sync_wait(produce(ch, end - start, latency));
+      wait_for(consumed, run * total_values);
+      barrier.arrive_and_wait();
+    }
+    if (tid == 0) {
+      ch.close();
+      stdexec::sync_wait(consumers.on_empty());
+    }
+  }
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<exec::static_thread_pool, spsc, mpmc>(argc, argv);
+}
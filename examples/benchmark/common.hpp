@@ -19,14 +19,27 @@
 #include <exec/static_thread_pool.hpp>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <barrier>
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #if __has_include(<memory_resource>)
@@ -36,57 +49,385 @@ namespace pmr = std::pmr;
 #define STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE 1
 #endif
 
-struct statistics {
-  std::chrono::milliseconds total_time_ms;
-  double ops_per_sec;
+// The command line of the benchmarks that use my_main:
+//
+//   --threads N       threads of the pool, and threads that submit work to it
+//   --iterations N    operations per run, which the threads share
+//   --runs N          number of measured runs, 100 by default, or unbounded
+//                     if only --duration is given
+//   --warmup N        number of runs before the measured ones, 1 by default
+//   --duration S      stop after S seconds of measured runs
+//   --sample-every N  measure the latency of every N-th operation of a
+//                     thread, 64 by default, or none for 0
+//   --format F        text, json or csv
+//   --output FILE     write the results to FILE instead of stdout
+//   --baseline FILE   compare the results with the json results of an
+//                     earlier run
+//   --variant NAME    what to measure, for benchmarks that compare several
+//                     implementations or modes
+//
+// A single number without a flag is the number of threads, as before.
+struct benchmark_options {
+  std::string name;
+  std::size_t threads = std::thread::hardware_concurrency();
+  std::size_t iterations = 10'000'000;
+  std::size_t runs = 100;
+  std::size_t warmup = 1;
+  double duration = 0.0;
+  std::size_t sample_every = 64;
+  std::string format = "text";
+  std::string output;
+  std::string baseline;
+  std::string variant;
+};
+
+[[noreturn]] inline void benchmark_usage(std::string_view name, std::string_view error) {
+  std::cerr << name << ": " << error << "\n"
+            << "Usage: " << name
+            << " [--threads N] [--iterations N] [--runs N] [--warmup N] [--duration S]\n"
+            << "  [--sample-every N] [--format text|json|csv] [--output FILE] [--baseline FILE]\n"
+            << "  [--variant NAME]" << std::endl;
+  std::exit(-1);
+}
+
+inline benchmark_options parse_benchmark_options(int argc, char** argv) {
+  benchmark_options options;
+  std::string_view path = argc > 0 ? argv[0] : "benchmark";
+  options.name = path.substr(path.find_last_of('/') + 1);
+  bool has_runs = false;
+  auto to_size = [&](std::string_view flag, const std::string& value) {
+    char* end = nullptr;
+    unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0') {
+      benchmark_usage(options.name, "invalid value '" + value + "' for " + std::string(flag));
+    }
+    return static_cast<std::size_t>(n);
+  };
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (!arg.starts_with("--")) {
+      options.threads = to_size("threads", std::string(arg));
+      continue;
+    }
+    std::string_view flag = arg;
+    std::string value;
+    if (std::size_t eq = arg.find('='); eq != arg.npos) {
+      flag = arg.substr(0, eq);
+      value = arg.substr(eq + 1);
+    } else if (i + 1 < argc) {
+      value = argv[++i];
+    } else {
+      benchmark_usage(options.name, "missing value for " + std::string(flag));
+    }
+    if (flag == "--threads") {
+      options.threads = to_size(flag, value);
+    } else if (flag == "--iterations") {
+      options.iterations = to_size(flag, value);
+    } else if (flag == "--runs") {
+      options.runs = to_size(flag, value);
+      has_runs = true;
+    } else if (flag == "--warmup") {
+      options.warmup = to_size(flag, value);
+    } else if (flag == "--duration") {
+      options.duration = std::atof(value.c_str());
+    } else if (flag == "--sample-every") {
+      options.sample_every = to_size(flag, value);
+    } else if (flag == "--format") {
+      if (value != "text" && value != "json" && value != "csv") {
+        benchmark_usage(options.name, "unknown format '" + value + "'");
+      }
+      options.format = value;
+    } else if (flag == "--output") {
+      options.output = value;
+    } else if (flag == "--baseline") {
+      options.baseline = value;
+    } else if (flag == "--variant") {
+      options.variant = value;
+    } else {
+      benchmark_usage(options.name, "unknown option " + std::string(flag));
+    }
+  }
+  if (options.threads == 0) {
+    benchmark_usage(options.name, "--threads must be at least 1");
+  }
+  if (options.duration > 0.0 && !has_runs) {
+    options.runs = std::numeric_limits<std::size_t>::max() - options.warmup;
+  }
+  return options;
+}
+
+// A histogram of latencies in nanoseconds, with 32 buckets for every power of
+// two, so that a bucket is at most 1/32 of its lower bound wide. It may be
+// recorded to from many threads at once.
+class latency_histogram {
+  static constexpr int sub_bucket_bits = 5;
+  static constexpr std::uint64_t sub_buckets = 1 << sub_bucket_bits;
+  static constexpr std::size_t num_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+  static std::size_t index_of(std::uint64_t ns) noexcept {
+    if (ns < 2 * sub_buckets) {
+      return static_cast<std::size_t>(ns);
+    }
+    int msb = std::bit_width(ns) - 1;
+    int shift = msb - sub_bucket_bits;
+    return static_cast<std::size_t>(msb - sub_bucket_bits + 1) * sub_buckets
+         + ((ns >> shift) & (sub_buckets - 1));
+  }
+
+  static std::uint64_t lower_bound_of(std::size_t index) noexcept {
+    if (index < 2 * sub_buckets) {
+      return index;
+    }
+    int shift = static_cast<int>(index / sub_buckets) - 1;
+    return (sub_buckets + index % sub_buckets) << shift;
+  }
+
+ public:
+  void record(std::uint64_t ns) noexcept {
+    counts_[index_of(ns)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void add(const latency_histogram& other) noexcept {
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+      counts_[i].fetch_add(
+        other.counts_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+  }
+
+  void reset() noexcept {
+    for (std::atomic<std::uint64_t>& count: counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::uint64_t count() const noexcept {
+    std::uint64_t total = 0;
+    for (const std::atomic<std::uint64_t>& count: counts_) {
+      total += count.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  // The lower bound of the bucket of the value at quantile q in [0, 1].
+  std::uint64_t quantile(double q) const noexcept {
+    std::uint64_t total = count();
+    if (total == 0) {
+      return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    rank = std::clamp<std::uint64_t>(rank, 1, total);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+      seen += counts_[i].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        return lower_bound_of(i);
+      }
+    }
+    return lower_bound_of(num_buckets - 1);
+  }
+
+ private:
+  std::array<std::atomic<std::uint64_t>, num_buckets> counts_{};
+};
+
+// Measures the latency of every n-th operation that a thread of a benchmark
+// submits. start() is called by the submitting thread before the operation is
+// started, and stop() by whichever thread completes it, before the benchmark
+// learns that the operation is done.
+class latency_recorder {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  explicit latency_recorder(std::size_t sample_every) noexcept
+    : sample_every_(sample_every) {
+  }
+
+  clock::time_point start() noexcept {
+    if (sample_every_ == 0 || ++count_ % sample_every_ != 0) {
+      return {};
+    }
+    return clock::now();
+  }
+
+  void stop(clock::time_point start) noexcept {
+    if (start != clock::time_point{}) {
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start);
+      histogram_.record(static_cast<std::uint64_t>(ns.count()));
+    }
+  }
+
+  latency_histogram& histogram() noexcept {
+    return histogram_;
+  }
+
+ private:
+  std::size_t sample_every_;
+  std::size_t count_{0};
+  latency_histogram histogram_{};
 };
 
-statistics compute_perf(
-  std::chrono::steady_clock::time_point start,
-  std::chrono::steady_clock::time_point end,
-  std::size_t total_scheds) {
-  auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
-  auto dur_ms = std::chrono::duration_cast<std::chrono::milliseconds>(dur);
-  auto dur_dbl = std::chrono::duration_cast<std::chrono::duration<double>>(dur);
-  double ops_per_sec = total_scheds / dur_dbl.count();
-  return {dur_ms, ops_per_sec};
+// The results of a benchmark as named numbers, in the order in which they
+// are written.
+using benchmark_metrics = std::vector<std::pair<std::string, double>>;
+
+inline double nearest_rank(std::span<const double> sorted, double q) {
+  if (sorted.empty()) {
+    return 0.0;
+  }
+  auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
 }
 
-struct statistics_all {
-  std::chrono::milliseconds total_time_ms;
-  double ops_per_sec;
-  double average;
-  double max;
-  double min;
-  double stddev;
+inline constexpr std::array<std::pair<const char*, double>, 4> benchmark_quantiles{
+  {{"p50", 0.5}, {"p90", 0.9}, {"p99", 0.99}, {"p999", 0.999}}
 };
 
-statistics_all compute_perf(
-  std::span<const std::chrono::steady_clock::time_point> start,
-  std::span<const std::chrono::steady_clock::time_point> end,
-  std::size_t i0,
-  std::size_t i,
-  std::size_t total_scheds) {
+inline benchmark_metrics compute_metrics(
+  std::span<const double> run_seconds,
+  std::size_t ops_per_run,
+  const latency_histogram& op_latency) {
+  benchmark_metrics metrics;
+  std::vector<double> throughput;
+  for (double s: run_seconds) {
+    throughput.push_back(static_cast<double>(ops_per_run) / s);
+  }
   double average = 0.0;
-  double max = 0.0;
-  double min = std::numeric_limits<double>::max();
-  for (std::size_t j = i0; j <= i; ++j) {
-    auto stats = compute_perf(start[j], end[j], total_scheds);
-    average += stats.ops_per_sec / (i + 1 - i0);
-    max = std::max(max, stats.ops_per_sec);
-    min = std::min(min, stats.ops_per_sec);
-  }
-  // compute variant
+  for (double t: throughput) {
+    average += t / static_cast<double>(throughput.size());
+  }
   double variance = 0.0;
-  for (std::size_t j = i0; j <= i; ++j) {
-    auto stats = compute_perf(start[j], end[j], total_scheds);
-    variance += (stats.ops_per_sec - average) * (stats.ops_per_sec - average);
-  }
-  variance /= (i + 1 - i0);
-  double stddev = std::sqrt(variance);
-  auto stats = compute_perf(start[i], end[i], total_scheds);
-  statistics_all all{stats.total_time_ms, stats.ops_per_sec, average, max, min, stddev};
-  return all;
+  for (double t: throughput) {
+    variance += (t - average) * (t - average) / static_cast<double>(throughput.size());
+  }
+  auto [min, max] = std::minmax_element(throughput.begin(), throughput.end());
+  metrics.emplace_back("throughput_mean", average);
+  metrics.emplace_back("throughput_min", throughput.empty() ? 0.0 : *min);
+  metrics.emplace_back("throughput_max", throughput.empty() ? 0.0 : *max);
+  metrics.emplace_back("throughput_stddev", std::sqrt(variance));
+
+  std::vector<double> run_ms;
+  for (double s: run_seconds) {
+    run_ms.push_back(s * 1e3);
+  }
+  std::sort(run_ms.begin(), run_ms.end());
+  for (auto [name, q]: benchmark_quantiles) {
+    metrics.emplace_back(std::string("run_ms_") + name, nearest_rank(run_ms, q));
+  }
+
+  metrics.emplace_back("op_latency_samples", static_cast<double>(op_latency.count()));
+  for (auto [name, q]: benchmark_quantiles) {
+    metrics.emplace_back(
+      std::string("op_latency_ns_") + name, static_cast<double>(op_latency.quantile(q)));
+  }
+  return metrics;
+}
+
+// Reads the metrics of a file that write_json() has written.
+inline benchmark_metrics read_baseline(const std::string& path, const benchmark_metrics& keys) {
+  std::ifstream file{path};
+  if (!file) {
+    std::cerr << "cannot open baseline " << path << std::endl;
+    std::exit(-1);
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  std::string json = buffer.str();
+  benchmark_metrics baseline;
+  for (const auto& [key, value]: keys) {
+    std::size_t pos = json.find("\"" + key + "\":");
+    if (pos != std::string::npos) {
+      baseline.emplace_back(key, std::atof(json.c_str() + pos + key.size() + 3));
+    }
+  }
+  return baseline;
+}
+
+inline void write_json(
+  std::ostream& out,
+  const benchmark_options& options,
+  std::size_t runs,
+  const benchmark_metrics& metrics,
+  const benchmark_metrics& baseline) {
+  out << "{\n"
+      << "  \"benchmark\": \"" << options.name << "\",\n";
+  if (!options.variant.empty()) {
+    out << "  \"variant\": \"" << options.variant << "\",\n";
+  }
+  out
+      << "  \"threads\": " << options.threads << ",\n"
+      << "  \"iterations\": " << options.iterations << ",\n"
+      << "  \"runs\": " << runs;
+  for (const auto& [key, value]: metrics) {
+    out << ",\n  \"" << key << "\": " << std::setprecision(10) << value;
+  }
+  if (!baseline.empty()) {
+    out << ",\n  \"baseline\": {";
+    const char* sep = "\n";
+    for (const auto& [key, value]: baseline) {
+      out << sep << "    \"" << key << "\": " << value;
+      sep = ",\n";
+    }
+    out << "\n  }";
+  }
+  out << "\n}\n";
+}
+
+inline void write_csv(
+  std::ostream& out,
+  const benchmark_options& options,
+  std::size_t runs,
+  const benchmark_metrics& metrics) {
+  out << "benchmark,variant,threads,iterations,runs";
+  for (const auto& [key, value]: metrics) {
+    out << "," << key;
+  }
+  out << "\n"
+      << options.name << "," << options.variant << "," << options.threads << ","
+      << options.iterations << "," << runs;
+  for (const auto& [key, value]: metrics) {
+    out << "," << std::setprecision(10) << value;
+  }
+  out << "\n";
+}
+
+inline void write_text(
+  std::ostream& out,
+  const benchmark_metrics& metrics,
+  const benchmark_metrics& baseline) {
+  for (const auto& [key, value]: metrics) {
+    out << std::left << std::setw(20) << key << " " << std::setprecision(4) << value;
+    auto it = std::find_if(baseline.begin(), baseline.end(), [&](const auto& b) {
+      return b.first == key;
+    });
+    if (it != baseline.end() && it->second != 0.0) {
+      out << "  (baseline " << it->second << ", " << std::showpos
+          << (value - it->second) / it->second * 100 << std::noshowpos << "%)";
+    }
+    out << "\n";
+  }
+}
+
+inline void report_benchmark(
+  const benchmark_options& options,
+  std::span<const double> run_seconds,
+  const latency_histogram& op_latency) {
+  benchmark_metrics metrics = compute_metrics(run_seconds, options.iterations, op_latency);
+  benchmark_metrics baseline;
+  if (!options.baseline.empty()) {
+    baseline = read_baseline(options.baseline, metrics);
+  }
+  std::ofstream file;
+  if (!options.output.empty()) {
+    file.open(options.output);
+  }
+  std::ostream& out = options.output.empty() ? std::cout : file;
+  if (options.format == "json") {
+    write_json(out, options, run_seconds.size(), metrics, baseline);
+  } else if (options.format == "csv") {
+    write_csv(out, options, run_seconds.size(), metrics);
+  } else {
+    write_text(out, metrics, baseline);
+  }
 }
 
 struct numa_deleter {
@@ -98,35 +439,49 @@ struct numa_deleter {
   }
 };
 
+// Runs a benchmark with the options of the command line. Every thread calls
+// RunThread with its share of the pool, a barrier that it arrives at before
+// and after each run, and the latency_recorder for its operations. The
+// harness times the runs between the two barriers. 'variant' is the name that
+// the results report if the command line has no --variant.
 template <class Pool, class RunThread>
-void my_main(int argc, char** argv, exec::numa_policy* policy = exec::get_numa_policy()) {
-  int nthreads = (int) std::thread::hardware_concurrency();
-  if (argc > 1) {
-    nthreads = std::atoi(argv[1]);
+void my_main(
+  int argc,
+  char** argv,
+  exec::numa_policy* policy = exec::get_numa_policy(),
+  std::string_view variant = {}) {
+  benchmark_options options = parse_benchmark_options(argc, argv);
+  if (options.variant.empty()) {
+    options.variant = variant;
   }
-  std::size_t total_scheds = 10'000'000;
+  std::size_t nthreads = options.threads;
+  std::size_t total_scheds = options.iterations;
 #ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
   std::vector<std::unique_ptr<char, numa_deleter>> buffers;
 #endif
   std::optional<Pool> pool{};
   if constexpr (std::same_as<Pool, exec::static_thread_pool>) {
-    pool.emplace(nthreads, exec::bwos_params{}, policy);
+    pool.emplace(static_cast<std::uint32_t>(nthreads), exec::bwos_params{}, policy);
   } else {
-    pool.emplace(nthreads);
+    pool.emplace(static_cast<int>(nthreads));
   }
-  std::barrier<> barrier(nthreads + 1);
+  std::barrier<> barrier(static_cast<std::ptrdiff_t>(nthreads + 1));
   std::vector<std::thread> threads;
+  std::vector<std::unique_ptr<latency_recorder>> recorders;
   std::atomic<bool> stop{false};
 #ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
   std::size_t buffer_size = 2000 << 20;
-  for (std::size_t i = 0; i < static_cast<std::size_t>(nthreads); ++i) {
+  for (std::size_t i = 0; i < nthreads; ++i) {
     exec::numa_allocator<char> alloc(policy->thread_index_to_node(i));
     buffers.push_back(std::unique_ptr<char, numa_deleter>{
       alloc.allocate(buffer_size), numa_deleter{buffer_size, alloc}
     });
   }
 #endif
-  for (std::size_t i = 0; i < static_cast<std::size_t>(nthreads); ++i) {
+  for (std::size_t i = 0; i < nthreads; ++i) {
+    recorders.push_back(std::make_unique<latency_recorder>(options.sample_every));
+  }
+  for (std::size_t i = 0; i < nthreads; ++i) {
     threads.emplace_back(
       RunThread{},
       std::ref(*pool),
@@ -137,26 +492,42 @@ void my_main(int argc, char** argv, exec::numa_policy* policy = exec::get_numa_p
       std::span<char>{buffers[i].get(), buffer_size},
 #endif
       std::ref(stop),
-      policy);
+      policy,
+      std::ref(*recorders[i]));
   }
-  std::size_t nRuns = 100;
-  std::size_t warmup = 1;
-  std::vector<std::chrono::steady_clock::time_point> starts(nRuns);
-  std::vector<std::chrono::steady_clock::time_point> ends(nRuns);
-  for (std::size_t i = 0; i < nRuns; ++i) {
+  const bool text = options.format == "text";
+  std::vector<double> seconds;
+  double elapsed = 0.0;
+  for (std::size_t i = 0; i < options.warmup + options.runs; ++i) {
     barrier.arrive_and_wait();
-    starts[i] = std::chrono::steady_clock::now();
+    auto start = std::chrono::steady_clock::now();
     barrier.arrive_and_wait();
-    ends[i] = std::chrono::steady_clock::now();
-    if (i < warmup) {
-      std::cout << "warmup: skip results\n";
-    } else {
-      auto [dur_ms, ops_per_sec, avg, max, min, stddev] = compute_perf(
-        starts, ends, warmup, i, total_scheds);
-      auto percent = stddev / ops_per_sec * 100;
-      std::cout << i + 1 << " " << dur_ms.count() << "ms, throughput: " << std::setprecision(3)
-                << ops_per_sec << ", average: " << avg << ", max: " << max << ", min: " << min
-                << ", stddev: " << stddev << " (" << percent << "%)\n";
+    auto end = std::chrono::steady_clock::now();
+    if (i < options.warmup) {
+      if (text) {
+        std::cout << "warmup: skip results\n";
+      }
+      // All operations of the run have completed, and no thread records
+      // until the next run starts.
+      for (auto& recorder: recorders) {
+        recorder->histogram().reset();
+      }
+      continue;
+    }
+    double s = std::chrono::duration<double>(end - start).count();
+    seconds.push_back(s);
+    elapsed += s;
+    if (text) {
+      benchmark_metrics m = compute_metrics(seconds, total_scheds, latency_histogram{});
+      double ops_per_sec = static_cast<double>(total_scheds) / s;
+      std::cout << i + 1 << " " << std::setprecision(4) << s * 1e3
+                << "ms, throughput: " << std::setprecision(3) << ops_per_sec
+                << ", average: " << m[0].second << ", max: " << m[2].second
+                << ", min: " << m[1].second << ", stddev: " << m[3].second << " ("
+                << m[3].second / ops_per_sec * 100 << "%)\n";
+    }
+    if (options.duration > 0.0 && elapsed >= options.duration) {
+      break;
     }
   }
   stop = true;
@@ -164,7 +535,41 @@ void my_main(int argc, char** argv, exec::numa_policy* policy = exec::get_numa_p
   for (auto& thread: threads) {
     thread.join();
   }
-  auto [dur_ms, ops_per_sec, avg, max, min, stddev] = compute_perf(
-    starts, ends, warmup, nRuns - 1, total_scheds);
-  std::cout << avg << " | " << max << " | " << min << " | " << stddev << "\n";
-}
\ No newline at end of file
+  latency_histogram op_latency;
+  for (auto& recorder: recorders) {
+    op_latency.add(recorder->histogram());
+  }
+  report_benchmark(options, seconds, op_latency);
+}
+
+template <class Pool, class RunThread>
+bool my_main_if_variant(
+  std::string_view variant,
+  int argc,
+  char** argv,
+  exec::numa_policy* policy) {
+  if (variant != RunThread::name) {
+    return false;
+  }
+  my_main<Pool, RunThread>(argc, argv, policy, variant);
+  return true;
+}
+
+// Runs my_main with the RunThread whose static member 'name' is the
+// --variant of the command line, or with the first one if none is given.
+template <class Pool, class... RunThreads>
+void my_main_variants(
+  int argc,
+  char** argv,
+  exec::numa_policy* policy = exec::get_numa_policy()) {
+  benchmark_options options = parse_benchmark_options(argc, argv);
+  std::string_view variant = options.variant;
+  if (variant.empty()) {
+    variant = std::get<0>(std::tuple{RunThreads::name...});
+  }
+  if (!(my_main_if_variant<Pool, RunThreads>(variant, argc, argv, policy) || ...)) {
+    std::string names;
+    ((names += " ", names += RunThreads::name), ...);
+    benchmark_usage(options.name, "unknown variant '" + options.variant + "', one of:" + names);
+  }
+}
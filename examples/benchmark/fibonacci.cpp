@@ -14,7 +14,10 @@
  * limitations under the License.
  */
 
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 
 #include <tbbexec/tbb_thread_pool.hpp>
 #include <exec/static_thread_pool.hpp>
@@ -22,13 +25,41 @@
 #include <exec/any_sender_of.hpp>
 #include <stdexec/execution.hpp>
 
+// Counts every heap allocation made by the program, so that we can report the
+// number of allocations per node of the recursion tree.
+std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
 long serial_fib(int n) {
   return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
 }
 
+// The number of fib_s senders that are started to compute fib(n).
+long count_nodes(long cutoff, long n) {
+  return n < cutoff ? 1 : 1 + count_nodes(cutoff, n - 1) + count_nodes(cutoff, n - 2);
+}
+
+// Large enough to store a fib_s and its operation state without allocating.
+constexpr std::size_t inline_size = 64;
+
 template <class... Ts>
-using any_sender_of =
-  typename exec::any_receiver_ref<stdexec::completion_signatures<Ts...>>::template any_sender<>;
+using any_sender_of = typename exec::any_receiver_ref<
+  stdexec::completion_signatures<Ts...>>::template basic_any_sender<inline_size>;
 
 using fib_sender = any_sender_of<stdexec::set_value_t(long)>;
 
@@ -109,6 +140,7 @@ int main(int argc, char** argv) {
   }
 
   std::vector<unsigned long> times;
+  std::size_t allocs = 0;
   long result;
   for (unsigned long i = 0; i < nruns; ++i) {
     auto snd = std::visit(
@@ -117,13 +149,18 @@ int main(int argc, char** argv) {
       },
       pool);
 
+    std::size_t allocs_before = allocations.load();
     auto time = measure<std::chrono::milliseconds>([&] {
       std::tie(result) = stdexec::sync_wait(std::move(snd)).value();
     });
+    if (i >= warmup) {
+      allocs += allocations.load() - allocs_before;
+    }
     times.push_back(static_cast<unsigned int>(time));
   }
 
   std::cout << "Avg time: "
             << (std::accumulate(times.begin() + warmup, times.end(), 0u) / (times.size() - warmup))
-            << "ms. Result: " << result << std::endl;
+            << "ms. Result: " << result << ". Allocations per node: "
+            << static_cast<double>(allocs) / (nruns - warmup) / count_nodes(cutoff, n) << std::endl;
 }
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Computes fib(20) with a tree of exec::task coroutines, one per node that
+// is not below the cutoff of 8, to compare the ways in which their frames can
+// be allocated. Every thread computes its share of the iterations.
+//
+//   new        std::allocator, i.e. the global heap
+//   recycling  the default: per-thread caches of recycled frames
+//   pool       a std::pmr::unsynchronized_pool_resource of the thread
+//
+// Every coroutine passes its allocator on to the ones that it awaits. With
+// --format text, the number of heap allocations per node of the tree is
+// reported as well.
+
+#include "./common.hpp"
+#include <exec/task.hpp>
+#include <stdexec/execution.hpp>
+
+#include <memory_resource>
+#include <new>
+
+// Counts every heap allocation made by the program, so that we can report the
+// number of allocations per node of the recursion tree.
+std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+// Not inlined, so that GCC does not see free() called on the result of
+// operator new and warn about a mismatched deallocation.
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+inline constexpr long fib_n = 20;
+inline constexpr long fib_cutoff = 8;
+
+long serial_fib(long n) {
+  return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2);
+}
+
+// The number of fib coroutines that are called to compute fib(n).
+long count_nodes(long cutoff, long n) {
+  return n < cutoff ? 1 : 1 + count_nodes(cutoff, n - 1) + count_nodes(cutoff, n - 2);
+}
+
+exec::task<long> fib(long cutoff, long n) {
+  if (n < cutoff) {
+    co_return serial_fib(n);
+  }
+  long a = co_await fib(cutoff, n - 1);
+  long b = co_await fib(cutoff, n - 2);
+  co_return a + b;
+}
+
+template <class Alloc>
+exec::task<long> fib(std::allocator_arg_t, Alloc alloc, long cutoff, long n) {
+  if (n < cutoff) {
+    co_return serial_fib(n);
+  }
+  long a = co_await fib(std::allocator_arg, alloc, cutoff, n - 1);
+  long b = co_await fib(std::allocator_arg, alloc, cutoff, n - 2);
+  co_return a + b;
+}
+
+// The number of fib trees that all threads have computed.
+std::atomic<std::size_t> trees{0};
+
+template <class MakeTask>
+struct run_fib {
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_trees,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    MakeTask make_task{};
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_trees, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        stdexec::sync_wait(make_task());
+        latency.stop(sample);
+      }
+      trees.fetch_add(end - start, std::memory_order_relaxed);
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+struct new_tasks {
+  exec::task<long> operator()() {
+    return fib(std::allocator_arg, std::allocator<long>{}, fib_cutoff, fib_n);
+  }
+};
+
+struct recycling_tasks {
+  exec::task<long> operator()() {
+    return fib(fib_cutoff, fib_n);
+  }
+};
+
+struct pool_tasks {
+  std::pmr::unsynchronized_pool_resource resource;
+
+  exec::task<long> operator()() {
+    return fib(
+      std::allocator_arg, std::pmr::polymorphic_allocator<long>{&resource}, fib_cutoff, fib_n);
+  }
+};
+
+struct recycling : run_fib<recycling_tasks> {
+  static constexpr std::string_view name = "recycling";
+};
+
+struct new_delete : run_fib<new_tasks> {
+  static constexpr std::string_view name = "new";
+};
+
+struct pool : run_fib<pool_tasks> {
+  static constexpr std::string_view name = "pool";
+};
+
+int main(int argc, char** argv) {
+  std::size_t allocations_before = allocations.load();
+  my_main_variants<exec::static_thread_pool, recycling, new_delete, pool>(argc, argv);
+  if (parse_benchmark_options(argc, argv).format == "text" && trees.load() != 0) {
+    auto nodes = static_cast<double>(trees.load() * count_nodes(fib_cutoff, fib_n));
+    std::cout << "allocations per node: "
+              << static_cast<double>(allocations.load() - allocations_before) / nodes << "\n";
+  }
+}
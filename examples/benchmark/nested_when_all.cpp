@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Connects and starts a binary tree of nested when_all senders with a
+// stoppable receiver. Every thread connects and starts its share of the
+// trees.
+//
+//   shared-D  the leaves cannot fail, so every when_all shares the stop token
+//             of the receiver and no stop callback is registered
+//   own-D     the leaves may throw, so every when_all has a stop source of its
+//             own and registers a stop callback with its parent
+//
+// where D is the depth of the tree: 1, 2, 4 or 6. A tree of depth D has
+// 2^D - 1 when_alls.
+
+#include "./common.hpp"
+#include <exec/env.hpp>
+#include <stdexec/execution.hpp>
+
+namespace ex = stdexec;
+
+struct sink_receiver {
+  using receiver_concept = ex::receiver_t;
+
+  ex::in_place_stop_token token_;
+
+  template <class... Args>
+  friend void tag_invoke(ex::set_value_t, sink_receiver&&, Args&&...) noexcept {
+  }
+
+  template <class Error>
+  friend void tag_invoke(ex::set_error_t, sink_receiver&&, Error&&) noexcept {
+  }
+
+  friend void tag_invoke(ex::set_stopped_t, sink_receiver&&) noexcept {
+  }
+
+  friend auto tag_invoke(ex::get_env_t, const sink_receiver& self) noexcept {
+    return exec::make_env(exec::with(ex::get_stop_token, self.token_));
+  }
+};
+
+template <std::size_t Depth, bool Nothrow>
+auto make_tree() {
+  if constexpr (Depth == 0) {
+    return ex::just() | ex::then([]() noexcept(Nothrow) {});
+  } else {
+    return ex::when_all(make_tree<Depth - 1, Nothrow>(), make_tree<Depth - 1, Nothrow>());
+  }
+}
+
+template <std::size_t Depth, bool Nothrow>
+struct run_trees {
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_trees,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    ex::in_place_stop_source stop_source;
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_trees, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        auto op = ex::connect(make_tree<Depth, Nothrow>(), sink_receiver{stop_source.get_token()});
+        ex::start(op);
+        latency.stop(sample);
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+struct shared_1 : run_trees<1, true> {
+  static constexpr std::string_view name = "shared-1";
+};
+
+struct own_1 : run_trees<1, false> {
+  static constexpr std::string_view name = "own-1";
+};
+
+struct shared_2 : run_trees<2, true> {
+  static constexpr std::string_view name = "shared-2";
+};
+
+struct own_2 : run_trees<2, false> {
+  static constexpr std::string_view name = "own-2";
+};
+
+struct shared_4 : run_trees<4, true> {
+  static constexpr std::string_view name = "shared-4";
+};
+
+struct own_4 : run_trees<4, false> {
+  static constexpr std::string_view name = "own-4";
+};
+
+struct shared_6 : run_trees<6, true> {
+  static constexpr std::string_view name = "shared-6";
+};
+
+struct own_6 : run_trees<6, false> {
+  static constexpr std::string_view name = "own-6";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<
+    exec::static_thread_pool,
+    shared_4,
+    own_4,
+    shared_1,
+    own_1,
+    shared_2,
+    own_2,
+    shared_6,
+    own_6>(argc, argv);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "./common.hpp"
+#include <exec/numa_memory_resource.hpp>
+#include <exec/static_thread_pool.hpp>
+
+// Every thread allocates and frees blocks of the sizes of small operation
+// states from the numa_memory_resource of its node, which all the threads of
+// the node share. A thread keeps the last few blocks alive, and every
+// iteration frees the oldest of them and allocates a new one. With more
+// threads, this measures how much the threads contend for the resource.
+struct RunThread {
+  static constexpr std::size_t live_blocks = 32;
+  static constexpr std::array<std::size_t, 4> sizes{48, 96, 200, 64};
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_allocs,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    exec::numa_memory_resource& resource = *pool.get_numa_memory_resource(numa_node);
+    std::array<std::pair<void*, std::size_t>, live_blocks> blocks{};
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_allocs, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        auto& [ptr, size] = blocks[i % live_blocks];
+        if (ptr != nullptr) {
+          resource.deallocate(ptr, size);
+        }
+        size = sizes[i % sizes.size()];
+        ptr = resource.allocate(size);
+        latency.stop(sample);
+      }
+      for (auto& [ptr, size]: blocks) {
+        if (ptr != nullptr) {
+          resource.deallocate(std::exchange(ptr, nullptr), size);
+        }
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+int main(int argc, char** argv) {
+  my_main<exec::static_thread_pool, RunThread>(argc, argv);
+}
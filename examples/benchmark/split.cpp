@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "./common.hpp"
+#include <stdexec/execution.hpp>
+#include <exec/env.hpp>
+
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+// Measures the cost of creating a split sender and fanning its result out to
+// a fixed number of consumers, with and without an allocator for the shared
+// state. Every thread splits its share of the iterations.
+//
+//   new-N   the shared state is allocated with new and delete
+//   pool-N  the shared state is allocated from an unsynchronized pool
+//           resource of the thread
+//
+// where N is the number of consumers: 1, 2 or 16.
+
+using payload = std::vector<int>;
+
+template <class Sender, std::size_t... Is>
+void consume(const Sender& shared, std::index_sequence<Is...>) {
+  stdexec::sync_wait(stdexec::when_all(((void) Is, shared)...));
+}
+
+template <std::size_t Consumers, class Env>
+void fan_out(const payload& value, const Env& env) {
+  auto shared = stdexec::split(stdexec::just(value), env);
+  if constexpr (Consumers == 1) {
+    // A split sender that is moved into its only consumer takes the direct path.
+    stdexec::sync_wait(std::move(shared));
+  } else {
+    consume(shared, std::make_index_sequence<Consumers>{});
+  }
+}
+
+template <std::size_t Consumers, bool UsePool>
+struct run_split {
+  static constexpr std::size_t payload_size = 16;
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_splits,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    payload value(payload_size, 42);
+    std::pmr::unsynchronized_pool_resource resource;
+    auto env = [&] {
+      if constexpr (UsePool) {
+        return exec::make_env(exec::with(
+          stdexec::get_allocator, std::pmr::polymorphic_allocator<std::byte>{&resource}));
+      } else {
+        return stdexec::empty_env{};
+      }
+    }();
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] = exec::_pool_::even_share(total_splits, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        fan_out<Consumers>(value, env);
+        latency.stop(sample);
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+struct new_1 : run_split<1, false> {
+  static constexpr std::string_view name = "new-1";
+};
+
+struct new_2 : run_split<2, false> {
+  static constexpr std::string_view name = "new-2";
+};
+
+struct new_16 : run_split<16, false> {
+  static constexpr std::string_view name = "new-16";
+};
+
+struct pool_1 : run_split<1, true> {
+  static constexpr std::string_view name = "pool-1";
+};
+
+struct pool_2 : run_split<2, true> {
+  static constexpr std::string_view name = "pool-2";
+};
+
+struct pool_16 : run_split<16, true> {
+  static constexpr std::string_view name = "pool-16";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<exec::static_thread_pool, new_1, new_2, new_16, pool_1, pool_2, pool_16>(
+    argc, argv);
+}
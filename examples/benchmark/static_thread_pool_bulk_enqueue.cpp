@@ -31,7 +31,9 @@ struct RunThread {
     std::span<char> buffer,
 #endif
     std::atomic<bool>& stop,
-    exec::numa_policy* numa) {
+    exec::numa_policy* numa,
+    // The items of the sequence are not timed one by one.
+    [[maybe_unused]] latency_recorder& latency) {
     int numa_node = numa->thread_index_to_node(tid);
     numa->bind_to_node(numa_node);
     while (true) {
@@ -27,7 +27,8 @@ struct RunThread {
     std::span<char> buffer,
 #endif
     std::atomic<bool>& stop,
-    exec::numa_policy* numa) {
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
     int numa_node = numa->thread_index_to_node(tid);
     numa->bind_to_node(numa_node);
     auto scheduler = pool.get_scheduler();
@@ -50,9 +51,11 @@ struct RunThread {
         stdexec::schedule(scheduler) //
         | stdexec::then([&] {
             while (scheds) {
+              auto sample = latency.start();
               stdexec::start_detached(       //
                 stdexec::schedule(scheduler) //
-                  | stdexec::then([&] {
+                  | stdexec::then([&, sample] {
+                      latency.stop(sample);
                       auto prev = counter.fetch_sub(1);
                       if (prev == 1) {
                         std::lock_guard lock{mut};
@@ -71,9 +74,11 @@ struct RunThread {
         stdexec::schedule(scheduler) //
         | stdexec::then([&] {
             while (scheds) {
+              auto sample = latency.start();
               stdexec::start_detached(       //
                 stdexec::schedule(scheduler) //
-                | stdexec::then([&] {
+                | stdexec::then([&, sample] {
+                    latency.stop(sample);
                     auto prev = counter.fetch_sub(1);
                     if (prev == 1) {
                       std::lock_guard lock{mut};
@@ -27,7 +27,8 @@ struct RunThread {
     std::span<char> buffer,
 #endif
     std::atomic<bool>& stop,
-    exec::numa_policy* numa) {
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
     int numa_node = numa->thread_index_to_node(tid);
     numa->bind_to_node(numa_node);
     auto scheduler = pool.get_scheduler();
@@ -47,9 +48,11 @@ struct RunThread {
       std::atomic<std::size_t> counter{scheds};
       auto env = exec::make_env(exec::with(stdexec::get_allocator, alloc));
       while (scheds) {
+        auto sample = latency.start();
         stdexec::start_detached(       //
           stdexec::schedule(scheduler) //
-            | stdexec::then([&] {
+            | stdexec::then([&, sample] {
+                latency.stop(sample);
                 auto prev = counter.fetch_sub(1);
                 if (prev == 1) {
                   std::lock_guard lock{mut};
@@ -64,9 +67,11 @@ struct RunThread {
       std::size_t scheds = end - start;
       std::atomic<std::size_t> counter{scheds};
       while (scheds) {
+        auto sample = latency.start();
         stdexec::start_detached(       //
           stdexec::schedule(scheduler) //
-          | stdexec::then([&] {
+          | stdexec::then([&, sample] {
+              latency.stop(sample);
               auto prev = counter.fetch_sub(1);
               if (prev == 1) {
                 std::lock_guard lock{mut};
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Compares stdexec::in_place_stop_source with exec::sharded_stop_source when
+// all threads share one source. The variants are named SOURCE-SCENARIO, where
+// SOURCE is in_place or sharded and SCENARIO is one of:
+//
+//   register  every thread constructs and destroys its share of the stop
+//             callbacks in a loop
+//   fan-in    the first thread registers all callbacks between the runs, like
+//             when_all_range does for its children, and every thread destroys
+//             its share of them
+//   cancel    every thread registers its share of the callbacks between the
+//             runs, and a run is the first thread's request_stop() until all
+//             threads have destroyed their callbacks. The latencies are the
+//             times from request_stop() until a callback has run.
+//
+// The iterations are the callbacks of a run.
+
+#include "./common.hpp"
+#include <exec/sharded_stop_token.hpp>
+#include <stdexec/stop_token.hpp>
+
+using clock_type = std::chrono::steady_clock;
+
+struct noop {
+  void operator()() const noexcept {
+  }
+};
+
+template <class Source, class Fun>
+using callback_for =
+  typename decltype(std::declval<const Source&>().get_token())::template callback_type<Fun>;
+
+template <class Source>
+struct run_register {
+  inline static Source source{};
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_callbacks,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    using callback_t = callback_for<Source, noop>;
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] =
+        exec::_pool_::even_share(total_callbacks, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        callback_t cb{source.get_token(), noop{}};
+        latency.stop(sample);
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+template <class Source>
+struct run_fan_in {
+  using callback_t = callback_for<Source, noop>;
+
+  inline static Source source{};
+  inline static std::vector<std::optional<callback_t>> callbacks{};
+
+  static void register_all(std::size_t total_callbacks) {
+    callbacks = std::vector<std::optional<callback_t>>(total_callbacks);
+    for (std::optional<callback_t>& cb: callbacks) {
+      cb.emplace(source.get_token(), noop{});
+    }
+  }
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_callbacks,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    // The other threads wait for the first one at the barrier, outside of
+    // the timed region.
+    if (tid == 0) {
+      register_all(total_callbacks);
+    }
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] =
+        exec::_pool_::even_share(total_callbacks, tid, pool.available_parallelism());
+      for (std::size_t i = start; i < end; ++i) {
+        auto sample = latency.start();
+        callbacks[i].reset();
+        latency.stop(sample);
+      }
+      barrier.arrive_and_wait();
+      if (tid == 0) {
+        register_all(total_callbacks);
+      }
+    }
+    if (tid == 0) {
+      callbacks.clear();
+    }
+  }
+};
+
+template <class Source>
+struct run_cancel {
+  // Records the time from request_stop() until it is called, if its
+  // registration was sampled.
+  struct record_latency {
+    latency_recorder* latency_;
+    bool sampled_;
+
+    void operator()() const noexcept;
+  };
+
+  using callback_t = callback_for<Source, record_latency>;
+
+  // Run r stops sources[r % 2]. The first thread replaces a source after its
+  // run, while the threads register with the other one for the next run.
+  inline static std::array<std::unique_ptr<Source>, 2> sources{
+    std::make_unique<Source>(),
+    std::make_unique<Source>()};
+  inline static clock_type::time_point stop_requested_at{};
+  inline static std::atomic<std::size_t> runs_stopped{0};
+
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_callbacks,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    auto [start, end] =
+      exec::_pool_::even_share(total_callbacks, tid, pool.available_parallelism());
+    std::vector<std::optional<callback_t>> callbacks(end - start);
+    auto register_all = [&](Source& source) {
+      for (std::optional<callback_t>& cb: callbacks) {
+        bool sampled = latency.start() != clock_type::time_point{};
+        cb.emplace(source.get_token(), record_latency{&latency, sampled});
+      }
+    };
+    register_all(*sources[0]);
+    for (std::size_t run = 0;; ++run) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      if (tid == 0) {
+        stop_requested_at = clock_type::now();
+        sources[run % 2]->request_stop();
+        runs_stopped.store(run + 1);
+        runs_stopped.notify_all();
+      } else {
+        for (std::size_t stopped = runs_stopped.load(); stopped <= run;
+             stopped = runs_stopped.load()) {
+          runs_stopped.wait(stopped);
+        }
+      }
+      for (std::optional<callback_t>& cb: callbacks) {
+        cb.reset();
+      }
+      barrier.arrive_and_wait();
+      if (tid == 0) {
+        sources[run % 2] = std::make_unique<Source>();
+      }
+      register_all(*sources[(run + 1) % 2]);
+    }
+    for (std::optional<callback_t>& cb: callbacks) {
+      cb.reset();
+    }
+  }
+};
+
+// All callbacks run on the first thread, within request_stop().
+template <class Source>
+void run_cancel<Source>::record_latency::operator()() const noexcept {
+  if (sampled_) {
+    latency_->stop(stop_requested_at);
+  }
+}
+
+struct in_place_register : run_register<stdexec::in_place_stop_source> {
+  static constexpr std::string_view name = "in_place-register";
+};
+
+struct sharded_register : run_register<exec::sharded_stop_source> {
+  static constexpr std::string_view name = "sharded-register";
+};
+
+struct in_place_fan_in : run_fan_in<stdexec::in_place_stop_source> {
+  static constexpr std::string_view name = "in_place-fan-in";
+};
+
+struct sharded_fan_in : run_fan_in<exec::sharded_stop_source> {
+  static constexpr std::string_view name = "sharded-fan-in";
+};
+
+struct in_place_cancel : run_cancel<stdexec::in_place_stop_source> {
+  static constexpr std::string_view name = "in_place-cancel";
+};
+
+struct sharded_cancel : run_cancel<exec::sharded_stop_source> {
+  static constexpr std::string_view name = "sharded-cancel";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<
+    exec::static_thread_pool,
+    sharded_register,
+    in_place_register,
+    sharded_fan_in,
+    in_place_fan_in,
+    sharded_cancel,
+    in_place_cancel>(argc, argv);
+}
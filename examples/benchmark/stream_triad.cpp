@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs the STREAM triad a[i] = b[i] + s * c[i] on a static_thread_pool. The
+// iterations are the elements of the arrays, so that the throughput is in
+// elements per second and the bandwidth is 24 bytes times the throughput. As
+// in STREAM, the arrays are cut into one chunk per thread of the pool, and a
+// bulk of one index per chunk runs a loop over it. Thread 0 submits the triad
+// of every run, and the other threads only wait for it.
+//
+//   bulk         the arrays are std::vectors that thread 0 initializes, and
+//                the triad is a bulk on the scheduler of the pool
+//   partitioned  the arrays are numa_partitioned_buffers whose chunks are
+//                initialized by a bulk on the numa partitioned scheduler,
+//                and the triad is a bulk on the same scheduler, so that every
+//                chunk is read and written on the node that holds it
+
+#include "./common.hpp"
+#include <exec/numa_partitioned_buffer.hpp>
+#include <exec/static_thread_pool.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ex = stdexec;
+
+struct chunk {
+  std::span<double> a;
+  std::span<double> b;
+  std::span<double> c;
+};
+
+// The chunk of every thread of the pool in three std::vectors.
+std::vector<chunk> make_chunks(
+  std::vector<double>& a,
+  std::vector<double>& b,
+  std::vector<double>& c,
+  std::size_t nthreads) {
+  std::vector<chunk> chunks;
+  for (std::size_t t = 0; t < nthreads; ++t) {
+    auto [begin, end] = exec::_pool_::even_share(a.size(), t, nthreads);
+    chunks.push_back(chunk{
+      std::span{a}.subspan(begin, end - begin),
+      std::span{b}.subspan(begin, end - begin),
+      std::span{c}.subspan(begin, end - begin)});
+  }
+  return chunks;
+}
+
+// The chunk of every thread of the pool in three numa_partitioned_buffers.
+// The chunks of the threads of a node are in the slice of that node, and
+// a bulk of shape 'nthreads' on the numa partitioned scheduler runs them on
+// that node.
+std::vector<chunk> make_chunks(
+  exec::static_thread_pool& pool,
+  exec::numa_partitioned_buffer<double>& a,
+  exec::numa_partitioned_buffer<double>& b,
+  exec::numa_partitioned_buffer<double>& c,
+  std::size_t nthreads) {
+  std::vector<chunk> chunks(nthreads);
+  for (std::size_t node = 0; node < pool.num_numa_nodes(); ++node) {
+    auto [first, last] = pool.numa_partition(nthreads, static_cast<int>(node));
+    auto offset = pool.numa_partition(a.size(), static_cast<int>(node)).first;
+    for (std::size_t t = first; t < last; ++t) {
+      auto [begin, end] = exec::_pool_::even_share(a.size(), t, nthreads);
+      begin -= offset;
+      end -= offset;
+      chunks[t] = chunk{
+        a.node_slice(static_cast<int>(node)).subspan(begin, end - begin),
+        b.node_slice(static_cast<int>(node)).subspan(begin, end - begin),
+        c.node_slice(static_cast<int>(node)).subspan(begin, end - begin)};
+    }
+  }
+  return chunks;
+}
+
+template <class Scheduler>
+void init(Scheduler sched, const std::vector<chunk>& chunks) {
+  ex::sync_wait(
+    ex::schedule(sched) //
+    | ex::bulk(chunks.size(), [&](std::size_t t) {
+        const chunk& ch = chunks[t];
+        std::fill(ch.a.begin(), ch.a.end(), 0.0);
+        std::fill(ch.b.begin(), ch.b.end(), 1.0);
+        std::fill(ch.c.begin(), ch.c.end(), 2.0);
+      }));
+}
+
+template <class Scheduler>
+void triad(Scheduler sched, const std::vector<chunk>& chunks) {
+  constexpr double scalar = 3.0;
+  ex::sync_wait(
+    ex::schedule(sched) //
+    | ex::bulk(chunks.size(), [&](std::size_t t) {
+        const chunk& ch = chunks[t];
+        for (std::size_t i = 0; i < ch.a.size(); ++i) {
+          ch.a[i] = ch.b[i] + scalar * ch.c[i];
+        }
+      }));
+}
+
+struct vector_arrays {
+  static auto scheduler(exec::static_thread_pool& pool) {
+    return pool.get_scheduler();
+  }
+
+  vector_arrays(exec::static_thread_pool& pool, std::size_t size)
+    : a(size)
+    , b(size)
+    , c(size)
+    , chunks(make_chunks(a, b, c, pool.available_parallelism())) {
+    init(scheduler(pool), chunks);
+  }
+
+  std::vector<double> a, b, c;
+  std::vector<chunk> chunks;
+};
+
+struct partitioned_arrays {
+  static auto scheduler(exec::static_thread_pool& pool) {
+    return pool.get_numa_partitioned_scheduler();
+  }
+
+  partitioned_arrays(exec::static_thread_pool& pool, std::size_t size)
+    : a{pool, size}
+    , b{pool, size}
+    , c{pool, size}
+    , chunks(make_chunks(pool, a, b, c, pool.available_parallelism())) {
+    init(scheduler(pool), chunks);
+  }
+
+  exec::numa_partitioned_buffer<double> a, b, c;
+  std::vector<chunk> chunks;
+};
+
+// The pool runs the triad, so the threads of the harness other than thread 0
+// have nothing to do but to wait at the barriers. The latency of a single
+// element is not measured.
+template <class Arrays>
+struct run_triad {
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_elements,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    [[maybe_unused]] exec::numa_policy* numa,
+    [[maybe_unused]] latency_recorder& latency) {
+    std::unique_ptr<Arrays> arrays;
+    if (tid == 0) {
+      arrays = std::make_unique<Arrays>(pool, total_elements);
+    }
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      if (tid == 0) {
+        triad(Arrays::scheduler(pool), arrays->chunks);
+      }
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+struct bulk : run_triad<vector_arrays> {
+  static constexpr std::string_view name = "bulk";
+};
+
+struct partitioned : run_triad<partitioned_arrays> {
+  static constexpr std::string_view name = "partitioned";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<exec::static_thread_pool, bulk, partitioned>(argc, argv);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Runs coroutines on a static_thread_pool that co_await senders which
+// complete on the pool, and counts how often the coroutines transition back
+// onto the pool after a co_await. Without the checks that a coroutine already
+// is on its scheduler, there would be one transition per co_await. Every
+// thread runs a coroutine with its share of the iterations on the pool.
+//
+//   erased    exec::task, which stores its scheduler type-erased
+//   concrete  exec::scheduler_task, which stores the pool's scheduler type
+//
+// With --format text, the number of co_awaits and of the transitions that
+// were saved is reported as well.
+
+#include "./common.hpp"
+#include <exec/static_thread_pool.hpp>
+#include <exec/task.hpp>
+#include <stdexec/execution.hpp>
+
+std::atomic<std::size_t> hops{0};
+
+using pool_scheduler = exec::static_thread_pool::scheduler;
+
+// Wraps the pool's scheduler to count the operations that it starts.
+struct counting_scheduler {
+  template <class Receiver>
+  struct operation {
+    stdexec::connect_result_t<stdexec::schedule_result_t<pool_scheduler>, Receiver> op_;
+
+    friend void tag_invoke(stdexec::start_t, operation& self) noexcept {
+      hops.fetch_add(1, std::memory_order_relaxed);
+      stdexec::start(self.op_);
+    }
+  };
+
+  struct env {
+    pool_scheduler sched_;
+
+    template <class CPO>
+    friend counting_scheduler
+      tag_invoke(stdexec::get_completion_scheduler_t<CPO>, const env& self) noexcept {
+      return {self.sched_};
+    }
+  };
+
+  struct sender {
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = stdexec::completion_signatures_of_t<
+      stdexec::schedule_result_t<pool_scheduler>>;
+
+    template <class Receiver>
+    friend operation<Receiver> tag_invoke(stdexec::connect_t, sender self, Receiver rcvr) {
+      return {stdexec::connect(stdexec::schedule(self.sched_), std::move(rcvr))};
+    }
+
+    friend env tag_invoke(stdexec::get_env_t, const sender& self) noexcept {
+      return {self.sched_};
+    }
+
+    pool_scheduler sched_;
+  };
+
+  friend sender tag_invoke(stdexec::schedule_t, const counting_scheduler& self) noexcept {
+    return {self.sched_};
+  }
+
+  friend bool tag_invoke(
+    exec::__current_sched::__is_current_t,
+    const counting_scheduler& self) noexcept {
+    return exec::__current_sched::__is_current(self.sched_);
+  }
+
+  friend stdexec::forward_progress_guarantee
+    tag_invoke(stdexec::get_forward_progress_guarantee_t, const counting_scheduler&) noexcept {
+    return stdexec::forward_progress_guarantee::parallel;
+  }
+
+  bool operator==(const counting_scheduler&) const noexcept = default;
+
+  pool_scheduler sched_;
+};
+
+// Every iteration co_awaits a sender that completes on the scheduler, a
+// sender that completes inline, and a child task.
+template <class Task>
+Task child() {
+  co_await stdexec::just();
+}
+
+template <class Task>
+Task loop(counting_scheduler sched, std::size_t iterations, latency_recorder& latency) {
+  for (std::size_t i = 0; i < iterations; ++i) {
+    auto sample = latency.start();
+    co_await stdexec::schedule(sched);
+    co_await stdexec::just();
+    co_await child<Task>();
+    latency.stop(sample);
+  }
+}
+
+// The number of co_await expressions in one call to loop, including those of
+// the child tasks. Each of them would transition back onto the scheduler.
+std::size_t count_awaits(std::size_t iterations) {
+  return 4 * iterations;
+}
+
+// The co_awaits of all loops, and the hops that they cannot avoid: the hop
+// onto the pool and the explicit schedules.
+std::atomic<std::size_t> awaits{0};
+std::atomic<std::size_t> required_hops{0};
+
+template <class Task>
+struct run_loop {
+  void operator()(
+    exec::static_thread_pool& pool,
+    std::size_t total_iterations,
+    std::size_t tid,
+    std::barrier<>& barrier,
+#ifndef STDEXEC_NO_MONOTONIC_BUFFER_RESOURCE
+    [[maybe_unused]] std::span<char> buffer,
+#endif
+    std::atomic<bool>& stop,
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
+    int numa_node = numa->thread_index_to_node(tid);
+    numa->bind_to_node(numa_node);
+    counting_scheduler sched{pool.get_scheduler()};
+    while (true) {
+      barrier.arrive_and_wait();
+      if (stop.load()) {
+        break;
+      }
+      auto [start, end] =
+        exec::_pool_::even_share(total_iterations, tid, pool.available_parallelism());
+      stdexec::sync_wait(stdexec::on(sched, loop<Task>(sched, end - start, latency)));
+      awaits.fetch_add(count_awaits(end - start), std::memory_order_relaxed);
+      required_hops.fetch_add(1 + end - start, std::memory_order_relaxed);
+      barrier.arrive_and_wait();
+    }
+  }
+};
+
+// Instantiated here rather than from my_main so that GCC does not warn that the
+// coroutine frames use types with internal linkage.
+template struct run_loop<exec::task<void>>;
+template struct run_loop<exec::scheduler_task<void, counting_scheduler>>;
+
+struct erased : run_loop<exec::task<void>> {
+  static constexpr std::string_view name = "erased";
+};
+
+struct concrete : run_loop<exec::scheduler_task<void, counting_scheduler>> {
+  static constexpr std::string_view name = "concrete";
+};
+
+int main(int argc, char** argv) {
+  my_main_variants<exec::static_thread_pool, erased, concrete>(argc, argv);
+  if (parse_benchmark_options(argc, argv).format == "text") {
+    std::size_t saved = awaits.load() - (hops.load() - required_hops.load());
+    std::cout << "co_awaits: " << awaits.load() << ", hops saved: " << saved << "\n";
+  }
+}
@@ -29,7 +29,8 @@ struct RunThread {
     [[maybe_unused]] std::span<char> buffer,
 #endif
     std::atomic<bool>& stop,
-    exec::numa_policy* numa) {
+    exec::numa_policy* numa,
+    latency_recorder& latency) {
     int numa_node = numa->thread_index_to_node(tid);
     numa->bind_to_node(numa_node);
     auto scheduler = pool.get_scheduler();
@@ -47,9 +48,8 @@ struct RunThread {
         stdexec::schedule(scheduler) //
         | stdexec::then([&] {
             for (std::size_t i = 0; i < scheds; ++i) {
-              tg.run([&] {
-                // empty
-              });
+              auto sample = latency.start();
+              tg.run([&, sample] { latency.stop(sample); });
             }
           }));
       tg.wait();
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+
+#include <utility>
+
+namespace exec {
+  namespace __current_sched {
+    using namespace stdexec;
+
+    // The execution context whose work is being run on this thread, if any.
+    // Execution contexts that own their threads, such as static_thread_pool,
+    // set it on each of their threads.
+    inline thread_local const void* __context = nullptr;
+
+    class __context_scope {
+     public:
+      explicit __context_scope(const void* __ctx) noexcept
+        : __prev_(std::exchange(__context, __ctx)) {
+      }
+
+      __context_scope(__context_scope&&) = delete;
+
+      ~__context_scope() {
+        __context = __prev_;
+      }
+
+     private:
+      const void* __prev_;
+    };
+
+    // Returns true if the calling thread is known to be an execution agent
+    // of the scheduler, so that work can continue inline instead of being
+    // scheduled. Schedulers opt in by customizing this query; for the rest
+    // it returns false.
+    struct __is_current_t : __query<__is_current_t> {
+      template <class _Scheduler>
+      bool operator()(const _Scheduler& __sched) const noexcept {
+        if constexpr (tag_invocable<__is_current_t, const _Scheduler&>) {
+          static_assert(nothrow_tag_invocable<__is_current_t, const _Scheduler&>);
+          return tag_invoke(*this, __sched);
+        } else {
+          return same_as<_Scheduler, __inln::__scheduler>;
+        }
+      }
+    };
+
+    inline constexpr __is_current_t __is_current{};
+  } // namespace __current_sched
+} // namespace exec
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/__detail/__recycling_allocator.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace exec {
+  namespace __frame {
+    // Coroutine frames are allocated in units of __block, so that every
+    // allocator provides the alignment that the frames require.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) __block {
+      std::byte __data_[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+    };
+
+    // Every frame is followed by a trailer, which is in turn followed by a
+    // copy of the allocator that the frame was allocated with. The frame's
+    // operator delete only knows the frame's size, which is enough to find
+    // the trailer.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) __trailer {
+      void (*__deallocate_)(__trailer*, void*, std::size_t) noexcept;
+    };
+
+    inline constexpr std::size_t __trailer_offset(std::size_t __size) noexcept {
+      return (__size + alignof(__trailer) - 1) & ~(alignof(__trailer) - 1);
+    }
+
+    inline __trailer* __trailer_of(void* __frame, std::size_t __size) noexcept {
+      return std::launder(
+        reinterpret_cast<__trailer*>(static_cast<char*>(__frame) + __trailer_offset(__size)));
+    }
+
+    template <class _Alloc>
+    struct __frame_allocator {
+      using __alloc_t = typename std::allocator_traits<_Alloc>::template rebind_alloc<__block>;
+      using __traits_t = std::allocator_traits<__alloc_t>;
+      static_assert(alignof(__alloc_t) <= alignof(__trailer));
+
+      static std::size_t __num_blocks(std::size_t __size) noexcept {
+        std::size_t __bytes = __trailer_offset(__size) + sizeof(__trailer) + sizeof(__alloc_t);
+        return (__bytes + sizeof(__block) - 1) / sizeof(__block);
+      }
+
+      static __alloc_t* __allocator_of(const __trailer* __trl) noexcept {
+        return std::launder(reinterpret_cast<__alloc_t*>(const_cast<__trailer*>(__trl) + 1));
+      }
+
+      static void* __allocate(__alloc_t __alloc, std::size_t __size) {
+        __block* __frame = __traits_t::allocate(__alloc, __num_blocks(__size));
+        auto* __trl = ::new (static_cast<void*>(__trailer_of(__frame, __size)))
+          __trailer{&__deallocate};
+        ::new (static_cast<void*>(__trl + 1)) __alloc_t((__alloc_t&&) __alloc);
+        return __frame;
+      }
+
+      static void __deallocate(__trailer* __trl, void* __frame, std::size_t __size) noexcept {
+        __alloc_t* __stored = __allocator_of(__trl);
+        __alloc_t __alloc((__alloc_t&&) *__stored);
+        __stored->~__alloc_t();
+        __traits_t::deallocate(__alloc, static_cast<__block*>(__frame), __num_blocks(__size));
+      }
+    };
+
+    template <class _Alloc>
+    void* __allocate(const _Alloc& __alloc, std::size_t __size) {
+      return __frame_allocator<_Alloc>::__allocate(__alloc, __size);
+    }
+
+    using __default_allocator = stdexec::__recycling_allocator<__block>;
+
+    // Without an allocator, a frame is recycled through a per-thread cache.
+    inline void* __allocate(std::size_t __size) {
+      return __frame_allocator<__default_allocator>::__allocate({}, __size);
+    }
+
+    inline void __deallocate(void* __frame, std::size_t __size) noexcept {
+      __trailer* __trl = __trailer_of(__frame, __size);
+      __trl->__deallocate_(__trl, __frame, __size);
+    }
+
+    template <class _Alloc>
+    concept __allocator = //
+      std::copy_constructible<_Alloc> && //
+      requires(_Alloc& __alloc) {
+        __alloc.allocate(std::size_t{1});
+      };
+
+    // A base for promise types whose frames can be allocated with an
+    // allocator that is passed to the coroutine after std::allocator_arg,
+    // as in `task<int> f(std::allocator_arg_t, Alloc, Args...)`, or after
+    // the object parameter of a member function. The frames of coroutines
+    // that are not passed an allocator are recycled. A frame is allocated
+    // before the expression that awaits the coroutine is evaluated, so it
+    // cannot depend on who awaits it: a coroutine that is spawned by another
+    // one may outlive the other's allocator. Coroutines pass their allocator
+    // on to the ones that they await by calling them with std::allocator_arg.
+    struct __allocating_promise {
+      static void* operator new(std::size_t __size) {
+        return __frame::__allocate(__size);
+      }
+
+      template <__allocator _Alloc, class... _Args>
+      static void* operator new(
+        std::size_t __size,
+        std::allocator_arg_t,
+        const _Alloc& __alloc,
+        const _Args&...) {
+        return __frame::__allocate(__alloc, __size);
+      }
+
+      template <class _Self, __allocator _Alloc, class... _Args>
+      static void* operator new(
+        std::size_t __size,
+        const _Self&,
+        std::allocator_arg_t,
+        const _Alloc& __alloc,
+        const _Args&...) {
+        return __frame::__allocate(__alloc, __size);
+      }
+
+      static void operator delete(void* __frame, std::size_t __size) noexcept {
+        __frame::__deallocate(__frame, __size);
+      }
+    };
+  } // namespace __frame
+} // namespace exec
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/__detail/__config.hpp"
+#include "../../stdexec/__detail/__env.hpp"
+
+#include <utility>
+
+namespace exec {
+  namespace __start_batch {
+    // Work that a scheduler has held back while a batch was active on the
+    // current thread. It is submitted when the batch ends.
+    struct __deferred {
+      void (*__submit_)(__deferred*) noexcept = nullptr;
+      __deferred* __next_ = nullptr;
+    };
+
+    struct __batch {
+      __deferred* __head_ = nullptr;
+
+      void __flush() noexcept {
+        __deferred* __work = std::exchange(__head_, nullptr);
+        while (__work != nullptr) {
+          __deferred* __next = __work->__next_;
+          __work->__submit_(__work);
+          __work = __next;
+        }
+      }
+    };
+
+    inline thread_local __batch* __current_batch = nullptr;
+
+    // The environment of the operations that a __scope starts answers this
+    // query with true. Schedulers only defer the operations that see it, so
+    // that work which the children start from their own code, such as a
+    // sync_wait in a then(), is submitted right away.
+    struct __deferrable_t : stdexec::__query<__deferrable_t> {
+      friend constexpr bool
+        tag_invoke(stdexec::forwarding_query_t, const __deferrable_t&) noexcept {
+        return true;
+      }
+
+      template <class _Env>
+      constexpr bool operator()(const _Env& __env) const noexcept {
+        if constexpr (stdexec::tag_invocable<__deferrable_t, const _Env&>) {
+          return stdexec::tag_invoke(*this, __env);
+        } else {
+          return false;
+        }
+      }
+    };
+
+    inline constexpr __deferrable_t __deferrable{};
+
+    // Whether an operation with a receiver environment of __env that is
+    // started on this thread may be deferred until the end of the current
+    // batch.
+    template <class _Env>
+    bool __active(const _Env& __env) noexcept {
+      return __current_batch != nullptr && __deferrable(__env);
+    }
+
+    // Registers work to be submitted at the end of the current batch. Must
+    // only be called when __active() returns true.
+    inline void __defer(__deferred* __work) noexcept {
+      STDEXEC_ASSERT(__current_batch != nullptr);
+      __work->__next_ = std::exchange(__current_batch->__head_, __work);
+    }
+
+    // While a __scope is alive, schedulers that support it (such as
+    // static_thread_pool) collect the operations that are started on this
+    // thread with a __deferrable environment instead of enqueuing them one
+    // at a time, and submit them in one go when the __scope is destroyed.
+    // A __scope that is opened while another one is alive, by code that a
+    // child runs inline, first submits what the outer one has collected, so
+    // that the child can block on its own work. The children of a __scope
+    // must not block on each other.
+    class __scope {
+     public:
+      __scope() noexcept
+        : __outer_(__current_batch) {
+        if (__outer_ != nullptr) {
+          __outer_->__flush();
+        }
+        __current_batch = &__batch_;
+      }
+
+      __scope(__scope&&) = delete;
+
+      ~__scope() {
+        __current_batch = __outer_;
+        __batch_.__flush();
+      }
+
+     private:
+      __batch __batch_{};
+      __batch* __outer_;
+    };
+  } // namespace __start_batch
+} // namespace exec
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/execution.hpp"
+#include "./any_sender_of.hpp"
+
+#include <exception>
+#include <optional>
+
+namespace exec {
+  namespace __any_sched {
+    using namespace stdexec;
+
+    // The scheduler itself is stored inline if it is no larger than this,
+    // which covers static_thread_pool, run_loop and io_uring_context.
+    inline constexpr std::size_t __inline_size = 4 * sizeof(void*);
+
+    // The schedule operation of the erased scheduler is stored inline in the
+    // operation state of any_scheduler's schedule sender if it is no larger
+    // than this. Again, this covers static_thread_pool, run_loop and
+    // io_uring_context, so that scheduling on them never allocates.
+    struct __op_buffer {
+      alignas(std::max_align_t) std::byte __bytes_[8 * sizeof(void*)];
+    };
+
+    template <class _Op>
+    inline constexpr bool __fits_inline =
+      sizeof(_Op) <= sizeof(__op_buffer) && alignof(_Op) <= alignof(__op_buffer);
+
+    struct __task;
+
+    struct __task_vtable {
+      void (*__set_value_)(__task*) noexcept;
+      void (*__set_error_)(__task*, std::exception_ptr&&) noexcept;
+      void (*__set_stopped_)(__task*) noexcept;
+    };
+
+    // The part of the operation state that does not depend on the receiver.
+    // The erased scheduler's schedule operation completes through it.
+    struct __task : __immovable {
+      const __task_vtable* __vtable_;
+      in_place_stop_token __token_{};
+    };
+
+    struct __task_env {
+      in_place_stop_token __token_;
+
+      friend in_place_stop_token tag_invoke(get_stop_token_t, const __task_env& __self) noexcept {
+        return __self.__token_;
+      }
+    };
+
+    // The erased scheduler's schedule sender is connected to this concrete
+    // receiver, so the schedule operation itself is never type-erased.
+    struct __task_receiver {
+      using receiver_concept = receiver_t;
+      __task* __task_;
+
+      friend void tag_invoke(set_value_t, __task_receiver&& __self) noexcept {
+        __self.__task_->__vtable_->__set_value_(__self.__task_);
+      }
+
+      template <class _Error>
+      friend void tag_invoke(set_error_t, __task_receiver&& __self, _Error&& __err) noexcept {
+        if constexpr (same_as<__decay_t<_Error>, std::exception_ptr>) {
+          __self.__task_->__vtable_->__set_error_(__self.__task_, (_Error&&) __err);
+        } else {
+          __self.__task_->__vtable_->__set_error_(
+            __self.__task_, std::make_exception_ptr((_Error&&) __err));
+        }
+      }
+
+      friend void tag_invoke(set_stopped_t, __task_receiver&& __self) noexcept {
+        __self.__task_->__vtable_->__set_stopped_(__self.__task_);
+      }
+
+      friend __task_env tag_invoke(get_env_t, const __task_receiver& __self) noexcept {
+        return {__self.__task_->__token_};
+      }
+    };
+
+    template <class _Scheduler>
+    using __schedule_op_t = connect_result_t<schedule_result_t<const _Scheduler&>, __task_receiver>;
+
+    template <class _Queries>
+    class __vtable : public __any::__query_vtable<_Queries> {
+     public:
+      void (*__connect_)(const void*, __task*, __op_buffer*);
+      void (*__start_)(__op_buffer*) noexcept;
+      void (*__destroy_)(__op_buffer*) noexcept;
+      forward_progress_guarantee (*__forward_progress_)(const void*) noexcept;
+      bool (*__equal_to_)(const void*, const void*) noexcept;
+
+      const __any::__query_vtable<_Queries>& __queries() const noexcept {
+        return *this;
+      }
+
+     private:
+      template <class _Op>
+      static _Op* __get_op(__op_buffer* __buffer) noexcept {
+        if constexpr (__fits_inline<_Op>) {
+          return std::launder(reinterpret_cast<_Op*>(__buffer->__bytes_));
+        } else {
+          return *std::launder(reinterpret_cast<_Op**>(__buffer->__bytes_));
+        }
+      }
+
+      template <scheduler _Scheduler>
+        requires sender_to<schedule_result_t<const _Scheduler&>, __task_receiver>
+      friend const __vtable*
+        tag_invoke(__any::__create_vtable_t, __mtype<__vtable>, __mtype<_Scheduler>) noexcept {
+        using _Op = __schedule_op_t<_Scheduler>;
+        static const __vtable __vtable_{
+          {*__any::__create_vtable(
+            __mtype<__any::__query_vtable<_Queries>>{}, __mtype<_Scheduler>{})},
+          [](const void* __sched, __task* __task, __op_buffer* __buffer) {
+            auto __connect = [&] {
+              return stdexec::connect(
+                schedule(*static_cast<const _Scheduler*>(__sched)), __task_receiver{__task});
+            };
+            if constexpr (__fits_inline<_Op>) {
+              ::new (static_cast<void*>(__buffer->__bytes_)) _Op(__conv{__connect});
+            } else {
+              using _Alloc = __recycling_allocator<_Op>;
+              _Alloc __alloc{};
+              _Op* __op = std::allocator_traits<_Alloc>::allocate(__alloc, 1);
+              try {
+                ::new (static_cast<void*>(__op)) _Op(__conv{__connect});
+              } catch (...) {
+                std::allocator_traits<_Alloc>::deallocate(__alloc, __op, 1);
+                throw;
+              }
+              ::new (static_cast<void*>(__buffer->__bytes_)) _Op*(__op);
+            }
+          },
+          [](__op_buffer* __buffer) noexcept {
+            stdexec::start(*__get_op<_Op>(__buffer));
+          },
+          [](__op_buffer* __buffer) noexcept {
+            _Op* __op = __get_op<_Op>(__buffer);
+            __op->~_Op();
+            if constexpr (!__fits_inline<_Op>) {
+              __recycling_allocator<_Op> __alloc{};
+              std::allocator_traits<__recycling_allocator<_Op>>::deallocate(__alloc, __op, 1);
+            }
+          },
+          [](const void* __sched) noexcept -> forward_progress_guarantee {
+            return get_forward_progress_guarantee(*static_cast<const _Scheduler*>(__sched));
+          },
+          [](const void* __self, const void* __other) noexcept -> bool {
+            static_assert(
+              noexcept(__declval<const _Scheduler&>() == __declval<const _Scheduler&>()));
+            return *static_cast<const _Scheduler*>(__self)
+                == *static_cast<const _Scheduler*>(__other);
+          }};
+        return &__vtable_;
+      }
+    };
+
+    struct __on_stop_request {
+      in_place_stop_source& __source_;
+
+      void operator()() const noexcept {
+        __source_.request_stop();
+      }
+    };
+
+    // Receivers whose stop token is an in_place_stop_token share it with the
+    // schedule operation. Other stoppable tokens are adapted through a stop
+    // source of our own.
+    template <class _Receiver>
+    struct __stop_state {
+      using __token_t = stop_token_of_t<env_of_t<_Receiver>>;
+      using __callback_t = typename __token_t::template callback_type<__on_stop_request>;
+
+      in_place_stop_token __start(const _Receiver& __rcvr) noexcept {
+        __on_stop_.emplace(get_stop_token(get_env(__rcvr)), __on_stop_request{__source_});
+        return __source_.get_token();
+      }
+
+      void __finish() noexcept {
+        __on_stop_.reset();
+      }
+
+      in_place_stop_source __source_{};
+      std::optional<__callback_t> __on_stop_{};
+    };
+
+    template <class _Receiver>
+      requires same_as<stop_token_of_t<env_of_t<_Receiver>>, in_place_stop_token>
+            || unstoppable_token<stop_token_of_t<env_of_t<_Receiver>>>
+    struct __stop_state<_Receiver> {
+      in_place_stop_token __start(const _Receiver& __rcvr) noexcept {
+        if constexpr (same_as<stop_token_of_t<env_of_t<_Receiver>>, in_place_stop_token>) {
+          return get_stop_token(get_env(__rcvr));
+        } else {
+          return {};
+        }
+      }
+
+      void __finish() noexcept {
+      }
+    };
+
+    template <class _ReceiverId, class _Vtable>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __task {
+        using __id = __operation;
+
+        static void __set_value_(__task* __self) noexcept {
+          __t& __op = *static_cast<__t*>(__self);
+          __op.__stop_.__finish();
+          stdexec::set_value((_Receiver&&) __op.__rcvr_);
+        }
+
+        static void __set_error_(__task* __self, std::exception_ptr&& __eptr) noexcept {
+          __t& __op = *static_cast<__t*>(__self);
+          __op.__stop_.__finish();
+          stdexec::set_error((_Receiver&&) __op.__rcvr_, std::move(__eptr));
+        }
+
+        static void __set_stopped_(__task* __self) noexcept {
+          __t& __op = *static_cast<__t*>(__self);
+          __op.__stop_.__finish();
+          stdexec::set_stopped((_Receiver&&) __op.__rcvr_);
+        }
+
+        static constexpr __task_vtable __task_vtable_{
+          &__set_value_,
+          &__set_error_,
+          &__set_stopped_};
+
+        __t(const _Vtable* __vtable, const void* __sched, _Receiver&& __rcvr)
+          : __task{{}, &__task_vtable_}
+          , __rcvr_((_Receiver&&) __rcvr)
+          , __vtable_{__vtable} {
+          __vtable_->__connect_(__sched, this, &__buffer_);
+        }
+
+        ~__t() {
+          __vtable_->__destroy_(&__buffer_);
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__token_ = __self.__stop_.__start(__self.__rcvr_);
+          __self.__vtable_->__start_(&__self.__buffer_);
+        }
+
+        _Receiver __rcvr_;
+        const _Vtable* __vtable_;
+        STDEXEC_ATTRIBUTE((no_unique_address)) __stop_state<_Receiver> __stop_{};
+        __op_buffer __buffer_;
+      };
+    };
+
+    template <class _Scheduler, class _Vtable>
+    struct __sender {
+      struct __env {
+        _Scheduler __sched_;
+
+        template <__one_of<set_value_t, set_stopped_t> _Tag>
+        friend _Scheduler
+          tag_invoke(get_completion_scheduler_t<_Tag>, const __env& __self) noexcept {
+          return __self.__sched_;
+        }
+      };
+
+      struct __t {
+        using __id = __sender;
+        using sender_concept = sender_t;
+        using completion_signatures = stdexec::completion_signatures<
+          set_value_t(),
+          set_error_t(std::exception_ptr),
+          set_stopped_t()>;
+
+        template <receiver_of<completion_signatures> _Receiver>
+        friend stdexec::__t<__operation<stdexec::__id<_Receiver>, _Vtable>>
+          tag_invoke(connect_t, const __t& __self, _Receiver __rcvr) {
+          return {
+            __self.__sched_.__storage_.__get_vtable(),
+            __self.__sched_.__storage_.__get_object_pointer(),
+            (_Receiver&&) __rcvr};
+        }
+
+        friend __env tag_invoke(get_env_t, const __t& __self) noexcept {
+          return {__self.__sched_};
+        }
+
+        _Scheduler __sched_;
+      };
+    };
+  } // namespace __any_sched
+
+  // A type-erased scheduler. The scheduler is stored inline if it is small
+  // enough, and its schedule operations are stored inline in the operation
+  // states of any_scheduler's schedule sender, so neither schedule nor
+  // connect needs to allocate for common schedulers. get_forward_progress_guarantee
+  // is always forwarded to the erased scheduler; other queries are forwarded
+  // if they are listed in _Queries, as with any_sender.
+  template <auto... _Queries>
+  class any_scheduler {
+    using __vtable_t = __any_sched::__vtable<queries<_Queries...>>;
+    using __query_vtable_t = __any::__query_vtable<queries<_Queries...>>;
+    using __sender_t = stdexec::__t<__any_sched::__sender<any_scheduler, __vtable_t>>;
+
+   public:
+    using __t = any_scheduler;
+    using __id = any_scheduler;
+
+    template <stdexec::__not_decays_to<any_scheduler> _Scheduler>
+      requires stdexec::scheduler<_Scheduler>
+            && stdexec::__callable<
+                 __any::__create_vtable_t,
+                 stdexec::__mtype<__vtable_t>,
+                 stdexec::__mtype<stdexec::__decay_t<_Scheduler>>>
+    any_scheduler(_Scheduler&& __sched)
+      : __storage_{(_Scheduler&&) __sched} {
+    }
+
+    stdexec::__t<__any::__storage<
+      __vtable_t,
+      std::allocator<std::byte>,
+      true,
+      alignof(std::max_align_t),
+      __any_sched::__inline_size>>
+      __storage_;
+
+   private:
+    template <stdexec::same_as<any_scheduler> _Self>
+    friend __sender_t tag_invoke(stdexec::schedule_t, const _Self& __self) {
+      return {__self};
+    }
+
+    template <stdexec::same_as<any_scheduler> _Self>
+    friend stdexec::forward_progress_guarantee
+      tag_invoke(stdexec::get_forward_progress_guarantee_t, const _Self& __self) noexcept {
+      return __self.__storage_.__get_vtable()->__forward_progress_(
+        __self.__storage_.__get_object_pointer());
+    }
+
+    template <class _Tag, stdexec::same_as<any_scheduler> _Self, class... _As>
+      requires stdexec::__callable<const __query_vtable_t&, _Tag, void*, _As...>
+    friend auto tag_invoke(_Tag, const _Self& __self, _As&&... __as) noexcept(
+      stdexec::__nothrow_callable<const __query_vtable_t&, _Tag, void*, _As...>)
+      -> stdexec::__call_result_t<const __query_vtable_t&, _Tag, void*, _As...> {
+      return __self.__storage_.__get_vtable()->__queries()(
+        _Tag{}, __self.__storage_.__get_object_pointer(), (_As&&) __as...);
+    }
+
+    template <stdexec::same_as<any_scheduler> _Self>
+    friend bool operator==(const _Self& __self, const any_scheduler& __other) noexcept {
+      if (__self.__storage_.__get_vtable() != __other.__storage_.__get_vtable()) {
+        return false;
+      }
+      void* __p = __self.__storage_.__get_object_pointer();
+      void* __o = __other.__storage_.__get_object_pointer();
+      return (__p && __o && __self.__storage_.__get_vtable()->__equal_to_(__p, __o))
+          || (!__p && !__o);
+    }
+  };
+} // namespace exec
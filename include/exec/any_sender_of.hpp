@@ -76,8 +76,11 @@ namespace exec {
     template <class>
     struct __query_vfun_fn;
 
+    // get_env is callable with any object, so only objects that customize it
+    // are treated as environment providers. Others, such as schedulers, are
+    // queried directly.
     template <class _EnvProvider>
-      requires __callable<get_env_t, const _EnvProvider&>
+      requires tag_invocable<get_env_t, const _EnvProvider&>
     struct __query_vfun_fn<_EnvProvider> {
       template <class _Tag, class _Ret, class... _As>
         requires __callable<_Tag, env_of_t<const _EnvProvider&>, _As...>
@@ -99,7 +102,7 @@ namespace exec {
     };
 
     template <class _Queryable>
-      requires(!__callable<get_env_t, const _Queryable&>)
+      requires(!tag_invocable<get_env_t, const _Queryable&>)
     struct __query_vfun_fn<_Queryable> {
       template <class _Tag, class _Ret, class... _As>
         requires __callable<_Tag, const _Queryable&, _As...>
@@ -232,12 +235,93 @@ namespace exec {
       {*__create_vtable(__mtype<_ParentVTable>{}, __mtype<_Tp>{})},
       {__storage_vfun_fn<_Storage, _Tp>{}((_StorageCPOs*) nullptr)}...};
 
+    // The number of bytes that type-erased objects reserve to store small
+    // objects without allocating.
+    inline constexpr std::size_t __default_inline_size = 3 * sizeof(void*);
+
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) __alloc_block {
+      std::byte __bytes_[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+    };
+
+    struct __allocator_vtable {
+      void* (*__allocate_)(void*, std::size_t);
+      void (*__deallocate_)(void*, void*, std::size_t) noexcept;
+    };
+
+    template <class _Allocator>
+    inline constexpr __allocator_vtable __allocator_vtbl{
+      [](void* __alloc, std::size_t __bytes) -> void* {
+        using _Alloc = typename std::allocator_traits<_Allocator>::template rebind_alloc<__alloc_block>;
+        _Alloc __block_alloc{*static_cast<_Allocator*>(__alloc)};
+        std::size_t __n = (__bytes + sizeof(__alloc_block) - 1) / sizeof(__alloc_block);
+        return std::allocator_traits<_Alloc>::allocate(__block_alloc, __n);
+      },
+      [](void* __alloc, void* __pointer, std::size_t __bytes) noexcept {
+        using _Alloc = typename std::allocator_traits<_Allocator>::template rebind_alloc<__alloc_block>;
+        _Alloc __block_alloc{*static_cast<_Allocator*>(__alloc)};
+        std::size_t __n = (__bytes + sizeof(__alloc_block) - 1) / sizeof(__alloc_block);
+        std::allocator_traits<_Alloc>::deallocate(
+          __block_alloc, static_cast<__alloc_block*>(__pointer), __n);
+      }};
+
+    // A reference to an allocator whose type has been erased. The referenced
+    // allocator must outlive every allocation made through the reference.
+    // A default-constructed __allocator_ref allocates with std::allocator, as
+    // do over-aligned types.
+    template <class _Ty>
+    class __allocator_ref {
+      template <class>
+      friend class __allocator_ref;
+
+      static constexpr bool __over_aligned = alignof(_Ty) > alignof(__alloc_block);
+
+      void* __alloc_ = nullptr;
+      const __allocator_vtable* __vtable_ = nullptr;
+
+     public:
+      using value_type = _Ty;
+
+      __allocator_ref() = default;
+
+      template <class _Allocator>
+      __allocator_ref(std::allocator_arg_t, _Allocator& __alloc) noexcept
+        : __alloc_{&__alloc}
+        , __vtable_{&__allocator_vtbl<_Allocator>} {
+      }
+
+      template <class _Uy>
+      __allocator_ref(const __allocator_ref<_Uy>& __other) noexcept
+        : __alloc_{__other.__alloc_}
+        , __vtable_{__other.__vtable_} {
+      }
+
+      _Ty* allocate(std::size_t __n) {
+        if (__over_aligned || __vtable_ == nullptr) {
+          return std::allocator<_Ty>{}.allocate(__n);
+        }
+        return static_cast<_Ty*>(__vtable_->__allocate_(__alloc_, __n * sizeof(_Ty)));
+      }
+
+      void deallocate(_Ty* __pointer, std::size_t __n) noexcept {
+        if (__over_aligned || __vtable_ == nullptr) {
+          std::allocator<_Ty>{}.deallocate(__pointer, __n);
+        } else {
+          __vtable_->__deallocate_(__alloc_, __pointer, __n * sizeof(_Ty));
+        }
+      }
+
+      template <class _Uy>
+      bool operator==(const __allocator_ref<_Uy>& __other) const noexcept {
+        return __alloc_ == __other.__alloc_;
+      }
+    };
+
     template <
       class _Vtable,
       class _Allocator,
       bool _Copyable = false,
       std::size_t _Alignment = alignof(std::max_align_t),
-      std::size_t _InlineSize = 3 * sizeof(void*)>
+      std::size_t _InlineSize = __default_inline_size>
     struct __storage {
       class __t;
     };
@@ -246,7 +330,7 @@ namespace exec {
       class _Vtable,
       class _Allocator,
       std::size_t _Alignment = alignof(std::max_align_t),
-      std::size_t _InlineSize = 3 * sizeof(void*)>
+      std::size_t _InlineSize = __default_inline_size>
     struct __immovable_storage {
       class __t : __immovable {
         static constexpr std::size_t __buffer_size = std::max(_InlineSize, sizeof(void*));
@@ -290,6 +374,22 @@ namespace exec {
           }
         }
 
+        template <class _Tp, class... _Args>
+          requires __callable<__create_vtable_t, __mtype<_Vtable>, __mtype<_Tp>>
+        __t(
+          std::allocator_arg_t,
+          const _Allocator& __alloc,
+          std::in_place_type_t<_Tp>,
+          _Args&&... __args)
+          : __vtable_{__get_vtable_of_type<_Tp>()}
+          , __allocator_{__alloc} {
+          if constexpr (__is_small<_Tp>) {
+            __construct_small<_Tp>((_Args&&) __args...);
+          } else {
+            __construct_large<_Tp>((_Args&&) __args...);
+          }
+        }
+
         ~__t() {
           __reset();
         }
@@ -553,11 +653,19 @@ namespace exec {
       }
     };
 
-    template <class _VTable = __empty_vtable, class _Allocator = std::allocator<std::byte>>
-    using __immovable_storage_t = __t<__immovable_storage<_VTable, _Allocator>>;
+    template <
+      class _VTable = __empty_vtable,
+      class _Allocator = std::allocator<std::byte>,
+      std::size_t _InlineSize = __default_inline_size>
+    using __immovable_storage_t = __t<
+      __immovable_storage<_VTable, _Allocator, alignof(std::max_align_t), _InlineSize>>;
 
-    template <class _VTable, class _Allocator = std::allocator<std::byte>>
-    using __unique_storage_t = __t<__storage<_VTable, _Allocator>>;
+    template <
+      class _VTable,
+      class _Allocator = std::allocator<std::byte>,
+      std::size_t _InlineSize = __default_inline_size>
+    using __unique_storage_t =
+      __t<__storage<_VTable, _Allocator, false, alignof(std::max_align_t), _InlineSize>>;
 
     template <class _VTable, class _Allocator = std::allocator<std::byte>>
     using __copyable_storage_t = __t<__storage<_VTable, _Allocator, true>>;
@@ -764,7 +872,11 @@ namespace exec {
       }
     };
 
-    using __immovable_operation_storage = __immovable_storage_t<__operation_vtable>;
+    // Operation states of type-erased senders are allocated with the allocator
+    // of the receiver's environment, or recycled if it has none.
+    template <std::size_t _InlineSize>
+    using __immovable_operation_storage =
+      __immovable_storage_t<__operation_vtable, __allocator_ref<std::byte>, _InlineSize>;
 
     template <class _Sigs, class _Queries>
     using __receiver_ref = __mapply<__mbind_front<__q<__rec::__ref>, _Sigs>, _Queries>;
@@ -838,7 +950,12 @@ namespace exec {
     template <class _ReceiverId>
     using __stoppable_receiver_t = stdexec::__t<__stoppable_receiver<_ReceiverId>>;
 
-    template <class _ReceiverId, bool>
+    // Operation states are connected and freed at a high rate in recursive
+    // algorithms, so by default they are recycled through per-thread caches.
+    template <class _Receiver>
+    using __allocator_of_t = __env_allocator_t<env_of_t<_Receiver>>;
+
+    template <class _ReceiverId, bool, std::size_t _InlineSize>
     struct __operation {
       using _Receiver = stdexec::__t<_ReceiverId>;
 
@@ -850,12 +967,14 @@ namespace exec {
         __t(_Sender&& __sender, _Receiver&& __receiver)
           : __operation_base<_Receiver>{static_cast<_Receiver&&>(__receiver)}
           , __rec_{this}
-          , __storage_{__sender.__connect(__rec_)} {
+          , __alloc_{__env_allocator(stdexec::get_env(this->__rcvr_))}
+          , __storage_{__sender.__connect(__rec_, {std::allocator_arg, __alloc_})} {
         }
 
        private:
         __stoppable_receiver_t<_ReceiverId> __rec_;
-        __immovable_operation_storage __storage_{};
+        STDEXEC_ATTRIBUTE((no_unique_address)) __allocator_of_t<_Receiver> __alloc_;
+        __immovable_operation_storage<_InlineSize> __storage_{};
 
         friend void tag_invoke(start_t, __t& __self) noexcept {
           __self.__on_stop_.emplace(
@@ -867,8 +986,8 @@ namespace exec {
       };
     };
 
-    template <class _ReceiverId>
-    struct __operation<_ReceiverId, false> {
+    template <class _ReceiverId, std::size_t _InlineSize>
+    struct __operation<_ReceiverId, false, _InlineSize> {
       using _Receiver = stdexec::__t<_ReceiverId>;
 
       class __t {
@@ -878,12 +997,14 @@ namespace exec {
         template <class _Sender>
         __t(_Sender&& __sender, _Receiver&& __receiver)
           : __rec_{static_cast<_Receiver&&>(__receiver)}
-          , __storage_{__sender.__connect(__rec_)} {
+          , __alloc_{__env_allocator(stdexec::get_env(__rec_))}
+          , __storage_{__sender.__connect(__rec_, {std::allocator_arg, __alloc_})} {
         }
 
        private:
         STDEXEC_ATTRIBUTE((no_unique_address)) _Receiver __rec_;
-        __immovable_operation_storage __storage_{};
+        STDEXEC_ATTRIBUTE((no_unique_address)) __allocator_of_t<_Receiver> __alloc_;
+        __immovable_operation_storage<_InlineSize> __storage_{};
 
         friend void tag_invoke(start_t, __t& __self) noexcept {
           STDEXEC_ASSERT(__self.__storage_.__get_vtable()->__start_);
@@ -910,9 +1031,14 @@ namespace exec {
       }
     };
 
-    template <class _Sigs, class _SenderQueries = __types<>, class _ReceiverQueries = __types<>>
+    template <
+      class _Sigs,
+      class _SenderQueries = __types<>,
+      class _ReceiverQueries = __types<>,
+      std::size_t _InlineSize = __default_inline_size>
     struct __sender {
       using __receiver_ref_t = __receiver_ref<_Sigs, _ReceiverQueries>;
+      using __operation_storage_t = __immovable_operation_storage<_InlineSize>;
       static constexpr bool __with_in_place_stop_token =
         __v<__mapply<__mall_of<__q<__is_not_stop_token_query_v>>, _ReceiverQueries>>;
 
@@ -924,19 +1050,20 @@ namespace exec {
           return *this;
         }
 
-        __immovable_operation_storage (*__connect_)(void*, __receiver_ref_t);
+        __operation_storage_t (*__connect_)(void*, __receiver_ref_t, __allocator_ref<std::byte>);
        private:
         template <sender_to<__receiver_ref_t> _Sender>
         friend const __vtable*
           tag_invoke(__create_vtable_t, __mtype<__vtable>, __mtype<_Sender>) noexcept {
           static const __vtable __vtable_{
             {*__create_vtable(__mtype<__query_vtable<_SenderQueries>>{}, __mtype<_Sender>{})},
-            [](void* __object_pointer, __receiver_ref_t __receiver)
-              -> __immovable_operation_storage {
+            [](void* __object_pointer,
+               __receiver_ref_t __receiver,
+               __allocator_ref<std::byte> __alloc) -> __operation_storage_t {
               _Sender& __sender = *static_cast<_Sender*>(__object_pointer);
               using __op_state_t = connect_result_t<_Sender, __receiver_ref_t>;
-              return __immovable_operation_storage{
-                std::in_place_type<__op_state_t>, __conv{[&] {
+              return __operation_storage_t{
+                std::allocator_arg, __alloc, std::in_place_type<__op_state_t>, __conv{[&] {
                   return stdexec::connect((_Sender&&) __sender, (__receiver_ref_t&&) __receiver);
                 }}};
             }};
@@ -981,9 +1108,10 @@ namespace exec {
           : __storage_{(_Sender&&) __sndr} {
         }
 
-        __immovable_operation_storage __connect(__receiver_ref_t __receiver) {
+        __operation_storage_t
+          __connect(__receiver_ref_t __receiver, __allocator_ref<std::byte> __alloc = {}) {
           return __storage_.__get_vtable()->__connect_(
-            __storage_.__get_object_pointer(), (__receiver_ref_t&&) __receiver);
+            __storage_.__get_object_pointer(), (__receiver_ref_t&&) __receiver, __alloc);
         }
 
         explicit operator bool() const noexcept {
@@ -991,10 +1119,11 @@ namespace exec {
         }
 
        private:
-        __unique_storage_t<__vtable> __storage_;
+        __unique_storage_t<__vtable, std::allocator<std::byte>, _InlineSize> __storage_;
 
         template <receiver_of<_Sigs> _Rcvr>
-        friend stdexec::__t<__operation<stdexec::__id<__decay_t<_Rcvr>>, __with_in_place_stop_token>>
+        friend stdexec::__t<
+          __operation<stdexec::__id<__decay_t<_Rcvr>>, __with_in_place_stop_token, _InlineSize>>
           tag_invoke(connect_t, __t&& __self, _Rcvr&& __rcvr) {
           return {(__t&&) __self, (_Rcvr&&) __rcvr};
         }
@@ -1111,13 +1240,19 @@ namespace exec {
       : __receiver_(__receiver) {
     }
 
-    template <auto... _SenderQueries>
-    class any_sender {
-      using __sender_base = stdexec::__t<
-        __any::__sender<_Completions, queries<_SenderQueries...>, queries<_ReceiverQueries...>>>;
+    // A type-erased sender that stores senders of up to _InlineSize bytes,
+    // and their operation states, without allocating. Operation states that
+    // do not fit are allocated with the receiver's allocator.
+    template <std::size_t _InlineSize, auto... _SenderQueries>
+    class basic_any_sender {
+      using __sender_base = stdexec::__t<__any::__sender<
+        _Completions,
+        queries<_SenderQueries...>,
+        queries<_ReceiverQueries...>,
+        _InlineSize>>;
       __sender_base __sender_;
 
-      template <class _Tag, stdexec::__decays_to<any_sender> Self, class... _As>
+      template <class _Tag, stdexec::__decays_to<basic_any_sender> Self, class... _As>
         requires stdexec::tag_invocable< _Tag, stdexec::__copy_cvref_t<Self, __sender_base>, _As...>
       friend auto tag_invoke(_Tag, Self&& __self, _As&&... __as) noexcept(
         std::is_nothrow_invocable_v< _Tag, stdexec::__copy_cvref_t<Self, __sender_base>, _As...>) {
@@ -1127,9 +1262,9 @@ namespace exec {
       using sender_concept = stdexec::sender_t;
       using completion_signatures = typename __sender_base::completion_signatures;
 
-      template <stdexec::__not_decays_to<any_sender> _Sender>
+      template <stdexec::__not_decays_to<basic_any_sender> _Sender>
         requires stdexec::sender_to<_Sender, __receiver_base>
-      any_sender(_Sender&& __sender) noexcept(
+      basic_any_sender(_Sender&& __sender) noexcept(
         stdexec::__nothrow_constructible_from<__sender_base, _Sender>)
         : __sender_((_Sender&&) __sender) {
       }
@@ -1162,10 +1297,13 @@ namespace exec {
           stdexec::get_completion_scheduler<stdexec::set_value_t>.signature<any_scheduler() noexcept>;
         template <class... _Queries>
         using __schedule_sender_fn =
-          typename __schedule_receiver::template any_sender< __any_scheduler_noexcept_signature>;
+          typename __schedule_receiver::template basic_any_sender<
+            _InlineSize,
+            __any_scheduler_noexcept_signature>;
 #else
         template <class... _Queries>
-        using __schedule_sender_fn = typename __schedule_receiver::template any_sender<
+        using __schedule_sender_fn = typename __schedule_receiver::template basic_any_sender<
+          _InlineSize,
           stdexec::get_completion_scheduler<stdexec::set_value_t>.template signature<any_scheduler() noexcept>>;
 #endif
         using __schedule_sender =
@@ -1202,5 +1340,8 @@ namespace exec {
           operator==(const any_scheduler& __self, const any_scheduler& __other) noexcept = default;
       };
     };
+
+    template <auto... _SenderQueries>
+    using any_sender = basic_any_sender<__any::__default_inline_size, _SenderQueries...>;
   };
 } // namespace exec
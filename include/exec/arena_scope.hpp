@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/execution.hpp"
+#include "async_scope.hpp"
+#include "env.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // arena_scope
+  namespace __arena {
+    using namespace stdexec;
+
+    // A monotonic buffer that may be allocated from concurrently. Allocating
+    // is a single fetch_add on the current block; the mutex is only taken to
+    // install a new block. Memory is never reused until release() is called.
+    //
+    // Whatever may still use memory of the arena registers as a user with
+    // __enter() and __leave(). __request_release() releases the arena once
+    // it has no users: right away if it has none, or else when the last one
+    // leaves. A thread that enters while the arena is being released waits
+    // until that is done.
+    class __monotonic_arena : __immovable {
+      struct alignas(std::max_align_t) __block {
+        explicit __block(__block* __next, std::size_t __capacity) noexcept
+          : __next_(__next)
+          , __capacity_(__capacity) {
+        }
+
+        std::byte* __data() noexcept {
+          return reinterpret_cast<std::byte*>(this + 1);
+        }
+
+        __block* __next_;
+        std::size_t __capacity_;
+        std::atomic<std::size_t> __used_{0};
+      };
+
+      static constexpr std::size_t __round_up(std::size_t __n, std::size_t __align) noexcept {
+        return (__n + __align - 1) & ~(__align - 1);
+      }
+
+      void __grow_(__block* __full, std::size_t __min_capacity) {
+        std::lock_guard __guard{__mutex_};
+        if (__current_.load(std::memory_order_relaxed) != __full) {
+          // another thread has installed a new block in the meantime
+          return;
+        }
+        std::size_t __capacity = std::max(__next_capacity_, __min_capacity);
+        void* __mem = ::operator new(sizeof(__block) + __capacity);
+        __blocks_ = ::new (__mem) __block{__blocks_, __capacity};
+        __next_capacity_ = 2 * __capacity;
+        __current_.store(__blocks_, std::memory_order_release);
+      }
+
+      static void __free_(__block* __blk) noexcept {
+        __blk->~__block();
+        ::operator delete(static_cast<void*>(__blk));
+      }
+
+     public:
+      explicit __monotonic_arena(std::size_t __initial_capacity) noexcept
+        : __next_capacity_(__round_up(__initial_capacity, alignof(std::max_align_t))) {
+      }
+
+      ~__monotonic_arena() {
+        while (__blocks_ != nullptr) {
+          __free_(std::exchange(__blocks_, __blocks_->__next_));
+        }
+      }
+
+      void* allocate(std::size_t __bytes, std::size_t __align) {
+        const std::size_t __size = __round_up(__bytes, alignof(std::max_align_t))
+                                 + (__align > alignof(std::max_align_t) ? __align : 0);
+        while (true) {
+          __block* __blk = __current_.load(std::memory_order_acquire);
+          if (__blk != nullptr) {
+            std::size_t __offset = __blk->__used_.fetch_add(__size, std::memory_order_relaxed);
+            if (__offset + __size <= __blk->__capacity_) {
+              void* __ptr = __blk->__data() + __offset;
+              std::size_t __space = __size;
+              return std::align(__align, __bytes, __ptr, __space);
+            }
+          }
+          __grow_(__blk, __size);
+        }
+      }
+
+      // Frees every block but the most recent one, which is the largest, and
+      // makes it available again. All memory handed out so far is invalidated.
+      void release() noexcept {
+        std::lock_guard __guard{__mutex_};
+        if (__blocks_ == nullptr) {
+          return;
+        }
+        while (__blocks_->__next_ != nullptr) {
+          __free_(std::exchange(__blocks_->__next_, __blocks_->__next_->__next_));
+        }
+        __blocks_->__used_.store(0, std::memory_order_relaxed);
+        __current_.store(__blocks_, std::memory_order_release);
+      }
+
+      void __enter() noexcept {
+        std::size_t __old = __users_.load(std::memory_order_relaxed);
+        while (true) {
+          if (__old & __releasing_bit) {
+            std::this_thread::yield();
+            __old = __users_.load(std::memory_order_relaxed);
+          } else if (__users_.compare_exchange_weak(
+                       __old, __old + __user_one, std::memory_order_acquire,
+                       std::memory_order_relaxed)) {
+            return;
+          }
+        }
+      }
+
+      void __leave() noexcept {
+        std::size_t __old = __users_.fetch_sub(__user_one, std::memory_order_acq_rel);
+        if (__old == (__user_one | __requested_bit)) {
+          __try_release_();
+        }
+      }
+
+      void __request_release() noexcept {
+        std::size_t __old = __users_.fetch_or(__requested_bit, std::memory_order_acq_rel);
+        if (__old == 0) {
+          __try_release_();
+        }
+      }
+
+     private:
+      static constexpr std::size_t __requested_bit = 1;
+      static constexpr std::size_t __releasing_bit = 2;
+      static constexpr std::size_t __user_one = 4;
+
+      // Only one thread can change the state from exactly __requested_bit,
+      // which means that nobody uses the arena.
+      void __try_release_() noexcept {
+        std::size_t __expected = __requested_bit;
+        if (__users_.compare_exchange_strong(
+              __expected, __releasing_bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+          release();
+          __users_.store(0, std::memory_order_release);
+        }
+      }
+
+      std::atomic<std::size_t> __users_{0};
+      std::atomic<__block*> __current_{nullptr};
+      std::mutex __mutex_{};
+      __block* __blocks_{nullptr};
+      std::size_t __next_capacity_;
+    };
+  } // namespace __arena
+
+  // An allocator that hands out memory from the arena of an arena_scope.
+  // Deallocation is a no-op; the memory is reclaimed all at once when the
+  // scope becomes empty.
+  template <class _Ty>
+  class arena_allocator {
+    template <class>
+    friend class arena_allocator;
+
+    __arena::__monotonic_arena* __arena_;
+
+   public:
+    using value_type = _Ty;
+
+    explicit arena_allocator(__arena::__monotonic_arena& __arena) noexcept
+      : __arena_(&__arena) {
+    }
+
+    template <class _Uy>
+    arena_allocator(const arena_allocator<_Uy>& __other) noexcept
+      : __arena_(__other.__arena_) {
+    }
+
+    _Ty* allocate(std::size_t __n) {
+      if (__n > std::numeric_limits<std::size_t>::max() / sizeof(_Ty)) {
+        throw std::bad_array_new_length();
+      }
+      return static_cast<_Ty*>(__arena_->allocate(__n * sizeof(_Ty), alignof(_Ty)));
+    }
+
+    void deallocate(_Ty*, std::size_t) noexcept {
+    }
+
+    template <class _Uy>
+    friend bool
+      operator==(const arena_allocator& __lhs, const arena_allocator<_Uy>& __rhs) noexcept {
+      return __lhs.__arena_ == __rhs.__arena_;
+    }
+  };
+
+  namespace __arena {
+    using __allocator_env_t = __env::__with<arena_allocator<std::byte>, get_allocator_t>;
+
+    // Keeps the arena from being released for as long as it is alive.
+    class __arena_user {
+      __monotonic_arena* __arena_;
+
+     public:
+      explicit __arena_user(__monotonic_arena& __arena) noexcept
+        : __arena_(&__arena) {
+        __arena_->__enter();
+      }
+
+      __arena_user(__arena_user&& __other) noexcept
+        : __arena_(std::exchange(__other.__arena_, nullptr)) {
+      }
+
+      __arena_user(const __arena_user& __other) noexcept
+        : __arena_(__other.__arena_) {
+        if (__arena_ != nullptr) {
+          __arena_->__enter();
+        }
+      }
+
+      __arena_user& operator=(__arena_user) = delete;
+
+      ~__arena_user() {
+        if (__arena_ != nullptr) {
+          __arena_->__leave();
+        }
+      }
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    struct __user_operation {
+      using _CvrefSender = stdexec::__cvref_t<_CvrefSenderId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using __id = __user_operation;
+
+        __arena_user __user_;
+        connect_result_t<_CvrefSender, _Receiver> __op_;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    // A sender that is nested in an arena_scope. It and its operation state
+    // are users of the arena, since the sender may connect to, and the
+    // operation state may hold, memory of the arena.
+    template <class _SenderId>
+    struct __user_sender {
+      using _Sender = stdexec::__t<_SenderId>;
+
+      struct __t {
+        using __id = __user_sender;
+        using sender_concept = stdexec::sender_t;
+
+        _Sender __sndr_;
+        __arena_user __user_;
+
+        template <class _Self, class _Receiver>
+        using __operation_t = stdexec::__t<
+          __user_operation<__cvref_id<__copy_cvref_t<_Self, _Sender>>, stdexec::__id<_Receiver>>>;
+
+        template <__decays_to<__t> _Self, receiver _Receiver>
+          requires sender_to<__copy_cvref_t<_Self, _Sender>, _Receiver>
+        friend auto tag_invoke(connect_t, _Self&& __self, _Receiver __rcvr)
+          -> __operation_t<_Self, _Receiver> {
+          return {
+            static_cast<_Self&&>(__self).__user_,
+            stdexec::connect(
+              static_cast<_Self&&>(__self).__sndr_, static_cast<_Receiver&&>(__rcvr))};
+        }
+
+        template <__decays_to<__t> _Self, class _Env>
+        friend auto tag_invoke(get_completion_signatures_t, _Self&&, _Env&&)
+          -> completion_signatures_of_t<__copy_cvref_t<_Self, _Sender>, _Env> {
+          return {};
+        }
+
+        friend env_of_t<const _Sender&> tag_invoke(get_env_t, const __t& __self) noexcept {
+          return stdexec::get_env(__self.__sndr_);
+        }
+      };
+    };
+
+    template <class _Sender>
+    using __with_allocator_t = stdexec::__t<
+      __user_sender<__id<__call_result_t<__write_t, _Sender, __allocator_env_t>>>>;
+
+    template <class _Env>
+    using __spawn_env_t = __env::__join_t<__allocator_env_t, _Env>;
+
+    // An async_scope that owns a monotonic arena. The arena is advertised
+    // through get_allocator to every sender that is nested in the scope and
+    // is released in one shot once a sender returned by on_empty() completes.
+    //
+    // Work allocates from the arena before it is counted by the scope, and
+    // its operation state may outlive its completion. So every sender that
+    // nest(), spawn() and spawn_future() create is a user of the arena, from
+    // its creation until it, and the operation state that it is connected
+    // to, are destroyed. The arena is only released when it has no users. If
+    // it still has some when on_empty() completes, the last one to be
+    // destroyed releases it. Memory that is taken from get_allocator()
+    // directly must not be used after on_empty() has completed.
+    class arena_scope : __immovable {
+     public:
+      static constexpr std::size_t default_initial_size = 64 * 1024;
+
+      arena_scope() noexcept
+        : arena_scope(default_initial_size) {
+      }
+
+      explicit arena_scope(std::size_t __initial_size) noexcept
+        : __arena_(__initial_size) {
+      }
+
+      using allocator_type = arena_allocator<std::byte>;
+
+      allocator_type get_allocator() const noexcept {
+        return allocator_type{__arena_};
+      }
+
+      template <sender _Constrained>
+      [[nodiscard]] auto when_empty(_Constrained&& __c) const {
+        return __scope_.when_empty((_Constrained&&) __c);
+      }
+
+      // Completes when the scope is empty, and requests that the arena be
+      // released, so the scope can be reused for the next batch of work.
+      [[nodiscard]] auto on_empty() const {
+        return stdexec::then(__scope_.on_empty(), [__arena = &__arena_]() noexcept {
+          __arena->__request_release();
+        });
+      }
+
+      template <sender _Constrained>
+      using nest_result_t = async_scope::nest_result_t<__with_allocator_t<_Constrained>>;
+
+      template <sender _Constrained>
+      [[nodiscard]] nest_result_t<_Constrained> nest(_Constrained&& __c) {
+        return __scope_.nest(__with_allocator((_Constrained&&) __c));
+      }
+
+      template <__movable_value _Env = empty_env, class _Sender>
+        requires requires(
+          async_scope& __scope, __with_allocator_t<_Sender>&& __sndr, __spawn_env_t<_Env>&& __env) {
+          __scope.spawn((__with_allocator_t<_Sender>&&) __sndr, (__spawn_env_t<_Env>&&) __env);
+        }
+      void spawn(_Sender&& __sndr, _Env __env = {}) {
+        __scope_.spawn(
+          __with_allocator((_Sender&&) __sndr),
+          __env::__join(__allocator_env(), (_Env&&) __env));
+      }
+
+      template <__movable_value _Env = empty_env, class _Sender>
+        requires requires(
+          async_scope& __scope, __with_allocator_t<_Sender>&& __sndr, __spawn_env_t<_Env>&& __env) {
+          __scope.spawn_future(
+            (__with_allocator_t<_Sender>&&) __sndr, (__spawn_env_t<_Env>&&) __env);
+        }
+      auto spawn_future(_Sender&& __sndr, _Env __env = {}) {
+        return __scope_.spawn_future(
+          __with_allocator((_Sender&&) __sndr),
+          __env::__join(__allocator_env(), (_Env&&) __env));
+      }
+
+      in_place_stop_source& get_stop_source() noexcept {
+        return __scope_.get_stop_source();
+      }
+
+      in_place_stop_token get_stop_token() const noexcept {
+        return __scope_.get_stop_token();
+      }
+
+      bool request_stop() noexcept {
+        return __scope_.request_stop();
+      }
+
+     private:
+      __allocator_env_t __allocator_env() const noexcept {
+        return __env::__with(get_allocator(), stdexec::get_allocator);
+      }
+
+      template <class _Sender>
+      __with_allocator_t<_Sender> __with_allocator(_Sender&& __sndr) {
+        return {__write((_Sender&&) __sndr, __allocator_env()), __arena_user{__arena_}};
+      }
+
+      mutable __monotonic_arena __arena_;
+      async_scope __scope_;
+    };
+  } // namespace __arena
+
+  using __arena::arena_scope;
+} // namespace exec
@@ -38,16 +38,80 @@ namespace exec {
     using __env_t = make_env_t< _BaseEnv, with_t<get_stop_token_t, in_place_stop_token>>;
 
     struct __impl {
+      // __active_ counts the running nested operations in units of
+      // __active_one. Its low bit is set while __waiters_ is non-empty. The
+      // lock is only taken to register a waiter and to hand the waiters off
+      // when the last operation completes; nest start and completion are
+      // otherwise lock-free.
+      static constexpr std::size_t __waiters_bit = 1;
+      static constexpr std::size_t __active_one = 2;
+
       in_place_stop_source __stop_source_{};
       mutable std::mutex __lock_{};
-      mutable std::ptrdiff_t __active_ = 0;
+      mutable std::atomic<std::size_t> __active_{0};
       mutable __intrusive_queue<&__task::__next_> __waiters_{};
 
       ~__impl() {
         std::unique_lock __guard{__lock_};
-        STDEXEC_ASSERT(__active_ == 0);
+        STDEXEC_ASSERT(__active_.load(std::memory_order_relaxed) == 0);
         STDEXEC_ASSERT(__waiters_.empty());
       }
+
+      void __add_active_() const noexcept {
+        __active_.fetch_add(__active_one, std::memory_order_relaxed);
+      }
+
+      void __remove_active_() const noexcept {
+        std::size_t __old = __active_.load(std::memory_order_relaxed);
+        do {
+          if (__old == (__active_one | __waiters_bit)) {
+            // This may be the last operation and someone is waiting
+            __remove_last_active_();
+            return;
+          }
+        } while (!__active_.compare_exchange_weak(
+          __old, __old - __active_one, std::memory_order_acq_rel, std::memory_order_relaxed));
+        // do not access this
+      }
+
+      void __remove_last_active_() const noexcept {
+        std::unique_lock __guard{__lock_};
+        // The waiters bit is only cleared while holding the lock, but other
+        // operations may have been nested since we looked at the count.
+        std::size_t __old = __active_.load(std::memory_order_relaxed);
+        std::size_t __new = 0;
+        do {
+          STDEXEC_ASSERT(__old & __waiters_bit);
+          __new = __old == (__active_one | __waiters_bit) ? 0 : __old - __active_one;
+        } while (!__active_.compare_exchange_weak(
+          __old, __new, std::memory_order_acq_rel, std::memory_order_relaxed));
+        if (__new != 0) {
+          return;
+        }
+        auto __local = std::move(__waiters_);
+        __guard.unlock();
+        // do not access this
+        while (!__local.empty()) {
+          auto* __next = __local.pop_front();
+          __next->__notify_waiter(__next);
+          // this must be considered deleted
+        }
+      }
+
+      // Returns true if the scope is currently empty. Otherwise, __waiter is
+      // enqueued and will be notified once the last nested operation completes.
+      bool __try_wait_(__task* __waiter) const noexcept {
+        std::unique_lock __guard{__lock_};
+        std::size_t __old = __active_.load(std::memory_order_acquire);
+        do {
+          if (__old == 0) {
+            return true;
+          }
+        } while (!__active_.compare_exchange_weak(
+          __old, __old | __waiters_bit, std::memory_order_acquire, std::memory_order_acquire));
+        __waiters_.push_back(__waiter);
+        return false;
+      }
     };
 
     ////////////////////////////////////////////////////////////////////////////
@@ -71,15 +135,9 @@ namespace exec {
         }
 
         void __start_() noexcept {
-          std::unique_lock __guard{this->__scope_->__lock_};
-          auto& __active = this->__scope_->__active_;
-          auto& __waiters = this->__scope_->__waiters_;
-          if (__active != 0) {
-            __waiters.push_back(this);
-            return;
+          if (this->__scope_->__try_wait_(this)) {
+            start(this->__op_);
           }
-          __guard.unlock();
-          start(this->__op_);
         }
 
         friend void tag_invoke(start_t, __t& __self) noexcept {
@@ -146,22 +204,6 @@ namespace exec {
         using receiver_concept = stdexec::receiver_t;
         __nest_op_base<_ReceiverId>* __op_;
 
-        static void __complete(const __impl* __scope) noexcept {
-          std::unique_lock __guard{__scope->__lock_};
-          auto& __active = __scope->__active_;
-          if (--__active == 0) {
-            auto __local = std::move(__scope->__waiters_);
-            __guard.unlock();
-            __scope = nullptr;
-            // do not access __scope
-            while (!__local.empty()) {
-              auto* __next = __local.pop_front();
-              __next->__notify_waiter(__next);
-              // __scope must be considered deleted
-            }
-          }
-        }
-
         template < __completion_tag _Tag, class... _As>
           requires __callable<_Tag, _Receiver, _As...>
         friend void tag_invoke(_Tag, __t&& __self, _As&&... __as) noexcept {
@@ -169,7 +211,7 @@ namespace exec {
           _Tag{}(std::move(__self.__op_->__rcvr_), (_As&&) __as...);
           // do not access __op_
           // do not access this
-          __complete(__scope);
+          __scope->__remove_active_();
         }
 
         friend __env_t<env_of_t<_Receiver>> tag_invoke(get_env_t, const __t& __self) noexcept {
@@ -198,10 +240,7 @@ namespace exec {
        private:
         void __start_() noexcept {
           STDEXEC_ASSERT(this->__scope_);
-          std::unique_lock __guard{this->__scope_->__lock_};
-          auto& __active = this->__scope_->__active_;
-          ++__active;
-          __guard.unlock();
+          this->__scope_->__add_active_();
           start(__op_);
         }
 
@@ -253,12 +292,15 @@ namespace exec {
 
     ////////////////////////////////////////////////////////////////////////////
     // async_scope::spawn_future implementation
+    // The state of a spawned future is driven by a single atomic. Only the
+    // transitions out of __created race; every other transition is made by
+    // whichever side won that race.
     enum class __future_step {
       __invalid = 0,
-      __created,
-      __future,
-      __no_future,
-      __deleted
+      __created,    // the result is pending and nobody waits for it
+      __subscribed, // the result is pending and a consumer is waiting for it
+      __no_future,  // the result is pending and all handles have been dropped
+      __completed   // the result is stored in __data_
     };
 
     template <class _Sender, class _Env>
@@ -278,8 +320,6 @@ namespace exec {
       void __complete() noexcept {
         __complete_(this);
       }
-
-      __subscription* __next_ = nullptr;
     };
 
     template <class _SenderId, class _EnvId, class _ReceiverId>
@@ -300,28 +340,20 @@ namespace exec {
           try {
             auto __state = std::move(__state_);
             STDEXEC_ASSERT(__state != nullptr);
-            std::unique_lock __guard{__state->__mutex_};
-            // either the future is still in use or it has passed ownership to __state->__no_future_
-            if (
-              __state->__no_future_.get() != nullptr
-              || __state->__step_ != __future_step::__future) {
+            if (__state->__step_.load(std::memory_order_relaxed) != __future_step::__completed) {
               // invalid state - there is a code bug in the state machine
               std::terminate();
             } else if (get_stop_token(get_env(__rcvr_)).stop_requested()) {
-              __guard.unlock();
               set_stopped((_Receiver&&) __rcvr_);
-              __guard.lock();
             } else {
               std::visit(
-                [this, &__guard]<class _Tup>(_Tup& __tup) {
+                [this]<class _Tup>(_Tup& __tup) {
                   if constexpr (same_as<_Tup, std::monostate>) {
                     std::terminate();
                   } else {
                     std::apply(
-                      [this, &__guard]<class... _As>(auto tag, _As&... __as) {
-                        __guard.unlock();
+                      [this]<class... _As>(auto tag, _As&... __as) {
                         tag((_Receiver&&) __rcvr_, (_As&&) __as...);
-                        __guard.lock();
                       },
                       __tup);
                   }
@@ -334,18 +366,14 @@ namespace exec {
         }
 
         void __start_() noexcept {
-          try {
-            if (!!__state_) {
-              std::unique_lock __guard{__state_->__mutex_};
-              if (__state_->__data_.index() != 0) {
-                __guard.unlock();
-                __complete_();
-              } else {
-                __state_->__subscribers_.push_back(this);
-              }
+          if (!!__state_) {
+            __state_->__subscriber_ = this;
+            auto __expected = __future_step::__created;
+            if (!__state_->__step_.compare_exchange_strong(
+                  __expected, __future_step::__subscribed, std::memory_order_acq_rel)) {
+              STDEXEC_ASSERT(__expected == __future_step::__completed);
+              __complete_();
             }
-          } catch (...) {
-            set_error((_Receiver&&) __rcvr_, std::current_exception());
           }
         }
 
@@ -358,16 +386,7 @@ namespace exec {
 
         ~__t() noexcept {
           if (__state_ != nullptr) {
-            auto __raw_state = __state_.get();
-            std::unique_lock __guard{__raw_state->__mutex_};
-            if (__raw_state->__data_.index() > 0) {
-              // completed given sender
-              // state is no longer needed
-              return;
-            }
-            __raw_state->__no_future_ = std::move(__state_);
-            __raw_state->__step_from_to_(
-              __guard, __future_step::__future, __future_step::__no_future);
+            __state_->__abandon_(std::move(__state_));
           }
         }
 
@@ -460,33 +479,29 @@ namespace exec {
             make_env((_Env&&) __env, with(get_stop_token, __scope->__stop_source_.get_token()))) {
       }
 
-      ~__future_state_base() {
-        std::unique_lock __guard{__mutex_};
-        if (__step_ == __future_step::__created) {
-          // exception during connect() will end up here
-          __step_from_to_(__guard, __future_step::__created, __future_step::__deleted);
-        } else if (__step_ != __future_step::__deleted) {
-          // completing the given sender before the future is dropped will end here
-          __step_from_to_(__guard, __future_step::__future, __future_step::__deleted);
+      // Called when the future, or an operation that was connected to it but
+      // never started, is destroyed. If the spawned sender is still running,
+      // ownership of the state passes to its completion.
+      template <class _State>
+      static void __abandon_(std::unique_ptr<_State> __state) noexcept {
+        auto* __raw_state = __state.get();
+        __raw_state->__no_future_ = std::move(__state);
+        auto __expected = __future_step::__created;
+        if (!__raw_state->__step_.compare_exchange_strong(
+              __expected, __future_step::__no_future, std::memory_order_acq_rel)) {
+          STDEXEC_ASSERT(__expected == __future_step::__completed);
+          // completed given sender
+          // state is no longer needed
+          __raw_state->__no_future_.reset();
         }
       }
 
-      void __step_from_to_(
-        std::unique_lock<std::mutex>& __guard,
-        __future_step __from,
-        __future_step __to) {
-        STDEXEC_ASSERT(__guard.owns_lock());
-        auto actual = std::exchange(__step_, __to);
-        STDEXEC_ASSERT(actual == __from);
-      }
-
       in_place_stop_source __stop_source_;
       std::optional<in_place_stop_callback<__forward_stopped>> __forward_scope_;
-      std::mutex __mutex_;
-      __future_step __step_ = __future_step::__created;
+      std::atomic<__future_step> __step_{__future_step::__created};
+      __subscription* __subscriber_ = nullptr;
       std::unique_ptr<__future_state_base, __dynamic_delete<__future_state_base>> __no_future_;
       __completions_as_variant<_Completions> __data_;
-      __intrusive_queue<&__subscription::__next_> __subscribers_;
       __env_t<_Env> __env_;
     };
 
@@ -502,21 +517,22 @@ namespace exec {
 
         void __dispatch_result_() noexcept {
           auto& __state = *__state_;
-          std::unique_lock __guard{__state.__mutex_};
-          auto __local = std::move(__state.__subscribers_);
           __state.__forward_scope_ = std::nullopt;
-          if (__state.__no_future_.get() != nullptr) {
+          switch (__state.__step_.exchange(__future_step::__completed, std::memory_order_acq_rel)) {
+          case __future_step::__created:
+            // the result will be picked up when the future is started
+            break;
+          case __future_step::__subscribed:
+            __state.__subscriber_->__complete();
+            break;
+          case __future_step::__no_future:
             // nobody is waiting for the results
             // delete this and return
-            __state.__step_from_to_(__guard, __future_step::__no_future, __future_step::__deleted);
-            __guard.unlock();
             __state.__no_future_.reset();
-            return;
-          }
-          __guard.unlock();
-          while (!__local.empty()) {
-            auto* __sub = __local.pop_front();
-            __sub->__complete();
+            break;
+          default:
+            // invalid state - there is a code bug in the state machine
+            std::terminate();
           }
         }
 
@@ -524,15 +540,13 @@ namespace exec {
         friend void tag_invoke(_Tag, __t&& __self, _As&&... __as) noexcept {
           auto& __state = *__self.__state_;
           try {
-            std::unique_lock __guard{__state.__mutex_};
             using _Tuple = __decayed_tuple<_Tag, _As...>;
             __state.__data_.template emplace<_Tuple>(_Tag{}, (_As&&) __as...);
-            __guard.unlock();
-            __self.__dispatch_result_();
           } catch (...) {
             using _Tuple = std::tuple<set_error_t, std::exception_ptr>;
             __state.__data_.template emplace<_Tuple>(set_error_t{}, std::current_exception());
           }
+          __self.__dispatch_result_();
         }
 
         friend const __env_t<_Env>& tag_invoke(get_env_t, const __t& __self) noexcept {
@@ -573,16 +587,7 @@ namespace exec {
 
         ~__t() noexcept {
           if (__state_ != nullptr) {
-            auto __raw_state = __state_.get();
-            std::unique_lock __guard{__raw_state->__mutex_};
-            if (__raw_state->__data_.index() != 0) {
-              // completed given sender
-              // state is no longer needed
-              return;
-            }
-            __raw_state->__no_future_ = std::move(__state_);
-            __raw_state->__step_from_to_(
-              __guard, __future_step::__future, __future_step::__no_future);
+            __state_->__abandon_(std::move(__state_));
           }
         }
        private:
@@ -596,8 +601,6 @@ namespace exec {
 
         explicit __t(std::unique_ptr<__future_state<_Sender, _Env>> __state) noexcept
           : __state_(std::move(__state)) {
-          std::unique_lock __guard{__state_->__mutex_};
-          __state_->__step_from_to_(__guard, __future_step::__created, __future_step::__future);
         }
 
         template <__decays_to<__t> _Self, receiver _Receiver>
@@ -680,7 +683,17 @@ namespace exec {
             __env::__with(__scope->__stop_source_.get_token(), get_stop_token),
             __env::__with(__inln::__scheduler{}, get_scheduler)),
             [](__spawn_op_base<_EnvId>* __op) {
-              delete static_cast<__t*>(__op);
+              auto* __self = static_cast<__t*>(__op);
+              if constexpr (__callable<get_allocator_t, const _Env&>) {
+                auto __alloc = get_allocator(__self->__env_);
+                using _Alloc = decltype(__alloc);
+                using _OpAlloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<__t>;
+                _OpAlloc __op_alloc{__alloc};
+                std::allocator_traits<_OpAlloc>::destroy(__op_alloc, __self);
+                std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __self, 1);
+              } else {
+                delete __self;
+              }
             }}
           , __op_(stdexec::connect((_Sndr&&) __sndr, __spawn_receiver_t<_Env>{this})) {
         }
@@ -729,7 +742,23 @@ namespace exec {
         // start is noexcept so we can assume that the operation will complete
         // after this, which means we can rely on its self-ownership to ensure
         // that it is eventually deleted
-        stdexec::start(*new __op_t{nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_});
+        if constexpr (__callable<get_allocator_t, const _Env&>) {
+          auto __alloc = get_allocator(__env);
+          using _Alloc = decltype(__alloc);
+          using _OpAlloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<__op_t>;
+          _OpAlloc __op_alloc{__alloc};
+          auto __op = std::allocator_traits<_OpAlloc>::allocate(__op_alloc, 1);
+          try {
+            std::allocator_traits<_OpAlloc>::construct(
+              __op_alloc, __op, nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_);
+          } catch (...) {
+            std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __op, 1);
+            throw;
+          }
+          stdexec::start(*__op);
+        } else {
+          stdexec::start(*new __op_t{nest((_Sender&&) __sndr), (_Env&&) __env, &__impl_});
+        }
       }
 
       template <__movable_value _Env = empty_env, sender_in<__env_t<_Env>> _Sender>
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sysfs_numa_policy.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace exec {
+  namespace __sysfs {
+    inline bool __parse_int(std::string_view __str, int& __value) noexcept {
+      const char* __last = __str.data() + __str.size();
+      auto [__ptr, __ec] = std::from_chars(__str.data(), __last, __value);
+      return __ec == std::errc{} && __ptr == __last && __value >= 0;
+    }
+
+    // Parses a cpu list like "0-3,8,10-11" into the ids of its cpus.
+    inline std::vector<int> __parse_cpulist(std::string_view __list) {
+      std::vector<int> __cpus;
+      while (!__list.empty()) {
+        std::size_t __comma = __list.find(',');
+        std::string_view __range = __list.substr(0, __comma);
+        __list.remove_prefix(__comma == __list.npos ? __list.size() : __comma + 1);
+        std::size_t __dash = __range.find('-');
+        int __first = 0;
+        int __last = 0;
+        if (__dash == __range.npos) {
+          if (!__parse_int(__range, __first)) {
+            continue;
+          }
+          __last = __first;
+        } else if (
+          !__parse_int(__range.substr(0, __dash), __first)
+          || !__parse_int(__range.substr(__dash + 1), __last)) {
+          continue;
+        }
+        for (int __cpu = __first; __cpu <= __last; ++__cpu) {
+          __cpus.push_back(__cpu);
+        }
+      }
+      std::sort(__cpus.begin(), __cpus.end());
+      __cpus.erase(std::unique(__cpus.begin(), __cpus.end()), __cpus.end());
+      return __cpus;
+    }
+
+    // Returns the node id of a directory entry named node<N>, or -1.
+    inline int __node_id(const std::string& __name) noexcept {
+      std::string_view __view = __name;
+      int __id = -1;
+      if (!__view.starts_with("node") || !__parse_int(__view.substr(4), __id)) {
+        return -1;
+      }
+      return __id;
+    }
+  }
+
+  inline sysfs_numa_policy::sysfs_numa_policy(
+    numa_placement __placement,
+    const std::filesystem::path& __root)
+    : __placement_(__placement) {
+    __read_topology(__root);
+  }
+
+  inline sysfs_numa_policy::sysfs_numa_policy(
+    std::vector<int> __thread_nodes,
+    const std::filesystem::path& __root)
+    : __thread_nodes_(std::move(__thread_nodes)) {
+    __read_topology(__root);
+  }
+
+  inline void sysfs_numa_policy::__read_topology(const std::filesystem::path& __root) {
+    std::error_code __ec;
+    for (const auto& __entry: std::filesystem::directory_iterator(__root, __ec)) {
+      int __node = __sysfs::__node_id(__entry.path().filename().string());
+      if (__node < 0) {
+        continue;
+      }
+      std::ifstream __file(__entry.path() / "cpulist");
+      std::string __list;
+      std::getline(__file, __list);
+      if (__cpus_.size() <= static_cast<std::size_t>(__node)) {
+        __cpus_.resize(static_cast<std::size_t>(__node) + 1);
+      }
+      __cpus_[__node] = __sysfs::__parse_cpulist(__list);
+    }
+    for (std::size_t __node = 0; __node < __cpus_.size(); ++__node) {
+      if (!__cpus_[__node].empty()) {
+        __nodes_.push_back(static_cast<int>(__node));
+        __total_cpus_ += __cpus_[__node].size();
+      }
+    }
+  }
+
+  inline std::size_t sysfs_numa_policy::num_nodes() {
+    return __nodes_.empty() ? 1 : __cpus_.size();
+  }
+
+  inline std::size_t sysfs_numa_policy::num_cpus(int __node) {
+    if (__nodes_.empty()) {
+      return std::thread::hardware_concurrency();
+    }
+    return cpus(__node).size();
+  }
+
+  inline const std::vector<int>& sysfs_numa_policy::cpus(int __node) const noexcept {
+    static const std::vector<int> __no_cpus{};
+    if (__node < 0 || static_cast<std::size_t>(__node) >= __cpus_.size()) {
+      return __no_cpus;
+    }
+    return __cpus_[__node];
+  }
+
+  inline int sysfs_numa_policy::bind_to_node(int __node) {
+    if (__nodes_.empty()) {
+      return 0;
+    }
+    const std::vector<int>& __node_cpus = cpus(__node);
+    if (__node_cpus.empty()) {
+      return -1;
+    }
+    int __rc = 0;
+    ::cpu_set_t __cpu_set;
+    CPU_ZERO(&__cpu_set);
+    for (int __cpu: __node_cpus) {
+      if (__cpu < CPU_SETSIZE) {
+        CPU_SET(__cpu, &__cpu_set);
+      }
+    }
+    if (::sched_setaffinity(0, sizeof(__cpu_set), &__cpu_set) != 0) {
+      __rc = -1;
+    }
+    constexpr std::size_t __bits = sizeof(unsigned long) * CHAR_BIT;
+    std::vector<unsigned long> __node_mask(static_cast<std::size_t>(__node) / __bits + 1);
+    __node_mask[__node / __bits] |= 1UL << (__node % __bits);
+    // The kernel reads one bit less than the maxnode argument.
+    if (
+      ::syscall(SYS_set_mempolicy, MPOL_BIND, __node_mask.data(), __node_mask.size() * __bits + 1)
+      != 0) {
+      __rc = -1;
+    }
+    return __rc;
+  }
+
+  inline int sysfs_numa_policy::thread_index_to_node(std::size_t __index) {
+    if (__nodes_.empty()) {
+      return 0;
+    }
+    if (!__thread_nodes_.empty()) {
+      return __thread_nodes_[__index % __thread_nodes_.size()];
+    }
+    if (__placement_ == numa_placement::scatter) {
+      return __nodes_[__index % __nodes_.size()];
+    }
+    __index %= __total_cpus_;
+    for (int __node: __nodes_) {
+      if (__index < __cpus_[__node].size()) {
+        return __node;
+      }
+      __index -= __cpus_[__node].size();
+    }
+    STDEXEC_UNREACHABLE();
+  }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../__detail/__numa.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace exec {
+  // How a sysfs_numa_policy places the threads of a pool on the nodes that
+  // have cpus.
+  enum class numa_placement {
+    // Fills the cpus of the first node before those of the next one.
+    compact,
+    // Puts consecutive threads on consecutive nodes.
+    scatter,
+  };
+
+  // A numa_policy that reads the topology from the node directories of sysfs
+  // instead of libnuma, so that it works whether or not STDEXEC_ENABLE_NUMA
+  // is set. The root directory is a parameter, which lets tests describe a
+  // topology of their own with a directory tree of node<N>/cpulist files.
+  // If the root has no node with cpus, the policy behaves like
+  // no_numa_policy.
+  //
+  // bind_to_node() restricts the calling thread to the cpus of the node with
+  // sched_setaffinity and its memory to the node with set_mempolicy.
+  class sysfs_numa_policy : public numa_policy {
+   public:
+    static constexpr const char* default_root = "/sys/devices/system/node";
+
+    explicit sysfs_numa_policy(
+      numa_placement __placement = numa_placement::compact,
+      const std::filesystem::path& __root = default_root);
+
+    // Places the thread with index i on the node __thread_nodes[i % size].
+    explicit sysfs_numa_policy(
+      std::vector<int> __thread_nodes,
+      const std::filesystem::path& __root = default_root);
+
+    // One more than the largest node id, as nodes may be numbered sparsely.
+    std::size_t num_nodes() override;
+
+    std::size_t num_cpus(int __node) override;
+
+    // Returns 0 on success and -1 if one of the system calls failed.
+    int bind_to_node(int __node) override;
+
+    int thread_index_to_node(std::size_t __index) override;
+
+    // The ids of the cpus of the node, in ascending order.
+    const std::vector<int>& cpus(int __node) const noexcept;
+
+   private:
+    void __read_topology(const std::filesystem::path& __root);
+
+    // The cpus of every node, indexed by node id.
+    std::vector<std::vector<int>> __cpus_{};
+    // The ids of the nodes with cpus, in ascending order.
+    std::vector<int> __nodes_{};
+    std::size_t __total_cpus_{0};
+    numa_placement __placement_{numa_placement::compact};
+    std::vector<int> __thread_nodes_{};
+  };
+}
+
+#include "__detail/sysfs_numa_policy.hpp"
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/__detail/__config.hpp"
+
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+
+#include "./__detail/__numa.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace exec {
+  // A pooled memory resource for the memory of one NUMA node, for small and
+  // frequent allocations such as operation states.
+  //
+  // Requests of up to max_pooled_size bytes are rounded up to a power of two
+  // and served from a free list per size. Every thread keeps its own free
+  // lists for each of the last few resources that it used, which it takes
+  // blocks from and returns blocks to without a lock. It exchanges blocks
+  // with the shared, locked free lists of the resource a batch at a time,
+  // when its own list is empty or has grown too long, and when it exits. A
+  // shared free list is refilled with the blocks of a whole run of run_size
+  // bytes, and the runs are cut from chunks that are allocated with the
+  // numa_allocator of the node. Larger requests go to the numa_allocator
+  // directly. The chunks are only freed when the resource is destroyed.
+  //
+  // Every block knows the resource it came from, so a block may be
+  // deallocated through any numa_memory_resource, see deallocate_any(). It
+  // goes to the free list of the deallocating thread for that resource.
+  class numa_memory_resource : public std::pmr::memory_resource {
+   public:
+    static constexpr std::size_t run_size = std::size_t{1} << 16;
+    static constexpr std::size_t max_pooled_size = 4096;
+
+    explicit numa_memory_resource(int node, std::size_t chunk_size = std::size_t{1} << 20)
+      : node_(node)
+      , runs_per_chunk_((std::max)(chunk_size / run_size, std::size_t{1})) {
+    }
+
+    numa_memory_resource(numa_memory_resource&&) = delete;
+
+    ~numa_memory_resource() override {
+      // Blocks that threads still hold in their own lists are dropped when
+      // they would be returned.
+      for (free_list& list: shared_->lists_) {
+        std::lock_guard lock{list.mutex_};
+        list.closed_ = true;
+        list.head_ = nullptr;
+      }
+      numa_allocator<std::byte> alloc{node_};
+      for (chunk& c: chunks_) {
+        alloc.deallocate(c.data_, c.size_);
+      }
+    }
+
+    int node() const noexcept {
+      return node_;
+    }
+
+    // Returns a block that was allocated from any numa_memory_resource to the
+    // resource that it came from.
+    static void deallocate_any(void* ptr, std::size_t bytes, std::size_t alignment) noexcept {
+      std::size_t cls = size_class_(bytes, alignment);
+      if (cls < num_size_classes) {
+        run_header* run = reinterpret_cast<run_header*>(
+          reinterpret_cast<std::uintptr_t>(ptr) & ~(run_size - 1));
+        run->owner_->push_(cls, ptr);
+      } else {
+        large_header* header = static_cast<large_header*>(ptr) - 1;
+        numa_allocator<std::byte>{header->owner_->node_}.deallocate(header->data_, header->size_);
+      }
+    }
+
+   private:
+    static constexpr std::size_t min_pooled_size = 16;
+    static constexpr std::size_t num_size_classes =
+      std::countr_zero(max_pooled_size) - std::countr_zero(min_pooled_size) + 1;
+
+    // The start of every run, which is aligned to run_size.
+    struct alignas(64) run_header {
+      numa_memory_resource* owner_;
+    };
+
+    // The bytes before a block that does not fit in a size class.
+    struct large_header {
+      numa_memory_resource* owner_;
+      std::byte* data_;
+      std::size_t size_;
+    };
+
+    struct free_block {
+      free_block* next_;
+    };
+
+    struct alignas(64) free_list {
+      std::mutex mutex_{};
+      free_block* head_{nullptr};
+      bool closed_{false};
+    };
+
+    // The shared free lists outlive the resource for as long as a thread
+    // still has a list of the resource, so that the thread can find out that
+    // the resource is gone.
+    struct shared_lists {
+      std::array<free_list, num_size_classes> lists_{};
+    };
+
+    struct local_list {
+      free_block* head_{nullptr};
+      std::size_t count_{0};
+    };
+
+    // The free lists of one thread for one resource.
+    struct thread_entry {
+      std::uint64_t id_{0};
+      std::shared_ptr<shared_lists> shared_{};
+      std::array<local_list, num_size_classes> lists_{};
+    };
+
+    struct thread_cache {
+      static constexpr std::size_t num_entries = 4;
+
+      thread_cache() = default;
+      thread_cache(thread_cache&&) = delete;
+
+      ~thread_cache() {
+        for (thread_entry& entry: entries_) {
+          flush_(entry);
+        }
+      }
+
+      std::array<thread_entry, num_entries> entries_{};
+      std::size_t next_victim_{0};
+    };
+
+    // Trivially destructible, so it can still be read after the thread's
+    // cache has been destroyed during thread exit.
+    static inline thread_local thread_cache* this_thread_cache_ = nullptr;
+    static inline thread_local bool thread_cache_closed_ = false;
+
+    struct thread_cache_handle {
+      thread_cache_handle() {
+        this_thread_cache_ = &cache_;
+      }
+
+      thread_cache_handle(thread_cache_handle&&) = delete;
+
+      ~thread_cache_handle() {
+        thread_cache_closed_ = true;
+        this_thread_cache_ = nullptr;
+      }
+
+      thread_cache cache_{};
+    };
+
+    static thread_cache* thread_cache_() {
+      if (this_thread_cache_ == nullptr && !thread_cache_closed_) {
+        static thread_local thread_cache_handle handle;
+      }
+      return this_thread_cache_;
+    }
+
+    // Resources are told apart by an id rather than by their address, which
+    // a later resource may reuse.
+    static std::uint64_t next_id_() noexcept {
+      static std::atomic<std::uint64_t> ids{0};
+      return ids.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    struct chunk {
+      std::byte* data_;
+      std::size_t size_;
+    };
+
+    static std::size_t size_class_(std::size_t bytes, std::size_t alignment) noexcept {
+      std::size_t size = std::bit_ceil((std::max)({bytes, alignment, min_pooled_size}));
+      if (size > max_pooled_size) {
+        return num_size_classes;
+      }
+      return static_cast<std::size_t>(
+        std::countr_zero(size) - std::countr_zero(min_pooled_size));
+    }
+
+    static std::size_t class_size_(std::size_t cls) noexcept {
+      return min_pooled_size << cls;
+    }
+
+    // The number of blocks that a thread moves between its own list and the
+    // shared list at once. A thread keeps at most twice as many.
+    static std::size_t batch_size_(std::size_t cls) noexcept {
+      return std::clamp(max_batch_bytes / class_size_(cls), std::size_t{1}, max_batch);
+    }
+
+    // Returns the blocks of a thread's lists to the shared lists of their
+    // resource, unless it has been destroyed.
+    static void flush_(thread_entry& entry) noexcept {
+      if (entry.shared_ == nullptr) {
+        return;
+      }
+      for (std::size_t cls = 0; cls < num_size_classes; ++cls) {
+        local_list& local = entry.lists_[cls];
+        if (local.head_ != nullptr) {
+          free_list& list = entry.shared_->lists_[cls];
+          std::lock_guard lock{list.mutex_};
+          if (!list.closed_) {
+            free_block* tail = local.head_;
+            while (tail->next_ != nullptr) {
+              tail = tail->next_;
+            }
+            tail->next_ = std::exchange(list.head_, local.head_);
+          }
+        }
+        local = local_list{};
+      }
+      entry.shared_.reset();
+      entry.id_ = 0;
+    }
+
+    // The lists of the calling thread for this resource, or nullptr if the
+    // thread is exiting.
+    thread_entry* thread_entry_() noexcept {
+      thread_cache* cache = thread_cache_();
+      if (cache == nullptr) {
+        return nullptr;
+      }
+      for (thread_entry& entry: cache->entries_) {
+        if (entry.id_ == id_) {
+          return &entry;
+        }
+      }
+      thread_entry& entry =
+        cache->entries_[cache->next_victim_++ % thread_cache::num_entries];
+      flush_(entry);
+      entry.id_ = id_;
+      entry.shared_ = shared_;
+      return &entry;
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+      std::size_t cls = size_class_(bytes, alignment);
+      if (cls == num_size_classes) {
+        return allocate_large_(bytes, alignment);
+      }
+      if (thread_entry* entry = thread_entry_()) {
+        local_list& local = entry->lists_[cls];
+        if (local.head_ == nullptr) {
+          take_(cls, local);
+        }
+        free_block* block = local.head_;
+        local.head_ = block->next_;
+        --local.count_;
+        return block;
+      }
+      local_list single{};
+      take_(cls, single, 1);
+      return single.head_;
+    }
+
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+      deallocate_any(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    // Moves up to a batch of blocks from the shared list into an empty
+    // local list, after refilling the shared list if it is empty.
+    void take_(std::size_t cls, local_list& local, std::size_t count = 0) {
+      if (count == 0) {
+        count = batch_size_(cls);
+      }
+      free_list& list = shared_->lists_[cls];
+      std::unique_lock lock{list.mutex_};
+      while (list.head_ == nullptr) {
+        lock.unlock();
+        refill_(cls);
+        lock.lock();
+      }
+      free_block* tail = list.head_;
+      std::size_t taken = 1;
+      for (; taken < count && tail->next_ != nullptr; ++taken) {
+        tail = tail->next_;
+      }
+      local.head_ = std::exchange(list.head_, tail->next_);
+      local.count_ = taken;
+      tail->next_ = nullptr;
+    }
+
+    void push_(std::size_t cls, void* ptr) noexcept {
+      thread_entry* entry = thread_entry_();
+      if (entry == nullptr) {
+        free_list& list = shared_->lists_[cls];
+        std::lock_guard lock{list.mutex_};
+        list.head_ = ::new (ptr) free_block{list.head_};
+        return;
+      }
+      local_list& local = entry->lists_[cls];
+      local.head_ = ::new (ptr) free_block{local.head_};
+      std::size_t batch = batch_size_(cls);
+      if (++local.count_ <= 2 * batch) {
+        return;
+      }
+      // Returns the oldest batch of blocks, which are at the end of the list.
+      free_block* last = local.head_;
+      for (std::size_t i = 1; i < local.count_ - batch; ++i) {
+        last = last->next_;
+      }
+      free_block* first = std::exchange(last->next_, nullptr);
+      free_block* tail = first;
+      while (tail->next_ != nullptr) {
+        tail = tail->next_;
+      }
+      local.count_ -= batch;
+      free_list& list = shared_->lists_[cls];
+      std::lock_guard lock{list.mutex_};
+      tail->next_ = std::exchange(list.head_, first);
+    }
+
+    // Cuts a new run into blocks of the size class and adds them to its free
+    // list.
+    void refill_(std::size_t cls) {
+      std::byte* run = new_run_();
+      ::new (run) run_header{this};
+      std::size_t size = class_size_(cls);
+      std::size_t first = (std::max)(sizeof(run_header), size);
+      free_block* head = nullptr;
+      free_block* tail = nullptr;
+      for (std::size_t offset = first; offset + size <= run_size; offset += size) {
+        free_block* block = ::new (run + offset) free_block{nullptr};
+        if (tail == nullptr) {
+          head = block;
+        } else {
+          tail->next_ = block;
+        }
+        tail = block;
+      }
+      free_list& list = shared_->lists_[cls];
+      std::lock_guard lock{list.mutex_};
+      tail->next_ = list.head_;
+      list.head_ = head;
+    }
+
+    std::byte* new_run_() {
+      std::lock_guard lock{chunk_mutex_};
+      if (next_run_ == end_run_) {
+        // Allocate one run more than we use, to align the runs to run_size.
+        std::size_t size = (runs_per_chunk_ + 1) * run_size;
+        chunks_.reserve(chunks_.size() + 1);
+        std::byte* data = numa_allocator<std::byte>{node_}.allocate(size);
+        chunks_.push_back(chunk{data, size});
+        auto begin = (reinterpret_cast<std::uintptr_t>(data) + run_size - 1) & ~(run_size - 1);
+        next_run_ = data + (begin - reinterpret_cast<std::uintptr_t>(data));
+        end_run_ = next_run_ + runs_per_chunk_ * run_size;
+      }
+      return std::exchange(next_run_, next_run_ + run_size);
+    }
+
+    void* allocate_large_(std::size_t bytes, std::size_t alignment) {
+      alignment = (std::max)(alignment, alignof(large_header));
+      std::size_t size = sizeof(large_header) + alignment + bytes;
+      std::byte* data = numa_allocator<std::byte>{node_}.allocate(size);
+      void* ptr = data + sizeof(large_header);
+      std::size_t space = size - sizeof(large_header);
+      ptr = std::align(alignment, bytes, ptr, space);
+      ::new (static_cast<large_header*>(ptr) - 1) large_header{this, data, size};
+      return ptr;
+    }
+
+    static constexpr std::size_t max_batch = 32;
+    static constexpr std::size_t max_batch_bytes = 8192;
+
+    int node_;
+    std::size_t runs_per_chunk_;
+    std::uint64_t id_{next_id_()};
+    std::shared_ptr<shared_lists> shared_{std::make_shared<shared_lists>()};
+    std::mutex chunk_mutex_{};
+    std::vector<chunk> chunks_{};
+    std::byte* next_run_{nullptr};
+    std::byte* end_run_{nullptr};
+  };
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "./static_thread_pool.hpp"
+#include "./__detail/__numa.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace exec {
+  // A buffer of `size` elements that is cut into the same slices as the
+  // indices of a bulk of shape `size` on the scheduler of
+  // static_thread_pool::get_numa_partitioned_scheduler(). Every slice is
+  // allocated with the numa_allocator of the node whose threads work on it.
+  // The elements are default-initialized, so that the pages of trivial types
+  // are first touched by the threads of the bulk that fills them.
+  template <class T>
+  class numa_partitioned_buffer {
+    struct slice {
+      std::size_t begin_;
+      std::size_t size_;
+      T* data_;
+      int node_;
+    };
+
+   public:
+    numa_partitioned_buffer(static_thread_pool& pool, std::size_t size)
+      : size_(size) {
+      std::size_t num_nodes = pool.num_numa_nodes();
+      slices_.reserve(num_nodes);
+      try {
+        for (std::size_t node = 0; node < num_nodes; ++node) {
+          auto [begin, end] = pool.numa_partition(size, static_cast<int>(node));
+          if (begin == end) {
+            continue;
+          }
+          numa_allocator<T> alloc{static_cast<int>(node)};
+          T* data = alloc.allocate(end - begin);
+          try {
+            std::uninitialized_default_construct_n(data, end - begin);
+          } catch (...) {
+            alloc.deallocate(data, end - begin);
+            throw;
+          }
+          slices_.push_back(slice{begin, end - begin, data, static_cast<int>(node)});
+        }
+      } catch (...) {
+        destroy_();
+        throw;
+      }
+    }
+
+    numa_partitioned_buffer(numa_partitioned_buffer&&) = delete;
+
+    ~numa_partitioned_buffer() {
+      destroy_();
+    }
+
+    std::size_t size() const noexcept {
+      return size_;
+    }
+
+    T& operator[](std::size_t index) noexcept {
+      const slice& s = find_(index);
+      return s.data_[index - s.begin_];
+    }
+
+    const T& operator[](std::size_t index) const noexcept {
+      const slice& s = find_(index);
+      return s.data_[index - s.begin_];
+    }
+
+    // The elements that the threads of the node work on, which start at the
+    // index numa_partition(size(), node).first.
+    std::span<T> node_slice(int node) noexcept {
+      auto it = std::find_if(slices_.begin(), slices_.end(), [node](const slice& s) {
+        return s.node_ == node;
+      });
+      return it == slices_.end() ? std::span<T>{} : std::span<T>{it->data_, it->size_};
+    }
+
+   private:
+    const slice& find_(std::size_t index) const noexcept {
+      STDEXEC_ASSERT(index < size_);
+      // There are only a few nodes, so a linear search is cheaper than a
+      // binary one.
+      const slice* s = &slices_.back();
+      while (index < s->begin_) {
+        --s;
+      }
+      return *s;
+    }
+
+    void destroy_() noexcept {
+      for (slice& s: slices_) {
+        std::destroy_n(s.data_, s.size_);
+        numa_allocator<T>{s.node_}.deallocate(s.data_, s.size_);
+      }
+      slices_.clear();
+    }
+
+    std::size_t size_;
+    std::vector<slice> slices_;
+  };
+}
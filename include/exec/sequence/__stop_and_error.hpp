@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/execution.hpp"
+
+#include <atomic>
+#include <optional>
+#include <variant>
+
+namespace exec {
+  namespace __seq {
+    using namespace stdexec;
+
+    struct __on_stop_request {
+      in_place_stop_source& __stop_source_;
+
+      void operator()() noexcept {
+        __stop_source_.request_stop();
+      }
+    };
+
+    // A variant of std::monostate and the decayed error types of _Sigs.
+    template <class _Sigs>
+    using __errors_variant_t = //
+      __gather_signal<
+        set_error_t,
+        _Sigs,
+        __q<__decay_t>,
+        __mbind_front_q<__variant, std::monostate>>;
+
+    // The cancellation of a sequence algorithm that runs several operations
+    // at the same time, and the first error of any of them. A stop request of
+    // the receiver, and the first error, are forwarded to all of them through
+    // __stop_source_. _Errors is a variant whose first alternative is
+    // std::monostate.
+    template <class _Env, class _Errors>
+    struct __stop_and_error_state {
+      using __on_stop_t = std::optional<
+        typename stop_token_of_t<_Env&>::template callback_type<__on_stop_request>>;
+
+      void __start_on_stop(const _Env& __env) noexcept {
+        __on_stop_.emplace(get_stop_token(__env), __on_stop_request{__stop_source_});
+      }
+
+      // Keeps the first error and asks all operations to stop.
+      template <class _Error>
+      void __set_error(_Error&& __err) noexcept {
+        int __expected = 0;
+        if (__error_state_.compare_exchange_strong(__expected, 1, std::memory_order_relaxed)) {
+          __errors_.template emplace<__decay_t<_Error>>(static_cast<_Error&&>(__err));
+          __error_state_.store(2, std::memory_order_release);
+        }
+        __stop_source_.request_stop();
+      }
+
+      // Called once all operations are done. Completes the receiver with
+      // the error and returns true if there was one.
+      template <class _Receiver>
+      bool __complete_with_error(_Receiver& __rcvr) noexcept {
+        __on_stop_.reset();
+        if (__error_state_.load(std::memory_order_acquire) == 0) {
+          return false;
+        }
+        std::visit(
+          [&]<class _Error>(_Error& __err) noexcept {
+            if constexpr (!same_as<_Error, std::monostate>) {
+              stdexec::set_error(static_cast<_Receiver&&>(__rcvr), static_cast<_Error&&>(__err));
+            }
+          },
+          __errors_);
+        return true;
+      }
+
+      in_place_stop_source __stop_source_{};
+      __on_stop_t __on_stop_{};
+      std::atomic<int> __error_state_{0};
+      _Errors __errors_{};
+    };
+  }
+}
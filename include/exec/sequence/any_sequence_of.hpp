@@ -172,25 +172,27 @@ namespace exec {
     struct __sender_vtable {
       using __query_vtable_t = __query_vtable<_SenderQueries>;
       using __receiver_ref_t = stdexec::__t<__next_receiver_ref<_Sigs, _ReceiverQueries>>;
+      using __operation_storage_t = __immovable_operation_storage<__default_inline_size>;
 
       struct __t : public __query_vtable_t {
         const __query_vtable_t& queries() const noexcept {
           return *this;
         }
 
-        __immovable_operation_storage (*subscribe_)(void*, __receiver_ref_t);
+        __operation_storage_t (*subscribe_)(void*, __receiver_ref_t, __allocator_ref<std::byte>);
 
         template <class _Sender>
           requires sequence_sender_to<_Sender, __receiver_ref_t>
         friend const __t* tag_invoke(__create_vtable_t, __mtype<__t>, __mtype<_Sender>) noexcept {
           static const __t __vtable_{
             {*__create_vtable(__mtype<__query_vtable_t>{}, __mtype<_Sender>{})},
-            [](void* __object_pointer, __receiver_ref_t __receiver)
-              -> __immovable_operation_storage {
+            [](void* __object_pointer,
+               __receiver_ref_t __receiver,
+               __allocator_ref<std::byte> __alloc) -> __operation_storage_t {
               _Sender& __sender = *static_cast<_Sender*>(__object_pointer);
               using __op_state_t = subscribe_result_t<_Sender, __receiver_ref_t>;
-              return __immovable_operation_storage{
-                std::in_place_type<__op_state_t>, __conv{[&] {
+              return __operation_storage_t{
+                std::allocator_arg, __alloc, std::in_place_type<__op_state_t>, __conv{[&] {
                   return ::exec::subscribe(
                     static_cast<_Sender&&>(__sender), static_cast<__receiver_ref_t&&>(__receiver));
                 }}};
@@ -252,15 +254,16 @@ namespace exec {
           : __storage_{(_Sender&&) __sndr} {
         }
 
-        __immovable_operation_storage __connect(__receiver_ref_t __receiver) {
+        __immovable_operation_storage<__default_inline_size>
+          __connect(__receiver_ref_t __receiver, __allocator_ref<std::byte> __alloc = {}) {
           return __storage_.__get_vtable()->subscribe_(
-            __storage_.__get_object_pointer(), __receiver);
+            __storage_.__get_object_pointer(), __receiver, __alloc);
         }
 
         __unique_storage_t<__vtable_t> __storage_;
 
         template <same_as<__t> _Self, class _Rcvr>
-        friend stdexec::__t<__operation<stdexec::__id<_Rcvr>, true>>
+        friend stdexec::__t<__operation<stdexec::__id<_Rcvr>, true, __default_inline_size>>
           tag_invoke(subscribe_t, _Self&& __self, _Rcvr __rcvr) {
           return {static_cast<_Self&&>(__self), static_cast<_Rcvr&&>(__rcvr)};
         }
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../../stdexec/coroutine.hpp"
+#include "../../stdexec/execution.hpp"
+
+#if !STDEXEC_STD_NO_COROUTINES_
+
+#include "../sequence_senders.hpp"
+#include "../__detail/__frame_allocator.hpp"
+
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace exec {
+  namespace __gen {
+    using namespace stdexec;
+
+    // The part of a subscription that the generator's promise talks to. The
+    // promise does not know the type of the receiver, so the operation state
+    // supplies these functions.
+    template <class _Ty>
+    struct __consumer_base {
+      // Sends the item to the receiver. Returns false if the coroutine is to
+      // be resumed right away.
+      bool (*__yield_)(__consumer_base*, _Ty*) noexcept;
+      // Destroys the coroutine and completes the receiver with the result
+      // of the coroutine.
+      void (*__complete_)(__consumer_base*) noexcept;
+      // Destroys the coroutine and completes the receiver with set_stopped.
+      void (*__stopped_)(__consumer_base*) noexcept;
+
+      in_place_stop_source __stop_source_{};
+    };
+
+    template <class _Ty>
+    struct __env {
+      __consumer_base<_Ty>* __consumer_;
+
+      friend in_place_stop_token tag_invoke(get_stop_token_t, const __env& __self) noexcept {
+        return __self.__consumer_->__stop_source_.get_token();
+      }
+    };
+
+    // The sender of a single item, which refers to the value that the
+    // coroutine yielded. It stays valid until the item completes, since the
+    // coroutine is not resumed before that.
+    template <class _Ty, class _ItemRcvr>
+    struct __item_operation {
+      struct __t {
+        using __id = __item_operation;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        _Ty* __value_;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::set_value(static_cast<_ItemRcvr&&>(__self.__rcvr_), std::move(*__self.__value_));
+        }
+      };
+    };
+
+    template <class _Ty>
+    struct __item {
+      struct __t {
+        using __id = __item;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures = stdexec::completion_signatures<set_value_t(_Ty)>;
+
+        _Ty* __value_;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr) //
+          noexcept(__nothrow_decay_copyable<_ItemRcvr>)
+            -> stdexec::__t<__item_operation<_Ty, _ItemRcvr>> {
+          return {static_cast<_ItemRcvr&&>(__rcvr), __self.__value_};
+        }
+      };
+    };
+
+    template <class _Ty>
+    using __item_t = stdexec::__t<__item<_Ty>>;
+
+    template <class _Ty>
+    struct __promise;
+
+    template <class _Ty>
+    class async_generator;
+
+    template <class _Ty, class _ReceiverId>
+    struct __operation {
+      struct __t;
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __next_receiver {
+      struct __t {
+        using __id = __next_receiver;
+        using receiver_concept = stdexec::receiver_t;
+        using _Receiver = stdexec::__t<_ReceiverId>;
+        stdexec::__t<__operation<_Ty, _ReceiverId>>* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__item_complete(false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__item_complete(true);
+        }
+
+        template <same_as<get_env_t> _GetEnv, __decays_to<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, _Self&& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__rcvr_);
+        }
+      };
+    };
+
+    struct __forward_stop_request {
+      in_place_stop_source& __stop_source_;
+
+      void operator()() noexcept {
+        __stop_source_.request_stop();
+      }
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __operation<_Ty, _ReceiverId>::__t : __consumer_base<_Ty> {
+      using __id = __operation;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __next_receiver_t = stdexec::__t<__next_receiver<_Ty, _ReceiverId>>;
+      using __stop_token_t = stop_token_of_t<env_of_t<_Receiver>>;
+      using __stop_callback_t =
+        typename __stop_token_t::template callback_type<__forward_stop_request>;
+
+      __t(__coro::coroutine_handle<__promise<_Ty>> __coro, _Receiver __rcvr) noexcept
+        : __consumer_base<_Ty>{&__yield, &__complete, &__stopped}
+        , __coro_(__coro)
+        , __rcvr_(static_cast<_Receiver&&>(__rcvr)) {
+      }
+
+      __t(__t&&) = delete;
+
+      ~__t() {
+        if (__coro_) {
+          __coro_.destroy();
+        }
+      }
+
+      // Destroys the coroutine and everything that refers to the receiver,
+      // which can then be completed.
+      void __destroy() noexcept {
+        std::exchange(__coro_, {}).destroy();
+        __on_stop_.reset();
+      }
+
+      static bool __yield(__consumer_base<_Ty>* __base, _Ty* __value) noexcept {
+        auto* __self = static_cast<__t*>(__base);
+        if (__self->__stop_source_.stop_requested()) {
+          __stopped(__base);
+          return true;
+        }
+        try {
+          __self->__next_op_.emplace(__conv{[&] {
+            return stdexec::connect(
+              exec::set_next(__self->__rcvr_, __item_t<_Ty>{__value}), __next_receiver_t{__self});
+          }});
+        } catch (...) {
+          __self->__destroy();
+          stdexec::set_error(static_cast<_Receiver&&>(__self->__rcvr_), std::current_exception());
+          return true;
+        }
+        __self->__ready_.store(false, std::memory_order_relaxed);
+        stdexec::start(*__self->__next_op_);
+        // If the item completed synchronously, resume the coroutine from here
+        // rather than from __item_complete, which would nest the stack frames
+        // of the items.
+        if (__self->__ready_.exchange(true, std::memory_order_acq_rel)) {
+          if (__self->__item_stopped_) {
+            __self->__break();
+            return true;
+          }
+          return false;
+        }
+        return true;
+      }
+
+      void __item_complete(bool __stopped) noexcept {
+        __item_stopped_ = __stopped;
+        if (__ready_.exchange(true, std::memory_order_acq_rel)) {
+          if (__stopped) {
+            __break();
+          } else {
+            __coro_.resume();
+          }
+        }
+      }
+
+      // The receiver does not want any more items.
+      void __break() noexcept {
+        __destroy();
+        exec::__set_value_unless_stopped(static_cast<_Receiver&&>(__rcvr_));
+      }
+
+      static void __complete(__consumer_base<_Ty>* __base) noexcept {
+        auto* __self = static_cast<__t*>(__base);
+        std::exception_ptr __eptr = std::move(__self->__coro_.promise().__eptr_);
+        __self->__destroy();
+        if (__eptr) {
+          stdexec::set_error(static_cast<_Receiver&&>(__self->__rcvr_), std::move(__eptr));
+        } else {
+          stdexec::set_value(static_cast<_Receiver&&>(__self->__rcvr_));
+        }
+      }
+
+      static void __stopped(__consumer_base<_Ty>* __base) noexcept {
+        auto* __self = static_cast<__t*>(__base);
+        __self->__destroy();
+        stdexec::set_stopped(static_cast<_Receiver&&>(__self->__rcvr_));
+      }
+
+      friend void tag_invoke(start_t, __t& __self) noexcept {
+        __self.__on_stop_.emplace(
+          get_stop_token(stdexec::get_env(__self.__rcvr_)),
+          __forward_stop_request{__self.__stop_source_});
+        __self.__coro_.promise().__consumer_ = &__self;
+        __self.__coro_.resume();
+      }
+
+      __coro::coroutine_handle<__promise<_Ty>> __coro_;
+      _Receiver __rcvr_;
+      std::optional<__stop_callback_t> __on_stop_{};
+      std::optional<connect_result_t<next_sender_of_t<_Receiver, __item_t<_Ty>>, __next_receiver_t>>
+        __next_op_{};
+      std::atomic<bool> __ready_{false};
+      bool __item_stopped_{false};
+    };
+
+    template <class _Ty>
+    struct __promise : __frame::__allocating_promise {
+      struct __yield_awaiter {
+        __promise* __self_;
+        _Ty* __value_;
+
+        static constexpr bool await_ready() noexcept {
+          return false;
+        }
+
+        bool await_suspend(__coro::coroutine_handle<>) const noexcept {
+          return __self_->__consumer_->__yield_(__self_->__consumer_, __value_);
+        }
+
+        static void await_resume() noexcept {
+        }
+      };
+
+      struct __copying_yield_awaiter : __yield_awaiter {
+        __copying_yield_awaiter(__promise* __self, const _Ty& __value)
+          : __yield_awaiter{__self, nullptr}
+          , __copy_(__value) {
+          this->__value_ = &__copy_;
+        }
+
+        __copying_yield_awaiter(__copying_yield_awaiter&&) = delete;
+
+        _Ty __copy_;
+      };
+
+      struct __final_awaiter {
+        static constexpr bool await_ready() noexcept {
+          return false;
+        }
+
+        static void await_suspend(__coro::coroutine_handle<__promise> __h) noexcept {
+          __consumer_base<_Ty>* __consumer = __h.promise().__consumer_;
+          __consumer->__complete_(__consumer);
+        }
+
+        static void await_resume() noexcept {
+        }
+      };
+
+      async_generator<_Ty> get_return_object() noexcept;
+
+      __coro::suspend_always initial_suspend() noexcept {
+        return {};
+      }
+
+      __final_awaiter final_suspend() noexcept {
+        return {};
+      }
+
+      __yield_awaiter yield_value(_Ty&& __value) noexcept {
+        return {this, std::addressof(__value)};
+      }
+
+      __copying_yield_awaiter yield_value(const _Ty& __value) //
+        noexcept(std::is_nothrow_copy_constructible_v<_Ty>)
+        requires std::copy_constructible<_Ty>
+      {
+        return {this, __value};
+      }
+
+      void return_void() noexcept {
+      }
+
+      void unhandled_exception() noexcept {
+        __eptr_ = std::current_exception();
+      }
+
+      __coro::coroutine_handle<> unhandled_stopped() noexcept {
+        __consumer_->__stopped_(__consumer_);
+        return __coro::noop_coroutine();
+      }
+
+      template <class _Awaitable>
+      decltype(auto) await_transform(_Awaitable&& __awaitable) {
+        return as_awaitable((_Awaitable&&) __awaitable, *this);
+      }
+
+      friend __env<_Ty> tag_invoke(get_env_t, const __promise& __self) noexcept {
+        return {__self.__consumer_};
+      }
+
+      __consumer_base<_Ty>* __consumer_ = nullptr;
+      std::exception_ptr __eptr_{};
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // async_generator
+    //
+    // A coroutine that produces a sequence of values with co_yield and that
+    // can co_await senders in between. The coroutine does not start before
+    // it is subscribed to, and it is suspended at each co_yield until the
+    // receiver is done with the item. Stop requests are forwarded to the
+    // senders that the coroutine awaits, and end the sequence with
+    // set_stopped at the next co_yield. The coroutine frame is allocated as
+    // described in __frame::__allocating_promise.
+    template <class _Ty>
+    class [[nodiscard]] async_generator {
+     public:
+      static_assert(std::is_object_v<_Ty>, "async_generator yields objects");
+
+      using __t = async_generator;
+      using __id = async_generator;
+      using promise_type = __promise<_Ty>;
+
+      using sender_concept = sequence_sender_t;
+      using completion_signatures = stdexec::completion_signatures<
+        set_value_t(),
+        set_error_t(std::exception_ptr),
+        set_stopped_t()>;
+      using item_types = exec::item_types<__item_t<_Ty>>;
+
+      async_generator(async_generator&& __that) noexcept
+        : __coro_(std::exchange(__that.__coro_, {})) {
+      }
+
+      ~async_generator() {
+        if (__coro_) {
+          __coro_.destroy();
+        }
+      }
+
+     private:
+      friend struct __promise<_Ty>;
+
+      explicit async_generator(__coro::coroutine_handle<promise_type> __coro) noexcept
+        : __coro_(__coro) {
+      }
+
+      template <class _Receiver>
+      using __operation_t = stdexec::__t<__operation<_Ty, stdexec::__id<_Receiver>>>;
+
+      template <same_as<async_generator> _Self, sequence_receiver_of<item_types> _Receiver>
+        requires sender_to<
+                   next_sender_of_t<_Receiver, __item_t<_Ty>>,
+                   stdexec::__t<__next_receiver<_Ty, stdexec::__id<_Receiver>>>>
+      friend auto tag_invoke(subscribe_t, _Self&& __self, _Receiver __rcvr) noexcept
+        -> __operation_t<_Receiver> {
+        return {std::exchange(__self.__coro_, {}), static_cast<_Receiver&&>(__rcvr)};
+      }
+
+      __coro::coroutine_handle<promise_type> __coro_;
+    };
+
+    template <class _Ty>
+    async_generator<_Ty> __promise<_Ty>::get_return_object() noexcept {
+      return async_generator<_Ty>(__coro::coroutine_handle<__promise>::from_promise(*this));
+    }
+  } // namespace __gen
+
+  using __gen::async_generator;
+} // namespace exec
+
+#endif // !STDEXEC_STD_NO_COROUTINES_
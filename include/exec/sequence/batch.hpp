@@ -0,0 +1,964 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sequence_senders.hpp"
+#include "../timed_scheduler.hpp"
+
+#include "../__detail/__basic_sequence.hpp"
+#include "./__stop_and_error.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // batch and window
+  //
+  // batch(seq, max_items, max_delay, sched) collects the values of the items
+  // of seq and passes them downstream in batches, as items that send a
+  // std::span over the collected values. A batch is passed on once it holds
+  // max_items values, once max_delay has passed on the timed scheduler since
+  // its first value arrived, or once seq has completed.
+  //
+  // window(seq, size, step) passes on every window of size consecutive
+  // values, starting a new window every step values. With step == size, the
+  // default, the windows are tumbling; with step < size they are sliding and
+  // share values. A window is only passed on once it is full.
+  //
+  // The span is valid until the item completes. Its buffer is then reused for
+  // a later batch, so in the steady state nothing is allocated. An item of
+  // seq that completes a batch waits until downstream is done with the
+  // batch, which holds back a serial upstream sequence until then.
+  //
+  // Batches are passed downstream one at a time and in the order in which
+  // they were completed, whether by a value, by the timer or by the end of
+  // seq. The next batch is only passed on once downstream is done with the
+  // previous one.
+  namespace __batch {
+    using namespace stdexec;
+
+    template <class _Scheduler>
+    struct __batch_data {
+      std::size_t __max_items_;
+      duration_of_t<_Scheduler> __max_delay_;
+      _Scheduler __sched_;
+    };
+
+    struct __window_data {
+      std::size_t __size_;
+      std::size_t __step_;
+    };
+
+    template <class _Env>
+    using __env_t = __env::__join_t<__env::__with<in_place_stop_token, get_stop_token_t>, _Env>;
+
+    template <class _Env>
+    struct __values_of {
+      template <class _Item>
+      using __f = __value_types_of_t<_Item, __env_t<_Env>, __q<__decay_t>, __q<__types>>;
+    };
+
+    // The type of the values of the items of the sequence, which must be the
+    // same for all of them.
+    template <class _Sequence, class _Env>
+    using __value_t = __mapply<
+      __q<__msingle>,
+      __mapply<
+        __transform<__values_of<_Env>, __mconcat<__munique<__q<__types>>>>,
+        item_types_of_t<_Sequence, __env_t<_Env>>>>;
+
+    template <class _Scheduler>
+    using __timer_sender_t =
+      __call_result_t<schedule_after_t, _Scheduler&, const duration_of_t<_Scheduler>&>;
+
+    // Reads the clock through the scheduler's customization of exec::now.
+    // The CPO itself asserts a time_point concept that std::chrono time points
+    // do not satisfy with this tree's swappable concept.
+    template <class _Scheduler>
+    auto __now(const _Scheduler& __sched) noexcept -> time_point_of_t<_Scheduler> {
+      return tag_invoke(now, __sched);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The items that are passed downstream.
+    template <class _Ty, class _ItemRcvr>
+    struct __span_operation {
+      struct __t {
+        using __id = __span_operation;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        std::span<_Ty> __span_;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::set_value(
+            static_cast<_ItemRcvr&&>(__self.__rcvr_), std::span<_Ty>{__self.__span_});
+        }
+      };
+    };
+
+    template <class _Ty>
+    struct __span_sender {
+      struct __t {
+        using __id = __span_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures = stdexec::completion_signatures<set_value_t(std::span<_Ty>)>;
+
+        std::span<_Ty> __span_;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr) //
+          noexcept(__nothrow_decay_copyable<_ItemRcvr>)
+            -> stdexec::__t<__span_operation<_Ty, _ItemRcvr>> {
+          return {static_cast<_ItemRcvr&&>(__rcvr), __self.__span_};
+        }
+      };
+    };
+
+    // Receives the completion of downstream's next-sender for a batch and
+    // tells _Target about it.
+    template <class _ReceiverId, class _Target>
+    struct __next_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __next_receiver;
+        _Target* __target_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__target_->__batch_done(false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__target_->__batch_done(true);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return stdexec::get_env(__self.__target_->__receiver());
+        }
+      };
+    };
+
+    template <class _ReceiverId, class _OpBase>
+    struct __timer_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __timer_receiver;
+        _OpBase* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__on_timer();
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__end_timer();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__end_timer();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> __env_t<env_of_t<_Receiver>> {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    // A complete batch that waits for its turn to be passed downstream.
+    struct __emission {
+      void* __target_;
+      void (*__start_)(void*) noexcept;
+      __emission* __next_{nullptr};
+    };
+
+    template <class _Target>
+    __emission __emission_of(_Target* __target) noexcept {
+      return {__target, [](void* __ptr) noexcept {
+                static_cast<_Target*>(__ptr)->__start_batch();
+              }};
+    }
+
+    template <class _Data>
+    struct __timer_traits {
+      using __time_point_t = __;
+
+      template <class _TimerRcvr>
+      using __op_t = __;
+    };
+
+    template <class _Scheduler>
+    struct __timer_traits<__batch_data<_Scheduler>> {
+      using __time_point_t = time_point_of_t<_Scheduler>;
+
+      template <class _TimerRcvr>
+      using __op_t = connect_result_t<__timer_sender_t<_Scheduler>, _TimerRcvr>;
+    };
+
+    template <class _Receiver, class _Value, class _Data, class _Errors>
+    struct __operation_base
+      : __immovable
+      , __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors> {
+      static constexpr bool __timed = !same_as<_Data, __window_data>;
+
+      using __state_t = __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors>;
+      using __state_t::__stop_source_;
+      using __state_t::__set_error;
+      using __span_sender_t = stdexec::__t<__span_sender<_Value>>;
+      using __next_sender_t = next_sender_of_t<_Receiver, __span_sender_t>;
+
+      template <class _Target>
+      using __next_receiver_t = stdexec::__t<__next_receiver<__id<_Receiver>, _Target>>;
+
+      template <class _Target>
+      using __next_op_t = connect_result_t<__next_sender_t, __next_receiver_t<_Target>>;
+
+      // The batch that is left once the sequence has completed.
+      struct __final_batch {
+        __operation_base* __op_;
+        std::vector<_Value> __batch_{};
+        std::optional<__next_op_t<__final_batch>> __next_op_{};
+        __emission __emission_{__batch::__emission_of(this)};
+
+        const _Receiver& __receiver() const noexcept {
+          return __op_->__rcvr_;
+        }
+
+        void __start_batch() noexcept {
+          if (!__op_->__emit(__next_op_, __batch_, this)) {
+            __op_->__emission_done();
+            __op_->__arrive();
+          }
+        }
+
+        void __batch_done(bool __stopped) noexcept {
+          __op_->__emission_done();
+          if (__stopped) {
+            __op_->__break();
+          }
+          __op_->__recycle(static_cast<std::vector<_Value>&&>(__batch_));
+          __op_->__arrive();
+        }
+      };
+
+      __operation_base(_Receiver&& __rcvr, _Data&& __data)
+        : __rcvr_(static_cast<_Receiver&&>(__rcvr))
+        , __data_(static_cast<_Data&&>(__data)) {
+        if constexpr (__timed) {
+          STDEXEC_ASSERT(__data_.__max_items_ != 0);
+        } else {
+          STDEXEC_ASSERT(__data_.__size_ != 0 && __data_.__step_ != 0);
+        }
+        __spare_.reserve(__max_spare);
+      }
+
+      __env_t<env_of_t<_Receiver>> __child_env() const noexcept {
+        return __env::__join(
+          __env::__with(__stop_source_.get_token(), get_stop_token), stdexec::get_env(__rcvr_));
+      }
+
+      const _Receiver& __receiver() const noexcept {
+        return __rcvr_;
+      }
+
+      // Starts a batch downstream. The batch must stay alive until _Target
+      // is told that downstream is done with it. Only called for the batch
+      // at the front of the queue.
+      template <class _Target>
+      bool __emit(
+        std::optional<__next_op_t<_Target>>& __slot,
+        std::vector<_Value>& __batch,
+        _Target* __target) noexcept {
+        if (__broken_.load(std::memory_order_relaxed)) {
+          __target->__batch_done(true);
+          return true;
+        }
+        try {
+          stdexec::start(__slot.emplace(__conv{[&] {
+            return stdexec::connect(
+              exec::set_next(__rcvr_, __span_sender_t{std::span<_Value>{__batch}}),
+              __next_receiver_t<_Target>{__target});
+          }}));
+          return true;
+        } catch (...) {
+          __set_error(std::current_exception());
+          return false;
+        }
+      }
+
+      /////////////////////////////////////////////////////////////////////////
+      // The queue of complete batches. Batches are queued in the order in which
+      // they are completed, with the mutex held. Whoever queues a batch while
+      // none is outstanding passes the queued batches on in a loop, and so does
+      // whoever is told that downstream is done with a batch while no loop is
+      // running. Each target calls __emission_done() before it completes.
+
+      // Must be called with the mutex held. Returns true if the caller must
+      // call __drain().
+      bool __enqueue(__emission& __e) noexcept {
+        __e.__next_ = nullptr;
+        if (__queue_back_ == nullptr) {
+          __queue_front_ = &__e;
+        } else {
+          __queue_back_->__next_ = &__e;
+        }
+        __queue_back_ = &__e;
+        return !std::exchange(__emitting_, true);
+      }
+
+      void __drain() noexcept {
+        // Keeps this operation alive until the loop is left, even if the last
+        // batch completes the sequence.
+        __pending_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock __lock{__mutex_};
+        while (__queue_front_ != nullptr) {
+          __emission* __e = std::exchange(__queue_front_, __queue_front_->__next_);
+          if (__queue_front_ == nullptr) {
+            __queue_back_ = nullptr;
+          }
+          __starting_ = true;
+          __done_while_starting_ = false;
+          __lock.unlock();
+          __e->__start_(__e->__target_);
+          __lock.lock();
+          __starting_ = false;
+          if (!__done_while_starting_) {
+            // The batch is still outstanding; its completion continues.
+            __lock.unlock();
+            __arrive();
+            return;
+          }
+        }
+        __emitting_ = false;
+        __lock.unlock();
+        __arrive();
+      }
+
+      void __emission_done() noexcept {
+        {
+          std::unique_lock __lock{__mutex_};
+          if (__starting_) {
+            __done_while_starting_ = true;
+            return;
+          }
+        }
+        __drain();
+      }
+
+      // Must be called with the mutex held.
+      std::vector<_Value> __take_spare() noexcept {
+        if (__spare_.empty()) {
+          return {};
+        }
+        std::vector<_Value> __buffer = static_cast<std::vector<_Value>&&>(__spare_.back());
+        __spare_.pop_back();
+        return __buffer;
+      }
+
+      void __recycle(std::vector<_Value>&& __buffer) noexcept {
+        __buffer.clear();
+        std::unique_lock __lock{__mutex_};
+        if (__spare_.size() < __max_spare) {
+          __spare_.push_back(static_cast<std::vector<_Value>&&>(__buffer));
+        }
+      }
+
+      // Adds a value. A complete batch is moved into __out and __e is queued
+      // to pass it on. Sets __arm if the caller must arm the timer, and
+      // __drain if the caller must pass on the queued batches.
+      template <class _Ty>
+      bool __push(
+        _Ty&& __value,
+        std::vector<_Value>& __out,
+        __emission& __e,
+        bool& __arm,
+        bool& __drain) {
+        std::unique_lock __lock{__mutex_};
+        if constexpr (__timed) {
+          if (__buffer_.empty()) {
+            __first_ = __batch::__now(__data_.__sched_);
+          }
+          __buffer_.emplace_back(static_cast<_Ty&&>(__value));
+          if (__buffer_.size() >= __data_.__max_items_) {
+            __out = static_cast<std::vector<_Value>&&>(__buffer_);
+            __buffer_ = __take_spare();
+            __drain = __enqueue(__e);
+            return true;
+          }
+          if (!__timer_armed_ && !__upstream_done_) {
+            __timer_armed_ = true;
+            __arm = true;
+            __pending_.fetch_add(1, std::memory_order_relaxed);
+          }
+          return false;
+        } else {
+          if (__skip_ != 0) {
+            --__skip_;
+            return false;
+          }
+          __buffer_.emplace_back(static_cast<_Ty&&>(__value));
+          if (__buffer_.size() < __data_.__size_) {
+            return false;
+          }
+          __out = __take_spare();
+          __out.assign(__buffer_.begin(), __buffer_.end());
+          if (__data_.__step_ >= __data_.__size_) {
+            __buffer_.clear();
+            __skip_ = __data_.__step_ - __data_.__size_;
+          } else {
+            __buffer_.erase(
+              __buffer_.begin(), __buffer_.begin() + static_cast<std::ptrdiff_t>(__data_.__step_));
+          }
+          __drain = __enqueue(__e);
+          return true;
+        }
+      }
+
+      // Downstream does not want any more batches.
+      void __break() noexcept {
+        __broken_.store(true, std::memory_order_relaxed);
+        __stop_source_.request_stop();
+      }
+
+      /////////////////////////////////////////////////////////////////////////
+      // At most one timer is armed at a time. It owns one of the pending
+      // counts from the time it is armed until it is done, including the time
+      // that downstream takes for the batch that it flushed.
+      template <class _Duration>
+      void __arm_timer(_Duration __delay) noexcept {
+        if constexpr (__timed) {
+          try {
+            stdexec::start(__timer_op_.emplace(__conv{[&] {
+              return stdexec::connect(
+                exec::schedule_after(__data_.__sched_, __delay), __timer_receiver_t{this});
+            }}));
+          } catch (...) {
+            __set_error(std::current_exception());
+            __end_timer();
+          }
+        }
+      }
+
+      void __on_timer() noexcept {
+        if constexpr (__timed) {
+          using __duration_t = duration_of_t<decltype(__data_.__sched_)>;
+          __duration_t __remaining{};
+          bool __flush = false;
+          bool __drain = false;
+          {
+            std::unique_lock __lock{__mutex_};
+            if (__upstream_done_ || __buffer_.empty()) {
+              __timer_armed_ = false;
+            } else {
+              __duration_t __elapsed = __batch::__now(__data_.__sched_) - __first_;
+              if (__elapsed >= __data_.__max_delay_) {
+                __timer_batch_ = static_cast<std::vector<_Value>&&>(__buffer_);
+                __buffer_ = __take_spare();
+                __flush = true;
+                __drain = __enqueue(__timer_emission_);
+              } else {
+                __remaining = __data_.__max_delay_ - __elapsed;
+              }
+            }
+          }
+          if (__flush) {
+            if (__drain) {
+              this->__drain();
+            }
+          } else if (__remaining != __duration_t{}) {
+            __arm_timer(__remaining);
+          } else {
+            __arrive();
+          }
+        }
+      }
+
+      void __start_batch() noexcept {
+        if (!__emit(__timer_next_op_, __timer_batch_, this)) {
+          __batch_done(false);
+        }
+      }
+
+      // Called when downstream is done with the batch that the timer flushed.
+      void __batch_done(bool __stopped) noexcept {
+        if constexpr (__timed) {
+          using __duration_t = duration_of_t<decltype(__data_.__sched_)>;
+          __emission_done();
+          if (__stopped) {
+            __break();
+          }
+          __recycle(static_cast<std::vector<_Value>&&>(__timer_batch_));
+          __duration_t __remaining{};
+          bool __rearm = false;
+          {
+            std::unique_lock __lock{__mutex_};
+            if (__upstream_done_ || __buffer_.empty() || __stop_source_.stop_requested()) {
+              __timer_armed_ = false;
+            } else {
+              __rearm = true;
+              __duration_t __elapsed = __batch::__now(__data_.__sched_) - __first_;
+              if (__elapsed < __data_.__max_delay_) {
+                __remaining = __data_.__max_delay_ - __elapsed;
+              }
+            }
+          }
+          if (__rearm) {
+            __arm_timer(__remaining);
+          } else {
+            __arrive();
+          }
+        }
+      }
+
+      void __end_timer() noexcept {
+        {
+          std::unique_lock __lock{__mutex_};
+          __timer_armed_ = false;
+        }
+        __arrive();
+      }
+
+      /////////////////////////////////////////////////////////////////////////
+      void __upstream_complete() noexcept {
+        const bool __flush = !__stop_source_.stop_requested();
+        bool __queued = false;
+        bool __drain = false;
+        {
+          std::unique_lock __lock{__mutex_};
+          __upstream_done_ = true;
+          if constexpr (__timed) {
+            __final_.__batch_ = static_cast<std::vector<_Value>&&>(__buffer_);
+          }
+          if (__flush && !__final_.__batch_.empty()) {
+            __queued = true;
+            __drain = __enqueue(__final_.__emission_);
+          }
+        }
+        // Cancels the timer.
+        __stop_source_.request_stop();
+        if (__drain) {
+          this->__drain();
+        }
+        if (!__queued) {
+          __arrive();
+        }
+      }
+
+      void __arrive() noexcept {
+        if (__pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          __complete();
+        }
+      }
+
+      void __complete() noexcept {
+        if (this->__complete_with_error(__rcvr_)) {
+          return;
+        }
+        if (get_stop_token(stdexec::get_env(__rcvr_)).stop_requested()) {
+          stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+        } else if (__broken_.load(std::memory_order_relaxed)) {
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        } else if (__upstream_stopped_) {
+          stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+        } else {
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        }
+      }
+
+      static constexpr std::size_t __max_spare = 4;
+
+      using __timer_receiver_t =
+        stdexec::__t<__timer_receiver<__id<_Receiver>, __operation_base>>;
+      using __timer_op_t = typename __timer_traits<_Data>::template __op_t<__timer_receiver_t>;
+      using __time_point_t = typename __timer_traits<_Data>::__time_point_t;
+
+      _Receiver __rcvr_;
+      _Data __data_;
+      // One for the upstream sequence, which is held until the last batch was
+      // passed on, and one for an armed timer.
+      std::atomic<std::size_t> __pending_{1};
+      std::atomic<bool> __broken_{false};
+      bool __upstream_stopped_{false};
+
+      std::mutex __mutex_{};
+      __emission* __queue_front_{nullptr};
+      __emission* __queue_back_{nullptr};
+      bool __emitting_{false};
+      bool __starting_{false};
+      bool __done_while_starting_{false};
+      std::vector<_Value> __buffer_{};
+      std::vector<std::vector<_Value>> __spare_{};
+      bool __upstream_done_{false};
+      // Only used by window.
+      std::size_t __skip_{0};
+      // Only used by batch.
+      bool __timer_armed_{false};
+      __time_point_t __first_{};
+      std::optional<__timer_op_t> __timer_op_{};
+      std::vector<_Value> __timer_batch_{};
+      std::optional<__next_op_t<__operation_base>> __timer_next_op_{};
+      __emission __timer_emission_{__batch::__emission_of(this)};
+
+      __final_batch __final_{this};
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The items that are handed to the upstream sequence.
+    template <class _ItemOp, class _OpBase>
+    struct __value_receiver {
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __value_receiver;
+        _ItemOp* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self, class _Ty>
+        friend void tag_invoke(_SetValue, _Self&& __self, _Ty&& __value) noexcept {
+          __self.__op_->__push(static_cast<_Ty&&>(__value));
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__stop();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__stop();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> decltype(__declval<const _OpBase&>().__child_env()) {
+          return __self.__op_->__op_->__child_env();
+        }
+      };
+    };
+
+    template <class _Item, class _ItemRcvr, class _OpBase>
+    struct __item_operation {
+      struct __t {
+        using __id = __item_operation;
+        using __value_receiver_t = stdexec::__t<__value_receiver<__t, _OpBase>>;
+        using __batch_t = decltype(__declval<_OpBase&>().__buffer_);
+
+        __t(_Item&& __item, _ItemRcvr&& __rcvr, _OpBase* __op)
+          : __rcvr_(static_cast<_ItemRcvr&&>(__rcvr))
+          , __op_(__op)
+          , __item_op_(stdexec::connect(static_cast<_Item&&>(__item), __value_receiver_t{this})) {
+        }
+
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        _OpBase* __op_;
+        connect_result_t<_Item, __value_receiver_t> __item_op_;
+        __batch_t __batch_{};
+        std::optional<typename _OpBase::template __next_op_t<__t>> __next_op_{};
+        __emission __emission_{__batch::__emission_of(this)};
+
+        const auto& __receiver() const noexcept {
+          return __op_->__rcvr_;
+        }
+
+        template <class _Ty>
+        void __push(_Ty&& __value) noexcept {
+          _OpBase* __op = __op_;
+          bool __ready = false;
+          bool __arm = false;
+          bool __drain = false;
+          try {
+            __ready = __op->__push(
+              static_cast<_Ty&&>(__value), __batch_, __emission_, __arm, __drain);
+          } catch (...) {
+            __op->__set_error(std::current_exception());
+            __stop();
+            return;
+          }
+          if (__arm) {
+            if constexpr (_OpBase::__timed) {
+              __op->__arm_timer(__op->__data_.__max_delay_);
+            }
+          }
+          if (!__ready) {
+            stdexec::set_value(static_cast<_ItemRcvr&&>(__rcvr_));
+          } else if (__drain) {
+            __op->__drain();
+          }
+        }
+
+        void __start_batch() noexcept {
+          if (!__op_->__emit(__next_op_, __batch_, this)) {
+            __op_->__emission_done();
+            __op_->__recycle(static_cast<__batch_t&&>(__batch_));
+            __stop();
+          }
+        }
+
+        void __batch_done(bool __stopped) noexcept {
+          __op_->__emission_done();
+          __op_->__recycle(static_cast<__batch_t&&>(__batch_));
+          if (__stopped) {
+            __op_->__break();
+            __stop();
+          } else {
+            stdexec::set_value(static_cast<_ItemRcvr&&>(__rcvr_));
+          }
+        }
+
+        void __stop() noexcept {
+          stdexec::set_stopped(static_cast<_ItemRcvr&&>(__rcvr_));
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          if (__self.__op_->__stop_source_.stop_requested()) {
+            __self.__stop();
+          } else {
+            stdexec::start(__self.__item_op_);
+          }
+        }
+      };
+    };
+
+    template <class _Item, class _OpBase>
+    struct __item_sender {
+      struct __t {
+        using __id = __item_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        _Item __item_;
+        _OpBase* __op_;
+
+        template <class _ItemRcvr>
+        using __operation_t = stdexec::__t<__item_operation<_Item, _ItemRcvr, _OpBase>>;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr)
+          -> __operation_t<_ItemRcvr> {
+          return {
+            static_cast<_Self&&>(__self).__item_, static_cast<_ItemRcvr&&>(__rcvr), __self.__op_};
+        }
+      };
+    };
+
+    template <class _ReceiverId, class _OpBase>
+    struct __receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __receiver;
+        _OpBase* __op_;
+
+        template <same_as<set_next_t> _SetNext, same_as<__t> _Self, sender _Item>
+        friend auto tag_invoke(_SetNext, _Self& __self, _Item&& __item) //
+          noexcept(__nothrow_decay_copyable<_Item>)
+            -> stdexec::__t<__item_sender<__decay_t<_Item>, _OpBase>> {
+          return {static_cast<_Item&&>(__item), __self.__op_};
+        }
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__upstream_complete();
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__upstream_stopped_ = true;
+          __self.__op_->__upstream_complete();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__upstream_complete();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> __env_t<env_of_t<_Receiver>> {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    template <class _Data, class _Env>
+    struct __timer_completions {
+      using __t = completion_signatures<>;
+    };
+
+    template <class _Scheduler, class _Env>
+    struct __timer_completions<__batch_data<_Scheduler>, _Env> {
+      using __t = __to_sequence_completion_signatures<__timer_sender_t<_Scheduler>, __env_t<_Env>>;
+    };
+
+    template <class _Sequence, class _Data, class _Env>
+    using __completion_sigs_t = __concat_completion_signatures_t<
+      completion_signatures<set_value_t(), set_error_t(std::exception_ptr), set_stopped_t()>,
+      __sequence_completion_signatures_of_t<_Sequence, __env_t<_Env>>,
+      stdexec::__t<__timer_completions<_Data, _Env>>>;
+
+    template <class _Sequence, class _Env>
+    using __item_types_t = item_types<stdexec::__t<__span_sender<__value_t<_Sequence, _Env>>>>;
+
+    template <class _Sequence, class _ReceiverId, class _Data>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __base_t = __operation_base<
+        _Receiver,
+        __value_t<_Sequence, env_of_t<_Receiver>>,
+        _Data,
+        __seq::__errors_variant_t<__completion_sigs_t<_Sequence, _Data, env_of_t<_Receiver>>>>;
+      using __receiver_t = stdexec::__t<__receiver<_ReceiverId, __base_t>>;
+
+      struct __t : __base_t {
+        using __id = __operation;
+        subscribe_result_t<_Sequence, __receiver_t> __op_;
+
+        __t(_Sequence&& __sndr, _Receiver __rcvr, _Data __data)
+          : __base_t{static_cast<_Receiver&&>(__rcvr), static_cast<_Data&&>(__data)}
+          , __op_{exec::subscribe(static_cast<_Sequence&&>(__sndr), __receiver_t{this})} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__start_on_stop(stdexec::get_env(__self.__rcvr_));
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    template <class _Receiver>
+    struct __subscribe_fn {
+      _Receiver& __rcvr_;
+
+      template <class _Data, class _Sequence>
+      auto operator()(__ignore, _Data __data, _Sequence&& __sequence)
+        -> stdexec::__t<__operation<_Sequence, __id<_Receiver>, _Data>> {
+        return {
+          static_cast<_Sequence&&>(__sequence),
+          static_cast<_Receiver&&>(__rcvr_),
+          static_cast<_Data&&>(__data)};
+      }
+    };
+
+    template <class _Tag>
+    struct __batch_impl {
+      template <sender_expr_for<_Tag> _Self, class _Env>
+      static auto get_completion_signatures(_Self&&, _Env&&) noexcept
+        -> __completion_sigs_t<__child_of<_Self>, __decay_t<__data_of<_Self>>, _Env> {
+        return {};
+      }
+
+      template <sender_expr_for<_Tag> _Self, class _Env>
+      static auto get_item_types(_Self&&, _Env&&) noexcept
+        -> __item_types_t<__child_of<_Self>, _Env> {
+        return {};
+      }
+
+      template <class _Self, class _Receiver>
+      using __receiver_t = typename __operation<
+        __child_of<_Self>,
+        __id<_Receiver>,
+        __decay_t<__data_of<_Self>>>::__receiver_t;
+
+      template <sender_expr_for<_Tag> _Self, receiver _Receiver>
+        requires sequence_receiver_of<
+                   _Receiver,
+                   __item_types_t<__child_of<_Self>, env_of_t<_Receiver>>>
+              && sequence_sender_to<__child_of<_Self>, __receiver_t<_Self, _Receiver>>
+      static auto subscribe(_Self&& __self, _Receiver __rcvr)
+        -> __call_result_t<__sexpr_apply_t, _Self, __subscribe_fn<_Receiver>> {
+        return __sexpr_apply(static_cast<_Self&&>(__self), __subscribe_fn<_Receiver>{__rcvr});
+      }
+
+      template <sender_expr_for<_Tag> _Sexpr>
+      static env_of_t<__child_of<_Sexpr>> get_env(const _Sexpr& __sexpr) noexcept {
+        return __sexpr_apply(__sexpr, []<class _Child>(__ignore, __ignore, const _Child& __child) {
+          return stdexec::get_env(__child);
+        });
+      }
+    };
+
+    struct batch_t : __batch_impl<batch_t> {
+      template <sender _Sequence, timed_scheduler _Scheduler>
+      auto operator()(
+        _Sequence&& __sndr,
+        std::size_t __max_items,
+        duration_of_t<_Scheduler> __max_delay,
+        _Scheduler __sched) const {
+        return make_sequence_expr<batch_t>(
+          __batch_data<_Scheduler>{
+            __max_items, __max_delay, static_cast<_Scheduler&&>(__sched)},
+          static_cast<_Sequence&&>(__sndr));
+      }
+
+      template <timed_scheduler _Scheduler>
+      auto operator()(
+        std::size_t __max_items,
+        duration_of_t<_Scheduler> __max_delay,
+        _Scheduler __sched) const
+        -> __binder_back<batch_t, std::size_t, duration_of_t<_Scheduler>, _Scheduler> {
+        return {{}, {}, {__max_items, __max_delay, static_cast<_Scheduler&&>(__sched)}};
+      }
+    };
+
+    struct window_t : __batch_impl<window_t> {
+      template <sender _Sequence>
+      auto operator()(_Sequence&& __sndr, std::size_t __size, std::size_t __step) const {
+        return make_sequence_expr<window_t>(
+          __window_data{__size, __step}, static_cast<_Sequence&&>(__sndr));
+      }
+
+      template <sender _Sequence>
+      auto operator()(_Sequence&& __sndr, std::size_t __size) const {
+        return (*this)(static_cast<_Sequence&&>(__sndr), __size, __size);
+      }
+
+      constexpr auto operator()(std::size_t __size, std::size_t __step) const noexcept
+        -> __binder_back<window_t, std::size_t, std::size_t> {
+        return {{}, {}, {__size, __step}};
+      }
+
+      constexpr auto operator()(std::size_t __size) const noexcept
+        -> __binder_back<window_t, std::size_t, std::size_t> {
+        return {{}, {}, {__size, __size}};
+      }
+    };
+  }
+
+  using __batch::batch_t;
+  inline constexpr batch_t batch{};
+
+  using __batch::window_t;
+  inline constexpr window_t window{};
+}
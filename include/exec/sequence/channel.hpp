@@ -0,0 +1,665 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sequence_senders.hpp"
+
+#include "../__detail/__atomic_intrusive_queue.hpp"
+#include "../__detail/__manual_lifetime.hpp"
+#include "../../stdexec/__detail/__intrusive_queue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // channel
+  //
+  // A bounded multi-producer multi-consumer channel. send(value) is a sender
+  // that completes once the value is in the channel, which may have to wait
+  // until a consumer made room. receive() is a sequence sender that sends
+  // every value that it takes from the channel as an item, and that
+  // completes once the channel is closed and drained. Each subscription to
+  // receive() takes one value at a time; several subscriptions share the
+  // values between them.
+  //
+  // The values are kept in a lock-free ring of capacity cells. Free cells and
+  // values are counted by two semaphores whose permits are taken with a
+  // single atomic operation when available. Operations that have to wait are
+  // pushed onto a lock-free intrusive list. Whoever hands out permits to the
+  // waiters does so without blocking: if another thread is already handing
+  // out permits, it leaves the new ones to that thread.
+  //
+  // Waiting operations complete on the thread that made a permit available,
+  // so a consumer that waited for a value receives it on the producer's
+  // thread and vice versa.
+  namespace __channel {
+    using namespace stdexec;
+
+    enum class __wake_t {
+      __granted,
+      __closed,
+      __stopped
+    };
+
+    enum class __wait_t {
+      __idle,
+      __waiting,
+      __granted,
+      __cancelled
+    };
+
+    // An operation that waits for a permit of a semaphore.
+    struct __waiter {
+      void (*__wake_)(__waiter*, __wake_t) noexcept;
+      std::atomic<__wait_t> __state_{__wait_t::__idle};
+      __waiter* __next_ = nullptr;
+    };
+
+    class __semaphore {
+      using __queue_t = __intrusive_queue<&__waiter::__next_>;
+
+     public:
+      explicit __semaphore(std::ptrdiff_t __count) noexcept
+        : __count_(__count) {
+      }
+
+      __semaphore(__semaphore&&) = delete;
+
+      // Takes a permit if one is available. Otherwise, the caller owes a
+      // permit and must __enqueue itself.
+      bool __try_acquire() noexcept {
+        return __count_.fetch_sub(1, std::memory_order_acquire) > 0;
+      }
+
+      // The waiter is woken once a permit is available, or the semaphore is
+      // closed, or __cancel was called for it.
+      void __enqueue(__waiter* __w) noexcept {
+        __incoming_.push_front(__w);
+        __signal();
+      }
+
+      void __release() noexcept {
+        if (__count_.fetch_add(1, std::memory_order_release) < 0) {
+          __owed_.fetch_add(1, std::memory_order_relaxed);
+          __signal();
+        }
+      }
+
+      // Called from a stop callback of a waiter that may or may not have
+      // been enqueued yet.
+      void __cancel(__waiter* __w) noexcept {
+        __wait_t __expected = __wait_t::__waiting;
+        if (__w->__state_.compare_exchange_strong(__expected, __wait_t::__cancelled)) {
+          __cancelled_.fetch_add(1, std::memory_order_relaxed);
+          __signal();
+        }
+      }
+
+      void __close() noexcept {
+        __closed_.store(true);
+        __signal();
+      }
+
+      bool __is_closed() const noexcept {
+        return __closed_.load(std::memory_order_relaxed);
+      }
+
+     private:
+      void __signal() noexcept {
+        __dirty_.store(true);
+        __drain();
+      }
+
+      // The waiter leaves the semaphore without a permit. If all waiters were
+      // owed a permit, the one that was meant for it becomes available.
+      void __forfeit() noexcept {
+        if (__count_.fetch_add(1, std::memory_order_relaxed) >= 0) {
+          __owed_.fetch_sub(1, std::memory_order_relaxed);
+        }
+      }
+
+      void __sweep(__queue_t& __stopped) noexcept {
+        __queue_t __kept;
+        while (!__pending_.empty()) {
+          __waiter* __w = __pending_.pop_front();
+          if (__w->__state_.load() == __wait_t::__cancelled) {
+            __forfeit();
+            __cancelled_.fetch_sub(1, std::memory_order_relaxed);
+            __stopped.push_back(__w);
+          } else {
+            __kept.push_back(__w);
+          }
+        }
+        __pending_ = static_cast<__queue_t&&>(__kept);
+      }
+
+      static void __wake_all(__queue_t& __queue, __wake_t __how) noexcept {
+        while (!__queue.empty()) {
+          __waiter* __w = __queue.pop_front();
+          __w->__wake_(__w, __how);
+        }
+      }
+
+      void __drain() noexcept {
+        do {
+          if (__draining_.exchange(true)) {
+            // The thread that drains will see that __dirty_ is set.
+            return;
+          }
+          __dirty_.store(false);
+          __queue_t __granted;
+          __queue_t __closed;
+          __queue_t __stopped;
+          __pending_.append(__incoming_.pop_all_reversed());
+          if (__cancelled_.load(std::memory_order_relaxed) != 0) {
+            __sweep(__stopped);
+          }
+          const bool __is_closed = __closed_.load();
+          while (!__pending_.empty()) {
+            const bool __has_permit = __owed_.load(std::memory_order_relaxed) > 0;
+            if (!__has_permit && !__is_closed) {
+              break;
+            }
+            __waiter* __w = __pending_.pop_front();
+            __wait_t __expected = __wait_t::__waiting;
+            if (!__w->__state_.compare_exchange_strong(__expected, __wait_t::__granted)) {
+              __forfeit();
+              __cancelled_.fetch_sub(1, std::memory_order_relaxed);
+              __stopped.push_back(__w);
+            } else if (__has_permit) {
+              __owed_.fetch_sub(1, std::memory_order_relaxed);
+              __granted.push_back(__w);
+            } else {
+              __closed.push_back(__w);
+            }
+          }
+          __draining_.store(false);
+          __wake_all(__granted, __wake_t::__granted);
+          __wake_all(__closed, __wake_t::__closed);
+          __wake_all(__stopped, __wake_t::__stopped);
+        } while (__dirty_.load());
+      }
+
+      // The number of free permits, less the number of waiters that are not
+      // owed one yet.
+      alignas(64) std::atomic<std::ptrdiff_t> __count_;
+      // The number of permits that were released for waiters and not handed
+      // out yet. Only the draining thread decreases it.
+      std::atomic<std::ptrdiff_t> __owed_{0};
+      std::atomic<std::size_t> __cancelled_{0};
+      std::atomic<bool> __closed_{false};
+      std::atomic<bool> __dirty_{false};
+      std::atomic<bool> __draining_{false};
+      __atomic_intrusive_queue<&__waiter::__next_> __incoming_{};
+      // Only touched by the draining thread.
+      __queue_t __pending_{};
+    };
+
+    // A bounded ring of cells in which every cell carries the position at
+    // which it may next be written or read. The semaphores guarantee that
+    // a cell is available to whoever takes its position, but the previous
+    // reader or writer of the cell may still be about to finish, so __push
+    // and __pop may spin briefly.
+    template <class _Ty>
+    class __ring {
+      struct __cell {
+        std::atomic<std::size_t> __seq_;
+        __manual_lifetime<_Ty> __value_;
+      };
+
+      __cell& __at(std::size_t __pos) const noexcept {
+        return __cells_[__pos % __capacity_];
+      }
+
+     public:
+      explicit __ring(std::size_t __capacity)
+        : __capacity_(__capacity)
+        , __cells_(new __cell[__capacity]) {
+        for (std::size_t __i = 0; __i < __capacity; ++__i) {
+          __cells_[__i].__seq_.store(__i, std::memory_order_relaxed);
+        }
+      }
+
+      ~__ring() {
+        const std::size_t __tail = __tail_.load(std::memory_order_relaxed);
+        for (std::size_t __pos = __head_.load(std::memory_order_relaxed); __pos != __tail;
+             ++__pos) {
+          __at(__pos).__value_.__destroy();
+        }
+      }
+
+      std::size_t __capacity() const noexcept {
+        return __capacity_;
+      }
+
+      void __push(_Ty&& __value) noexcept {
+        const std::size_t __pos = __tail_.fetch_add(1, std::memory_order_relaxed);
+        __cell& __c = __at(__pos);
+        for (__stok::__spin_wait __spin; __c.__seq_.load(std::memory_order_acquire) != __pos;) {
+          __spin.__wait();
+        }
+        __c.__value_.__construct(static_cast<_Ty&&>(__value));
+        __c.__seq_.store(__pos + 1, std::memory_order_release);
+      }
+
+      _Ty __pop() noexcept {
+        const std::size_t __pos = __head_.fetch_add(1, std::memory_order_relaxed);
+        __cell& __c = __at(__pos);
+        for (__stok::__spin_wait __spin; __c.__seq_.load(std::memory_order_acquire) != __pos + 1;) {
+          __spin.__wait();
+        }
+        _Ty __value = static_cast<_Ty&&>(__c.__value_.__get());
+        __c.__value_.__destroy();
+        __c.__seq_.store(__pos + __capacity_, std::memory_order_release);
+        return __value;
+      }
+
+     private:
+      std::size_t __capacity_;
+      std::unique_ptr<__cell[]> __cells_;
+      alignas(64) std::atomic<std::size_t> __head_{0};
+      alignas(64) std::atomic<std::size_t> __tail_{0};
+    };
+
+    template <class _Ty>
+    struct __state {
+      explicit __state(std::size_t __capacity)
+        : __ring_(__capacity)
+        , __free_(static_cast<std::ptrdiff_t>(__capacity))
+        , __values_(0) {
+        STDEXEC_ASSERT(__capacity != 0);
+      }
+
+      __ring<_Ty> __ring_;
+      __semaphore __free_;
+      __semaphore __values_;
+    };
+
+    template <class _Semaphore>
+    struct __on_stop_request {
+      _Semaphore* __sem_;
+      __waiter* __waiter_;
+
+      void operator()() noexcept {
+        __sem_->__cancel(__waiter_);
+      }
+    };
+
+    template <class _Receiver>
+    using __on_stop_t = std::optional<typename stop_token_of_t<
+      env_of_t<_Receiver>&>::template callback_type<__on_stop_request<__semaphore>>>;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // send
+    template <class _Ty, class _ReceiverId>
+    struct __send_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t : __waiter {
+        using __id = __send_operation;
+
+        __t(__state<_Ty>* __chan, _Ty&& __value, _Receiver&& __rcvr)
+          : __waiter{&__wake}
+          , __chan_(__chan)
+          , __value_(static_cast<_Ty&&>(__value))
+          , __rcvr_(static_cast<_Receiver&&>(__rcvr)) {
+        }
+
+        __state<_Ty>* __chan_;
+        _Ty __value_;
+        _Receiver __rcvr_;
+        __on_stop_t<_Receiver> __on_stop_{};
+
+        void __send() noexcept {
+          __chan_->__ring_.__push(static_cast<_Ty&&>(__value_));
+          __chan_->__values_.__release();
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        }
+
+        static void __wake(__waiter* __w, __wake_t __how) noexcept {
+          auto* __self = static_cast<__t*>(__w);
+          __self->__on_stop_.reset();
+          if (__how == __wake_t::__granted) {
+            __self->__send();
+          } else {
+            stdexec::set_stopped(static_cast<_Receiver&&>(__self->__rcvr_));
+          }
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __state<_Ty>* __chan = __self.__chan_;
+          if (__chan->__free_.__is_closed()) {
+            stdexec::set_stopped(static_cast<_Receiver&&>(__self.__rcvr_));
+          } else if (__chan->__free_.__try_acquire()) {
+            __self.__send();
+          } else {
+            __self.__state_.store(__wait_t::__waiting, std::memory_order_relaxed);
+            __self.__on_stop_.emplace(
+              get_stop_token(stdexec::get_env(__self.__rcvr_)),
+              __on_stop_request<__semaphore>{&__chan->__free_, &__self});
+            __chan->__free_.__enqueue(&__self);
+          }
+        }
+      };
+    };
+
+    template <class _Ty>
+    struct __send_sender {
+      struct __t {
+        using __id = __send_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        __state<_Ty>* __chan_;
+        _Ty __value_;
+
+        template <class _Receiver>
+        using __operation_t = stdexec::__t<__send_operation<_Ty, stdexec::__id<_Receiver>>>;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _Receiver>
+        friend auto tag_invoke(connect_t, _Self&& __self, _Receiver __rcvr)
+          -> __operation_t<_Receiver> {
+          return {
+            __self.__chan_,
+            static_cast<_Self&&>(__self).__value_,
+            static_cast<_Receiver&&>(__rcvr)};
+        }
+      };
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // receive
+    template <class _Ty, class _ItemRcvr>
+    struct __item_operation {
+      struct __t {
+        using __id = __item_operation;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        _Ty* __value_;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::set_value(
+            static_cast<_ItemRcvr&&>(__self.__rcvr_), static_cast<_Ty&&>(*__self.__value_));
+        }
+      };
+    };
+
+    // The sender of a value that was taken from the channel. The value lives
+    // in the subscription until the item completes.
+    template <class _Ty>
+    struct __item_sender {
+      struct __t {
+        using __id = __item_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures = stdexec::completion_signatures<set_value_t(_Ty)>;
+
+        _Ty* __value_;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr) //
+          noexcept(__nothrow_decay_copyable<_ItemRcvr>)
+            -> stdexec::__t<__item_operation<_Ty, _ItemRcvr>> {
+          return {static_cast<_ItemRcvr&&>(__rcvr), __self.__value_};
+        }
+      };
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __receive_operation {
+      struct __t;
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __next_receiver {
+      struct __t {
+        using __id = __next_receiver;
+        using receiver_concept = stdexec::receiver_t;
+        using _Receiver = stdexec::__t<_ReceiverId>;
+        stdexec::__t<__receive_operation<_Ty, _ReceiverId>>* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__item_done(false);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__item_done(true);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__rcvr_);
+        }
+      };
+    };
+
+    template <class _Ty, class _ReceiverId>
+    struct __receive_operation<_Ty, _ReceiverId>::__t : __waiter {
+      using __id = __receive_operation;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __item_t = stdexec::__t<__item_sender<_Ty>>;
+      using __next_receiver_t = stdexec::__t<__next_receiver<_Ty, _ReceiverId>>;
+      using __next_op_t = connect_result_t<next_sender_of_t<_Receiver, __item_t>, __next_receiver_t>;
+
+      enum class __phase_t {
+        __starting,
+        __started,
+        __done
+      };
+
+      __t(__state<_Ty>* __chan, _Receiver&& __rcvr)
+        : __waiter{&__wake}
+        , __chan_(__chan)
+        , __rcvr_(static_cast<_Receiver&&>(__rcvr)) {
+      }
+
+      __state<_Ty>* __chan_;
+      _Receiver __rcvr_;
+      __on_stop_t<_Receiver> __on_stop_{};
+      std::optional<_Ty> __value_{};
+      std::optional<__next_op_t> __next_op_{};
+      std::atomic<__phase_t> __phase_{__phase_t::__starting};
+      bool __break_ = false;
+
+      // Takes values and sends them downstream for as long as the items
+      // complete inline and values are available.
+      void __loop() noexcept {
+        __semaphore& __values = __chan_->__values_;
+        auto __token = get_stop_token(stdexec::get_env(__rcvr_));
+        while (__values.__try_acquire()) {
+          if (__token.stop_requested()) {
+            __values.__release();
+            __complete([this]() noexcept {
+              stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+            });
+            return;
+          }
+          if (!__deliver()) {
+            return;
+          }
+          if (__break_) {
+            __complete_break();
+            return;
+          }
+        }
+        __state_.store(__wait_t::__waiting);
+        if (__token.stop_requested()) {
+          __values.__cancel(this);
+        }
+        __values.__enqueue(this);
+      }
+
+      // Returns true if the item has completed inline.
+      bool __deliver() noexcept {
+        __value_.emplace(__chan_->__ring_.__pop());
+        __chan_->__free_.__release();
+        __phase_.store(__phase_t::__starting, std::memory_order_relaxed);
+        try {
+          stdexec::start(__next_op_.emplace(__conv{[this] {
+            return stdexec::connect(
+              exec::set_next(__rcvr_, __item_t{std::addressof(*__value_)}),
+              __next_receiver_t{this});
+          }}));
+        } catch (...) {
+          __value_.reset();
+          __complete([this]() noexcept {
+            stdexec::set_error(static_cast<_Receiver&&>(__rcvr_), std::current_exception());
+          });
+          return false;
+        }
+        return __phase_.exchange(__phase_t::__started, std::memory_order_acq_rel)
+            == __phase_t::__done;
+      }
+
+      // __break is true if downstream does not want any more items.
+      void __item_done(bool __break) noexcept {
+        __value_.reset();
+        __break_ = __break;
+        if (__phase_.exchange(__phase_t::__done, std::memory_order_acq_rel) == __phase_t::__started) {
+          if (__break_) {
+            __complete_break();
+          } else {
+            __loop();
+          }
+        }
+      }
+
+      void __complete_break() noexcept {
+        __complete([this]() noexcept {
+          __set_value_unless_stopped(static_cast<_Receiver&&>(__rcvr_));
+        });
+      }
+
+      template <class _Fn>
+      void __complete(_Fn __fn) noexcept {
+        __on_stop_.reset();
+        __next_op_.reset();
+        __fn();
+      }
+
+      static void __wake(__waiter* __w, __wake_t __how) noexcept {
+        auto* __self = static_cast<__t*>(__w);
+        __self->__state_.store(__wait_t::__idle, std::memory_order_relaxed);
+        switch (__how) {
+        case __wake_t::__granted:
+          if (__self->__deliver()) {
+            if (__self->__break_) {
+              __self->__complete_break();
+            } else {
+              __self->__loop();
+            }
+          }
+          break;
+        case __wake_t::__closed:
+          __self->__complete([__self]() noexcept {
+            stdexec::set_value(static_cast<_Receiver&&>(__self->__rcvr_));
+          });
+          break;
+        case __wake_t::__stopped:
+          __self->__complete([__self]() noexcept {
+            stdexec::set_stopped(static_cast<_Receiver&&>(__self->__rcvr_));
+          });
+          break;
+        }
+      }
+
+      friend void tag_invoke(start_t, __t& __self) noexcept {
+        __self.__on_stop_.emplace(
+          get_stop_token(stdexec::get_env(__self.__rcvr_)),
+          __on_stop_request<__semaphore>{&__self.__chan_->__values_, &__self});
+        __self.__loop();
+      }
+    };
+
+    template <class _Ty>
+    struct __receive_sender {
+      struct __t {
+        using __id = __receive_sender;
+        using sender_concept = sequence_sender_t;
+        using completion_signatures = stdexec::completion_signatures<
+          set_value_t(),
+          set_error_t(std::exception_ptr),
+          set_stopped_t()>;
+        using item_types = exec::item_types<stdexec::__t<__item_sender<_Ty>>>;
+
+        __state<_Ty>* __chan_;
+
+        template <class _Receiver>
+        using __operation_t = stdexec::__t<__receive_operation<_Ty, stdexec::__id<_Receiver>>>;
+
+        template <__decays_to<__t> _Self, receiver _Receiver>
+          requires sequence_receiver_of<_Receiver, item_types>
+                && receiver_of<_Receiver, completion_signatures>
+        friend auto tag_invoke(subscribe_t, _Self&& __self, _Receiver __rcvr)
+          -> __operation_t<_Receiver> {
+          return {__self.__chan_, static_cast<_Receiver&&>(__rcvr)};
+        }
+      };
+    };
+  } // namespace __channel
+
+  template <class _Ty>
+  class channel {
+    static_assert(
+      std::is_nothrow_move_constructible_v<_Ty>,
+      "The values of a channel must be nothrow move constructible");
+
+   public:
+    // The sender returned by send().
+    using send_sender = stdexec::__t<__channel::__send_sender<_Ty>>;
+    // The sequence sender returned by receive().
+    using receive_sender = stdexec::__t<__channel::__receive_sender<_Ty>>;
+
+    explicit channel(std::size_t __capacity)
+      : __state_(__capacity) {
+    }
+
+    channel(channel&&) = delete;
+
+    std::size_t capacity() const noexcept {
+      return __state_.__ring_.__capacity();
+    }
+
+    // Completes with set_value once the value is in the channel, or with
+    // set_stopped if the channel is closed first or the operation is
+    // cancelled while it waits for room.
+    [[nodiscard]] send_sender send(_Ty __value) noexcept {
+      return {&__state_, static_cast<_Ty&&>(__value)};
+    }
+
+    [[nodiscard]] receive_sender receive() noexcept {
+      return {&__state_};
+    }
+
+    // Ends the subscriptions to receive() once they have taken the values
+    // that are left in the channel, and stops the sends that wait for room.
+    // Must not be called while a send may still complete successfully,
+    // since its value might not be received.
+    void close() noexcept {
+      __state_.__free_.__close();
+      __state_.__values_.__close();
+    }
+
+   private:
+    __channel::__state<_Ty> __state_;
+  };
+} // namespace exec
@@ -0,0 +1,555 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sequence_senders.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <variant>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // fold and reduce_each
+  //
+  // fold(seq, init, fun) consumes seq and completes with the result of
+  // folding the values of its items into an accumulator. The accumulator
+  // starts as init and is replaced by fun(std::move(acc), values...) for
+  // every item, in the order in which the items complete. Items that
+  // complete concurrently are folded one at a time.
+  //
+  // reduce_each(seq, identity, fun, sched) starts every item on sched and
+  // folds its values into a partial accumulator of the thread that the item
+  // completes on. Each operation has one partial accumulator per hardware
+  // thread, each on its own cache line, and hands them out to the threads
+  // that items complete on in the order in which they first do, so that
+  // items completing on different threads do not contend. Once seq has
+  // completed, the partial accumulators are combined with
+  // fun(std::move(acc), std::move(partial)), starting from identity.
+  // fun is called concurrently, must be associative and commutative,
+  // and identity must be its identity element.
+  //
+  // If fun throws, the sequence is stopped and the exception is the result.
+  namespace __fold {
+    using namespace stdexec;
+
+    template <class _Init>
+    struct __serial_accumulator {
+      _Init __acc_;
+      std::mutex __mutex_{};
+
+      template <class _Data>
+      explicit __serial_accumulator(_Data& __data)
+        : __acc_(static_cast<_Init&&>(__data.__init_)) {
+      }
+
+      template <class _Data, class... _Args>
+      void __add(_Data& __data, _Args&&... __args) {
+        std::unique_lock __lock{__mutex_};
+        __acc_ = __data.__fun_(static_cast<_Init&&>(__acc_), static_cast<_Args&&>(__args)...);
+      }
+
+      template <class _Data>
+      _Init __result(_Data&) {
+        return static_cast<_Init&&>(__acc_);
+      }
+    };
+
+    // Tells the partial accumulators of different operations apart.
+    inline std::uint64_t __new_accumulators_id() noexcept {
+      static std::atomic<std::uint64_t> __next_id{1};
+      return __next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <class _Init>
+    struct __partial_accumulators {
+      struct alignas(64) __partial {
+        std::mutex __mutex_{};
+        std::optional<_Init> __acc_{};
+      };
+
+      template <class _Data>
+      explicit __partial_accumulators(_Data&)
+        : __size_(std::max(std::thread::hardware_concurrency(), 1u))
+        , __partials_(std::make_unique<__partial[]>(__size_)) {
+      }
+
+      // The slot of the calling thread in __partials_. A thread keeps the
+      // slots that it got from the last __num_cached operations that it
+      // added to, so that a thread that works for several operations at once
+      // keeps its slot in each of them. Only threads beyond the number of
+      // hardware threads, or a thread that works for more operations at once
+      // than it caches, share a partial accumulator with another thread of
+      // the same operation.
+      std::size_t __slot() noexcept {
+        static constexpr std::size_t __num_cached = 8;
+
+        struct __cached_slot {
+          std::uint64_t __id_;
+          std::size_t __slot_;
+        };
+
+        struct __slot_cache {
+          __cached_slot __entries_[__num_cached]{};
+          std::size_t __next_victim_{0};
+        };
+
+        thread_local __slot_cache __cache{};
+        for (__cached_slot& __entry: __cache.__entries_) {
+          if (__entry.__id_ == __id_) {
+            return __entry.__slot_;
+          }
+        }
+        __cached_slot& __entry = __cache.__entries_[__cache.__next_victim_++ % __num_cached];
+        __entry = {__id_, __next_slot_.fetch_add(1, std::memory_order_relaxed) % __size_};
+        return __entry.__slot_;
+      }
+
+      template <class _Data, class... _Args>
+      void __add(_Data& __data, _Args&&... __args) {
+        __partial& __part = __partials_[__slot()];
+        std::unique_lock __lock{__part.__mutex_};
+        if (__part.__acc_) {
+          *__part.__acc_ = __data.__fun_(
+            static_cast<_Init&&>(*__part.__acc_), static_cast<_Args&&>(__args)...);
+        } else {
+          __part.__acc_.emplace(
+            __data.__fun_(_Init(__data.__init_), static_cast<_Args&&>(__args)...));
+        }
+      }
+
+      // All items have completed by now, so no lock is needed.
+      template <class _Data>
+      _Init __result(_Data& __data) {
+        _Init __acc = static_cast<_Init&&>(__data.__init_);
+        for (std::size_t __i = 0; __i < __size_; ++__i) {
+          if (__partials_[__i].__acc_) {
+            __acc = __data.__fun_(
+              static_cast<_Init&&>(__acc), static_cast<_Init&&>(*__partials_[__i].__acc_));
+          }
+        }
+        return __acc;
+      }
+
+      std::size_t __size_;
+      std::unique_ptr<__partial[]> __partials_;
+      const std::uint64_t __id_ = __fold::__new_accumulators_id();
+      std::atomic<std::size_t> __next_slot_{0};
+    };
+
+    template <class _Init, class _Fun>
+    struct __fold_data {
+      using __accumulator_t = __serial_accumulator<_Init>;
+
+      _Init __init_;
+      _Fun __fun_;
+
+      template <class _Item>
+      _Item&& __adapt(_Item&& __item) const noexcept {
+        return static_cast<_Item&&>(__item);
+      }
+
+      template <class _Env>
+      using __extra_completions_t = completion_signatures<>;
+    };
+
+    template <class _Init, class _Fun, class _Scheduler>
+    struct __reduce_data {
+      using __accumulator_t = __partial_accumulators<_Init>;
+
+      _Init __init_;
+      _Fun __fun_;
+      _Scheduler __sched_;
+
+      template <class _Item>
+      auto __adapt(_Item&& __item) const {
+        return stdexec::on(__sched_, static_cast<_Item&&>(__item));
+      }
+
+      // The errors and stops of scheduling an item on __sched_.
+      template <class _Env>
+      using __schedule_completions_t =
+        completion_signatures_of_t<schedule_result_t<_Scheduler&>, _Env>;
+
+      template <class _Env>
+      using __extra_completions_t = __concat_completion_signatures_t<
+        __only_gather_signal<set_error_t, __schedule_completions_t<_Env>>,
+        __only_gather_signal<set_stopped_t, __schedule_completions_t<_Env>>>;
+    };
+
+    template <class _Data>
+    using __acc_of = decltype(_Data::__init_);
+
+    template <class _Data, class _Sequence, class _Env>
+    using __completion_sigs_t = __concat_completion_signatures_t<
+      completion_signatures<set_value_t(__acc_of<_Data>), set_error_t(std::exception_ptr)>,
+      __only_gather_signal<set_error_t, __sequence_completion_signatures_of_t<_Sequence, _Env>>,
+      __only_gather_signal<set_stopped_t, __sequence_completion_signatures_of_t<_Sequence, _Env>>,
+      typename _Data::template __extra_completions_t<_Env>>;
+
+    template <class _Tag, class _Sigs>
+    using __gather_types =
+      __gather_signal<_Tag, _Sigs, __mbind_front_q<__decayed_tuple, _Tag>, __q<__types>>;
+
+    template <class _Sigs>
+    using __result_variant_ = __minvoke<
+      __mconcat<__nullable_variant_t>,
+      __gather_types<set_error_t, _Sigs>,
+      __gather_types<set_stopped_t, _Sigs>>;
+
+    template <class _Data, class _Sequence, class _Env>
+    using __result_variant_t = __result_variant_<__completion_sigs_t<_Data, _Sequence, _Env>>;
+
+    template <class _Receiver, class _Data, class _ResultVariant>
+    struct __operation_base : __immovable {
+      using __accumulator_t = typename _Data::__accumulator_t;
+
+      __operation_base(_Receiver&& __rcvr, _Data&& __data)
+        : __receiver_(static_cast<_Receiver&&>(__rcvr))
+        , __data_(static_cast<_Data&&>(__data))
+        , __acc_(__data_) {
+      }
+
+      template <class... _Args>
+      bool __add(_Args&&... __args) noexcept {
+        try {
+          __acc_.__add(__data_, static_cast<_Args&&>(__args)...);
+          return true;
+        } catch (...) {
+          __emplace(set_error_t{}, std::current_exception());
+          return false;
+        }
+      }
+
+      // Keeps the first error or stop of an item.
+      template <class... _Args>
+      void __emplace(_Args&&... __args) noexcept {
+        int __expected = 0;
+        if (__emplaced_.compare_exchange_strong(__expected, 1, std::memory_order_relaxed)) {
+          __result_.template emplace<__decayed_tuple<_Args...>>(static_cast<_Args&&>(__args)...);
+          __emplaced_.store(2, std::memory_order_release);
+        }
+      }
+
+      bool __visit_result() noexcept {
+        if (__emplaced_.load(std::memory_order_acquire) == 0) {
+          return false;
+        }
+        std::visit(
+          [&]<class _Tuple>(_Tuple&& __tuple) noexcept {
+            if constexpr (__not_decays_to<_Tuple, std::monostate>) {
+              std::apply(
+                [&]<__completion_tag _Tag, class... _Args>(
+                  _Tag __completion, _Args&&... __args) noexcept {
+                  __completion(
+                    static_cast<_Receiver&&>(__receiver_), static_cast<_Args&&>(__args)...);
+                },
+                static_cast<_Tuple&&>(__tuple));
+            }
+          },
+          static_cast<_ResultVariant&&>(__result_));
+        return true;
+      }
+
+      void __complete() noexcept {
+        if (__visit_result()) {
+          return;
+        }
+        try {
+          stdexec::set_value(static_cast<_Receiver&&>(__receiver_), __acc_.__result(__data_));
+        } catch (...) {
+          stdexec::set_error(static_cast<_Receiver&&>(__receiver_), std::current_exception());
+        }
+      }
+
+      STDEXEC_ATTRIBUTE((no_unique_address)) _Receiver __receiver_;
+      _Data __data_;
+      __accumulator_t __acc_;
+      _ResultVariant __result_{};
+      std::atomic<int> __emplaced_{0};
+    };
+
+    template <class _ItemReceiver, class _OpBase>
+    struct __item_operation_base {
+      STDEXEC_ATTRIBUTE((no_unique_address)) _ItemReceiver __receiver_;
+      _OpBase* __parent_;
+    };
+
+    template <class _ItemReceiver, class _OpBase>
+    struct __item_receiver {
+      struct __t {
+        using __id = __item_receiver;
+        using receiver_concept = stdexec::receiver_t;
+        __item_operation_base<_ItemReceiver, _OpBase>* __op_;
+
+        template <same_as<set_value_t> _Tag, same_as<__t> _Self, class... _Args>
+        friend void tag_invoke(_Tag, _Self&& __self, _Args&&... __args) noexcept {
+          if (__self.__op_->__parent_->__add(static_cast<_Args&&>(__args)...)) {
+            stdexec::set_value(static_cast<_ItemReceiver&&>(__self.__op_->__receiver_));
+          } else {
+            stdexec::set_stopped(static_cast<_ItemReceiver&&>(__self.__op_->__receiver_));
+          }
+        }
+
+        template <same_as<set_error_t> _Tag, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_Tag, _Self&& __self, _Error&& __error) noexcept {
+          // store error and signal stop
+          __self.__op_->__parent_->__emplace(_Tag{}, static_cast<_Error&&>(__error));
+          stdexec::set_stopped(static_cast<_ItemReceiver&&>(__self.__op_->__receiver_));
+        }
+
+        template <same_as<set_stopped_t> _Tag, same_as<__t> _Self>
+        friend void tag_invoke(_Tag, _Self&& __self) noexcept {
+          __self.__op_->__parent_->__emplace(_Tag{});
+          stdexec::set_stopped(static_cast<_ItemReceiver&&>(__self.__op_->__receiver_));
+        }
+
+        template <same_as<get_env_t> _GetEnv, __decays_to<__t> _Self>
+        friend env_of_t<_ItemReceiver> tag_invoke(_GetEnv, _Self&& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__receiver_);
+        }
+      };
+    };
+
+    template <class _Sender, class _ItemReceiver, class _OpBase>
+    struct __item_operation {
+      using __base_type = __item_operation_base<_ItemReceiver, _OpBase>;
+      using __item_receiver_t = stdexec::__t<__item_receiver<_ItemReceiver, _OpBase>>;
+
+      struct __t : __base_type {
+        connect_result_t<_Sender, __item_receiver_t> __op_;
+
+        __t(_OpBase* __parent, _Sender&& __sndr, _ItemReceiver __rcvr) //
+          noexcept(__nothrow_decay_copyable<_ItemReceiver>              //
+                     && __nothrow_connectable<_Sender, __item_receiver_t>)
+          : __base_type{static_cast<_ItemReceiver&&>(__rcvr), __parent}
+          , __op_{stdexec::connect(static_cast<_Sender&&>(__sndr), __item_receiver_t{this})} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    template <class _Sender, class _OpBase>
+    struct __item_sender {
+      struct __t {
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        template <class _Self, class _Receiver>
+        using __operation_t =
+          stdexec::__t<__item_operation<__copy_cvref_t<_Self, _Sender>, _Receiver, _OpBase>>;
+
+        template <class _Receiver>
+        using __item_receiver_t = stdexec::__t<__item_receiver<_Receiver, _OpBase>>;
+
+        _Sender __sender_;
+        _OpBase* __parent_;
+
+        template <__decays_to<__t> _Self, stdexec::receiver_of<completion_signatures> _Receiver>
+          requires sender_to<__copy_cvref_t<_Self, _Sender>, __item_receiver_t<_Receiver>>
+        friend auto tag_invoke(connect_t, _Self&& __self, _Receiver __rcvr)
+          -> __operation_t<_Self, _Receiver> {
+          return {
+            __self.__parent_,
+            static_cast<_Self&&>(__self).__sender_,
+            static_cast<_Receiver&&>(__rcvr)};
+        }
+      };
+    };
+
+    template <class _ReceiverId, class _OpBase>
+    struct __receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using __id = __receiver;
+        using receiver_concept = stdexec::receiver_t;
+        _OpBase* __op_;
+
+        template <class _Item>
+        using __item_sender_t = stdexec::__t<__item_sender<
+          __decay_t<decltype(__declval<_OpBase&>().__data_.__adapt(__declval<_Item>()))>,
+          _OpBase>>;
+
+        template <same_as<set_next_t> _SetNext, same_as<__t> _Self, sender _Item>
+        friend auto tag_invoke(_SetNext, _Self& __self, _Item&& __item)
+          -> __item_sender_t<_Item> {
+          return {__self.__op_->__data_.__adapt(static_cast<_Item&&>(__item)), __self.__op_};
+        }
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__complete();
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          if (!__self.__op_->__visit_result()) {
+            stdexec::set_stopped(static_cast<_Receiver&&>(__self.__op_->__receiver_));
+          }
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& error) noexcept {
+          stdexec::set_error(
+            static_cast<_Receiver&&>(__self.__op_->__receiver_), static_cast<_Error&&>(error));
+        }
+
+        template <same_as<get_env_t> _GetEnv, __decays_to<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, _Self&& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__receiver_);
+        }
+      };
+    };
+
+    template <class _Sequence, class _ReceiverId, class _Data>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using _ResultVariant = __result_variant_t<_Data, _Sequence, env_of_t<_Receiver>>;
+      using __base_type = __operation_base<_Receiver, _Data, _ResultVariant>;
+      using __receiver_t = stdexec::__t<__receiver<_ReceiverId, __base_type>>;
+
+      struct __t : __base_type {
+        subscribe_result_t<_Sequence, __receiver_t> __op_;
+
+        __t(_Sequence&& __sndr, _Receiver __rcvr, _Data __data)
+          : __base_type{static_cast<_Receiver&&>(__rcvr), static_cast<_Data&&>(__data)}
+          , __op_{exec::subscribe(static_cast<_Sequence&&>(__sndr), __receiver_t{this})} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    template <class _Receiver>
+    struct __connect_fn {
+      _Receiver& __rcvr_;
+
+      template <class _Child, class _Data>
+      using __operation_t = stdexec::__t<__operation<_Child, __id<_Receiver>, __decay_t<_Data>>>;
+
+      template <class _Data, class _Child>
+      auto operator()(__ignore, _Data&& __data, _Child&& __child)
+        -> __operation_t<_Child, _Data> {
+        return {
+          static_cast<_Child&&>(__child),
+          static_cast<_Receiver&&>(__rcvr_),
+          static_cast<_Data&&>(__data)};
+      }
+    };
+
+    template <class _Sender, class _Env>
+    using __completion_sigs_of_t =
+      __completion_sigs_t<__decay_t<__data_of<_Sender>>, __child_of<_Sender>, _Env>;
+
+    template <class _Sender, class _Receiver>
+    using __receiver_of_t = typename __operation<
+      __child_of<_Sender>,
+      __id<_Receiver>,
+      __decay_t<__data_of<_Sender>>>::__receiver_t;
+
+    struct __fold_impl : __sexpr_defaults {
+      static constexpr auto get_completion_signatures = //
+        []<class _Sender, class _Env>(_Sender&&, _Env&&) noexcept
+        -> __completion_sigs_of_t<_Sender, _Env> {
+        return {};
+      };
+
+      static constexpr auto connect = //
+        []<class _Sender, receiver _Receiver>(_Sender && __sndr, _Receiver __rcvr)
+        -> __call_result_t<__sexpr_apply_t, _Sender, __connect_fn<_Receiver>>
+        requires receiver_of<_Receiver, __completion_sigs_of_t<_Sender, env_of_t<_Receiver>>>
+              && sequence_sender_to<__child_of<_Sender>, __receiver_of_t<_Sender, _Receiver>>
+      {
+        return __sexpr_apply(static_cast<_Sender&&>(__sndr), __connect_fn<_Receiver>{__rcvr});
+      };
+    };
+
+    struct fold_t {
+      template <sender _Sequence, class _Init, class _Fun>
+      auto operator()(_Sequence&& __sndr, _Init&& __init, _Fun __fun) const {
+        auto __domain = __get_early_domain(static_cast<_Sequence&&>(__sndr));
+        return transform_sender(
+          __domain,
+          __make_sexpr<fold_t>(
+            __fold_data<__decay_t<_Init>, _Fun>{
+              static_cast<_Init&&>(__init), static_cast<_Fun&&>(__fun)},
+            static_cast<_Sequence&&>(__sndr)));
+      }
+
+      template <class _Init, class _Fun>
+      constexpr auto operator()(_Init&& __init, _Fun __fun) const
+        -> __binder_back<fold_t, __decay_t<_Init>, _Fun> {
+        return {{}, {}, {static_cast<_Init&&>(__init), static_cast<_Fun&&>(__fun)}};
+      }
+    };
+
+    struct reduce_each_t {
+      template <sender _Sequence, class _Init, class _Fun, scheduler _Scheduler>
+      auto operator()(_Sequence&& __sndr, _Init&& __identity, _Fun __fun, _Scheduler __sched)
+        const {
+        auto __domain = __get_early_domain(static_cast<_Sequence&&>(__sndr));
+        return transform_sender(
+          __domain,
+          __make_sexpr<reduce_each_t>(
+            __reduce_data<__decay_t<_Init>, _Fun, _Scheduler>{
+              static_cast<_Init&&>(__identity),
+              static_cast<_Fun&&>(__fun),
+              static_cast<_Scheduler&&>(__sched)},
+            static_cast<_Sequence&&>(__sndr)));
+      }
+
+      template <class _Init, class _Fun, scheduler _Scheduler>
+      constexpr auto operator()(_Init&& __identity, _Fun __fun, _Scheduler __sched) const
+        -> __binder_back<reduce_each_t, __decay_t<_Init>, _Fun, _Scheduler> {
+        return {
+          {},
+          {},
+          {static_cast<_Init&&>(__identity),
+           static_cast<_Fun&&>(__fun),
+           static_cast<_Scheduler&&>(__sched)}};
+      }
+    };
+  }
+
+  using __fold::fold_t;
+  inline constexpr fold_t fold{};
+
+  using __fold::reduce_each_t;
+  inline constexpr reduce_each_t reduce_each{};
+}
+
+namespace stdexec {
+  template <>
+  struct __sexpr_impl<exec::fold_t> : exec::__fold::__fold_impl { };
+
+  template <>
+  struct __sexpr_impl<exec::reduce_each_t> : exec::__fold::__fold_impl { };
+}
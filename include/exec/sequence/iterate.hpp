@@ -26,7 +26,12 @@
 #include "../env.hpp"
 #include "../trampoline_scheduler.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <ranges>
+#include <span>
 
 namespace exec {
   namespace __iterate {
@@ -209,10 +214,158 @@ namespace exec {
         return {};
       }
     };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // iterate_chunks(range, chunk_size) iterates a random access range in
+    // chunks of chunk_size consecutive elements, the last of which may be
+    // shorter. Every item sends a std::span over its chunk if the range is
+    // contiguous, or a std::ranges::subrange otherwise, so that there is one
+    // set_next per chunk rather than one per element. It is an iterate over
+    // a view of the chunks.
+    template <class _Iterator>
+    using __chunk_t = __if_c<
+      std::contiguous_iterator<_Iterator>,
+      std::span<std::remove_reference_t<std::iter_reference_t<_Iterator>>>,
+      std::ranges::subrange<_Iterator>>;
+
+    // A random access iterator over the chunks of a range. __index_ counts
+    // the chunks before the current one.
+    template <class _Iterator>
+    struct __chunk_iterator {
+      using iterator_concept = std::random_access_iterator_tag;
+      using iterator_category = std::input_iterator_tag;
+      using value_type = __chunk_t<_Iterator>;
+      using difference_type = std::ptrdiff_t;
+
+      _Iterator __first_{};
+      std::size_t __size_{};
+      std::size_t __chunk_size_{};
+      std::size_t __index_{};
+
+      value_type operator*() const {
+        const std::size_t __offset = __index_ * __chunk_size_;
+        const std::size_t __length = std::min(__size_ - __offset, __chunk_size_);
+        const _Iterator __begin =
+          __first_ + static_cast<std::iter_difference_t<_Iterator>>(__offset);
+        if constexpr (std::contiguous_iterator<_Iterator>) {
+          return value_type{std::to_address(__begin), __length};
+        } else {
+          return value_type{
+            __begin, __begin + static_cast<std::iter_difference_t<_Iterator>>(__length)};
+        }
+      }
+
+      value_type operator[](difference_type __n) const {
+        return *(*this + __n);
+      }
+
+      __chunk_iterator& operator+=(difference_type __n) noexcept {
+        __index_ += static_cast<std::size_t>(__n);
+        return *this;
+      }
+
+      __chunk_iterator& operator-=(difference_type __n) noexcept {
+        __index_ -= static_cast<std::size_t>(__n);
+        return *this;
+      }
+
+      __chunk_iterator& operator++() noexcept {
+        ++__index_;
+        return *this;
+      }
+
+      __chunk_iterator operator++(int) noexcept {
+        __chunk_iterator __tmp = *this;
+        ++__index_;
+        return __tmp;
+      }
+
+      __chunk_iterator& operator--() noexcept {
+        --__index_;
+        return *this;
+      }
+
+      __chunk_iterator operator--(int) noexcept {
+        __chunk_iterator __tmp = *this;
+        --__index_;
+        return __tmp;
+      }
+
+      friend __chunk_iterator operator+(__chunk_iterator __it, difference_type __n) noexcept {
+        return __it += __n;
+      }
+
+      friend __chunk_iterator operator+(difference_type __n, __chunk_iterator __it) noexcept {
+        return __it += __n;
+      }
+
+      friend __chunk_iterator operator-(__chunk_iterator __it, difference_type __n) noexcept {
+        return __it -= __n;
+      }
+
+      friend difference_type
+        operator-(const __chunk_iterator& __lhs, const __chunk_iterator& __rhs) noexcept {
+        return static_cast<difference_type>(__lhs.__index_)
+             - static_cast<difference_type>(__rhs.__index_);
+      }
+
+      friend bool
+        operator==(const __chunk_iterator& __lhs, const __chunk_iterator& __rhs) noexcept {
+        return __lhs.__index_ == __rhs.__index_;
+      }
+
+      friend auto
+        operator<=>(const __chunk_iterator& __lhs, const __chunk_iterator& __rhs) noexcept {
+        return __lhs.__index_ <=> __rhs.__index_;
+      }
+    };
+
+    template <class _Range>
+    struct __chunk_view {
+      using __iterator_t = __chunk_iterator<std::ranges::iterator_t<const _Range>>;
+
+      _Range __range_;
+      std::size_t __chunk_size_;
+
+      std::size_t size() const {
+        const auto __size = static_cast<std::size_t>(std::ranges::size(__range_));
+        return (__size + __chunk_size_ - 1) / __chunk_size_;
+      }
+
+      __iterator_t begin() const {
+        return {
+          std::ranges::begin(__range_),
+          static_cast<std::size_t>(std::ranges::size(__range_)),
+          __chunk_size_,
+          0};
+      }
+
+      __iterator_t end() const {
+        return begin() + static_cast<std::ptrdiff_t>(size());
+      }
+    };
+
+    template <class _Range>
+    concept __chunkable_range =
+      std::ranges::random_access_range<_Range>
+      && std::ranges::random_access_range<const __decay_t<_Range>>
+      && std::ranges::sized_range<const __decay_t<_Range>> && __decay_copyable<_Range>;
+
+    struct iterate_chunks_t {
+      template <__chunkable_range _Range>
+      auto operator()(_Range&& __range, std::size_t __chunk_size) const {
+        STDEXEC_ASSERT(__chunk_size != 0);
+        return make_sequence_expr<iterate_t>(
+          __chunk_view<__decay_t<_Range>>{static_cast<_Range&&>(__range), __chunk_size});
+      }
+    };
   }
 
   using __iterate::iterate_t;
   inline constexpr iterate_t iterate;
+
+  using __iterate::iterate_chunks_t;
+  inline constexpr iterate_chunks_t iterate_chunks{};
 }
 
 #endif // STDEXEC_HAS_STD_RANGES()
\ No newline at end of file
@@ -0,0 +1,756 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sequence_senders.hpp"
+
+#include "../__detail/__basic_sequence.hpp"
+#include "./__stop_and_error.hpp"
+#include "../../stdexec/__detail/__intrusive_queue.hpp"
+#include "../../stdexec/__detail/__recycling_allocator.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <variant>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // merge and merge_each
+  //
+  // merge(seqs...) subscribes to all of the given sequences at once and
+  // passes their items downstream as they arrive. merge_each(seq) does the
+  // same for the sequences that the items of seq send, subscribing to each
+  // of them as soon as it arrives. Items of different sequences may be
+  // passed downstream concurrently, from different threads.
+  //
+  // Items are passed on as they are; the next-sender that downstream returns
+  // for an item is wrapped only to notice when downstream does not want any
+  // more items, in which case all sequences are asked to stop. The same
+  // happens if one of them completes with an error or is stopped. The merged
+  // sequence completes once all of them have completed.
+  //
+  // If downstream advertises a limit with get_max_in_flight, an item whose
+  // next-sender is started while that many items are in flight waits in an
+  // intrusive queue until one of them completes. This holds back the
+  // sequence that sent it.
+  //
+  // merge allocates nothing. merge_each allocates the subscription of every
+  // inner sequence with the allocator of the receiver's environment if it
+  // has one, or else with the recycling allocator, but nothing per item.
+  namespace __merge {
+    using namespace stdexec;
+
+    template <class _Env>
+    using __env_t = __env::__join_t<__env::__with<in_place_stop_token, get_stop_token_t>, _Env>;
+
+    // An item that waits until downstream accepts another one.
+    struct __credit_waiter {
+      void (*__grant_)(__credit_waiter*) noexcept;
+      __credit_waiter* __next_ = nullptr;
+    };
+
+    template <class _Receiver, class _Errors>
+    struct __operation_base
+      : __immovable
+      , __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors> {
+      using __state_t = __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors>;
+      using __state_t::__stop_source_;
+
+      __operation_base(_Receiver&& __rcvr, std::size_t __pending)
+        : __rcvr_(static_cast<_Receiver&&>(__rcvr))
+        , __pending_(__pending)
+        , __credits_(exec::get_max_in_flight(stdexec::get_env(__rcvr_)))
+        , __limited_(__credits_ != std::numeric_limits<std::size_t>::max()) {
+      }
+
+      __env_t<env_of_t<_Receiver>> __child_env() const noexcept {
+        return __env::__join(
+          __env::__with(__stop_source_.get_token(), get_stop_token), stdexec::get_env(__rcvr_));
+      }
+
+      auto __allocator() const noexcept {
+        return __env_allocator(stdexec::get_env(__rcvr_));
+      }
+
+      void __start_on_stop() noexcept {
+        __state_t::__start_on_stop(stdexec::get_env(__rcvr_));
+      }
+
+      // Passes the item on right away if downstream accepts another one, or
+      // else queues it until a credit is returned.
+      void __acquire(__credit_waiter* __item) noexcept {
+        if (__limited_) {
+          std::unique_lock __lock{__mutex_};
+          if (__credits_ == 0) {
+            __waiters_.push_back(__item);
+            return;
+          }
+          --__credits_;
+        }
+        __item->__grant_(__item);
+      }
+
+      // Returns the credit of a completed item and hands it over to the next
+      // waiting item. A granted item may complete inline and return its
+      // credit again, so only the outermost call grants credits, in a loop.
+      void __release() noexcept {
+        if (!__limited_) {
+          return;
+        }
+        {
+          std::unique_lock __lock{__mutex_};
+          ++__credits_;
+          if (__releasing_) {
+            return;
+          }
+          __releasing_ = true;
+        }
+        while (true) {
+          __credit_waiter* __next = nullptr;
+          {
+            std::unique_lock __lock{__mutex_};
+            if (__waiters_.empty() || __credits_ == 0) {
+              __releasing_ = false;
+              return;
+            }
+            --__credits_;
+            __next = __waiters_.pop_front();
+          }
+          __next->__grant_(__next);
+        }
+      }
+
+      // One of the sequences was stopped.
+      void __set_stopped() noexcept {
+        __stopped_.store(true, std::memory_order_relaxed);
+        __stop_source_.request_stop();
+      }
+
+      // Downstream does not want any more items.
+      void __break() noexcept {
+        __broken_.store(true, std::memory_order_relaxed);
+        __stop_source_.request_stop();
+      }
+
+      void __arrive() noexcept {
+        if (__pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          __complete();
+        }
+      }
+
+      void __complete() noexcept {
+        if (this->__complete_with_error(__rcvr_)) {
+          return;
+        }
+        if (get_stop_token(stdexec::get_env(__rcvr_)).stop_requested()) {
+          stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+        } else if (__broken_.load(std::memory_order_relaxed)) {
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        } else if (__stopped_.load(std::memory_order_relaxed)) {
+          stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+        } else {
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        }
+      }
+
+      _Receiver __rcvr_;
+      std::atomic<std::size_t> __pending_;
+      std::atomic<bool> __stopped_{false};
+      std::atomic<bool> __broken_{false};
+      std::mutex __mutex_{};
+      std::size_t __credits_;
+      bool __releasing_{false};
+      const bool __limited_;
+      __intrusive_queue<&__credit_waiter::__next_> __waiters_{};
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The next-sender that downstream returns for an item, wrapped to notice
+    // when it completes with set_stopped.
+    template <class _ItemRcvr, class _OpBase>
+    struct __next_operation_base : __credit_waiter {
+      STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+      _OpBase* __op_;
+    };
+
+    template <class _ItemRcvr, class _OpBase>
+    struct __next_receiver {
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __next_receiver;
+        __next_operation_base<_ItemRcvr, _OpBase>* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__op_->__release();
+          stdexec::set_value(static_cast<_ItemRcvr&&>(__self.__op_->__rcvr_));
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__op_->__break();
+          __self.__op_->__op_->__release();
+          stdexec::set_stopped(static_cast<_ItemRcvr&&>(__self.__op_->__rcvr_));
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend env_of_t<_ItemRcvr> tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__rcvr_);
+        }
+      };
+    };
+
+    template <class _NextSender, class _ItemRcvr, class _OpBase>
+    struct __next_operation {
+      using __next_receiver_t = stdexec::__t<__next_receiver<_ItemRcvr, _OpBase>>;
+
+      struct __t : __next_operation_base<_ItemRcvr, _OpBase> {
+        using __id = __next_operation;
+        connect_result_t<_NextSender, __next_receiver_t> __op_state_;
+
+        __t(_NextSender&& __sndr, _ItemRcvr&& __rcvr, _OpBase* __op)
+          : __next_operation_base<_ItemRcvr, _OpBase>{
+            {&__grant},
+            static_cast<_ItemRcvr&&>(__rcvr),
+            __op}
+          , __op_state_(
+              stdexec::connect(static_cast<_NextSender&&>(__sndr), __next_receiver_t{this})) {
+        }
+
+        static void __grant(__credit_waiter* __self) noexcept {
+          stdexec::start(static_cast<__t*>(__self)->__op_state_);
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__op_->__acquire(&__self);
+        }
+      };
+    };
+
+    template <class _NextSender, class _OpBase>
+    struct __next_sender {
+      struct __t {
+        using __id = __next_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        _NextSender __sndr_;
+        _OpBase* __op_;
+
+        template <class _ItemRcvr>
+        using __operation_t = stdexec::__t<__next_operation<_NextSender, _ItemRcvr, _OpBase>>;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+          requires sender_to<_NextSender, stdexec::__t<__next_receiver<_ItemRcvr, _OpBase>>>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr)
+          -> __operation_t<_ItemRcvr> {
+          return {
+            static_cast<_Self&&>(__self).__sndr_, static_cast<_ItemRcvr&&>(__rcvr), __self.__op_};
+        }
+      };
+    };
+
+    template <class _Receiver, class _Item, class _OpBase>
+    using __next_sender_t =
+      stdexec::__t<__next_sender<next_sender_of_t<_Receiver, _Item>, _OpBase>>;
+
+    // Receives the items and the completion of one of the merged sequences.
+    // _Done is called once the sequence has completed.
+    template <class _ReceiverId, class _OpBase, class _Done>
+    struct __receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __receiver;
+        _OpBase* __op_;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _Done __done_;
+
+        template <same_as<set_next_t> _SetNext, same_as<__t> _Self, class _Item>
+          requires __callable<set_next_t, _Receiver&, _Item>
+        friend auto tag_invoke(_SetNext, _Self& __self, _Item&& __item)
+          -> __next_sender_t<_Receiver, _Item, _OpBase> {
+          return {
+            exec::set_next(__self.__op_->__rcvr_, static_cast<_Item&&>(__item)), __self.__op_};
+        }
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__done_(__self.__op_);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__set_stopped();
+          __self.__done_(__self.__op_);
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__done_(__self.__op_);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> __env_t<env_of_t<_Receiver>> {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    struct __arrive_fn {
+      template <class _OpBase>
+      void operator()(_OpBase* __op) const noexcept {
+        __op->__arrive();
+      }
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // merge
+    template <class _Env>
+    struct __merge_completions_fn {
+      template <class... _Sequences>
+      using __f = __concat_completion_signatures_t<
+        completion_signatures<set_value_t(), set_stopped_t()>,
+        __sequence_completion_signatures_of_t<_Sequences, __env_t<_Env>>...>;
+    };
+
+    template <class _Env>
+    struct __merge_items_fn {
+      template <class... _Sequences>
+      using __f = __minvoke<
+        __mconcat<__munique<__q<item_types>>>,
+        item_types_of_t<_Sequences, __env_t<_Env>>...>;
+    };
+
+    template <class _ReceiverId, class... _Sequences>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __base_t = __operation_base<
+        _Receiver,
+        __seq::__errors_variant_t<
+          __minvoke<__merge_completions_fn<env_of_t<_Receiver>>, _Sequences...>>>;
+      using __receiver_t = stdexec::__t<__receiver<_ReceiverId, __base_t, __arrive_fn>>;
+
+      struct __t : __base_t {
+        using __id = __operation;
+        std::tuple<subscribe_result_t<_Sequences, __receiver_t>...> __ops_;
+
+        // One for every sequence, and one that is held until all of them are
+        // started.
+        __t(_Receiver __rcvr, _Sequences&&... __sequences)
+          : __base_t{static_cast<_Receiver&&>(__rcvr), sizeof...(_Sequences) + 1}
+          , __ops_{__conv{[&, this] {
+            return exec::subscribe(static_cast<_Sequences&&>(__sequences), __receiver_t{this});
+          }}...} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__start_on_stop();
+          std::apply([](auto&... __ops) noexcept { (stdexec::start(__ops), ...); }, __self.__ops_);
+          __self.__arrive();
+        }
+      };
+    };
+
+    template <class _Receiver>
+    struct __subscribe_fn {
+      _Receiver& __rcvr_;
+
+      template <class... _Sequences>
+      auto operator()(__ignore, __ignore, _Sequences&&... __sequences)
+        -> stdexec::__t<__operation<__id<_Receiver>, _Sequences...>> {
+        return {static_cast<_Receiver&&>(__rcvr_), static_cast<_Sequences&&>(__sequences)...};
+      }
+    };
+
+    struct merge_t {
+      template <sender... _Sequences>
+      auto operator()(_Sequences&&... __sequences) const
+        noexcept((__nothrow_decay_copyable<_Sequences> && ...)) {
+        return make_sequence_expr<merge_t>(__(), static_cast<_Sequences&&>(__sequences)...);
+      }
+
+      template <class _Self, class _Env>
+      using __completion_sigs_t = __children_of<_Self, __merge_completions_fn<_Env>>;
+
+      template <sender_expr_for<merge_t> _Self, class _Env>
+      static __completion_sigs_t<_Self, _Env> get_completion_signatures(_Self&&, _Env&&) noexcept {
+        return {};
+      }
+
+      template <class _Self, class _Env>
+      using __item_types_t = __children_of<_Self, __merge_items_fn<_Env>>;
+
+      template <sender_expr_for<merge_t> _Self, class _Env>
+      static __item_types_t<_Self, _Env> get_item_types(_Self&&, _Env&&) noexcept {
+        return {};
+      }
+
+      template <class _Receiver>
+      struct __subscribable {
+        template <class... _Sequences>
+        using __f = __mbool<(
+          sequence_sender_to<
+            _Sequences,
+            typename __operation<__id<_Receiver>, _Sequences...>::__receiver_t>
+          && ...)>;
+      };
+
+      template <sender_expr_for<merge_t> _Self, receiver _Receiver>
+        requires sequence_receiver_of<_Receiver, __item_types_t<_Self, env_of_t<_Receiver>>>
+              && __v<__children_of<_Self, __subscribable<_Receiver>>>
+      static auto subscribe(_Self&& __self, _Receiver __rcvr)
+        -> __call_result_t<__sexpr_apply_t, _Self, __subscribe_fn<_Receiver>> {
+        return __sexpr_apply(static_cast<_Self&&>(__self), __subscribe_fn<_Receiver>{__rcvr});
+      }
+
+      template <sender_expr_for<merge_t> _Sexpr>
+      static empty_env get_env(const _Sexpr&) noexcept {
+        return {};
+      }
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // merge_each
+    template <class _Env>
+    struct __values_of {
+      template <class _Item>
+      using __f = __value_types_of_t<_Item, __env_t<_Env>, __q<__decay_t>, __q<__types>>;
+    };
+
+    // The inner sequences that the items of the outer sequence send.
+    template <class _Sequence, class _Env>
+    using __inner_sequences_t = __mapply<
+      __transform<__values_of<_Env>, __mconcat<__munique<__q<__types>>>>,
+      item_types_of_t<_Sequence, __env_t<_Env>>>;
+
+    template <class _Alloc, class _Ty>
+    using __rebind_t = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Ty>;
+
+    template <class _Block, class _OpBase, class... _Args>
+    _Block* __make_block(_OpBase* __op, _Args&&... __args) {
+      using _Alloc = __rebind_t<decltype(__op->__allocator()), _Block>;
+      _Alloc __alloc{__op->__allocator()};
+      _Block* __block = std::allocator_traits<_Alloc>::allocate(__alloc, 1);
+      try {
+        std::allocator_traits<_Alloc>::construct(
+          __alloc, __block, __op, static_cast<_Args&&>(__args)...);
+      } catch (...) {
+        std::allocator_traits<_Alloc>::deallocate(__alloc, __block, 1);
+        throw;
+      }
+      return __block;
+    }
+
+    template <class _Block>
+    void __destroy_block(_Block* __block) noexcept {
+      using _Alloc = __rebind_t<decltype(__block->__op_->__allocator()), _Block>;
+      _Alloc __alloc{__block->__op_->__allocator()};
+      std::allocator_traits<_Alloc>::destroy(__alloc, __block);
+      std::allocator_traits<_Alloc>::deallocate(__alloc, __block, 1);
+    }
+
+    template <class _Block>
+    struct __release_block_fn {
+      _Block* __block_;
+
+      template <class _OpBase>
+      void operator()(_OpBase* __op) const noexcept {
+        __merge::__destroy_block(__block_);
+        __op->__arrive();
+      }
+    };
+
+    // The subscription to an inner sequence, which lives until the inner
+    // sequence has completed.
+    template <class _Sequence, class _ReceiverId, class _OpBase>
+    struct __inner_block {
+      using __receiver_t =
+        stdexec::__t<__receiver<_ReceiverId, _OpBase, __release_block_fn<__inner_block>>>;
+
+      template <class _Seq>
+      __inner_block(_OpBase* __op, _Seq&& __seq)
+        : __op_(__op)
+        , __op_state_(exec::subscribe(
+            _Sequence(static_cast<_Seq&&>(__seq)),
+            __receiver_t{__op, {this}})) {
+      }
+
+      _OpBase* __op_;
+      subscribe_result_t<_Sequence, __receiver_t> __op_state_;
+    };
+
+    // Receives the inner sequence that an item of the outer sequence sends.
+    template <class _InnerOp, class _OpBase>
+    struct __value_receiver {
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __value_receiver;
+        _InnerOp* __op_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self, class _Seq>
+        friend void tag_invoke(_SetValue, _Self&& __self, _Seq&& __seq) noexcept {
+          __self.__op_->__subscribe(static_cast<_Seq&&>(__seq));
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__stop();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__stop();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> decltype(__declval<const _OpBase&>().__child_env()) {
+          return __self.__op_->__op_->__child_env();
+        }
+      };
+    };
+
+    // The operation of an item of the outer sequence. It completes as soon
+    // as the inner sequence was subscribed to, so that the outer sequence can
+    // go on while the inner one runs.
+    template <class _Item, class _ItemRcvr, class _ReceiverId, class _OpBase>
+    struct __inner_operation {
+      struct __t {
+        using __id = __inner_operation;
+        using __value_receiver_t = stdexec::__t<__value_receiver<__t, _OpBase>>;
+
+        __t(_Item&& __item, _ItemRcvr&& __rcvr, _OpBase* __op)
+          : __rcvr_(static_cast<_ItemRcvr&&>(__rcvr))
+          , __op_(__op)
+          , __item_op_(stdexec::connect(static_cast<_Item&&>(__item), __value_receiver_t{this})) {
+        }
+
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        _OpBase* __op_;
+        connect_result_t<_Item, __value_receiver_t> __item_op_;
+
+        template <class _Seq>
+        void __subscribe(_Seq&& __seq) noexcept {
+          using __block_t = __inner_block<__decay_t<_Seq>, _ReceiverId, _OpBase>;
+          _OpBase* __op = __op_;
+          __block_t* __block = nullptr;
+          try {
+            __block = __merge::__make_block<__block_t>(__op, static_cast<_Seq&&>(__seq));
+          } catch (...) {
+            __op->__set_error(std::current_exception());
+            __stop();
+            return;
+          }
+          __op->__pending_.fetch_add(1, std::memory_order_relaxed);
+          stdexec::start(__block->__op_state_);
+          stdexec::set_value(static_cast<_ItemRcvr&&>(__rcvr_));
+        }
+
+        void __stop() noexcept {
+          stdexec::set_stopped(static_cast<_ItemRcvr&&>(__rcvr_));
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          if (__self.__op_->__stop_source_.stop_requested()) {
+            __self.__stop();
+          } else {
+            stdexec::start(__self.__item_op_);
+          }
+        }
+      };
+    };
+
+    template <class _Item, class _ReceiverId, class _OpBase>
+    struct __inner_sender {
+      struct __t {
+        using __id = __inner_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        _Item __item_;
+        _OpBase* __op_;
+
+        template <class _ItemRcvr>
+        using __operation_t =
+          stdexec::__t<__inner_operation<_Item, _ItemRcvr, _ReceiverId, _OpBase>>;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr)
+          -> __operation_t<_ItemRcvr> {
+          return {
+            static_cast<_Self&&>(__self).__item_, static_cast<_ItemRcvr&&>(__rcvr), __self.__op_};
+        }
+      };
+    };
+
+    // Receives the items and the completion of the outer sequence.
+    template <class _ReceiverId, class _OpBase>
+    struct __outer_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __outer_receiver;
+        _OpBase* __op_;
+
+        template <same_as<set_next_t> _SetNext, same_as<__t> _Self, sender _Item>
+        friend auto tag_invoke(_SetNext, _Self& __self, _Item&& __item) //
+          noexcept(__nothrow_decay_copyable<_Item>)
+            -> stdexec::__t<__inner_sender<__decay_t<_Item>, _ReceiverId, _OpBase>> {
+          return {static_cast<_Item&&>(__item), __self.__op_};
+        }
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__set_stopped();
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> __env_t<env_of_t<_Receiver>> {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    template <class _Env>
+    struct __inner_completions_fn {
+      template <class... _Inner>
+      using __f = __concat_completion_signatures_t<
+        completion_signatures<set_value_t(), set_error_t(std::exception_ptr), set_stopped_t()>,
+        __sequence_completion_signatures_of_t<_Inner, __env_t<_Env>>...>;
+    };
+
+    template <class _Sequence, class _Env>
+    using __merge_each_completions_t = __concat_completion_signatures_t<
+      __sequence_completion_signatures_of_t<_Sequence, __env_t<_Env>>,
+      __mapply<__inner_completions_fn<_Env>, __inner_sequences_t<_Sequence, _Env>>>;
+
+    template <class _Sequence, class _Env>
+    using __merge_each_items_t =
+      __mapply<__merge_items_fn<_Env>, __inner_sequences_t<_Sequence, _Env>>;
+
+    template <class _Sequence, class _ReceiverId>
+    struct __each_operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __base_t = __operation_base<
+        _Receiver,
+        __seq::__errors_variant_t<__merge_each_completions_t<_Sequence, env_of_t<_Receiver>>>>;
+      using __receiver_t = stdexec::__t<__outer_receiver<_ReceiverId, __base_t>>;
+
+      struct __t : __base_t {
+        using __id = __each_operation;
+        subscribe_result_t<_Sequence, __receiver_t> __op_;
+
+        // One for the outer sequence, and one for every inner sequence.
+        __t(_Sequence&& __sndr, _Receiver __rcvr)
+          : __base_t{static_cast<_Receiver&&>(__rcvr), 1}
+          , __op_{exec::subscribe(static_cast<_Sequence&&>(__sndr), __receiver_t{this})} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__start_on_stop();
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    template <class _Receiver>
+    struct __subscribe_each_fn {
+      _Receiver& __rcvr_;
+
+      template <class _Sequence>
+      auto operator()(__ignore, __ignore, _Sequence&& __sequence)
+        -> stdexec::__t<__each_operation<_Sequence, __id<_Receiver>>> {
+        return {static_cast<_Sequence&&>(__sequence), static_cast<_Receiver&&>(__rcvr_)};
+      }
+    };
+
+    struct merge_each_t {
+      template <sender _Sequence>
+      auto operator()(_Sequence&& __sndr) const noexcept(__nothrow_decay_copyable<_Sequence>) {
+        return make_sequence_expr<merge_each_t>(__(), static_cast<_Sequence&&>(__sndr));
+      }
+
+      constexpr auto operator()() const noexcept -> __binder_back<merge_each_t> {
+        return {{}, {}, {}};
+      }
+
+      template <sender_expr_for<merge_each_t> _Self, class _Env>
+      static auto get_completion_signatures(_Self&&, _Env&&) noexcept
+        -> __merge_each_completions_t<__child_of<_Self>, _Env> {
+        return {};
+      }
+
+      template <sender_expr_for<merge_each_t> _Self, class _Env>
+      static auto get_item_types(_Self&&, _Env&&) noexcept
+        -> __merge_each_items_t<__child_of<_Self>, _Env> {
+        return {};
+      }
+
+      template <class _Self, class _Receiver>
+      using __receiver_t =
+        typename __each_operation<__child_of<_Self>, __id<_Receiver>>::__receiver_t;
+
+      template <sender_expr_for<merge_each_t> _Self, receiver _Receiver>
+        requires sequence_receiver_of<
+                   _Receiver,
+                   __merge_each_items_t<__child_of<_Self>, env_of_t<_Receiver>>>
+              && sequence_sender_to<__child_of<_Self>, __receiver_t<_Self, _Receiver>>
+      static auto subscribe(_Self&& __self, _Receiver __rcvr)
+        -> __call_result_t<__sexpr_apply_t, _Self, __subscribe_each_fn<_Receiver>> {
+        return __sexpr_apply(static_cast<_Self&&>(__self), __subscribe_each_fn<_Receiver>{__rcvr});
+      }
+
+      template <sender_expr_for<merge_each_t> _Sexpr>
+      static env_of_t<__child_of<_Sexpr>> get_env(const _Sexpr& __sexpr) noexcept {
+        return __sexpr_apply(__sexpr, []<class _Child>(__ignore, __ignore, const _Child& __child) {
+          return stdexec::get_env(__child);
+        });
+      }
+    };
+  }
+
+  using __merge::merge_t;
+  inline constexpr merge_t merge{};
+
+  using __merge::merge_each_t;
+  inline constexpr merge_each_t merge_each{};
+}
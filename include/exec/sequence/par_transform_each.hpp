@@ -0,0 +1,813 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../sequence_senders.hpp"
+
+#include "../__detail/__basic_sequence.hpp"
+#include "./__stop_and_error.hpp"
+#include "../../stdexec/__detail/__intrusive_queue.hpp"
+#include "../../stdexec/__detail/__recycling_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // par_transform_each and par_transform_each_ordered
+  //
+  // Like transform_each, but every item is transformed with
+  // adaptor(on(sched, item)) and up to max_in_flight transformations run at
+  // the same time. The sender that set_next returns to the upstream sequence
+  // completes as soon as the item was admitted, so that a serial upstream
+  // such as iterate can go on producing items while earlier ones are still
+  // being transformed. Items beyond max_in_flight wait in an intrusive queue
+  // until a slot is released.
+  //
+  // par_transform_each passes every transformation downstream as soon as it
+  // is admitted, so downstream sees the results in the order in which they
+  // complete. par_transform_each_ordered runs the transformations eagerly,
+  // keeps their results in a reorder buffer of max_in_flight entries and
+  // passes them downstream one at a time, in the order in which the items
+  // were admitted.
+  //
+  // Both advertise their number of slots to the upstream sequence with
+  // get_max_in_flight. par_transform_each also takes no more slots than
+  // downstream advertises.
+  //
+  // The state of an admitted item is allocated with the allocator of the
+  // receiver's environment if it has one, or else with the recycling
+  // allocator.
+  namespace __par_transform_each {
+    using namespace stdexec;
+
+    template <class _Scheduler, class _Adaptor>
+    struct __data {
+      using __scheduler_t = _Scheduler;
+      using __adaptor_t = _Adaptor;
+
+      _Scheduler __sched_;
+      _Adaptor __adaptor_;
+      std::size_t __max_in_flight_;
+    };
+
+    template <class _Env>
+    using __env_t = __env::__join_t<
+      __env::__with<in_place_stop_token, get_stop_token_t>,
+      __env::__with<std::size_t, get_max_in_flight_t>,
+      _Env>;
+
+    template <class _Sequence, class _Env>
+    using __errors_variant_t = //
+      __minvoke<
+        __mconcat<__transform<__q<__decay_t>, __munique<__q<std::variant>>>>,
+        __types<std::monostate, std::exception_ptr>,
+        error_types_of_t<_Sequence, _Env, __types>>;
+
+    // An item that the upstream sequence has started and that waits for a
+    // free slot.
+    struct __item_base {
+      // Called when the item got a slot.
+      void (*__admit_)(__item_base*) noexcept;
+      // Called when the item has completed and upstream may go on.
+      void (*__complete_)(__item_base*) noexcept;
+      __item_base* __next_ = nullptr;
+    };
+
+    // The state of an admitted item, which lives until downstream is done
+    // with it.
+    struct __block_base {
+      void (*__destroy_)(__block_base*) noexcept;
+      // Only used by the ordered variant.
+      void (*__deliver_)(__block_base*) noexcept = nullptr;
+      std::size_t __seq_ = 0;
+    };
+
+    template <class _Receiver, class _Data, class _Errors, bool _Ordered>
+    struct __operation_base
+      : __immovable
+      , __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors> {
+      using __state_t = __seq::__stop_and_error_state<env_of_t<_Receiver>, _Errors>;
+      using __state_t::__stop_source_;
+
+      __operation_base(_Receiver&& __rcvr, _Data&& __data)
+        : __rcvr_(static_cast<_Receiver&&>(__rcvr))
+        , __data_(static_cast<_Data&&>(__data))
+        , __slots_(__slots(__rcvr_, __data_))
+        , __free_slots_(__slots_) {
+        STDEXEC_ASSERT(__free_slots_ != 0);
+        if constexpr (_Ordered) {
+          __reorder_.resize(__free_slots_);
+        }
+      }
+
+      // The unordered variant passes every admitted item downstream right
+      // away, so it admits no more items than downstream accepts at a time.
+      static std::size_t __slots(const _Receiver& __rcvr, const _Data& __data) noexcept {
+        if constexpr (_Ordered) {
+          return __data.__max_in_flight_;
+        } else {
+          return std::min(
+            __data.__max_in_flight_, exec::get_max_in_flight(stdexec::get_env(__rcvr)));
+        }
+      }
+
+      // Tells the upstream sequence how many items can be admitted at a time,
+      // so that a concurrent one does not pile up items that wait for a slot.
+      __env_t<env_of_t<_Receiver>> __child_env() const noexcept {
+        return __env::__join(
+          __env::__with(__stop_source_.get_token(), get_stop_token),
+          __env::__with(__slots_, get_max_in_flight),
+          stdexec::get_env(__rcvr_));
+      }
+
+      auto __allocator() const noexcept {
+        return __env_allocator(stdexec::get_env(__rcvr_));
+      }
+
+      // Admits the item right away if a slot is free, or else queues it until
+      // one is released.
+      void __acquire(__item_base* __item) noexcept {
+        {
+          std::unique_lock __lock{__mutex_};
+          if (__free_slots_ == 0) {
+            __waiters_.push_back(__item);
+            return;
+          }
+          --__free_slots_;
+        }
+        __item->__admit_(__item);
+      }
+
+      // Hands the slot over to the next waiting item, or returns it.
+      void __release() noexcept {
+        __item_base* __next = nullptr;
+        {
+          std::unique_lock __lock{__mutex_};
+          if (__waiters_.empty()) {
+            ++__free_slots_;
+            return;
+          }
+          __next = __waiters_.pop_front();
+        }
+        __next->__admit_(__next);
+      }
+
+      // Called once the state of an admitted item was constructed, right
+      // before it is started.
+      void __launch(__block_base* __block) noexcept {
+        __pending_.fetch_add(1, std::memory_order_relaxed);
+        if constexpr (_Ordered) {
+          std::unique_lock __lock{__mutex_};
+          __block->__seq_ = __next_seq_++;
+        }
+      }
+
+      // Called by the ordered variant when the transformation of an item has
+      // completed and its result is stored.
+      void __ready(__block_base* __block) noexcept {
+        {
+          std::unique_lock __lock{__mutex_};
+          __reorder_[__block->__seq_ % __reorder_.size()] = __block;
+          if (__delivering_ || __block->__seq_ != __delivered_seq_) {
+            return;
+          }
+          __delivering_ = true;
+        }
+        __block->__deliver_(__block);
+      }
+
+      // Called when downstream is done with an admitted item.
+      void __done(__block_base* __block) noexcept {
+        __block->__destroy_(__block);
+        if constexpr (_Ordered) {
+          __block_base* __next = nullptr;
+          {
+            std::unique_lock __lock{__mutex_};
+            const std::size_t __size = __reorder_.size();
+            __reorder_[__delivered_seq_++ % __size] = nullptr;
+            __next = __reorder_[__delivered_seq_ % __size];
+            __delivering_ = __next != nullptr;
+          }
+          __release();
+          if (__next != nullptr) {
+            __next->__deliver_(__next);
+          }
+        } else {
+          __release();
+        }
+        __arrive();
+      }
+
+      void __arrive() noexcept {
+        if (__pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+          __complete();
+        }
+      }
+
+      void __complete() noexcept {
+        if (this->__complete_with_error(__rcvr_)) {
+          return;
+        }
+        if (__upstream_stopped_) {
+          stdexec::set_stopped(static_cast<_Receiver&&>(__rcvr_));
+        } else {
+          stdexec::set_value(static_cast<_Receiver&&>(__rcvr_));
+        }
+      }
+
+      _Receiver __rcvr_;
+      _Data __data_;
+      // One for the upstream sequence and one for every admitted item.
+      std::atomic<std::size_t> __pending_{1};
+      std::mutex __mutex_{};
+      const std::size_t __slots_;
+      std::size_t __free_slots_;
+      __intrusive_queue<&__item_base::__next_> __waiters_{};
+      bool __upstream_stopped_{false};
+      // The reorder buffer of the ordered variant. An item holds its slot
+      // until it was delivered, so the sequence numbers of the items in the
+      // buffer never differ by more than its size.
+      std::vector<__block_base*> __reorder_{};
+      std::size_t __next_seq_{0};
+      std::size_t __delivered_seq_{0};
+      bool __delivering_{false};
+    };
+
+    template <class _Alloc, class _Ty>
+    using __rebind_t = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Ty>;
+
+    template <class _Block, class _OpBase, class... _Args>
+    _Block* __make_block(_OpBase* __op, _Args&&... __args) {
+      using _Alloc = __rebind_t<decltype(__op->__allocator()), _Block>;
+      _Alloc __alloc{__op->__allocator()};
+      _Block* __block = std::allocator_traits<_Alloc>::allocate(__alloc, 1);
+      try {
+        std::allocator_traits<_Alloc>::construct(
+          __alloc, __block, __op, static_cast<_Args&&>(__args)...);
+      } catch (...) {
+        std::allocator_traits<_Alloc>::deallocate(__alloc, __block, 1);
+        throw;
+      }
+      return __block;
+    }
+
+    template <class _Block>
+    void __destroy_block(__block_base* __base) noexcept {
+      _Block* __block = static_cast<_Block*>(__base);
+      using _Alloc = __rebind_t<decltype(__block->__op_->__allocator()), _Block>;
+      _Alloc __alloc{__block->__op_->__allocator()};
+      std::allocator_traits<_Alloc>::destroy(__alloc, __block);
+      std::allocator_traits<_Alloc>::deallocate(__alloc, __block, 1);
+    }
+
+    // Receives the completion of the next-sender that downstream returned
+    // for an admitted item.
+    template <class _OpBase>
+    struct __next_receiver {
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __next_receiver;
+
+        _OpBase* __op_;
+        __block_base* __block_;
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__done(__self.__block_);
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          // Downstream does not want any more items.
+          __self.__op_->__stop_source_.request_stop();
+          __self.__op_->__done(__self.__block_);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The results of an item and of its transformation are stored in the
+    // state of the item and sent on by a sender that refers to them.
+    template <class _Tag, class... _Args>
+    using __stored_sig_t = _Tag(_Args&&...);
+
+    template <class _Tuple>
+    using __stored_sig_of_t = __mapply<__q<__stored_sig_t>, _Tuple>;
+
+    template <class _Sigs>
+    using __result_variant_t = //
+      __compl_sigs::__maybe_for_all_sigs<
+        _Sigs,
+        __q<__decayed_tuple>,
+        __mbind_front_q<
+          __variant,
+          std::tuple<set_stopped_t>,
+          std::tuple<set_error_t, std::exception_ptr>>>;
+
+    template <class _Sigs>
+    using __stored_sigs_t = //
+      __mapply<
+        __transform<__q<__stored_sig_of_t>, __q<completion_signatures>>,
+        __result_variant_t<_Sigs>>;
+
+    template <class _Sigs, class _ItemRcvr>
+    struct __stored_operation {
+      struct __t {
+        using __id = __stored_operation;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        __result_variant_t<_Sigs>* __result_;
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          std::visit(
+            [&__self]<class _Tuple>(_Tuple& __tuple) noexcept {
+              std::apply(
+                [&__self]<class _Tag, class... _Args>(_Tag __tag, _Args&... __args) noexcept {
+                  __tag(static_cast<_ItemRcvr&&>(__self.__rcvr_), static_cast<_Args&&>(__args)...);
+                },
+                __tuple);
+            },
+            *__self.__result_);
+        }
+      };
+    };
+
+    template <class _Sigs>
+    struct __stored_sender {
+      struct __t {
+        using __id = __stored_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures = __stored_sigs_t<_Sigs>;
+
+        __result_variant_t<_Sigs>* __result_;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr) //
+          noexcept(__nothrow_decay_copyable<_ItemRcvr>)
+            -> stdexec::__t<__stored_operation<_Sigs, _ItemRcvr>> {
+          return {static_cast<_ItemRcvr&&>(__rcvr), __self.__result_};
+        }
+      };
+    };
+
+    template <class _Sender, class _Env>
+    using __stored_sender_t =
+      stdexec::__t<__stored_sender<completion_signatures_of_t<_Sender, __env_t<_Env>>>>;
+
+    template <class _Sender, class _Env>
+    using __stored_variant_t =
+      __result_variant_t<completion_signatures_of_t<_Sender, __env_t<_Env>>>;
+
+    // The item is run to completion before upstream may go on, since an item
+    // sender may refer to state of the upstream sequence that is only valid
+    // until the item completes. The transformation is then applied to a
+    // sender of the stored results.
+    template <class _Data, class _Item, class _Env>
+    using __transform_sender_t = __call_result_t<
+      typename _Data::__adaptor_t&,
+      __call_result_t<on_t, typename _Data::__scheduler_t&, __stored_sender_t<_Item, _Env>>>;
+
+    template <class _Block, class _Variant, class _OpBase>
+    struct __store_receiver {
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __store_receiver;
+
+        _Block* __block_;
+        _Variant* __result_;
+        void (*__stored_)(_Block*) noexcept;
+
+        template <__completion_tag _Tag, same_as<__t> _Self, class... _Args>
+        friend void tag_invoke(_Tag, _Self&& __self, _Args&&... __args) noexcept {
+          try {
+            __self.__result_->template emplace<__decayed_tuple<_Tag, _Args...>>(
+              _Tag{}, static_cast<_Args&&>(__args)...);
+          } catch (...) {
+            __self.__result_->template emplace<std::tuple<set_error_t, std::exception_ptr>>(
+              set_error_t{}, std::current_exception());
+          }
+          __self.__stored_(__self.__block_);
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend auto tag_invoke(_GetEnv, const _Self& __self) noexcept
+          -> decltype(__declval<const _OpBase&>().__child_env()) {
+          return __self.__block_->__op_->__child_env();
+        }
+      };
+    };
+
+    // The part of an admitted item that runs the item itself.
+    template <class _Block, class _Item, class _Receiver, class _OpBase>
+    struct __item_block : __block_base {
+      using __item_variant_t = __stored_variant_t<_Item, env_of_t<_Receiver>>;
+      using __item_receiver_t = stdexec::__t<__store_receiver<_Block, __item_variant_t, _OpBase>>;
+
+      __item_block(
+        _Block* __self,
+        _OpBase* __op,
+        __item_base* __upstream,
+        _Item&& __item,
+        void (*__deliver)(__block_base*) noexcept)
+        : __block_base{&__destroy_block<_Block>, __deliver}
+        , __op_(__op)
+        , __upstream_(__upstream)
+        , __item_op_(stdexec::connect(
+            static_cast<_Item&&>(__item),
+            __item_receiver_t{__self, &__item_result_, &_Block::__item_stored})) {
+      }
+
+      void __start() noexcept {
+        stdexec::start(__item_op_);
+      }
+
+      auto __transform() {
+        return __op_->__data_.__adaptor_(stdexec::on(
+          __op_->__data_.__sched_, __stored_sender_t<_Item, env_of_t<_Receiver>>{&__item_result_}));
+      }
+
+      _OpBase* __op_;
+      __item_base* __upstream_;
+      __item_variant_t __item_result_{};
+      connect_result_t<_Item, __item_receiver_t> __item_op_;
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unordered: the transformation is downstream's next-sender.
+    template <class _Item, class _Receiver, class _OpBase, class _Data>
+    struct __unordered_block
+      : __item_block<
+          __unordered_block<_Item, _Receiver, _OpBase, _Data>,
+          _Item,
+          _Receiver,
+          _OpBase> {
+      using __next_receiver_t = stdexec::__t<__next_receiver<_OpBase>>;
+      using __next_sender_t =
+        next_sender_of_t<_Receiver, __transform_sender_t<_Data, _Item, env_of_t<_Receiver>>>;
+
+      __unordered_block(_OpBase* __op, __item_base* __upstream, _Item&& __item)
+        : __unordered_block::__item_block{
+          this,
+          __op,
+          __upstream,
+          static_cast<_Item&&>(__item),
+          nullptr}
+        , __next_op_(stdexec::connect(
+            exec::set_next(__op->__rcvr_, this->__transform()),
+            __next_receiver_t{__op, this})) {
+      }
+
+      static void __item_stored(__unordered_block* __self) noexcept {
+        __item_base* __upstream = __self->__upstream_;
+        stdexec::start(__self->__next_op_);
+        __upstream->__complete_(__upstream);
+      }
+
+      connect_result_t<__next_sender_t, __next_receiver_t> __next_op_;
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Ordered: the transformation runs into a result buffer, and downstream's
+    // next-sender is given a sender of the stored result once it is the
+    // item's turn.
+    template <class _Item, class _Receiver, class _OpBase, class _Data>
+    struct __ordered_block
+      : __item_block<
+          __ordered_block<_Item, _Receiver, _OpBase, _Data>,
+          _Item,
+          _Receiver,
+          _OpBase> {
+      using __transform_t = __transform_sender_t<_Data, _Item, env_of_t<_Receiver>>;
+      using __result_variant_t = __stored_variant_t<__transform_t, env_of_t<_Receiver>>;
+      using __result_receiver_t =
+        stdexec::__t<__store_receiver<__ordered_block, __result_variant_t, _OpBase>>;
+      using __stored_t = __stored_sender_t<__transform_t, env_of_t<_Receiver>>;
+      using __next_receiver_t = stdexec::__t<__next_receiver<_OpBase>>;
+      using __next_sender_t = next_sender_of_t<_Receiver, __stored_t>;
+
+      __ordered_block(_OpBase* __op, __item_base* __upstream, _Item&& __item)
+        : __ordered_block::__item_block{
+          this,
+          __op,
+          __upstream,
+          static_cast<_Item&&>(__item),
+          &__deliver}
+        , __transform_op_(stdexec::connect(
+            this->__transform(),
+            __result_receiver_t{this, &__result_, &__result_stored})) {
+      }
+
+      static void __item_stored(__ordered_block* __self) noexcept {
+        __item_base* __upstream = __self->__upstream_;
+        stdexec::start(__self->__transform_op_);
+        __upstream->__complete_(__upstream);
+      }
+
+      static void __result_stored(__ordered_block* __self) noexcept {
+        __self->__op_->__ready(__self);
+      }
+
+      static void __deliver(__block_base* __base) noexcept {
+        auto* __self = static_cast<__ordered_block*>(__base);
+        _OpBase* __op = __self->__op_;
+        if (__op->__stop_source_.stop_requested()) {
+          __op->__done(__self);
+          return;
+        }
+        try {
+          stdexec::start(__self->__next_op_.emplace(__conv{[&] {
+            return stdexec::connect(
+              exec::set_next(__op->__rcvr_, __stored_t{&__self->__result_}),
+              __next_receiver_t{__op, __self});
+          }}));
+        } catch (...) {
+          __op->__set_error(std::current_exception());
+          __op->__done(__self);
+        }
+      }
+
+      __result_variant_t __result_{};
+      connect_result_t<__transform_t, __result_receiver_t> __transform_op_;
+      std::optional<connect_result_t<__next_sender_t, __next_receiver_t>> __next_op_{};
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // The item senders that are handed to the upstream sequence.
+    template <class _Item, class _ItemRcvr, class _Receiver, class _OpBase, bool _Ordered>
+    struct __item_operation {
+      struct __t : __item_base {
+        using __id = __item_operation;
+        using _Data = decltype(__declval<_OpBase&>().__data_);
+        using __block_t = __if_c<
+          _Ordered,
+          __ordered_block<_Item, _Receiver, _OpBase, _Data>,
+          __unordered_block<_Item, _Receiver, _OpBase, _Data>>;
+
+        __t(_Item __item, _ItemRcvr __rcvr, _OpBase* __op)
+          : __item_base{&__admit, &__complete}
+          , __item_(static_cast<_Item&&>(__item))
+          , __rcvr_(static_cast<_ItemRcvr&&>(__rcvr))
+          , __op_(__op) {
+        }
+
+        _Item __item_;
+        STDEXEC_ATTRIBUTE((no_unique_address)) _ItemRcvr __rcvr_;
+        _OpBase* __op_;
+
+        static void __admit(__item_base* __base) noexcept {
+          auto* __self = static_cast<__t*>(__base);
+          _OpBase* __op = __self->__op_;
+          if (__op->__stop_source_.stop_requested()) {
+            __op->__release();
+            stdexec::set_stopped(static_cast<_ItemRcvr&&>(__self->__rcvr_));
+            return;
+          }
+          __block_t* __block = nullptr;
+          try {
+            __block = __par_transform_each::__make_block<__block_t>(
+              __op, __base, static_cast<_Item&&>(__self->__item_));
+          } catch (...) {
+            __op->__set_error(std::current_exception());
+            __op->__release();
+            stdexec::set_stopped(static_cast<_ItemRcvr&&>(__self->__rcvr_));
+            return;
+          }
+          __op->__launch(__block);
+          __block->__start();
+        }
+
+        // Lets the upstream sequence go on while the item is in flight.
+        static void __complete(__item_base* __base) noexcept {
+          auto* __self = static_cast<__t*>(__base);
+          stdexec::set_value(static_cast<_ItemRcvr&&>(__self->__rcvr_));
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          if (__self.__op_->__stop_source_.stop_requested()) {
+            stdexec::set_stopped(static_cast<_ItemRcvr&&>(__self.__rcvr_));
+          } else {
+            __self.__op_->__acquire(&__self);
+          }
+        }
+      };
+    };
+
+    template <class _Item, class _Receiver, class _OpBase, bool _Ordered>
+    struct __item_sender {
+      struct __t {
+        using __id = __item_sender;
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures =
+          stdexec::completion_signatures<set_value_t(), set_stopped_t()>;
+
+        _Item __item_;
+        _OpBase* __op_;
+
+        template <class _ItemRcvr>
+        using __operation_t =
+          stdexec::__t<__item_operation<_Item, _ItemRcvr, _Receiver, _OpBase, _Ordered>>;
+
+        template <__decays_to<__t> _Self, receiver_of<completion_signatures> _ItemRcvr>
+        friend auto tag_invoke(connect_t, _Self&& __self, _ItemRcvr __rcvr) //
+          -> __operation_t<_ItemRcvr> {
+          return {
+            static_cast<_Self&&>(__self).__item_, static_cast<_ItemRcvr&&>(__rcvr), __self.__op_};
+        }
+      };
+    };
+
+    template <class _ReceiverId, class _OpBase, bool _Ordered>
+    struct __receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+
+      struct __t {
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __receiver;
+        _OpBase* __op_;
+
+        template <same_as<set_next_t> _SetNext, same_as<__t> _Self, sender _Item>
+        friend auto tag_invoke(_SetNext, _Self& __self, _Item&& __item) //
+          noexcept(__nothrow_decay_copyable<_Item>)
+            -> stdexec::__t<__item_sender<__decay_t<_Item>, _Receiver, _OpBase, _Ordered>> {
+          return {static_cast<_Item&&>(__item), __self.__op_};
+        }
+
+        template <same_as<set_value_t> _SetValue, same_as<__t> _Self>
+        friend void tag_invoke(_SetValue, _Self&& __self) noexcept {
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<set_stopped_t> _SetStopped, same_as<__t> _Self>
+        friend void tag_invoke(_SetStopped, _Self&& __self) noexcept {
+          __self.__op_->__upstream_stopped_ = true;
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<set_error_t> _SetError, same_as<__t> _Self, class _Error>
+        friend void tag_invoke(_SetError, _Self&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error(static_cast<_Error&&>(__err));
+          __self.__op_->__arrive();
+        }
+
+        template <same_as<get_env_t> _GetEnv, same_as<__t> _Self>
+        friend env_of_t<_Receiver> tag_invoke(_GetEnv, const _Self& __self) noexcept {
+          return stdexec::get_env(__self.__op_->__rcvr_);
+        }
+      };
+    };
+
+    template <class _Sequence, class _ReceiverId, class _Data, bool _Ordered>
+    struct __operation {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __base_t = __operation_base<
+        _Receiver,
+        _Data,
+        __errors_variant_t<_Sequence, env_of_t<_Receiver>>,
+        _Ordered>;
+      using __receiver_t = stdexec::__t<__receiver<_ReceiverId, __base_t, _Ordered>>;
+
+      struct __t : __base_t {
+        using __id = __operation;
+        subscribe_result_t<_Sequence, __receiver_t> __op_;
+
+        __t(_Sequence&& __sndr, _Receiver __rcvr, _Data __data)
+          : __base_t{static_cast<_Receiver&&>(__rcvr), static_cast<_Data&&>(__data)}
+          , __op_{exec::subscribe(static_cast<_Sequence&&>(__sndr), __receiver_t{this})} {
+        }
+
+        friend void tag_invoke(start_t, __t& __self) noexcept {
+          __self.__start_on_stop(stdexec::get_env(__self.__rcvr_));
+          stdexec::start(__self.__op_);
+        }
+      };
+    };
+
+    template <class _Receiver, bool _Ordered>
+    struct __subscribe_fn {
+      _Receiver& __rcvr_;
+
+      template <class _Data, class _Sequence>
+      auto operator()(__ignore, _Data __data, _Sequence&& __sequence)
+        -> __t<__operation<_Sequence, __id<_Receiver>, _Data, _Ordered>> {
+        return {
+          static_cast<_Sequence&&>(__sequence),
+          static_cast<_Receiver&&>(__rcvr_),
+          static_cast<_Data&&>(__data)};
+      }
+    };
+
+    template <bool _Ordered>
+    struct __par_transform_each_t {
+      template <sender _Sequence, scheduler _Scheduler, __sender_adaptor_closure _Adaptor>
+      auto operator()(
+        _Sequence&& __sndr,
+        _Scheduler&& __sched,
+        _Adaptor&& __adaptor,
+        std::size_t __max_in_flight) const {
+        return make_sequence_expr<__par_transform_each_t>(
+          __data<__decay_t<_Scheduler>, __decay_t<_Adaptor>>{
+            static_cast<_Scheduler&&>(__sched),
+            static_cast<_Adaptor&&>(__adaptor),
+            __max_in_flight},
+          static_cast<_Sequence&&>(__sndr));
+      }
+
+      template <scheduler _Scheduler, class _Adaptor>
+      constexpr auto
+        operator()(_Scheduler __sched, _Adaptor __adaptor, std::size_t __max_in_flight) const
+        noexcept -> __binder_back<__par_transform_each_t, _Scheduler, _Adaptor, std::size_t> {
+        return {
+          {},
+          {},
+          {static_cast<_Scheduler&&>(__sched), static_cast<_Adaptor&&>(__adaptor), __max_in_flight}
+        };
+      }
+
+      template <class _Self, class _Env>
+      using __completion_sigs_t = __concat_completion_signatures_t<
+        __sequence_completion_signatures_of_t<__child_of<_Self>, _Env>,
+        completion_signatures<set_error_t(std::exception_ptr), set_stopped_t()>>;
+
+      template <sender_expr_for<__par_transform_each_t> _Self, class _Env>
+      static __completion_sigs_t<_Self, _Env> get_completion_signatures(_Self&&, _Env&&) noexcept {
+        return {};
+      }
+
+      template <class _Data, class _Env>
+      struct __item_of {
+        template <class _Item>
+        using __f = __if_c<
+          _Ordered,
+          __stored_sender_t<__transform_sender_t<_Data, _Item, _Env>, _Env>,
+          __transform_sender_t<_Data, _Item, _Env>>;
+      };
+
+      template <class _Self, class _Env>
+      using __item_types_t = stdexec::__mapply<
+        stdexec::__transform<
+          __item_of<__decay_t<__data_of<_Self>>, _Env>,
+          stdexec::__munique<stdexec::__q<item_types>>>,
+        item_types_of_t<__child_of<_Self>, _Env>>;
+
+      template <sender_expr_for<__par_transform_each_t> _Self, class _Env>
+      static __item_types_t<_Self, _Env> get_item_types(_Self&&, _Env&&) noexcept {
+        return {};
+      }
+
+      template <class _Self, class _Receiver>
+      using __receiver_t = typename __operation<
+        __child_of<_Self>,
+        __id<_Receiver>,
+        __decay_t<__data_of<_Self>>,
+        _Ordered>::__receiver_t;
+
+      template <sender_expr_for<__par_transform_each_t> _Self, receiver _Receiver>
+        requires sequence_receiver_of<_Receiver, __item_types_t<_Self, env_of_t<_Receiver>>>
+              && sequence_sender_to<__child_of<_Self>, __receiver_t<_Self, _Receiver>>
+      static auto subscribe(_Self&& __self, _Receiver __rcvr)
+        -> __call_result_t<__sexpr_apply_t, _Self, __subscribe_fn<_Receiver, _Ordered>> {
+        return __sexpr_apply(
+          static_cast<_Self&&>(__self), __subscribe_fn<_Receiver, _Ordered>{__rcvr});
+      }
+
+      template <sender_expr_for<__par_transform_each_t> _Sexpr>
+      static env_of_t<__child_of<_Sexpr>> get_env(const _Sexpr& __sexpr) noexcept {
+        return __sexpr_apply(__sexpr, []<class _Child>(__ignore, __ignore, const _Child& __child) {
+          return stdexec::get_env(__child);
+        });
+      }
+    };
+  }
+
+  using par_transform_each_t = __par_transform_each::__par_transform_each_t<false>;
+  inline constexpr par_transform_each_t par_transform_each{};
+
+  using par_transform_each_ordered_t = __par_transform_each::__par_transform_each_t<true>;
+  inline constexpr par_transform_each_ordered_t par_transform_each_ordered{};
+}
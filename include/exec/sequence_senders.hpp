@@ -18,6 +18,9 @@
 
 #include "../stdexec/execution.hpp"
 
+#include <cstddef>
+#include <limits>
+
 namespace exec {
   struct sequence_sender_t : stdexec::sender_t { };
 
@@ -74,6 +77,36 @@ namespace exec {
     stdexec::__declval<stdexec::__decay_t<_Receiver>&>(),
     stdexec::__declval<_Sender>()));
 
+  namespace __sequence_sndr {
+    // This is an optional query through which a sequence-receiver advertises how many items it
+    // accepts at the same time. An item is in flight from the time that the next-sender returned
+    // for it is started until that next-sender completes, so every item holds one credit for that
+    // long. Sequences that pass on items concurrently hold back further items while all credits
+    // are taken, which keeps memory and latency bounded when the consumer is slower than the
+    // producers. Serial sequences never have more than one item in flight. Environments that do
+    // not customize the query accept any number of items.
+    struct get_max_in_flight_t : __query<get_max_in_flight_t> {
+      friend constexpr bool tag_invoke(forwarding_query_t, const get_max_in_flight_t&) noexcept {
+        return true;
+      }
+
+      template <class _Env>
+      std::size_t operator()(const _Env& __env) const noexcept {
+        if constexpr (tag_invocable<get_max_in_flight_t, const _Env&>) {
+          static_assert(nothrow_tag_invocable<get_max_in_flight_t, const _Env&>);
+          const std::size_t __max_in_flight = tag_invoke(*this, __env);
+          STDEXEC_ASSERT(__max_in_flight != 0);
+          return __max_in_flight;
+        } else {
+          return std::numeric_limits<std::size_t>::max();
+        }
+      }
+    };
+  } // namespace __sequence_sndr
+
+  using __sequence_sndr::get_max_in_flight_t;
+  inline constexpr get_max_in_flight_t get_max_in_flight{};
+
   namespace __sequence_sndr {
 
     template <class _ReceiverId>
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/stop_token.hpp"
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace exec {
+  class sharded_stop_token;
+  class sharded_stop_source;
+  template <class _Callback>
+  class sharded_stop_callback;
+
+  // A stop source with the semantics of stdexec::in_place_stop_source for
+  // sources that many threads register callbacks with at the same time, like
+  // the one that all children of a large when_all_range share. The callbacks
+  // are kept in a number of lists, each with its own lock on its own cache
+  // line, and the list of a callback is picked by its address. Registration
+  // and deregistration therefore only contend with the callbacks that share a
+  // list, whichever threads they run on, and request_stop() drains the lists
+  // one after the other. The price is a much larger source, so in_place_stop_source remains
+  // the better choice when only a few callbacks are registered at once.
+  namespace __sharded_stop {
+    struct __callback_base {
+      void __execute() noexcept {
+        this->__execute_(this);
+      }
+
+     protected:
+      using __execute_fn_t = void(__callback_base*) noexcept;
+
+      explicit __callback_base(
+        const sharded_stop_source* __source,
+        __execute_fn_t* __execute) noexcept
+        : __source_(__source)
+        , __execute_(__execute) {
+      }
+
+      void __register_callback_() noexcept;
+
+      friend sharded_stop_source;
+
+      const sharded_stop_source* __source_;
+      __execute_fn_t* __execute_;
+      __callback_base* __next_ = nullptr;
+      __callback_base** __prev_ptr_ = nullptr;
+      bool* __removed_during_callback_ = nullptr;
+      std::atomic<bool> __callback_completed_{false};
+      std::size_t __shard_ = 0;
+    };
+
+    struct alignas(64) __shard {
+      void __lock() noexcept {
+        stdexec::__stok::__spin_wait __spin;
+        while (__locked_.exchange(true, std::memory_order_acquire)) {
+          while (__locked_.load(std::memory_order_relaxed)) {
+            __spin.__wait();
+          }
+        }
+      }
+
+      void __unlock() noexcept {
+        __locked_.store(false, std::memory_order_release);
+      }
+
+      std::atomic<bool> __locked_{false};
+      __callback_base* __callbacks_ = nullptr;
+    };
+  }
+
+  class sharded_stop_source {
+   public:
+    sharded_stop_source() noexcept = default;
+    ~sharded_stop_source();
+    sharded_stop_source(sharded_stop_source&&) = delete;
+
+    sharded_stop_token get_token() const noexcept;
+
+    bool request_stop() noexcept;
+
+    bool stop_requested() const noexcept {
+      return __stop_requested_.load(std::memory_order_acquire);
+    }
+
+   private:
+    friend sharded_stop_token;
+    friend __sharded_stop::__callback_base;
+    template <class>
+    friend class sharded_stop_callback;
+
+    bool __try_add_callback_(__sharded_stop::__callback_base*) const noexcept;
+
+    // Spreads the callbacks of neighbouring operation states, such as those
+    // of the children of a when_all_range, over all shards.
+    static std::size_t __shard_of_(const void* __ptr) noexcept {
+      auto __bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(__ptr));
+      return static_cast<std::size_t>(
+        (__bits * 0x9E37'79B9'7F4A'7C15ull) >> (64 - std::countr_zero(__shard_count_)));
+    }
+
+    void __remove_callback_(__sharded_stop::__callback_base*) const noexcept;
+
+    static constexpr std::size_t __shard_count_ = 16;
+    static_assert(std::has_single_bit(__shard_count_));
+
+    std::atomic<bool> __stop_requested_{false};
+    std::thread::id __notifying_thread_;
+    mutable __sharded_stop::__shard __shards_[__shard_count_];
+  };
+
+  class sharded_stop_token {
+   public:
+    template <class _Fun>
+    using callback_type = sharded_stop_callback<_Fun>;
+
+    sharded_stop_token() noexcept
+      : __source_(nullptr) {
+    }
+
+    sharded_stop_token(const sharded_stop_token& __other) noexcept = default;
+
+    sharded_stop_token(sharded_stop_token&& __other) noexcept
+      : __source_(std::exchange(__other.__source_, {})) {
+    }
+
+    sharded_stop_token& operator=(const sharded_stop_token& __other) noexcept = default;
+
+    sharded_stop_token& operator=(sharded_stop_token&& __other) noexcept {
+      __source_ = std::exchange(__other.__source_, nullptr);
+      return *this;
+    }
+
+    bool stop_requested() const noexcept {
+      return __source_ != nullptr && __source_->stop_requested();
+    }
+
+    bool stop_possible() const noexcept {
+      return __source_ != nullptr;
+    }
+
+    void swap(sharded_stop_token& __other) noexcept {
+      std::swap(__source_, __other.__source_);
+    }
+
+    bool operator==(const sharded_stop_token&) const noexcept = default;
+
+   private:
+    friend sharded_stop_source;
+    template <class>
+    friend class sharded_stop_callback;
+
+    explicit sharded_stop_token(const sharded_stop_source* __source) noexcept
+      : __source_(__source) {
+    }
+
+    const sharded_stop_source* __source_;
+  };
+
+  inline sharded_stop_token sharded_stop_source::get_token() const noexcept {
+    return sharded_stop_token{this};
+  }
+
+  template <class _Fun>
+  class sharded_stop_callback : __sharded_stop::__callback_base {
+   public:
+    template <class _Fun2>
+      requires stdexec::constructible_from<_Fun, _Fun2>
+    explicit sharded_stop_callback(sharded_stop_token __token, _Fun2&& __fun) //
+      noexcept(stdexec::__nothrow_constructible_from<_Fun, _Fun2>)
+      : __sharded_stop::__callback_base(__token.__source_, &sharded_stop_callback::__execute_impl_)
+      , __fun_((_Fun2&&) __fun) {
+      __register_callback_();
+    }
+
+    ~sharded_stop_callback() {
+      if (__source_ != nullptr)
+        __source_->__remove_callback_(this);
+    }
+
+   private:
+    static void __execute_impl_(__sharded_stop::__callback_base* cb) noexcept {
+      std::move(static_cast<sharded_stop_callback*>(cb)->__fun_)();
+    }
+
+    STDEXEC_ATTRIBUTE((no_unique_address)) _Fun __fun_;
+  };
+
+  namespace __sharded_stop {
+    inline void __callback_base::__register_callback_() noexcept {
+      if (__source_ != nullptr) {
+        if (!__source_->__try_add_callback_(this)) {
+          __source_ = nullptr;
+          // Callback not registered because stop_requested() was true.
+          // Execute inline here.
+          __execute();
+        }
+      }
+    }
+  }
+
+  inline sharded_stop_source::~sharded_stop_source() {
+    for (const __sharded_stop::__shard& __shard: __shards_) {
+      STDEXEC_ASSERT(!__shard.__locked_.load(std::memory_order_relaxed));
+      STDEXEC_ASSERT(__shard.__callbacks_ == nullptr);
+    }
+  }
+
+  inline bool sharded_stop_source::request_stop() noexcept {
+    if (__stop_requested_.exchange(true, std::memory_order_acq_rel))
+      return true;
+
+    // A callback that is added to a shard after we have drained it sees the
+    // flag under the lock of the shard, and is executed inline instead. The
+    // notifying thread is published to __remove_callback_ by the shard locks.
+    __notifying_thread_ = std::this_thread::get_id();
+
+    for (__sharded_stop::__shard& __shard: __shards_) {
+      __shard.__lock();
+      while (__shard.__callbacks_ != nullptr) {
+        auto* __callbk = __shard.__callbacks_;
+        __callbk->__prev_ptr_ = nullptr;
+        __shard.__callbacks_ = __callbk->__next_;
+        if (__shard.__callbacks_ != nullptr)
+          __shard.__callbacks_->__prev_ptr_ = &__shard.__callbacks_;
+
+        __shard.__unlock();
+
+        bool __removed_during_callback = false;
+        __callbk->__removed_during_callback_ = &__removed_during_callback;
+
+        __callbk->__execute();
+
+        if (!__removed_during_callback) {
+          __callbk->__removed_during_callback_ = nullptr;
+          __callbk->__callback_completed_.store(true, std::memory_order_release);
+        }
+
+        __shard.__lock();
+      }
+      __shard.__unlock();
+    }
+
+    return false;
+  }
+
+  inline bool sharded_stop_source::__try_add_callback_(
+    __sharded_stop::__callback_base* __callbk) const noexcept {
+    if (stop_requested()) {
+      return false;
+    }
+
+    __callbk->__shard_ = __shard_of_(__callbk);
+    __sharded_stop::__shard& __shard = __shards_[__callbk->__shard_];
+    __shard.__lock();
+    if (stop_requested()) {
+      __shard.__unlock();
+      return false;
+    }
+
+    __callbk->__next_ = __shard.__callbacks_;
+    __callbk->__prev_ptr_ = &__shard.__callbacks_;
+    if (__shard.__callbacks_ != nullptr) {
+      __shard.__callbacks_->__prev_ptr_ = &__callbk->__next_;
+    }
+    __shard.__callbacks_ = __callbk;
+
+    __shard.__unlock();
+
+    return true;
+  }
+
+  inline void sharded_stop_source::__remove_callback_(
+    __sharded_stop::__callback_base* __callbk) const noexcept {
+    __sharded_stop::__shard& __shard = __shards_[__callbk->__shard_];
+    __shard.__lock();
+
+    if (__callbk->__prev_ptr_ != nullptr) {
+      // Callback has not been executed yet.
+      // Remove from the list.
+      *__callbk->__prev_ptr_ = __callbk->__next_;
+      if (__callbk->__next_ != nullptr) {
+        __callbk->__next_->__prev_ptr_ = __callbk->__prev_ptr_;
+      }
+      __shard.__unlock();
+    } else {
+      auto __notifying_thread = __notifying_thread_;
+      __shard.__unlock();
+
+      // Callback has either already been executed or is
+      // currently executing on another thread.
+      if (std::this_thread::get_id() == __notifying_thread) {
+        if (__callbk->__removed_during_callback_ != nullptr) {
+          *__callbk->__removed_during_callback_ = true;
+        }
+      } else {
+        // Concurrently executing on another thread.
+        // Wait until the other thread finishes executing the callback.
+        stdexec::__stok::__spin_wait __spin;
+        while (!__callbk->__callback_completed_.load(std::memory_order_acquire)) {
+          __spin.__wait();
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/execution.hpp"
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // share
+  //
+  // Like split, share returns a copyable sender that runs the input sender at
+  // most once. Unlike split, which sends its result by T const&, share sends
+  // it by T&&: each consumer receives a copy of its own, except the consumer
+  // that holds the last reference to the shared result, which receives it by
+  // move. A consumer is the last one when every other share sender that refers
+  // to the same input has been connected or destroyed and the other operation
+  // states have completed, so passing the final copy of the sender as an
+  // rvalue is enough to avoid copying the result into it.
+  namespace __share {
+    using namespace stdexec;
+
+    struct share_t {
+      template <sender _Sender, class _Env = empty_env>
+        requires sender_in<_Sender, _Env> && __decay_copyable<env_of_t<_Sender>>
+      auto operator()(_Sender&& __sndr, _Env&& __env = {}) const {
+        auto __domain = __get_late_domain(__sndr, __env);
+        return stdexec::transform_sender(
+          __domain, __make_sexpr<share_t>((_Env&&) __env, (_Sender&&) __sndr));
+      }
+
+      STDEXEC_ATTRIBUTE((always_inline)) //
+      __binder_back<share_t> operator()() const {
+        return {{}, {}, {}};
+      }
+
+      template <class _CvrefSender, class _Env>
+      using __receiver_t =
+        __t<__meval<__shared::__receiver, __cvref_id<_CvrefSender>, __id<_Env>>>;
+
+      template <class _Sender>
+      static auto transform_sender(_Sender&& __sndr) {
+        using _Receiver = __receiver_t<__child_of<_Sender>, __decay_t<__data_of<_Sender>>>;
+        static_assert(sender_to<__child_of<_Sender>, _Receiver>);
+        return __sexpr_apply(
+          (_Sender&&) __sndr,
+          [&]<class _Env, class _Child>(__ignore, _Env&& __env, _Child&& __child) {
+            auto __state = __shared::__make_shared_state((_Child&&) __child, (_Env&&) __env);
+            return __make_sexpr<__split::__share_t>(__split::__data{std::move(__state)});
+          });
+      }
+    };
+  } // namespace __share
+
+  using __share::share_t;
+  inline constexpr share_t share{};
+} // namespace exec
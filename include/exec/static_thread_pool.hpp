@@ -23,10 +23,13 @@
 #include "../stdexec/__detail/__meta.hpp"
 #include "./__detail/__atomic_intrusive_queue.hpp"
 #include "./__detail/__bwos_lifo_queue.hpp"
+#include "./__detail/__current_scheduler.hpp"
 #include "./__detail/__manual_lifetime.hpp"
 #include "./__detail/__xorshift.hpp"
 #include "./__detail/__numa.hpp"
+#include "./__detail/__start_batch.hpp"
 
+#include "./numa_memory_resource.hpp"
 #include "./sequence_senders.hpp"
 #include "./sequence/iterate.hpp"
 
@@ -34,6 +37,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <exception>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <thread>
@@ -93,6 +97,8 @@ namespace exec {
       void (*__execute)(task_base*, std::uint32_t tid) noexcept;
     };
 
+    class static_thread_pool_;
+
     struct remote_queue {
       explicit remote_queue(std::size_t nthreads) noexcept
         : queues_(nthreads) {
@@ -108,6 +114,17 @@ namespace exec {
       std::thread::id id_{std::this_thread::get_id()};
       // This marks whether the submitter is a thread in the pool or not.
       std::size_t index_{std::numeric_limits<std::size_t>::max()};
+
+      // Tasks that were started on this thread while a start batch was
+      // active. They are enqueued all at once when the batch ends.
+      struct deferred_tasks : __start_batch::__deferred {
+        static_thread_pool_* pool_{};
+        remote_queue* queue_{};
+        __intrusive_queue<&task_base::next> tasks_{};
+        std::size_t size_{0};
+      };
+
+      deferred_tasks deferred_{};
     };
 
     struct remote_queue_list {
@@ -236,10 +253,11 @@ namespace exec {
         auto operator()(bulk_t, Data&& data, Sender&& sndr) {
           auto [shape, fun] = (Data&&) data;
           return bulk_sender_t<Sender, decltype(shape), decltype(fun)>{
-            pool_, (Sender&&) sndr, shape, std::move(fun)};
+            pool_, (Sender&&) sndr, shape, std::move(fun), numa_partitioned_};
         }
 
         static_thread_pool_& pool_;
+        bool numa_partitioned_;
       };
 
 #if STDEXEC_HAS_STD_RANGES()
@@ -260,7 +278,8 @@ namespace exec {
         auto transform_sender(Sender&& sndr) const noexcept {
           if constexpr (__completes_on<Sender, static_thread_pool_::scheduler>) {
             auto sched = get_completion_scheduler<set_value_t>(get_env(sndr));
-            return __sexpr_apply((Sender&&) sndr, transform_bulk{*sched.pool_});
+            return __sexpr_apply(
+              (Sender&&) sndr, transform_bulk{*sched.pool_, sched.is_numa_partitioned_()});
           } else {
             static_assert(
               __completes_on<Sender, static_thread_pool_::scheduler>,
@@ -276,10 +295,12 @@ namespace exec {
         auto transform_sender(Sender&& sndr, const Env& env) const noexcept {
           if constexpr (__completes_on<Sender, static_thread_pool_::scheduler>) {
             auto sched = get_completion_scheduler<set_value_t>(get_env(sndr));
-            return __sexpr_apply((Sender&&) sndr, transform_bulk{*sched.pool_});
+            return __sexpr_apply(
+              (Sender&&) sndr, transform_bulk{*sched.pool_, sched.is_numa_partitioned_()});
           } else if constexpr (__starts_on<Sender, static_thread_pool_::scheduler, Env>) {
             auto sched = stdexec::get_scheduler(env);
-            return __sexpr_apply((Sender&&) sndr, transform_bulk{*sched.pool_});
+            return __sexpr_apply(
+              (Sender&&) sndr, transform_bulk{*sched.pool_, sched.is_numa_partitioned_()});
           } else {
             static_assert( //
               __starts_on<Sender, static_thread_pool_::scheduler, Env>
@@ -349,6 +370,7 @@ namespace exec {
           struct env {
             static_thread_pool_& pool_;
             remote_queue* queue_;
+            bool numa_partitioned_;
 
             template <class CPO>
             friend static_thread_pool_::scheduler
@@ -357,12 +379,29 @@ namespace exec {
             }
 
             static_thread_pool_::scheduler make_scheduler_() const {
-              return static_thread_pool_::scheduler{pool_, *queue_};
+              static_thread_pool_::scheduler sched{pool_, *queue_};
+              if (numa_partitioned_) {
+                sched.thread_idx_ = numa_partitioned_index_;
+              }
+              return sched;
             }
+
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+            // Allocations made on a thread of the pool use the memory of its
+            // node, see static_thread_pool_::get_allocator().
+            friend std::pmr::polymorphic_allocator<std::byte>
+              tag_invoke(get_allocator_t, const env& self) noexcept {
+              return self.pool_.get_allocator();
+            }
+#endif
           };
 
+          env make_env_() const noexcept {
+            return env{pool_, queue_, threadIndex_ == scheduler::numa_partitioned_index_};
+          }
+
           friend env tag_invoke(get_env_t, const sender& self) noexcept {
-            return env{self.pool_, self.queue_};
+            return self.make_env_();
           }
 
           friend struct static_thread_pool_::scheduler;
@@ -388,6 +427,10 @@ namespace exec {
           return sender{*pool_, queue_, thread_idx_, nodemask_};
         }
 
+        bool is_numa_partitioned_() const noexcept {
+          return thread_idx_ == numa_partitioned_index_;
+        }
+
         friend sender tag_invoke(schedule_t, const scheduler& sch) noexcept {
           return sch.make_sender_();
         }
@@ -401,6 +444,14 @@ namespace exec {
           return {};
         }
 
+        // Work may continue inline on any thread of the pool, unless the
+        // scheduler is constrained to particular threads.
+        friend bool
+          tag_invoke(__current_sched::__is_current_t, const scheduler& self) noexcept {
+          return __current_sched::__context == self.pool_ && self.nodemask_ == nodemask::any()
+              && self.thread_idx_ >= numa_partitioned_index_;
+        }
+
         friend class static_thread_pool_;
 
         explicit scheduler(
@@ -429,6 +480,14 @@ namespace exec {
           , thread_idx_{threadIndex} {
         }
 
+        // A thread_idx_ for work that may run on any thread and whose bulk
+        // work splits its indices by NUMA node, see
+        // get_numa_partitioned_scheduler(). Like the default of max(), it is
+        // not the index of a thread, so the scheduler stays as small as the
+        // inline storage of any_scheduler.
+        static constexpr std::size_t numa_partitioned_index_ =
+          std::numeric_limits<std::size_t>::max() - 1;
+
         static_thread_pool_* pool_;
         remote_queue* queue_;
         nodemask nodemask_;
@@ -439,6 +498,61 @@ namespace exec {
         return scheduler{*this};
       }
 
+      // A scheduler for work that may run on any thread, like the one of
+      // get_scheduler(), except that bulk work on it is split by NUMA node.
+      // The indices [0, shape) are cut into one slice per node, of a size
+      // proportional to the number of threads of the pool on that node, and
+      // the work of a slice is submitted to the threads of its node only. See
+      // numa_partition() for the slices, and numa_partitioned_buffer for data
+      // that is allocated to match them.
+      scheduler get_numa_partitioned_scheduler() noexcept {
+        scheduler sched{*this};
+        sched.thread_idx_ = scheduler::numa_partitioned_index_;
+        return sched;
+      }
+
+      // The slice [begin, end) of [0, n) that a bulk of shape n on the
+      // scheduler of get_numa_partitioned_scheduler() runs on the threads of
+      // the given node. It is empty if the pool has no threads on the node.
+      template <std::integral Shape>
+      std::pair<Shape, Shape> numa_partition(Shape n, int node) const noexcept {
+        thread_index_by_numa_node key{node, 0};
+        auto first = std::lower_bound(
+          threadIndexByNumaNode_.begin(), threadIndexByNumaNode_.end(), key);
+        auto last = std::upper_bound(first, threadIndexByNumaNode_.end(), key);
+        auto rank = static_cast<std::uint32_t>(first - threadIndexByNumaNode_.begin());
+        auto begin = even_share(n, rank, threadCount_).first;
+        if (first == last) {
+          return {begin, begin};
+        }
+        auto lastRank = static_cast<std::uint32_t>(last - threadIndexByNumaNode_.begin() - 1);
+        return {begin, even_share(n, lastRank, threadCount_).second};
+      }
+
+      // One more than the largest NUMA node that a thread of the pool runs on.
+      std::size_t num_numa_nodes() const noexcept {
+        return static_cast<std::size_t>(threadIndexByNumaNode_.back().numa_node + 1);
+      }
+
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+      // The pooled memory of a node, for node < num_numa_nodes().
+      numa_memory_resource* get_numa_memory_resource(int node) noexcept {
+        STDEXEC_ASSERT(0 <= node && static_cast<std::size_t>(node) < memoryResources_.size());
+        return memoryResources_[static_cast<std::size_t>(node)].get();
+      }
+
+      // An allocator that takes memory from get_numa_memory_resource() of
+      // the node of the calling thread, if that is a thread of the pool, and
+      // of the node of the first thread otherwise. The env of the senders of
+      // the schedulers of the pool returns it from get_allocator. Algorithms
+      // only use it for a receiver whose env returns it from get_allocator,
+      // e.g. after exec::write(exec::with(get_allocator, pool.get_allocator())).
+      // All memory must be deallocated before the pool is destroyed.
+      std::pmr::polymorphic_allocator<std::byte> get_allocator() noexcept {
+        return std::pmr::polymorphic_allocator<std::byte>{&nodeMemoryResource_};
+      }
+#endif
+
       scheduler get_scheduler_on_thread(std::size_t threadIndex) noexcept {
         return scheduler{*this, *get_remote_queue(), threadIndex};
       }
@@ -479,6 +593,8 @@ namespace exec {
 
       template <std::derived_from<task_base> TaskT>
       void bulk_enqueue(TaskT* task, std::uint32_t n_threads) noexcept;
+      template <std::derived_from<task_base> TaskT>
+      void numa_bulk_enqueue(TaskT* task) noexcept;
       void bulk_enqueue(
         remote_queue& queue,
         __intrusive_queue<&task_base::next> tasks,
@@ -486,6 +602,8 @@ namespace exec {
         const nodemask& constraints = nodemask::any()) noexcept;
 
      private:
+      void defer(remote_queue& queue, task_base* task) noexcept;
+
       class workstealing_victim {
        public:
         explicit workstealing_victim(
@@ -635,6 +753,39 @@ namespace exec {
 
       std::vector<thread_index_by_numa_node> threadIndexByNumaNode_;
 
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+      class node_memory_resource : public std::pmr::memory_resource {
+       public:
+        explicit node_memory_resource(static_thread_pool_& pool) noexcept
+          : pool_(pool) {
+        }
+
+       private:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+          int node = __current_sched::__context == &pool_
+                     ? currentNumaNode_
+                     : pool_.threadIndexByNumaNode_.front().numa_node;
+          return pool_.get_numa_memory_resource(node)->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+          numa_memory_resource::deallocate_any(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+          return this == &other;
+        }
+
+        static_thread_pool_& pool_;
+      };
+
+      // The node of the thread of the pool that runs on this thread.
+      static inline thread_local int currentNumaNode_ = 0;
+
+      std::vector<std::unique_ptr<numa_memory_resource>> memoryResources_;
+      node_memory_resource nodeMemoryResource_{*this};
+#endif
+
       std::size_t num_threads(int numa) const noexcept;
       std::size_t num_threads(nodemask constraints) const noexcept;
       std::size_t get_thread_index(int numa, std::size_t index) const noexcept;
@@ -662,6 +813,11 @@ namespace exec {
           thread_index_by_numa_node{threadStates_[index]->numa_node(), index});
       }
       std::sort(threadIndexByNumaNode_.begin(), threadIndexByNumaNode_.end());
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+      for (std::size_t node = 0; node < num_numa_nodes(); ++node) {
+        memoryResources_.push_back(std::make_unique<numa_memory_resource>(static_cast<int>(node)));
+      }
+#endif
       std::vector<workstealing_victim> victims{};
       for (auto& state: threadStates_) {
         victims.emplace_back(state->as_victim());
@@ -696,6 +852,10 @@ namespace exec {
     inline void static_thread_pool_::run(std::uint32_t threadIndex, numa_policy* numa) noexcept {
       numa->bind_to_node(threadStates_[threadIndex]->numa_node());
       STDEXEC_ASSERT(threadIndex < threadCount_);
+      __current_sched::__context_scope scope{this};
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+      currentNumaNode_ = threadStates_[threadIndex]->numa_node();
+#endif
       while (true) {
         // Make a blocking call to de-queue a task if we don't already have one.
         auto [task, queueIndex] = threadStates_[threadIndex]->pop();
@@ -809,6 +969,36 @@ namespace exec {
       }
     }
 
+    // Submits the i-th task to the i-th thread in the order of their NUMA
+    // nodes, so that each node gets as many tasks as it has threads.
+    template <std::derived_from<task_base> TaskT>
+    void static_thread_pool_::numa_bulk_enqueue(TaskT* task) noexcept {
+      auto& queue = *get_remote_queue();
+      for (std::size_t i = 0; i < threadCount_; ++i) {
+        std::size_t index = threadIndexByNumaNode_[i].thread_index;
+        queue.queues_[index].push_front(task + i);
+        threadStates_[index]->notify();
+      }
+    }
+
+    inline void static_thread_pool_::defer(remote_queue& queue, task_base* task) noexcept {
+      static thread_local std::thread::id this_id = std::this_thread::get_id();
+      remote_queue* correct_queue = this_id == queue.id_ ? &queue : get_remote_queue();
+      auto& deferred = correct_queue->deferred_;
+      if (deferred.size_ == 0) {
+        deferred.pool_ = this;
+        deferred.queue_ = correct_queue;
+        deferred.__submit_ = [](__start_batch::__deferred* self) noexcept {
+          auto& deferred = static_cast<remote_queue::deferred_tasks&>(*self);
+          deferred.pool_->bulk_enqueue(
+            *deferred.queue_, std::move(deferred.tasks_), std::exchange(deferred.size_, 0));
+        };
+        __start_batch::__defer(&deferred);
+      }
+      deferred.tasks_.push_back(task);
+      ++deferred.size_;
+    }
+
     inline void static_thread_pool_::bulk_enqueue(
       remote_queue& queue,
       __intrusive_queue<&task_base::next> tasks,
@@ -1028,8 +1218,20 @@ namespace exec {
         }
       }
 
+      void start_() noexcept {
+        // Operations that may run on any thread are submitted together with
+        // the others that are started in the same batch.
+        if (
+          __start_batch::__active(stdexec::get_env(rcvr_))
+          && threadIndex_ >= pool_.available_parallelism() && constraints_ == nodemask::any()) {
+          pool_.defer(*queue_, this);
+        } else {
+          enqueue_(this);
+        }
+      }
+
       friend void tag_invoke(start_t, __t& op) noexcept {
-        op.enqueue_(&op);
+        op.start_();
       }
     };
 
@@ -1044,6 +1246,7 @@ namespace exec {
       Sender sndr_;
       Shape shape_;
       Fun fun_;
+      bool numa_partitioned_;
 
       template <class Sender, class Env>
       using with_error_invoke_t = //
@@ -1081,9 +1284,15 @@ namespace exec {
                  Shape,
                  Fun,
                  Sender,
-                 Receiver>) {
+                 Receiver,
+                 bool>) {
         return bulk_op_state_t<Self, Receiver>{
-          self.pool_, self.shape_, self.fun_, ((Self&&) self).sndr_, (Receiver&&) rcvr};
+          self.pool_,
+          self.shape_,
+          self.fun_,
+          ((Self&&) self).sndr_,
+          (Receiver&&) rcvr,
+          self.numa_partitioned_};
       }
 
       template <__decays_to<__t> Self, class Env>
@@ -1101,12 +1310,18 @@ namespace exec {
     struct static_thread_pool_::bulk_shared_state {
       struct bulk_task : task_base {
         bulk_shared_state* sh_state_;
+        // The position of the task in the NUMA-partitioned order
+        std::uint32_t rank_{0};
 
         bulk_task(bulk_shared_state* sh_state)
           : sh_state_(sh_state) {
-          this->__execute = [](task_base* t, const std::uint32_t tid) noexcept {
-            auto& sh_state = *static_cast<bulk_task*>(t)->sh_state_;
+          this->__execute = [](task_base* t, const std::uint32_t queue_index) noexcept {
+            auto& self = *static_cast<bulk_task*>(t);
+            auto& sh_state = *self.sh_state_;
             auto total_threads = sh_state.num_agents_required();
+            // A stolen task runs with the index of the queue that it was
+            // submitted to, but a NUMA-partitioned task knows its rank.
+            const std::uint32_t tid = sh_state.numa_partitioned_ ? self.rank_ : queue_index;
 
             auto computation = [&](auto&... args) {
               auto [begin, end] = even_share(sh_state.shape_, tid, total_threads);
@@ -1163,6 +1378,7 @@ namespace exec {
       Receiver rcvr_;
       Shape shape_;
       Fun fun_;
+      bool numa_partitioned_;
 
       std::atomic<std::uint32_t> finished_threads_{0};
       std::atomic<std::uint32_t> thread_with_exception_{0};
@@ -1170,6 +1386,11 @@ namespace exec {
       std::vector<bulk_task> tasks_;
 
       std::uint32_t num_agents_required() const {
+        // A NUMA-partitioned bulk has an agent for every thread, so that the
+        // slices of the nodes match numa_partition().
+        if (numa_partitioned_) {
+          return pool_.available_parallelism();
+        }
         return static_cast<std::uint32_t>(
           std::min(shape_, static_cast<Shape>(pool_.available_parallelism())));
       }
@@ -1181,13 +1402,22 @@ namespace exec {
           data_);
       }
 
-      bulk_shared_state(static_thread_pool_& pool, Receiver rcvr, Shape shape, Fun fun)
+      bulk_shared_state(
+        static_thread_pool_& pool,
+        Receiver rcvr,
+        Shape shape,
+        Fun fun,
+        bool numa_partitioned)
         : pool_{pool}
         , rcvr_{(Receiver&&) rcvr}
         , shape_{shape}
         , fun_{fun}
+        , numa_partitioned_{numa_partitioned}
         , thread_with_exception_{num_agents_required()}
         , tasks_{num_agents_required(), {this}} {
+        for (std::uint32_t i = 0; i < tasks_.size(); ++i) {
+          tasks_[i].rank_ = i;
+        }
       }
     };
 
@@ -1201,8 +1431,12 @@ namespace exec {
       shared_state& shared_state_;
 
       void enqueue() noexcept {
-        shared_state_.pool_.bulk_enqueue(
-          shared_state_.tasks_.data(), shared_state_.num_agents_required());
+        if (shared_state_.numa_partitioned_) {
+          shared_state_.pool_.numa_bulk_enqueue(shared_state_.tasks_.data());
+        } else {
+          shared_state_.pool_.bulk_enqueue(
+            shared_state_.tasks_.data(), shared_state_.num_agents_required());
+        }
       }
 
       template <class... As>
@@ -1264,8 +1498,14 @@ namespace exec {
         start(op.inner_op_);
       }
 
-      __t(static_thread_pool_& pool, Shape shape, Fun fun, CvrefSender&& sndr, Receiver rcvr)
-        : shared_state_(pool, (Receiver&&) rcvr, shape, fun)
+      __t(
+        static_thread_pool_& pool,
+        Shape shape,
+        Fun fun,
+        CvrefSender&& sndr,
+        Receiver rcvr,
+        bool numa_partitioned)
+        : shared_state_(pool, (Receiver&&) rcvr, shape, fun, numa_partitioned)
         , inner_op_{connect((CvrefSender&&) sndr, bulk_rcvr{shared_state_})} {
       }
     };
@@ -1357,7 +1597,7 @@ namespace exec {
 
           template <same_as<get_env_t> GetEnv, __decays_to<__t> Self>
           friend auto tag_invoke(GetEnv, Self&& self) noexcept -> env {
-            return {self.op_->pool_};
+            return {&self.op_->pool_};
           }
 
           template <__decays_to<__t> Self, receiver ItemReceiver>
@@ -1372,11 +1612,25 @@ namespace exec {
       template <class Range, class Receiver>
       struct operation_base_with_receiver : operation_base<Range> {
         Receiver rcvr_;
+        // Set if the receiver accepts fewer items at a time than the range has. Every item
+        // that completes then starts the item with the index next_item_.
+        void (*start_next_)(operation_base_with_receiver*) noexcept = nullptr;
+        std::atomic<std::size_t> next_item_{0};
 
         operation_base_with_receiver(Range range, static_thread_pool_& pool, Receiver rcvr)
           : operation_base<Range>{range, pool}
           , rcvr_(static_cast<Receiver&&>(rcvr)) {
         }
+
+        void item_done() noexcept {
+          if (start_next_ != nullptr) {
+            start_next_(this);
+          }
+          std::size_t countdown = this->countdown_.fetch_sub(1, std::memory_order_acq_rel);
+          if (countdown == 1) {
+            set_value((Receiver&&) rcvr_);
+          }
+        }
       };
 
       template <class Range, class ReceiverId>
@@ -1390,18 +1644,12 @@ namespace exec {
 
           template <same_as<set_value_t> SetValue, same_as<__t> Self>
           friend void tag_invoke(SetValue, Self&& self) noexcept {
-            std::size_t countdown = self.op_->countdown_.fetch_sub(1, std::memory_order_relaxed);
-            if (countdown == 1) {
-              set_value((Receiver&&) self.op_->rcvr_);
-            }
+            self.op_->item_done();
           }
 
           template <same_as<set_stopped_t> SetStopped, same_as<__t> Self>
           friend void tag_invoke(SetStopped, Self&& self) noexcept {
-            std::size_t countdown = self.op_->countdown_.fetch_sub(1, std::memory_order_relaxed);
-            if (countdown == 1) {
-              set_value((Receiver&&) self.op_->rcvr_);
-            }
+            self.op_->item_done();
           }
 
           template <same_as<get_env_t> GetEnv, __decays_to<__t> Self>
@@ -1427,37 +1675,68 @@ namespace exec {
 
           std::vector<__manual_lifetime<ItemOperation>, ItemAllocator> items_;
 
+          void start_item_(std::size_t i) noexcept {
+            std::ranges::iterator_t<Range> it = std::ranges::begin(this->range_);
+            items_[i].__construct_with([&] {
+              return connect(set_next(this->rcvr_, ItemSender{this, it + i}), NextReceiver{this});
+            });
+            start(items_[i].__get());
+          }
+
+          static void
+            start_next_item_(operation_base_with_receiver<Range, Receiver>* base) noexcept {
+            __t& op = *static_cast<__t*>(base);
+            std::size_t i = op.next_item_.fetch_add(1, std::memory_order_relaxed);
+            if (i < op.items_.size()) {
+              op.start_item_(i);
+            }
+          }
+
+          // Starts as many items as the receiver accepts at a time. Every item that completes
+          // hands its credit on to the next item that has not been started yet.
+          void start_with_credits_(std::size_t max_in_flight) noexcept {
+            this->start_next_ = &start_next_item_;
+            this->next_item_.store(max_in_flight, std::memory_order_relaxed);
+            {
+              std::unique_lock lock{this->start_mutex_};
+              this->has_started_ = true;
+            }
+            for (std::size_t i = 0; i < max_in_flight; ++i) {
+              start_item_(i);
+            }
+          }
+
           template <same_as<__t> Self>
           friend void tag_invoke(start_t, Self& op) noexcept {
             std::size_t size = op.items_.size();
+            std::size_t max_in_flight = exec::get_max_in_flight(get_env(op.rcvr_));
+            if (max_in_flight < size) {
+              op.start_with_credits_(max_in_flight);
+              return;
+            }
             std::size_t nthreads = op.pool_.available_parallelism();
             bwos_params params = op.pool_.params();
             std::size_t localSize = params.blockSize * params.numBlocks;
             std::size_t chunkSize = std::min<std::size_t>(size / nthreads, localSize * nthreads);
             auto& remote_queue = *op.pool_.get_remote_queue();
-            std::ranges::iterator_t<Range> it = std::ranges::begin(op.range_);
             std::size_t i0 = 0;
             while (i0 + chunkSize < size) {
               for (std::size_t i = i0; i < i0 + chunkSize; ++i) {
-                op.items_[i].__construct_with([&] {
-                  return connect(set_next(op.rcvr_, ItemSender{&op, it + i}), NextReceiver{&op});
-                });
-                start(op.items_[i].__get());
+                op.start_item_(i);
               }
               std::unique_lock lock{op.start_mutex_};
-              op.pool_.bulk_enqueue(remote_queue, std::move(op.tasks_), op.tasks_size_);
+              op.pool_.bulk_enqueue(
+                remote_queue, std::move(op.tasks_), std::exchange(op.tasks_size_, 0));
               lock.unlock();
               i0 += chunkSize;
             }
             for (std::size_t i = i0; i < size; ++i) {
-              op.items_[i].__construct_with([&] {
-                return connect(set_next(op.rcvr_, ItemSender{&op, it + i}), NextReceiver{&op});
-              });
-              start(op.items_[i].__get());
+              op.start_item_(i);
             }
             std::unique_lock lock{op.start_mutex_};
             op.has_started_ = true;
-            op.pool_.bulk_enqueue(remote_queue, std::move(op.tasks_), op.tasks_size_);
+            op.pool_.bulk_enqueue(
+              remote_queue, std::move(op.tasks_), std::exchange(op.tasks_size_, 0));
           }
 
          public:
@@ -1542,6 +1821,24 @@ namespace exec {
     // scheduler get_constrained_scheduler(const nodemask& constraints) noexcept;
     using _pool_::static_thread_pool_::get_constrained_scheduler;
 
+    // scheduler get_numa_partitioned_scheduler() noexcept;
+    using _pool_::static_thread_pool_::get_numa_partitioned_scheduler;
+
+    // template <std::integral Shape>
+    // std::pair<Shape, Shape> numa_partition(Shape n, int node) const noexcept;
+    using _pool_::static_thread_pool_::numa_partition;
+
+    // std::size_t num_numa_nodes() const noexcept;
+    using _pool_::static_thread_pool_::num_numa_nodes;
+
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+    // numa_memory_resource* get_numa_memory_resource(int node) noexcept;
+    using _pool_::static_thread_pool_::get_numa_memory_resource;
+
+    // std::pmr::polymorphic_allocator<std::byte> get_allocator() noexcept;
+    using _pool_::static_thread_pool_::get_allocator;
+#endif
+
     // void request_stop() noexcept;
     using _pool_::static_thread_pool_::request_stop;
 
@@ -1554,12 +1851,26 @@ namespace exec {
 
 #if STDEXEC_HAS_STD_RANGES()
   namespace _pool_ {
+    // schedule_all(pool, range) is a sequence that sends every element of range as an item
+    // that completes on a thread of pool. If the receiver advertises get_max_in_flight, an
+    // item is only started once fewer items than that are in flight.
+    //
+    // schedule_all(pool, range, chunk_size) sends the chunks of chunk_size consecutive
+    // elements of a random access range instead, as iterate_chunks does, so that every chunk
+    // costs one task of the pool rather than one per element.
     struct schedule_all_t {
       template <class Range>
       stdexec::__t<schedule_all_::sequence<__decay_t<Range>>>
         operator()(static_thread_pool& pool, Range&& range) const {
         return {static_cast<Range&&>(range), pool};
       }
+
+      template <__iterate::__chunkable_range Range>
+      stdexec::__t<schedule_all_::sequence<__iterate::__chunk_view<__decay_t<Range>>>>
+        operator()(static_thread_pool& pool, Range&& range, std::size_t chunk_size) const {
+        STDEXEC_ASSERT(chunk_size != 0);
+        return {{static_cast<Range&&>(range), chunk_size}, pool};
+      }
     };
   } // namespace _pool_
 
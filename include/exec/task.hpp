@@ -18,6 +18,7 @@
 #include <any>
 #include <cassert>
 #include <exception>
+#include <optional>
 #include <utility>
 #include <variant>
 
@@ -25,6 +26,8 @@
 #include "../stdexec/execution.hpp"
 #include "../stdexec/__detail/__meta.hpp"
 
+#include "__detail/__current_scheduler.hpp"
+#include "__detail/__frame_allocator.hpp"
 #include "any_sender_of.hpp"
 #include "at_coroutine_exit.hpp"
 #include "inline_scheduler.hpp"
@@ -40,7 +43,7 @@ namespace exec {
     using __any_scheduler =                                                     //
       any_receiver_ref<                                                         //
         completion_signatures<set_error_t(std::exception_ptr), set_stopped_t()> //
-        >::any_sender<>::any_scheduler<>;
+        >::any_sender<>::any_scheduler<__current_sched::__is_current.signature<bool() noexcept>>;
     static_assert(scheduler<__any_scheduler>);
 
     template <class _Ty>
@@ -88,23 +91,37 @@ namespace exec {
       __sticky
     };
 
-    template <__scheduler_affinity _SchedulerAffinity = __scheduler_affinity::__sticky>
+    template <
+      __scheduler_affinity _SchedulerAffinity = __scheduler_affinity::__sticky,
+      class _Scheduler = __any_scheduler>
     class __default_task_context_impl {
       template <class _ParentPromise>
       friend struct __default_awaiter_context;
 
       static constexpr bool __with_scheduler = _SchedulerAffinity == __scheduler_affinity::__sticky;
 
+      // The scheduler is set when the task is awaited. Until then, it is
+      // the inline_scheduler if _Scheduler can hold one.
+      static auto __initial_scheduler() noexcept {
+        if constexpr (!__with_scheduler) {
+          return __ignore{};
+        } else if constexpr (constructible_from<_Scheduler, exec::inline_scheduler>) {
+          return std::optional<_Scheduler>{exec::inline_scheduler{}};
+        } else {
+          return std::optional<_Scheduler>{};
+        }
+      }
+
       STDEXEC_ATTRIBUTE((no_unique_address))
-      __if_c<__with_scheduler, __any_scheduler, __ignore> //
-        __scheduler_{exec::inline_scheduler{}};
+      __if_c<__with_scheduler, std::optional<_Scheduler>, __ignore> //
+        __scheduler_{__initial_scheduler()};
       in_place_stop_token __stop_token_;
 
-      friend const __any_scheduler&
+      friend const _Scheduler&
         tag_invoke(get_scheduler_t, const __default_task_context_impl& __self) noexcept
         requires(__with_scheduler)
       {
-        return __self.__scheduler_;
+        return *__self.__scheduler_;
       }
 
       friend auto tag_invoke(get_stop_token_t, const __default_task_context_impl& __self) noexcept
@@ -115,20 +132,22 @@ namespace exec {
      public:
       __default_task_context_impl() = default;
 
-      template <scheduler _Scheduler>
-      explicit __default_task_context_impl(_Scheduler&& __scheduler)
-        : __scheduler_{(_Scheduler&&) __scheduler} {
+      template <scheduler _Scheduler2>
+        requires constructible_from<_Scheduler, _Scheduler2>
+      explicit __default_task_context_impl(_Scheduler2&& __scheduler)
+        : __scheduler_{(_Scheduler2&&) __scheduler} {
       }
 
       bool stop_requested() const noexcept {
         return __stop_token_.stop_requested();
       }
 
-      template <scheduler _Scheduler>
-      void set_scheduler(_Scheduler&& __sched)
+      template <scheduler _Scheduler2>
+        requires constructible_from<_Scheduler, _Scheduler2>
+      void set_scheduler(_Scheduler2&& __sched)
         requires(__with_scheduler)
       {
-        __scheduler_ = (_Scheduler&&) __sched;
+        __scheduler_.emplace((_Scheduler2&&) __sched);
       }
 
       template <class _ThisPromise>
@@ -144,13 +163,17 @@ namespace exec {
     template <class _Ty>
     using __raw_task_context = __default_task_context_impl<__scheduler_affinity::__none>;
 
+    template <class _Ty, class _Scheduler>
+    using scheduler_task_context =
+      __default_task_context_impl<__scheduler_affinity::__sticky, _Scheduler>;
+
     // This is the context associated with basic_task's awaiter. By default
     // it does nothing.
     template <class _ParentPromise>
     struct __default_awaiter_context {
-      template <__scheduler_affinity _Affinity>
+      template <__scheduler_affinity _Affinity, class _Scheduler>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) noexcept {
         if constexpr (_Affinity == __scheduler_affinity::__sticky) {
           __check_parent_promise_has_scheduler<_ParentPromise>();
@@ -169,9 +192,9 @@ namespace exec {
       using __stop_callback_t =
         typename __stop_token_t::template callback_type<__forward_stop_request>;
 
-      template <__scheduler_affinity _Affinity>
+      template <__scheduler_affinity _Affinity, class _Scheduler>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) noexcept
         // Register a callback that will request stop on this basic_task's
         // stop_source when stop is requested on the parent coroutine's stop
@@ -198,9 +221,9 @@ namespace exec {
     template <__indirect_stop_token_provider _ParentPromise>
       requires std::same_as< in_place_stop_token, stop_token_of_t<env_of_t<_ParentPromise>>>
     struct __default_awaiter_context<_ParentPromise> {
-      template <__scheduler_affinity _Affinity>
+      template <__scheduler_affinity _Affinity, class _Scheduler>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) noexcept {
         if constexpr (_Affinity == __scheduler_affinity::__sticky) {
           __check_parent_promise_has_scheduler<_ParentPromise>();
@@ -215,9 +238,9 @@ namespace exec {
     template <__indirect_stop_token_provider _ParentPromise>
       requires unstoppable_token< stop_token_of_t<env_of_t<_ParentPromise>>>
     struct __default_awaiter_context<_ParentPromise> {
-      template <__scheduler_affinity _Affinity>
+      template <__scheduler_affinity _Affinity, class _Scheduler>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) noexcept {
         if constexpr (_Affinity == __scheduler_affinity::__sticky) {
           __check_parent_promise_has_scheduler<_ParentPromise>();
@@ -230,9 +253,9 @@ namespace exec {
     // worst and save a type-erased stop callback.
     template <>
     struct __default_awaiter_context<void> {
-      template <__scheduler_affinity _Affinity, class _ParentPromise>
+      template <__scheduler_affinity _Affinity, class _Scheduler, class _ParentPromise>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) noexcept {
         if constexpr (_Affinity == __scheduler_affinity::__sticky) {
           __check_parent_promise_has_scheduler<_ParentPromise>();
@@ -240,9 +263,12 @@ namespace exec {
         }
       }
 
-      template <__scheduler_affinity _Affinity, __indirect_stop_token_provider _ParentPromise>
+      template <
+        __scheduler_affinity _Affinity,
+        class _Scheduler,
+        __indirect_stop_token_provider _ParentPromise>
       explicit __default_awaiter_context(
-        __default_task_context_impl<_Affinity>& __self,
+        __default_task_context_impl<_Affinity, _Scheduler>& __self,
         _ParentPromise& __parent) {
         if constexpr (_Affinity == __scheduler_affinity::__sticky) {
           __check_parent_promise_has_scheduler<_ParentPromise>();
@@ -313,8 +339,121 @@ namespace exec {
       }
     };
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // __resume_on(sndr, sched) is like transfer(sndr, sched), except that it
+    // completes inline when it can tell that it already is on sched: when
+    // the completion schedulers of sndr compare equal to sched, or when the
+    // thread that sndr completes on is an execution agent of sched.
+    struct __resume_on_t {
+      template <sender _Sender, scheduler _Scheduler>
+      auto operator()(_Sender&& __sndr, _Scheduler __sched) const {
+        using _Env = stdexec::__t<__schedule_from::__environ<stdexec::__id<_Scheduler>>>;
+        return __make_sexpr<__resume_on_t>(_Env{{(_Scheduler&&) __sched}}, (_Sender&&) __sndr);
+      }
+    };
+
+    inline constexpr __resume_on_t __resume_on{};
+
+    template <class _Scheduler, class _Attrs, class _Tag>
+    concept __completes_on_comparable = //
+      __callable<get_completion_scheduler_t<_Tag>, const _Attrs&> &&
+      std::equality_comparable_with<
+        const _Scheduler&,
+        __call_result_t<get_completion_scheduler_t<_Tag>, const _Attrs&>>;
+
+    // Whether the sender is known to complete on the scheduler. Its stopped
+    // completions do not matter, because they do not resume the coroutine.
+    template <class _Env, class _Sender, class _Scheduler>
+    bool __completes_on(const _Sender& __sndr, const _Scheduler& __sched) noexcept {
+      using _Attrs = env_of_t<const _Sender&>;
+      constexpr bool __sends_errors =
+        !same_as<__error_types_of_t<_Sender, _Env, __q<__types>>, __types<>>;
+      if constexpr (__completes_on_comparable<_Scheduler, _Attrs, set_value_t>) {
+        auto&& __attrs = stdexec::get_env(__sndr);
+        if constexpr (!__sends_errors) {
+          return __sched == get_completion_scheduler<set_value_t>(__attrs);
+        } else if constexpr (__completes_on_comparable<_Scheduler, _Attrs, set_error_t>) {
+          return __sched == get_completion_scheduler<set_value_t>(__attrs)
+              && __sched == get_completion_scheduler<set_error_t>(__attrs);
+        }
+      }
+      return false;
+    }
+
+    template <class _Scheduler, class _Sexpr, class _Receiver>
+    struct __resume_on_state : __schedule_from::__state<_Scheduler, _Sexpr, _Receiver> {
+      __resume_on_state(_Scheduler __sched, bool __skip)
+        : __schedule_from::__state<_Scheduler, _Sexpr, _Receiver>{__sched}
+        , __sched_{(_Scheduler&&) __sched}
+        , __skip_{__skip} {
+      }
+
+      _Scheduler __sched_;
+      // Whether the sender is known to complete on __sched_.
+      bool __skip_;
+    };
+
+    struct __resume_on_impl : __sexpr_defaults {
+      template <class _Sender>
+      using __scheduler_t = __schedule_from::__schedule_from_impl::__scheduler_t<_Sender>;
+
+      static constexpr auto get_attrs = //
+        []<class _Data, class _Child>(const _Data& __data, const _Child& __child) noexcept {
+          return __env::__join(__data, stdexec::get_env(__child));
+        };
+
+      static constexpr auto get_completion_signatures = //
+        []<class _Sender, class _Env>(_Sender&&, const _Env&) noexcept
+        -> __schedule_from::__completions_t<__scheduler_t<_Sender>, __child_of<_Sender>, _Env> {
+        return {};
+      };
+
+      static constexpr auto get_state =
+        []<class _Sender, class _Receiver>(_Sender&& __sndr, _Receiver& __rcvr) {
+          return __sexpr_apply(
+            (_Sender&&) __sndr, [&](__ignore, const auto& __data, const auto& __child) {
+              auto __sched = get_completion_scheduler<set_value_t>(__data);
+              using _Scheduler = decltype(__sched);
+              bool __skip = __task::__completes_on<env_of_t<_Receiver>>(__child, __sched);
+              return __resume_on_state<_Scheduler, _Sender, _Receiver>{__sched, __skip};
+            });
+        };
+
+      static constexpr auto complete = //
+        []<class _Index, class _Tag, class... _Args>(
+          _Index __index,
+          auto& __state,
+          auto& __rcvr,
+          _Tag,
+          _Args&&... __args) noexcept -> void {
+        if (!__state.__skip_ && !__current_sched::__is_current(__state.__sched_)) {
+          __schedule_from::__schedule_from_impl::complete(
+            __index, __state, __rcvr, _Tag(), (_Args&&) __args...);
+        } else if constexpr ((same_as<_Args, __decay_t<_Args>> && ...)) {
+          _Tag()(std::move(__rcvr), (_Args&&) __args...);
+        } else {
+          // The completion signatures promise decayed rvalues, so make
+          // copies first.
+          using __async_result = __decayed_tuple<_Tag, _Args...>;
+          try {
+            __state.__data_.template emplace<__async_result>(_Tag(), (_Args&&) __args...);
+          } catch (...) {
+            set_error(std::move(__rcvr), std::current_exception());
+            return;
+          }
+          typename __decay_t<decltype(__state)>::__receiver2_t{&__state}.set_value();
+        }
+      };
+    };
+
     ////////////////////////////////////////////////////////////////////////////////
     // basic_task
+    // A task that sticks to the scheduler of the coroutine that awaits it
+    // completes on that scheduler, so there is no need to transition back.
+    template <class _Awaitable>
+    concept __completes_where_it_starts = //
+      requires { requires __decay_t<_Awaitable>::__sticky; };
+
     template <class _Ty, class _Context = default_task_context<_Ty>>
     class [[nodiscard]] basic_task {
       struct __promise;
@@ -323,6 +462,8 @@ namespace exec {
       using __id = basic_task;
       using promise_type = __promise;
 
+      static constexpr bool __sticky = __scheduler_provider<_Context>;
+
       basic_task(basic_task&& __that) noexcept
         : __coro_(std::exchange(__that.__coro_, {})) {
       }
@@ -347,9 +488,13 @@ namespace exec {
         }
       };
 
+      // The frames of basic_task coroutines are allocated with the allocator
+      // that follows std::allocator_arg in the coroutine's parameters, if
+      // any, or else recycled through a per-thread cache.
       struct __promise
         : __promise_base<_Ty>
-        , with_awaitable_senders<__promise> {
+        , with_awaitable_senders<__promise>
+        , __frame::__allocating_promise {
         basic_task get_return_object() noexcept {
           return basic_task(__coro::coroutine_handle<__promise>::from_promise(*this));
         }
@@ -373,10 +518,12 @@ namespace exec {
         template <sender _Awaitable>
           requires __scheduler_provider<_Context>
         decltype(auto) await_transform(_Awaitable&& __awaitable) noexcept {
-          // TODO: If we have a complete-where-it-starts query then we can optimize
-          // this to avoid the reschedule
-          return as_awaitable(
-            transfer((_Awaitable&&) __awaitable, get_scheduler(__context_)), *this);
+          if constexpr (__completes_where_it_starts<_Awaitable>) {
+            return as_awaitable((_Awaitable&&) __awaitable, *this);
+          } else {
+            return as_awaitable(
+              __resume_on((_Awaitable&&) __awaitable, get_scheduler(__context_)), *this);
+          }
         }
 
         template <class _Scheduler>
@@ -508,7 +655,20 @@ namespace exec {
   template <class _Ty>
   using task = basic_task<_Ty, default_task_context<_Ty>>;
 
+  // A task context that sticks to a scheduler of the given type instead of
+  // a type-erased one.
+  template <class _Ty, class _Scheduler>
+  using scheduler_task_context = __task::scheduler_task_context<_Ty, _Scheduler>;
+
+  template <class _Ty, class _Scheduler>
+  using scheduler_task = basic_task<_Ty, scheduler_task_context<_Ty, _Scheduler>>;
+
   inline constexpr __task::__reschedule_coroutine_on reschedule_coroutine_on{};
 } // namespace exec
 
+namespace stdexec {
+  template <>
+  struct __sexpr_impl<exec::__task::__resume_on_t> : exec::__task::__resume_on_impl { };
+}
+
 STDEXEC_PRAGMA_POP()
@@ -0,0 +1,658 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "../stdexec/execution.hpp"
+#include "./__detail/__start_batch.hpp"
+#include "./sharded_stop_token.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace exec {
+  /////////////////////////////////////////////////////////////////////////////
+  // when_all_range and when_any_range
+  //
+  // The counterparts of when_all and when_any for a number of senders of the
+  // same type that is only known at runtime. A range that is passed as an
+  // lvalue is not copied, so it must outlive the sender and its operation.
+  // The operation states of all the children are allocated in one block,
+  // with the allocator of the receiver's environment if it has one, or else
+  // with the recycling allocator. The children share one sharded_stop_source,
+  // so that their stop callbacks do not all contend for one lock, and one
+  // countdown, and are started in a single start batch, so that the ones that
+  // start on a static_thread_pool are submitted to it all at once.
+  namespace __when_range {
+    using namespace stdexec;
+
+    struct __on_stop_request {
+      sharded_stop_source& __stop_source_;
+
+      void operator()() noexcept {
+        __stop_source_.request_stop();
+      }
+    };
+
+    template <class _Env>
+    using __env_t = __env::__join_t<
+      __env::__with<sharded_stop_token, get_stop_token_t>,
+      __env::__with<bool, __start_batch::__deferrable_t>,
+      _Env>;
+
+    template <class _Ty>
+    using __decay_rvalue_ref = __decay_t<_Ty>&&;
+
+    template <class _Sender, class _Env>
+    using __errors_sigs_t = //
+      __try_make_completion_signatures<
+        _Sender,
+        __env_t<_Env>,
+        completion_signatures<set_error_t(std::exception_ptr&&), set_stopped_t()>,
+        __mconst<completion_signatures<>>,
+        __mcompose<__q<completion_signatures>, __qf<set_error_t>, __q<__decay_rvalue_ref>>>;
+
+    // The operation states of the children, constructed in place in a single
+    // allocation.
+    template <class _Slot, class _Alloc>
+    class __slot_array {
+      using __alloc_t = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Slot>;
+      using __traits_t = std::allocator_traits<__alloc_t>;
+
+      void __destroy() noexcept {
+        while (__size_ != 0) {
+          std::destroy_at(__data_ + --__size_);
+        }
+        if (__data_ != nullptr) {
+          __traits_t::deallocate(__alloc_, __data_, __capacity_);
+        }
+      }
+
+     public:
+      template <class _Range, class _MakeSlot>
+      __slot_array(const _Alloc& __alloc, _Range&& __range, _MakeSlot __make_slot)
+        : __alloc_(__alloc)
+        , __capacity_(std::ranges::size(__range)) {
+        if (__capacity_ == 0) {
+          return;
+        }
+        __data_ = __traits_t::allocate(__alloc_, __capacity_);
+        try {
+          for (auto&& __sndr: __range) {
+            __make_slot(static_cast<void*>(__data_ + __size_), (decltype(__sndr)&&) __sndr);
+            ++__size_;
+          }
+        } catch (...) {
+          __destroy();
+          throw;
+        }
+      }
+
+      __slot_array(__slot_array&&) = delete;
+
+      ~__slot_array() {
+        __destroy();
+      }
+
+      _Slot* begin() const noexcept {
+        return __data_;
+      }
+
+      _Slot* end() const noexcept {
+        return __data_ + __size_;
+      }
+
+      std::size_t size() const noexcept {
+        return __size_;
+      }
+
+     private:
+      STDEXEC_ATTRIBUTE((no_unique_address)) __alloc_t __alloc_;
+      std::size_t __capacity_;
+      std::size_t __size_{0};
+      _Slot* __data_{nullptr};
+    };
+
+    // The part of the operation state that the children's receivers see.
+    template <class _Receiver>
+    struct __op_base : __immovable {
+      using __on_stop_t = std::optional<
+        typename stop_token_of_t<env_of_t<_Receiver>&>::template callback_type<__on_stop_request>>;
+
+      __op_base(_Receiver&& __rcvr, std::size_t __count)
+        : __rcvr_((_Receiver&&) __rcvr)
+        , __count_(__count) {
+      }
+
+      __env_t<env_of_t<_Receiver>> __child_env() const noexcept {
+        return __env::__join(
+          __env::__with(__stop_source_.get_token(), get_stop_token),
+          __env::__with(true, __start_batch::__deferrable),
+          stdexec::get_env(__rcvr_));
+      }
+
+      // Returns true if this was the last child to complete.
+      bool __arrive() noexcept {
+        return __count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+      }
+
+      _Receiver __rcvr_;
+      std::atomic<std::size_t> __count_;
+      sharded_stop_source __stop_source_{};
+      __on_stop_t __on_stop_{};
+    };
+
+    // Starts the children of an operation, or completes the operation with
+    // _Complete right away if there are none.
+    template <class _Op, class _Complete>
+    void __start(_Op& __op, _Complete __complete) noexcept {
+      __op.__on_stop_.emplace(
+        get_stop_token(stdexec::get_env(__op.__rcvr_)), __on_stop_request{__op.__stop_source_});
+      if (__op.__stop_source_.stop_requested()) {
+        __op.__on_stop_.reset();
+        stdexec::set_stopped(std::move(__op.__rcvr_));
+        return;
+      }
+      if (__op.__slots_.size() == 0) {
+        __complete(__op);
+        return;
+      }
+      // The last child to complete may destroy __op, so do not touch it after
+      // the last child has been started.
+      auto* __first = __op.__slots_.begin();
+      auto* const __last = __op.__slots_.end();
+      __start_batch::__scope __batch;
+      for (; __first != __last; ++__first) {
+        stdexec::start(__first->__op_);
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // when_all_range
+    struct __no_values { };
+
+    template <class _Sender, class _Env>
+    using __values_t = //
+      __value_types_of_t<_Sender, __env_t<_Env>, __q<__decayed_tuple>, __msingle_or<__no_values>>;
+
+    // A range of senders of Ts... sends a vector of tuple<Ts...>, a range of
+    // senders of T sends a vector of T, and a range of senders of nothing sends
+    // nothing.
+    template <class _Values>
+    struct __all_result {
+      using __t = std::vector<_Values>;
+    };
+
+    template <class _Ty>
+    struct __all_result<std::tuple<_Ty>> {
+      using __t = std::vector<_Ty>;
+    };
+
+    template <>
+    struct __all_result<std::tuple<>> {
+      using __t = void;
+    };
+
+    template <class _Values>
+    using __all_result_t = typename __all_result<_Values>::__t;
+
+    template <class _Values>
+    struct __all_value_sig {
+      using __t = set_value_t(__all_result_t<_Values>&&);
+    };
+
+    template <>
+    struct __all_value_sig<std::tuple<>> {
+      using __t = set_value_t();
+    };
+
+    template <class... _Ts>
+    using __all_value_sigs_t =
+      completion_signatures<typename __all_value_sig<__decayed_tuple<_Ts...>>::__t>;
+
+    template <class _Sender, class _Env>
+    using __all_completions_t = //
+      __concat_completion_signatures_t<
+        __errors_sigs_t<_Sender, _Env>,
+        __value_types_of_t<
+          _Sender,
+          __env_t<_Env>,
+          __q<__all_value_sigs_t>,
+          __msingle_or<completion_signatures<>>>>;
+
+    template <class _Sender, class _Env>
+    using __all_errors_t = //
+      __minvoke<
+        __mconcat<__transform<__q<__decay_t>, __munique<__q<std::variant>>>>,
+        __types<std::monostate, std::exception_ptr>,
+        error_types_of_t<_Sender, __env_t<_Env>, __types>>;
+
+    enum class __all_state_t {
+      __started,
+      __error,
+      __stopped
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    struct __all_operation {
+      class __t;
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    struct __all_receiver {
+      using _CvrefSender = stdexec::__cvref_t<_CvrefSenderId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __operation_t = stdexec::__t<__all_operation<_CvrefSenderId, _ReceiverId>>;
+      using __values_t = __when_range::__values_t<_CvrefSender, env_of_t<_Receiver>>;
+
+      class __t {
+       public:
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __all_receiver;
+
+        __t(__operation_t* __op, std::optional<__values_t>* __values) noexcept
+          : __op_(__op)
+          , __values_(__values) {
+        }
+
+       private:
+        __operation_t* __op_;
+        std::optional<__values_t>* __values_;
+
+        template <class... _Args>
+        friend void tag_invoke(set_value_t, __t&& __self, _Args&&... __args) noexcept {
+          __operation_t& __op = *__self.__op_;
+          if (__op.__state_.load(std::memory_order_relaxed) == __all_state_t::__started) {
+            try {
+              __self.__values_->emplace((_Args&&) __args...);
+            } catch (...) {
+              __op.__set_error(std::current_exception());
+            }
+          }
+          __op.__arrive_and_complete();
+        }
+
+        template <class _Error>
+        friend void tag_invoke(set_error_t, __t&& __self, _Error&& __err) noexcept {
+          __self.__op_->__set_error((_Error&&) __err);
+          __self.__op_->__arrive_and_complete();
+        }
+
+        friend void tag_invoke(set_stopped_t, __t&& __self) noexcept {
+          __operation_t& __op = *__self.__op_;
+          __all_state_t __expected = __all_state_t::__started;
+          // An error trumps cancellation.
+          if (__op.__state_.compare_exchange_strong(__expected, __all_state_t::__stopped)) {
+            __op.__stop_source_.request_stop();
+          }
+          __op.__arrive_and_complete();
+        }
+
+        friend __env_t<env_of_t<_Receiver>> tag_invoke(get_env_t, const __t& __self) noexcept {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    class __all_operation<_CvrefSenderId, _ReceiverId>::__t
+      : public __op_base<stdexec::__t<_ReceiverId>> {
+     public:
+      using _CvrefSender = stdexec::__cvref_t<_CvrefSenderId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __receiver_t = stdexec::__t<__all_receiver<_CvrefSenderId, _ReceiverId>>;
+      using __values_t = __when_range::__values_t<_CvrefSender, env_of_t<_Receiver>>;
+      using __errors_t = __all_errors_t<_CvrefSender, env_of_t<_Receiver>>;
+
+      struct __slot {
+        __slot(_CvrefSender&& __sndr, __t* __op)
+          : __op_(stdexec::connect((_CvrefSender&&) __sndr, __receiver_t{__op, &__values_})) {
+        }
+
+        std::optional<__values_t> __values_{};
+        connect_result_t<_CvrefSender, __receiver_t> __op_;
+      };
+
+      using __allocator_t = __env_allocator_t<env_of_t<_Receiver>>;
+
+      template <class _Error>
+      void __set_error(_Error&& __err) noexcept {
+        if (__state_.exchange(__all_state_t::__error) != __all_state_t::__error) {
+          this->__stop_source_.request_stop();
+          // We won the race, free to write the error without worry.
+          try {
+            __errors_.template emplace<__decay_t<_Error>>((_Error&&) __err);
+          } catch (...) {
+            __errors_.template emplace<std::exception_ptr>(std::current_exception());
+          }
+        }
+      }
+
+      void __arrive_and_complete() noexcept {
+        if (this->__arrive()) {
+          __complete();
+        }
+      }
+
+      void __complete() noexcept {
+        this->__on_stop_.reset();
+        switch (__state_.load(std::memory_order_relaxed)) {
+        case __all_state_t::__started:
+          __set_values();
+          break;
+        case __all_state_t::__error:
+          std::visit(
+            [this]<class _Error>(_Error& __err) noexcept {
+              if constexpr (!same_as<_Error, std::monostate>) {
+                stdexec::set_error(std::move(this->__rcvr_), std::move(__err));
+              }
+            },
+            __errors_);
+          break;
+        case __all_state_t::__stopped:
+          stdexec::set_stopped(std::move(this->__rcvr_));
+          break;
+        }
+      }
+
+      void __set_values() noexcept {
+        using __result_t = __all_result_t<__values_t>;
+        if constexpr (same_as<__result_t, void>) {
+          stdexec::set_value(std::move(this->__rcvr_));
+        } else {
+          std::optional<__result_t> __result;
+          try {
+            __result.emplace();
+            __result->reserve(__slots_.size());
+            for (__slot& __slt: __slots_) {
+              if constexpr (std::tuple_size_v<__values_t> == 1) {
+                __result->push_back(std::get<0>(std::move(*__slt.__values_)));
+              } else {
+                __result->push_back(std::move(*__slt.__values_));
+              }
+            }
+          } catch (...) {
+            stdexec::set_error(std::move(this->__rcvr_), std::current_exception());
+            return;
+          }
+          stdexec::set_value(std::move(this->__rcvr_), std::move(*__result));
+        }
+      }
+
+      friend void tag_invoke(start_t, __t& __self) noexcept {
+        __when_range::__start(__self, [](__t& __op) noexcept { __op.__complete(); });
+      }
+
+      std::atomic<__all_state_t> __state_{__all_state_t::__started};
+      __errors_t __errors_{};
+
+      template <class _Range>
+      __t(_Range&& __senders, _Receiver __rcvr)
+        : __op_base<_Receiver>((_Receiver&&) __rcvr, std::ranges::size(__senders))
+        , __slots_(
+            __env_allocator(stdexec::get_env(this->__rcvr_)),
+            (_Range&&) __senders,
+            [this](void* __where, auto&& __sndr) {
+              ::new (__where) __slot(static_cast<_CvrefSender&&>(__sndr), this);
+            }) {
+      }
+
+      __slot_array<__slot, __allocator_t> __slots_;
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // when_any_range
+    template <class _Sender, class _Env>
+    using __any_completions_t = //
+      __concat_completion_signatures_t<
+        __errors_sigs_t<_Sender, _Env>,
+        __try_make_completion_signatures<
+          _Sender,
+          __env_t<_Env>,
+          completion_signatures<>,
+          __transform<
+            __q<__decay_rvalue_ref>,
+            __mcompose<__q<completion_signatures>, __qf<set_value_t>>>,
+          __mconst<completion_signatures<>>,
+          completion_signatures<>>>;
+
+    template <class _Ret, class... _Args>
+    __decayed_tuple<_Ret, _Args...> __signature_to_tuple_(_Ret (*)(_Args...));
+
+    template <class _Sig>
+    using __signature_to_tuple_t = decltype(__signature_to_tuple_((_Sig*) nullptr));
+
+    template <class _Sender, class _Env>
+    using __any_result_t = //
+      __mapply<
+        __transform<__q<__signature_to_tuple_t>, __munique<__q<std::variant>>>,
+        __any_completions_t<_Sender, _Env>>;
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    struct __any_operation {
+      class __t;
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    struct __any_receiver {
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __operation_t = stdexec::__t<__any_operation<_CvrefSenderId, _ReceiverId>>;
+
+      class __t {
+       public:
+        using receiver_concept = stdexec::receiver_t;
+        using __id = __any_receiver;
+
+        explicit __t(__operation_t* __op) noexcept
+          : __op_(__op) {
+        }
+
+       private:
+        __operation_t* __op_;
+
+        template <__completion_tag _Tag, class... _Args>
+        friend void tag_invoke(_Tag, __t&& __self, _Args&&... __args) noexcept {
+          __self.__op_->__notify(_Tag(), (_Args&&) __args...);
+        }
+
+        friend __env_t<env_of_t<_Receiver>> tag_invoke(get_env_t, const __t& __self) noexcept {
+          return __self.__op_->__child_env();
+        }
+      };
+    };
+
+    template <class _CvrefSenderId, class _ReceiverId>
+    class __any_operation<_CvrefSenderId, _ReceiverId>::__t
+      : public __op_base<stdexec::__t<_ReceiverId>> {
+     public:
+      using _CvrefSender = stdexec::__cvref_t<_CvrefSenderId>;
+      using _Receiver = stdexec::__t<_ReceiverId>;
+      using __receiver_t = stdexec::__t<__any_receiver<_CvrefSenderId, _ReceiverId>>;
+      using __result_t = __any_result_t<_CvrefSender, env_of_t<_Receiver>>;
+
+      struct __slot {
+        __slot(_CvrefSender&& __sndr, __t* __op)
+          : __op_(stdexec::connect((_CvrefSender&&) __sndr, __receiver_t{__op})) {
+        }
+
+        connect_result_t<_CvrefSender, __receiver_t> __op_;
+      };
+
+      using __allocator_t = __env_allocator_t<env_of_t<_Receiver>>;
+
+      template <class _Tag, class... _Args>
+      void __notify(_Tag, _Args&&... __args) noexcept {
+        if (!__emplaced_.exchange(true, std::memory_order_relaxed)) {
+          // Only the first child to complete gets here.
+          try {
+            __result_.emplace(std::tuple<_Tag, __decay_t<_Args>...>{_Tag(), (_Args&&) __args...});
+          } catch (...) {
+            __result_.emplace(std::tuple{set_error_t(), std::current_exception()});
+          }
+          this->__stop_source_.request_stop();
+        }
+        // The acq_rel fetch_sub makes the result visible to the last child.
+        if (this->__arrive()) {
+          __complete();
+        }
+      }
+
+      void __complete() noexcept {
+        this->__on_stop_.reset();
+        if (!__result_ || get_stop_token(stdexec::get_env(this->__rcvr_)).stop_requested()) {
+          stdexec::set_stopped(std::move(this->__rcvr_));
+          return;
+        }
+        std::visit(
+          [this](auto& __result) noexcept {
+            std::apply(
+              [this]<class _Tag, class... _As>(_Tag, _As&... __as) noexcept {
+                _Tag()(std::move(this->__rcvr_), std::move(__as)...);
+              },
+              __result);
+          },
+          *__result_);
+      }
+
+      friend void tag_invoke(start_t, __t& __self) noexcept {
+        __when_range::__start(__self, [](__t& __op) noexcept { __op.__complete(); });
+      }
+
+      std::atomic<bool> __emplaced_{false};
+      std::optional<__result_t> __result_{};
+
+      template <class _Range>
+      __t(_Range&& __senders, _Receiver __rcvr)
+        : __op_base<_Receiver>((_Receiver&&) __rcvr, std::ranges::size(__senders))
+        , __slots_(
+            __env_allocator(stdexec::get_env(this->__rcvr_)),
+            (_Range&&) __senders,
+            [this](void* __where, auto&& __sndr) {
+              ::new (__where) __slot(static_cast<_CvrefSender&&>(__sndr), this);
+            }) {
+      }
+
+      __slot_array<__slot, __allocator_t> __slots_;
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    struct __all_t {
+      template <class _CvrefSender, class _Receiver>
+      using __operation_t =
+        stdexec::__t<__all_operation<__cvref_id<_CvrefSender>, __id<_Receiver>>>;
+
+      template <class _CvrefSender, class _Receiver>
+      using __receiver_t = stdexec::__t<__all_receiver<__cvref_id<_CvrefSender>, __id<_Receiver>>>;
+
+      template <class _CvrefSender, class _Env>
+      using __completions_t = __all_completions_t<_CvrefSender, _Env>;
+    };
+
+    struct __any_t {
+      template <class _CvrefSender, class _Receiver>
+      using __operation_t =
+        stdexec::__t<__any_operation<__cvref_id<_CvrefSender>, __id<_Receiver>>>;
+
+      template <class _CvrefSender, class _Receiver>
+      using __receiver_t = stdexec::__t<__any_receiver<__cvref_id<_CvrefSender>, __id<_Receiver>>>;
+
+      template <class _CvrefSender, class _Env>
+      using __completions_t = __any_completions_t<_CvrefSender, _Env>;
+    };
+
+    template <class _Kind, class _RangeId>
+    struct __sender {
+      using _Range = stdexec::__t<_RangeId>;
+
+      class __t {
+       public:
+        using __id = __sender;
+        using sender_concept = stdexec::sender_t;
+
+        explicit __t(_Range __range) noexcept(__nothrow_decay_copyable<_Range>)
+          : __range_((_Range&&) __range) {
+        }
+
+       private:
+        // The children are moved out of a range that the sender owns when it
+        // is connected as an rvalue, and copied otherwise.
+        template <class _Self>
+        using __child_t = __if_c<
+          same_as<_Self, __t> && !std::ranges::borrowed_range<_Range>,
+          std::ranges::range_rvalue_reference_t<_Range>,
+          std::ranges::range_reference_t<__copy_cvref_t<_Self, _Range>>>;
+
+        template <__decays_to<__t> _Self, receiver _Receiver>
+          requires sender_to<
+            __child_t<_Self>,
+            typename _Kind::template __receiver_t<__child_t<_Self>, _Receiver>>
+        friend auto tag_invoke(connect_t, _Self&& __self, _Receiver __rcvr)
+          -> typename _Kind::template __operation_t<__child_t<_Self>, _Receiver> {
+          return {__self.__range_, (_Receiver&&) __rcvr};
+        }
+
+        template <__decays_to<__t> _Self, class _Env>
+        friend auto tag_invoke(get_completion_signatures_t, _Self&&, _Env&&)
+          -> typename _Kind::template __completions_t<__child_t<_Self>, _Env> {
+          return {};
+        }
+
+        _Range __range_;
+      };
+    };
+
+    // The sender refers to a range that is passed as an lvalue, and takes
+    // ownership of one that is passed as an rvalue.
+    template <class _Range>
+    using __range_t = __if_c<
+      std::is_lvalue_reference_v<_Range>,
+      std::views::all_t<_Range>,
+      __decay_t<_Range>>;
+
+    template <class _Kind, class _Range>
+    using __sender_t = stdexec::__t<__sender<_Kind, __id<__range_t<_Range>>>>;
+
+    template <class _Range>
+    concept __range_of_senders = //
+      std::ranges::viewable_range<_Range>
+      && std::ranges::forward_range<__range_t<_Range>>
+      && std::ranges::sized_range<__range_t<_Range>>
+      && sender<__decay_t<std::ranges::range_reference_t<__range_t<_Range>>>>;
+
+    template <class _Kind>
+    struct __when_range_t {
+      template <__range_of_senders _Range>
+      auto operator()(_Range&& __range) const -> __sender_t<_Kind, _Range> {
+        return __sender_t<_Kind, _Range>{__range_t<_Range>((_Range&&) __range)};
+      }
+    };
+  } // namespace __when_range
+
+  // Completes with a vector of the values of all the senders of the range
+  // once they have all completed successfully, or with the first error or
+  // stopped signal.
+  inline constexpr __when_range::__when_range_t<__when_range::__all_t> when_all_range{};
+
+  // Completes with the result of the first sender of the range to complete,
+  // after the others have been stopped. Completes with set_stopped if the
+  // range is empty.
+  inline constexpr __when_range::__when_range_t<__when_range::__any_t> when_any_range{};
+} // namespace exec
@@ -195,6 +195,7 @@ namespace stdexec {
   namespace __split {
     struct split_t;
     struct __split_t;
+    struct __share_t;
   }
 
   using __split::split_t;
@@ -31,6 +31,9 @@ namespace stdexec {
     template <class _Ty>
     struct __make_intrusive_t;
 
+    template <class _Ty>
+    struct __allocate_intrusive_t;
+
     template <class _Ty>
     class __intrusive_ptr;
 
@@ -51,10 +54,12 @@ namespace stdexec {
     struct __control_block {
       alignas(_Ty) unsigned char __value_[sizeof(_Ty)];
       std::atomic<unsigned long> __refcount_;
+      void (*__destroy_)(__control_block*) noexcept;
 
       template <class... _Us>
       explicit __control_block(_Us&&... __us) noexcept(noexcept(_Ty{__declval<_Us>()...}))
-        : __refcount_(1u) {
+        : __refcount_(1u)
+        , __destroy_(&__delete_) {
         // Construct the value *after* the initialization of the
         // atomic in case the constructor of _Ty calls
         // __intrusive_from_this() (which increments the atomic):
@@ -65,10 +70,18 @@ namespace stdexec {
         __value().~_Ty();
       }
 
+      static void __delete_(__control_block* __self) noexcept {
+        delete __self;
+      }
+
       _Ty& __value() const noexcept {
         return *(_Ty*) __value_;
       }
 
+      unsigned long __use_count_() const noexcept {
+        return __refcount_.load(std::memory_order_acquire);
+      }
+
       void __inc_ref_() noexcept {
         __refcount_.fetch_add(1, std::memory_order_relaxed);
       }
@@ -79,17 +92,43 @@ namespace stdexec {
           // TSan does not support std::atomic_thread_fence, so we
           // need to use the TSan-specific __tsan_acquire instead:
           STDEXEC_TSAN(__tsan_acquire(&__refcount_));
-          delete this;
+          __destroy_(this);
         }
       }
     };
 
+    // A control block whose storage was obtained from an allocator, which
+    // is also used to release it.
+    template <class _Ty, class _Alloc>
+    struct __alloc_control_block : __control_block<_Ty> {
+      using __alloc_t =
+        typename std::allocator_traits<_Alloc>::template rebind_alloc<__alloc_control_block>;
+
+      template <class... _Us>
+      explicit __alloc_control_block(const _Alloc& __alloc, _Us&&... __us) noexcept(
+        noexcept(_Ty{__declval<_Us>()...}))
+        : __control_block<_Ty>((_Us&&) __us...)
+        , __alloc_(__alloc) {
+        this->__destroy_ = &__deallocate_;
+      }
+
+      static void __deallocate_(__control_block<_Ty>* __base) noexcept {
+        auto* __self = static_cast<__alloc_control_block*>(__base);
+        __alloc_t __alloc{std::move(__self->__alloc_)};
+        std::allocator_traits<__alloc_t>::destroy(__alloc, __self);
+        std::allocator_traits<__alloc_t>::deallocate(__alloc, __self, 1);
+      }
+
+      STDEXEC_ATTRIBUTE((no_unique_address)) __alloc_t __alloc_;
+    };
+
     STDEXEC_PRAGMA_POP()
 
     template <class _Ty>
     class __intrusive_ptr {
       using _UncvTy = std::remove_cv_t<_Ty>;
       friend struct __make_intrusive_t<_Ty>;
+      friend struct __allocate_intrusive_t<_Ty>;
       friend struct __enable_intrusive_from_this<_UncvTy>;
 
       __control_block<_UncvTy>* __data_{nullptr};
@@ -150,6 +189,11 @@ namespace stdexec {
         operator=({});
       }
 
+      // The number of __intrusive_ptr objects that refer to the same value.
+      unsigned long __use_count() const noexcept {
+        return __data_ ? __data_->__use_count_() : 0;
+      }
+
       void swap(__intrusive_ptr& __that) noexcept {
         std::swap(__data_, __that.__data_);
       }
@@ -217,11 +261,34 @@ namespace stdexec {
         return __intrusive_ptr<_Ty>{::new __control_block<_UncvTy>{(_Us&&) __us...}};
       }
     };
+
+    template <class _Ty>
+    struct __allocate_intrusive_t {
+      template <class _Alloc, class... _Us>
+        requires constructible_from<_Ty, _Us...>
+      __intrusive_ptr<_Ty> operator()(const _Alloc& __alloc, _Us&&... __us) const {
+        using _UncvTy = std::remove_cv_t<_Ty>;
+        using __block_t = __alloc_control_block<_UncvTy, _Alloc>;
+        using __alloc_t = typename __block_t::__alloc_t;
+        __alloc_t __block_alloc{__alloc};
+        __block_t* __block = std::allocator_traits<__alloc_t>::allocate(__block_alloc, 1);
+        try {
+          std::allocator_traits<__alloc_t>::construct(
+            __block_alloc, __block, __alloc, (_Us&&) __us...);
+        } catch (...) {
+          std::allocator_traits<__alloc_t>::deallocate(__block_alloc, __block, 1);
+          throw;
+        }
+        return __intrusive_ptr<_Ty>{__block};
+      }
+    };
   } // namespace __ptr
 
   using __ptr::__intrusive_ptr;
   using __ptr::__enable_intrusive_from_this;
   template <class _Ty>
   inline constexpr __ptr::__make_intrusive_t<_Ty> __make_intrusive{};
+  template <class _Ty>
+  inline constexpr __ptr::__allocate_intrusive_t<_Ty> __allocate_intrusive{};
 
 } // namespace stdexec
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "__execution_fwd.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace stdexec {
+  namespace __recycle {
+    // Blocks are grouped into size classes of __granularity bytes. Each thread
+    // keeps up to __max_cached free blocks per class; anything beyond that, and
+    // any block larger than the largest class, goes back to the global heap.
+    inline constexpr std::size_t __granularity = 64;
+    inline constexpr std::size_t __num_classes = 16;
+    inline constexpr std::size_t __max_cached = 256;
+
+    struct __cache;
+
+    // Every recycled block starts with a header that records the cache of
+    // the thread that allocated it. The header doubles as the link of the
+    // free lists.
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) __header {
+      __cache* __owner_;
+      __header* __next_;
+    };
+
+    // The number of bytes in a block of the given size class, header included.
+    inline constexpr std::size_t __block_size(std::size_t __class) noexcept {
+      return (__class + 1) * __granularity;
+    }
+
+    // Blocks are owned by the cache of the thread that allocated them. When a
+    // block is freed on another thread, it is pushed onto a lock-free list of
+    // its owner, which the owner drains once its own list of that class runs
+    // dry. This keeps producer/consumer patterns, where operation states are
+    // allocated on one thread and completed on another, from draining the
+    // producer's cache.
+    //
+    // A cache outlives its thread for as long as any of its blocks are in
+    // use. When the thread exits, it closes the remote lists, frees every
+    // block that it holds, and adds the number of outstanding blocks to
+    // __orphans_. Whoever brings __orphans_ back to zero deletes the cache.
+    struct __cache {
+      __cache() = default;
+      __cache(__cache&&) = delete;
+
+      void* __allocate(std::size_t __class) {
+        __header* __blk = __local_[__class];
+        if (__blk == nullptr) {
+          __blk = __drain(__class);
+        }
+        if (__blk != nullptr) {
+          __local_[__class] = __blk->__next_;
+          --__counts_[__class];
+        } else {
+          __blk = static_cast<__header*>(::operator new(__block_size(__class)));
+          __blk->__owner_ = this;
+          ++__owned_;
+        }
+        return __blk + 1;
+      }
+
+      // Called on the owning thread only.
+      void __deallocate_local(__header* __blk, std::size_t __class) noexcept {
+        if (__counts_[__class] >= __max_cached) {
+          --__owned_;
+          ::operator delete(static_cast<void*>(__blk));
+          return;
+        }
+        __blk->__next_ = __local_[__class];
+        __local_[__class] = __blk;
+        ++__counts_[__class];
+      }
+
+      // Called on any thread other than the owning one, or on the owning
+      // thread after the cache was closed.
+      void __deallocate_remote(__header* __blk, std::size_t __class) noexcept {
+        std::atomic<__header*>& __head = __remote_[__class];
+        __header* __old = __head.load(std::memory_order_relaxed);
+        do {
+          if (__old == __closed()) {
+            ::operator delete(static_cast<void*>(__blk));
+            if (__orphans_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+              delete this;
+            }
+            return;
+          }
+          __blk->__next_ = __old;
+        } while (!__head.compare_exchange_weak(
+          __old, __blk, std::memory_order_release, std::memory_order_relaxed));
+      }
+
+      // Called by the owning thread when it exits.
+      void __close() noexcept {
+        for (std::size_t __class = 0; __class < __num_classes; ++__class) {
+          __free_list(__local_[__class]);
+          __free_list(__remote_[__class].exchange(__closed(), std::memory_order_acquire));
+        }
+        std::intptr_t __outstanding = static_cast<std::intptr_t>(__owned_);
+        if (__orphans_.fetch_add(__outstanding, std::memory_order_acq_rel) + __outstanding == 0) {
+          delete this;
+        }
+      }
+
+     private:
+      static __header* __closed() noexcept {
+        return reinterpret_cast<__header*>(alignof(__header));
+      }
+
+      __header* __drain(std::size_t __class) noexcept {
+        std::atomic<__header*>& __head = __remote_[__class];
+        if (__head.load(std::memory_order_relaxed) == nullptr) {
+          return nullptr;
+        }
+        __header* __list = __head.exchange(nullptr, std::memory_order_acquire);
+        for (__header* __blk = __list; __blk != nullptr; __blk = __blk->__next_) {
+          ++__counts_[__class];
+        }
+        return __list;
+      }
+
+      void __free_list(__header* __blk) noexcept {
+        while (__blk != nullptr) {
+          --__owned_;
+          ::operator delete(static_cast<void*>(std::exchange(__blk, __blk->__next_)));
+        }
+      }
+
+      __header* __local_[__num_classes]{};
+      std::size_t __counts_[__num_classes]{};
+      // The number of blocks allocated by this cache that have not been
+      // returned to the global heap.
+      std::size_t __owned_ = 0;
+      std::atomic<std::intptr_t> __orphans_{0};
+      std::atomic<__header*> __remote_[__num_classes]{};
+    };
+
+    // Trivially destructible, so it can still be read after the thread's
+    // cache has been closed during thread exit.
+    inline thread_local __cache* __this_thread_cache = nullptr;
+    inline thread_local bool __cache_closed = false;
+
+    struct __cache_handle {
+      __cache_handle()
+        : __cache_(new __cache) {
+        __this_thread_cache = __cache_;
+      }
+
+      __cache_handle(__cache_handle&&) = delete;
+
+      ~__cache_handle() {
+        __cache_closed = true;
+        __this_thread_cache = nullptr;
+        __cache_->__close();
+      }
+
+      __cache* __cache_;
+    };
+
+    inline __cache* __thread_cache() {
+      if (__this_thread_cache == nullptr && !__cache_closed) {
+        static thread_local __cache_handle __handle;
+      }
+      return __this_thread_cache;
+    }
+
+    // An allocator that recycles blocks through per-thread caches of free
+    // lists. A block freed on the thread that allocated it goes back to that
+    // thread's cache directly; a block freed on another thread is handed back
+    // to its owner without taking a lock. It is used for operation states
+    // that would otherwise be allocated with new, such as those of
+    // start_detached and of type-erased senders.
+    template <class _Ty>
+    struct __recycling_allocator {
+      using value_type = _Ty;
+
+      __recycling_allocator() = default;
+
+      template <class _Uy>
+      __recycling_allocator(const __recycling_allocator<_Uy>&) noexcept {
+      }
+
+      static constexpr bool __recyclable(std::size_t __n) noexcept {
+        return alignof(_Ty) <= alignof(__header)
+            && __n * sizeof(_Ty) + sizeof(__header) <= __num_classes * __granularity;
+      }
+
+      static constexpr std::size_t __size_class(std::size_t __n) noexcept {
+        return (__n * sizeof(_Ty) + sizeof(__header) + __granularity - 1) / __granularity - 1;
+      }
+
+      _Ty* allocate(std::size_t __n) {
+        if (!__recyclable(__n)) {
+          return std::allocator<_Ty>{}.allocate(__n);
+        }
+        std::size_t __class = __size_class(__n);
+        if (__cache* __c = __thread_cache()) {
+          return static_cast<_Ty*>(__c->__allocate(__class));
+        }
+        // This thread's cache is gone. Allocate a block that belongs to no
+        // cache.
+        auto* __blk = static_cast<__header*>(::operator new(__block_size(__class)));
+        __blk->__owner_ = nullptr;
+        return reinterpret_cast<_Ty*>(__blk + 1);
+      }
+
+      void deallocate(_Ty* __ptr, std::size_t __n) noexcept {
+        if (!__recyclable(__n)) {
+          std::allocator<_Ty>{}.deallocate(__ptr, __n);
+          return;
+        }
+        __header* __blk = reinterpret_cast<__header*>(__ptr) - 1;
+        __cache* __owner = __blk->__owner_;
+        if (__owner == nullptr) {
+          ::operator delete(static_cast<void*>(__blk));
+        } else if (__owner == __this_thread_cache) {
+          __owner->__deallocate_local(__blk, __size_class(__n));
+        } else {
+          __owner->__deallocate_remote(__blk, __size_class(__n));
+        }
+      }
+
+      template <class _Uy>
+      bool operator==(const __recycling_allocator<_Uy>&) const noexcept {
+        return true;
+      }
+    };
+  } // namespace __recycle
+
+  using __recycle::__recycling_allocator;
+
+  // The allocator with which an algorithm allocates operation states on
+  // behalf of a receiver: the allocator of the receiver's environment if it
+  // has one, or else the recycling allocator.
+  template <class _Env>
+  auto __env_allocator(const _Env& __env) noexcept {
+    if constexpr (__callable<get_allocator_t, const _Env&>) {
+      return get_allocator(__env);
+    } else {
+      return __recycling_allocator<std::byte>{};
+    }
+  }
+
+  template <class _Env>
+  using __env_allocator_t = decltype(stdexec::__env_allocator(__declval<const _Env&>()));
+} // namespace stdexec
@@ -34,6 +34,7 @@
 #include "__detail/__domain.hpp"
 #include "__detail/__intrusive_ptr.hpp"
 #include "__detail/__meta.hpp"
+#include "__detail/__recycling_allocator.hpp"
 #include "__detail/__scope.hpp"
 #include "__detail/__basic_sender.hpp"
 #include "__detail/__utility.hpp"
@@ -1194,6 +1195,16 @@ namespace stdexec {
   // __connect_awaitable_
   namespace __connect_awaitable_ {
     struct __promise_base {
+      // The frames of these coroutines are allocated each time an awaitable
+      // is connected, so recycle them.
+      static void* operator new(std::size_t __size) {
+        return __recycling_allocator<std::byte>{}.allocate(__size);
+      }
+
+      static void operator delete(void* __ptr, std::size_t __size) noexcept {
+        __recycling_allocator<std::byte>{}.deallocate(static_cast<std::byte*>(__ptr), __size);
+      }
+
       __coro::suspend_always initial_suspend() noexcept {
         return {};
       }
@@ -1847,18 +1858,12 @@ namespace stdexec {
 
       void __delete_op() noexcept {
         _Operation* __op = &__opref_();
-        if constexpr (__callable<get_allocator_t, env_of_t<_Receiver>>) {
-          auto&& __env = get_env(__op->__rcvr_);
-          auto __alloc = get_allocator(__env);
-          using _Alloc = decltype(__alloc);
-          using _OpAlloc =
-            typename std::allocator_traits<_Alloc>::template rebind_alloc<_Operation>;
-          _OpAlloc __op_alloc{__alloc};
-          std::allocator_traits<_OpAlloc>::destroy(__op_alloc, __op);
-          std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __op, 1);
-        } else {
-          delete __op;
-        }
+        auto __alloc = __env_allocator(get_env(__op->__rcvr_));
+        using _Alloc = decltype(__alloc);
+        using _OpAlloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Operation>;
+        _OpAlloc __op_alloc{__alloc};
+        std::allocator_traits<_OpAlloc>::destroy(__op_alloc, __op);
+        std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __op, 1);
       }
 
       // Forward all receiever queries.
@@ -1885,27 +1890,20 @@ namespace stdexec {
     struct __submit_t {
       template <receiver _Receiver, sender_to<_Receiver> _Sender>
       void operator()(_Sender&& __sndr, _Receiver __rcvr) const noexcept(false) {
-        if constexpr (__callable<get_allocator_t, env_of_t<_Receiver>>) {
-          auto&& __env = get_env(__rcvr);
-          auto __alloc = get_allocator(__env);
-          using _Alloc = decltype(__alloc);
-          using _Op = __operation<__id<_Sender>, __id<_Receiver>>;
-          using _OpAlloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Op>;
-          _OpAlloc __op_alloc{__alloc};
-          auto __op = std::allocator_traits<_OpAlloc>::allocate(__op_alloc, 1);
-          try {
-            std::allocator_traits<_OpAlloc>::construct(
-              __op_alloc, __op, (_Sender&&) __sndr, (_Receiver&&) __rcvr);
-            start(__op->__op_state_);
-          } catch (...) {
-            std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __op, 1);
-            throw;
-          }
-        } else {
-          start((new __operation<__id<_Sender>, __id<_Receiver>>{
-                   (_Sender&&) __sndr, (_Receiver&&) __rcvr})
-                  ->__op_state_);
+        auto __alloc = __env_allocator(get_env(__rcvr));
+        using _Alloc = decltype(__alloc);
+        using _Op = __operation<__id<_Sender>, __id<_Receiver>>;
+        using _OpAlloc = typename std::allocator_traits<_Alloc>::template rebind_alloc<_Op>;
+        _OpAlloc __op_alloc{__alloc};
+        auto __op = std::allocator_traits<_OpAlloc>::allocate(__op_alloc, 1);
+        try {
+          std::allocator_traits<_OpAlloc>::construct(
+            __op_alloc, __op, (_Sender&&) __sndr, (_Receiver&&) __rcvr);
+        } catch (...) {
+          std::allocator_traits<_OpAlloc>::deallocate(__op_alloc, __op, 1);
+          throw;
         }
+        start(__op->__op_state_);
       }
     };
   } // namespace __submit_
@@ -2874,6 +2872,11 @@ namespace stdexec {
   //   sender is move-only and single-shot, so there will only ever be one
   //   operation state to be notified on completion.
   //
+  // exec::share is a variant of split that sends the result by T&& instead
+  //   of T const&. Every consumer is given its own copy of the result, except
+  //   the one that holds the last reference to the shared state, which has
+  //   the result moved into it.
+  //
   // The shared state should add-ref itself when the input async
   // operation is started and release itself when its completion
   // is notified.
@@ -2903,6 +2906,29 @@ namespace stdexec {
       };
     }
 
+    template <class _Cvref, class _CvrefSenderId, class _EnvId>
+    using __completions_t = //
+      __try_make_completion_signatures<
+        // NOT TO SPEC:
+        // See https://github.com/cplusplus/sender-receiver/issues/23
+        __cvref_t<_CvrefSenderId>,
+        __env_t<__t<_EnvId>>,
+        completion_signatures<
+          set_error_t(__minvoke<_Cvref, std::exception_ptr>),
+          set_stopped_t()>, // NOT TO SPEC
+        __transform<_Cvref, __mcompose<__q<completion_signatures>, __qf<set_value_t>>>,
+        __transform<_Cvref, __mcompose<__q<completion_signatures>, __qf<set_error_t>>>>;
+
+    template <class _Ty>
+    using __clref_t = const __decay_t<_Ty>&;
+
+    template <class _Ty>
+    using __rref_t = __decay_t<_Ty>&&;
+
+    // split and share senders are copyable and may have many consumers.
+    template <class _Tag>
+    concept __multi_shot = __one_of<_Tag, __split::__split_t, __split::__share_t>;
+
     enum class __action_kind : bool {
       __notify,
       __detach
@@ -2915,6 +2941,39 @@ namespace stdexec {
       __local_state_base* __next_{};
     };
 
+    // When a split sender has a single consumer, the result of the input
+    // operation is passed straight to that consumer through a table of these,
+    // one per completion signature, instead of being stored in the variant of
+    // the shared state first.
+    template <class _Sig>
+    struct __direct_fn;
+
+    template <class _Tag, class... _Args>
+    struct __direct_fn<_Tag(_Args...)> {
+      template <class _LocalState>
+      static constexpr __direct_fn __for() noexcept {
+        return {[](__local_state_base* __self, _Args... __args) noexcept {
+          static_cast<_LocalState*>(__self)->__complete_direct(_Tag(), (_Args&&) __args...);
+        }};
+      }
+
+      void operator()(__local_state_base* __self, _Tag, _Args... __args) const noexcept {
+        __fn_(__self, (_Args&&) __args...);
+      }
+
+      void (*__fn_)(__local_state_base*, _Args...) noexcept;
+    };
+
+    template <class... _Sigs>
+    struct __direct_fns : __direct_fn<_Sigs>... {
+      template <class _LocalState>
+      static constexpr __direct_fns __for() noexcept {
+        return {__direct_fn<_Sigs>::template __for<_LocalState>()...};
+      }
+
+      using __direct_fn<_Sigs>::operator()...;
+    };
+
     template <class _CvrefSender, class _Env>
     struct __shared_state;
 
@@ -2932,7 +2991,7 @@ namespace stdexec {
       using __on_stop_cb_t = //
         typename stop_token_of_t<env_of_t<_Receiver>&>::template callback_type<__on_stop_request>;
       using __tag_t = tag_of_t<_CvrefSender>;
-      static_assert(__one_of<__tag_t, __split::__split_t, __ensure_started::__ensure_started_t>);
+      static_assert(__multi_shot<__tag_t> || same_as<__tag_t, __ensure_started::__ensure_started_t>);
 
       explicit __local_state(_CvrefSender&& __sndr) noexcept
         : __local_state::__local_state_base{{}, &__action<tag_of_t<_CvrefSender>>}
@@ -2945,6 +3004,20 @@ namespace stdexec {
         __action_(this, __action_kind::__detach);
       }
 
+      static const auto* __direct_fns() noexcept {
+        using __direct_fns_t = typename __shared_state_t::__direct_fns_t;
+        static constexpr __direct_fns_t __fns = __direct_fns_t::template __for<__local_state>();
+        return &__fns;
+      }
+
+      // Called in place of __action when this is the only consumer of a
+      // split sender.
+      template <class _Tag, class... _Args>
+      void __complete_direct(_Tag, _Args&&... __args) noexcept {
+        __on_stop_.reset();
+        _Tag()(std::move(this->__receiver()), (_Args&&) __args...);
+      }
+
       // This is called when the input async operation completes; or,
       // if it has already completed when start is called, it is called
       // from start:
@@ -2954,17 +3027,19 @@ namespace stdexec {
         if (__kind == __action_kind::__notify) {
           __op->__on_stop_.reset();
 
-          // The split algorithm sends by T const&. ensure_started sends by T&&.
+          // The split algorithm sends by T const&. share and ensure_started send by T&&.
           if constexpr (same_as<__split::__split_t, _Tag>) {
             std::visit(
               __notify_visitor(__op->__receiver()), std::as_const(__op->__shared_state_->__data_));
+          } else if constexpr (same_as<__split::__share_t, _Tag>) {
+            __op->__notify_shared();
           } else {
             std::visit(
               __notify_visitor(__op->__receiver()), std::move(__op->__shared_state_->__data_));
           }
         } else {
           // This is a detach operation
-          if constexpr (same_as<__split::__split_t, _Tag>) {
+          if constexpr (__multi_shot<_Tag>) {
             // no-op
           } else {
             __op->__shared_state_->__detach();
@@ -2972,6 +3047,29 @@ namespace stdexec {
         }
       }
 
+      // Delivers the result of a share sender. If this consumer holds the
+      // only remaining reference to the shared state, no other consumer can
+      // observe the result anymore, so it is moved out. Otherwise it is
+      // copied. The reference is dropped before the receiver is completed so
+      // that the next consumer to be notified can tell whether it is the last.
+      void __notify_shared() noexcept {
+        using __variant_t = typename __shared_state_t::__variant_t;
+        __intrusive_ptr<__shared_state_t> __shared_state = std::move(__shared_state_);
+        std::optional<__variant_t> __result;
+        try {
+          if (__shared_state.__use_count() == 1) {
+            __result.emplace(std::move(__shared_state->__data_));
+          } else {
+            __result.emplace(__shared_state->__data_);
+          }
+        } catch (...) {
+          using __tuple_t = __decayed_tuple<set_error_t, std::exception_ptr>;
+          __result.emplace(std::in_place_type<__tuple_t>, set_error, std::current_exception());
+        }
+        __shared_state.reset();
+        std::visit(__notify_visitor(this->__receiver()), std::move(*__result));
+      }
+
       std::optional<__on_stop_cb_t> __on_stop_{};
       __intrusive_ptr<__shared_state_t> __shared_state_;
     };
@@ -2993,6 +3091,15 @@ namespace stdexec {
         friend void tag_invoke(_Tag __tag, __t&& __self, _As&&... __as) noexcept {
           __shared_state<_CvrefSender, _Env>& __state = *__self.__shared_state_;
 
+          if (__state.__direct_ != nullptr) {
+            // There is exactly one consumer and it holds the only reference
+            // to the shared state, which it may release when it completes.
+            auto* __consumer = static_cast<__local_state_base*>(
+              __state.__head_.load(std::memory_order_relaxed));
+            (*__state.__direct_)(__consumer, __tag, (_As&&) __as...);
+            return;
+          }
+
           try {
             using __tuple_t = __decayed_tuple<_Tag, _As...>;
             __state.__data_.template emplace<__tuple_t>(__tag, (_As&&) __as...);
@@ -3024,9 +3131,14 @@ namespace stdexec {
 
       using __receiver_t = __t<__receiver<__cvref_id<_CvrefSender>, __id<_Env>>>;
 
+      using __direct_fns_t = __mapply<
+        __q<__direct_fns>,
+        __completions_t<__q<__clref_t>, __cvref_id<_CvrefSender>, __id<_Env>>>;
+
       in_place_stop_source __stop_source_{};
       __variant_t __data_;
       std::atomic<void*> __head_{nullptr};
+      const __direct_fns_t* __direct_{nullptr};
       __env_t<_Env> __env_;
       connect_result_t<_CvrefSender, __receiver_t> __op_state2_;
 
@@ -3053,21 +3165,31 @@ namespace stdexec {
         }
       }
 
+      // Starts the input operation on behalf of a split sender's only
+      // consumer. The consumer's reference keeps *this alive until it is
+      // completed, so neither the reference count nor the variant is touched.
+      void __start_op_direct(const __direct_fns_t* __direct) noexcept {
+        __direct_ = __direct;
+        stdexec::start(__op_state2_);
+      }
+
       // This is called when the shared async operation completes:
       void __notify() noexcept {
         void* const __completion_state = static_cast<void*>(this);
         void* const __old = __head_.exchange(__completion_state, std::memory_order_acq_rel);
         __local_state_base* __state = static_cast<__local_state_base*>(__old);
 
+        // The async operation has completed, so we can release our
+        // ref-count on it. Every operation state in the list holds a
+        // reference of its own, so *this stays alive while they are
+        // notified. (share relies on the count excluding this one.)
+        this->__dec_ref();
+
         while (__state != nullptr) {
           __local_state_base* __next = __state->__next_;
           __state->__action_(__state, __action_kind::__notify);
           __state = __next;
         }
-
-        // The async operation has completed, so we can release our
-        // ref-count on it:
-        this->__dec_ref();
       }
 
       void __detach() noexcept {
@@ -3079,25 +3201,6 @@ namespace stdexec {
       }
     };
 
-    template <class _Cvref, class _CvrefSenderId, class _EnvId>
-    using __completions_t = //
-      __try_make_completion_signatures<
-        // NOT TO SPEC:
-        // See https://github.com/cplusplus/sender-receiver/issues/23
-        __cvref_t<_CvrefSenderId>,
-        __env_t<__t<_EnvId>>,
-        completion_signatures<
-          set_error_t(__minvoke<_Cvref, std::exception_ptr>),
-          set_stopped_t()>, // NOT TO SPEC
-        __transform<_Cvref, __mcompose<__q<completion_signatures>, __qf<set_value_t>>>,
-        __transform<_Cvref, __mcompose<__q<completion_signatures>, __qf<set_error_t>>>>;
-
-    template <class _Ty>
-    using __clref_t = const __decay_t<_Ty>&;
-
-    template <class _Ty>
-    using __rref_t = __decay_t<_Ty>&&;
-
     template <class _Tag>
     using __cvref_results_t = //
       __if_c<same_as<_Tag, __split::__split_t>, __q<__clref_t>, __q<__rref_t>>;
@@ -3110,6 +3213,20 @@ namespace stdexec {
       };
     }
 
+    // The shared state is allocated with the allocator of the environment
+    // that was passed to split or ensure_started, if it has one.
+    template <class _Child, class _Env>
+    auto __make_shared_state(_Child&& __child, _Env&& __env) {
+      using __shared_state_t = __shared_state<_Child, __decay_t<_Env>>;
+      if constexpr (__callable<get_allocator_t, const __decay_t<_Env>&>) {
+        auto __alloc = get_allocator(std::as_const(__env));
+        return __allocate_intrusive<__shared_state_t>(
+          __alloc, (_Child&&) __child, (_Env&&) __env);
+      } else {
+        return __make_intrusive<__shared_state_t>((_Child&&) __child, (_Env&&) __env);
+      }
+    }
+
     template <class _Tag>
     struct __shared_impl : __sexpr_defaults {
       static constexpr auto get_state = //
@@ -3171,8 +3288,18 @@ namespace stdexec {
           std::memory_order_release,
           std::memory_order_acquire));
 
-        if constexpr (same_as<_Tag, __split::__split_t>) {
+        if constexpr (__multi_shot<_Tag>) {
           if (__old == nullptr) {
+            if constexpr (same_as<_Tag, __split::__split_t>) {
+              if (
+                __state.__shared_state_.__use_count() == 1
+                && !__shared_state->__stop_source_.stop_requested()) {
+                // This operation owns the only reference to the shared state,
+                // so no other consumer can ever subscribe.
+                __shared_state->__start_op_direct(__state.__direct_fns());
+                return;
+              }
+            }
             __shared_state->__start_op();
           }
         }
@@ -3196,6 +3323,9 @@ namespace stdexec {
 
     struct __split_t { };
 
+    // The tag of the senders returned by exec::share.
+    struct __share_t { };
+
     struct split_t {
       template <sender _Sender, class _Env = empty_env>
         requires sender_in<_Sender, _Env> && __decay_copyable<env_of_t<_Sender>>
@@ -3229,8 +3359,7 @@ namespace stdexec {
         return __sexpr_apply(
           (_Sender&&) __sndr,
           [&]<class _Env, class _Child>(__ignore, _Env&& __env, _Child&& __child) {
-            auto __state = __make_intrusive<__shared_state<_Child, __decay_t<_Env>>>(
-              (_Child&&) __child, (_Env&&) __env);
+            auto __state = __make_shared_state((_Child&&) __child, (_Env&&) __env);
             return __make_sexpr<__split_t>(__data{std::move(__state)});
           });
       }
@@ -3243,6 +3372,9 @@ namespace stdexec {
   template <>
   struct __sexpr_impl<__split::__split_t> : __shared::__shared_impl<__split::__split_t> { };
 
+  template <>
+  struct __sexpr_impl<__split::__share_t> : __shared::__shared_impl<__split::__share_t> { };
+
   /////////////////////////////////////////////////////////////////////////////
   // [execution.senders.adaptors.ensure_started]
   namespace __ensure_started {
@@ -3312,8 +3444,7 @@ namespace stdexec {
         return __sexpr_apply(
           (_Sender&&) __sndr,
           [&]<class _Env, class _Child>(__ignore, _Env&& __env, _Child&& __child) {
-            auto __state = __make_intrusive<__shared_state<_Child, __decay_t<_Env>>>(
-              (_Child&&) __child, (_Env&&) __env);
+            auto __state = __make_shared_state((_Child&&) __child, (_Env&&) __env);
             return __make_sexpr<__ensure_started_t>(__data{std::move(__state)});
           });
       }
@@ -4640,6 +4771,44 @@ namespace stdexec {
         __q<__all_nothrow_decay_copyable_>,
         __q<__mand>>...>;
 
+    struct when_all_t;
+
+    // A when_all requests stop on its own only when a child completes with an
+    // error or with stopped, or when it fails to store a child's values. If
+    // none of that can happen, its children share the stop token of the
+    // receiver instead of getting one of their own, which saves a stop source
+    // and a stop callback per level of a deep pipeline. A nested when_all
+    // that shares the stop token only completes with stopped after stop was
+    // requested on that token, so it does not keep its parent from sharing
+    // the token as well.
+    template <class _Env, class... _Senders>
+    struct __shares_stop_token;
+
+    template <class _Env, class _Sender>
+    consteval bool __never_requests_stop() {
+      if constexpr (
+        !__mvalid<__count_of, set_error_t, _Sender, _Env>
+        || !__mvalid<__count_of, set_stopped_t, _Sender, _Env>) {
+        return false;
+      } else if constexpr (
+        __sends<set_error_t, _Sender, _Env> || !__v<__all_nothrow_decay_copyable<_Env, _Sender>>) {
+        return false;
+      } else if constexpr (!__sends<set_stopped_t, _Sender, _Env>) {
+        return true;
+      } else if constexpr (sender_expr_for<_Sender, when_all_t>) {
+        return __v<__children_of<_Sender, __mbind_front_q<__shares_stop_token, _Env>>>;
+      } else {
+        return false;
+      }
+    }
+
+    template <class _Env, class... _Senders>
+    struct __shares_stop_token : __mbool<(__never_requests_stop<_Env, _Senders>() && ...)> { };
+
+    // The environment of the children.
+    template <class _Env, class... _Senders>
+    using __child_env_t = __if<__shares_stop_token<_Env, _Senders...>, _Env, __env_t<_Env>>;
+
     template <class _Env, class... _Senders>
     using __completions_t = //
       __concat_completion_signatures_t<
@@ -4686,21 +4855,24 @@ namespace stdexec {
         __values);
     }
 
-    template <class _Env, class _Sender>
+    template <class _ChildEnv, class _Sender>
     using __values_opt_tuple_t = //
       __value_types_of_t<
         _Sender,
-        __env_t<_Env>,
+        _ChildEnv,
         __mcompose<__q<std::optional>, __q<__decayed_tuple>>,
         __q<__msingle>>;
 
-    template <class _Env, __max1_sender<__env_t<_Env>>... _Senders>
+    template <class _Env, class... _Senders>
+      requires(__max1_sender<_Senders, __child_env_t<_Env, _Senders...>> && ...)
     struct __traits {
+      using __child_env = __child_env_t<_Env, _Senders...>;
+
       // tuple<optional<tuple<Vs1...>>, optional<tuple<Vs2...>>, ...>
       using __values_tuple = //
         __minvoke<
           __with_default<
-            __transform< __mbind_front_q<__values_opt_tuple_t, _Env>, __q<std::tuple>>,
+            __transform< __mbind_front_q<__values_opt_tuple_t, __child_env>, __q<std::tuple>>,
             __ignore>,
           _Senders...>;
 
@@ -4709,20 +4881,38 @@ namespace stdexec {
       using __error_types = //
         __minvoke<
           __mconcat<__transform<__q<__decay_t>, __nullable_variant_t_>>,
-          error_types_of_t<_Senders, __env_t<_Env>, __types>... >;
+          error_types_of_t<_Senders, __child_env, __types>... >;
 
       using __errors_variant = //
         __if<
-          __all_nothrow_decay_copyable<_Env, _Senders...>,
+          __all_nothrow_decay_copyable<__child_env, _Senders...>,
           __error_types,
           __minvoke<__push_back_unique<__q<std::variant>>, __error_types, std::exception_ptr>>;
     };
 
     struct _INVALID_ARGUMENTS_TO_WHEN_ALL_ { };
 
-    template <class _ErrorsVariant, class _ValuesTuple, class _StopToken>
+    template <class _ErrorsVariant, class _ValuesTuple, class _StopToken, bool _SharesStopToken>
     struct __when_all_state {
       using __stop_callback_t = typename _StopToken::template callback_type<__on_stop_request>;
+      using __stop_source_t = __if_c<_SharesStopToken, __ignore, in_place_stop_source>;
+
+      static constexpr bool __shares_stop_token = _SharesStopToken;
+
+      template <class _Receiver>
+      bool __stop_requested(const _Receiver& __rcvr) const noexcept {
+        if constexpr (_SharesStopToken) {
+          return get_stop_token(stdexec::get_env(__rcvr)).stop_requested();
+        } else {
+          return __stop_source_.stop_requested();
+        }
+      }
+
+      void __request_stop() noexcept {
+        if constexpr (!_SharesStopToken) {
+          __stop_source_.request_stop();
+        }
+      }
 
       template <class _Receiver>
       void __arrive(_Receiver& __rcvr) noexcept {
@@ -4757,7 +4947,7 @@ namespace stdexec {
       }
 
       std::atomic<std::size_t> __count_;
-      in_place_stop_source __stop_source_{};
+      STDEXEC_ATTRIBUTE((no_unique_address)) __stop_source_t __stop_source_{};
       // Could be non-atomic here and atomic_ref everywhere except __completion_fn
       std::atomic<__state_t> __state_{__started};
       _ErrorsVariant __errors_{};
@@ -4767,14 +4957,20 @@ namespace stdexec {
 
     template <class _Env>
     static auto __mk_state_fn(const _Env& __env) noexcept {
-      return [&]<__max1_sender<__env_t<_Env>>... _Child>(__ignore, __ignore, _Child&&...) {
+      return [&]<class... _Child>(__ignore, __ignore, _Child&&...)
+               requires(__max1_sender<_Child, __child_env_t<_Env, _Child...>> && ...)
+      {
         using _Traits = __traits<_Env, _Child...>;
         using _ErrorsVariant = typename _Traits::__errors_variant;
         using _ValuesTuple = typename _Traits::__values_tuple;
-        using _State = __when_all_state<_ErrorsVariant, _ValuesTuple, stop_token_of_t<_Env>>;
+        using _State = __when_all_state<
+          _ErrorsVariant,
+          _ValuesTuple,
+          stop_token_of_t<_Env>,
+          __v<__shares_stop_token<_Env, _Child...>>>;
         return _State{
           sizeof...(_Child),
-          in_place_stop_source{},
+          {},
           __started,
           _ErrorsVariant{},
           _ValuesTuple{},
@@ -4808,9 +5004,12 @@ namespace stdexec {
         __children_of<_Self, __q<_WITH_SENDERS_>>,
         _WITH_ENVIRONMENT_<_Env>>;
 
+      template <class _Env, class... _Senders>
+      using __completions_for_t = __completions_t<__child_env_t<_Env, _Senders...>, _Senders...>;
+
       template <class _Self, class _Env>
       using __completions = //
-        __children_of<_Self, __mbind_front_q<__completions_t, __env_t<_Env>>>;
+        __children_of<_Self, __mbind_front_q<__completions_for_t, _Env>>;
 
       static constexpr auto get_attrs = //
         []<class... _Child>(__ignore, const _Child&...) noexcept {
@@ -4833,9 +5032,12 @@ namespace stdexec {
         []<class _State, class _Receiver>(
           __ignore,
           _State& __state,
-          const _Receiver& __rcvr) noexcept //
-        -> __env_t<env_of_t<const _Receiver&>> {
-        return __mkenv(stdexec::get_env(__rcvr), __state.__stop_source_);
+          const _Receiver& __rcvr) noexcept -> decltype(auto) {
+        if constexpr (_State::__shares_stop_token) {
+          return stdexec::get_env(__rcvr);
+        } else {
+          return __mkenv(stdexec::get_env(__rcvr), __state.__stop_source_);
+        }
       };
 
       static constexpr auto get_state = //
@@ -4849,10 +5051,12 @@ namespace stdexec {
           _State& __state,
           _Receiver& __rcvr,
           _Operations&... __child_ops) noexcept -> void {
-        // register stop callback:
-        __state.__on_stop_.emplace(
-          get_stop_token(stdexec::get_env(__rcvr)), __on_stop_request{__state.__stop_source_});
-        if (__state.__stop_source_.stop_requested()) {
+        // register stop callback, unless the children share our stop token:
+        if constexpr (!_State::__shares_stop_token) {
+          __state.__on_stop_.emplace(
+            get_stop_token(stdexec::get_env(__rcvr)), __on_stop_request{__state.__stop_source_});
+        }
+        if (__state.__stop_requested(__rcvr)) {
           // Stop has already been requested. Don't bother starting
           // the child operations.
           stdexec::set_stopped(std::move(__rcvr));
@@ -4868,7 +5072,7 @@ namespace stdexec {
       static void __set_error(_State& __state, _Receiver& __rcvr, _Error&& __err) noexcept {
         // TODO: What memory orderings are actually needed here?
         if (__error != __state.__state_.exchange(__error)) {
-          __state.__stop_source_.request_stop();
+          __state.__request_stop();
           // We won the race, free to write the error into the operation
           // state without worry.
           if constexpr (__nothrow_decay_copyable<_Error>) {
@@ -4898,7 +5102,7 @@ namespace stdexec {
           // "started" state. (If this fails, it's because we're in an
           // error state, which trumps cancellation.)
           if (__state.__state_.compare_exchange_strong(__expected, __stopped)) {
-            __state.__stop_source_.request_stop();
+            __state.__request_stop();
           }
         } else if constexpr (!same_as<decltype(_State::__values_), __ignore>) {
           // We only need to bother recording the completion values
@@ -0,0 +1,165 @@
+#include <catch2/catch.hpp>
+#include <exec/arena_scope.hpp>
+#include <exec/static_thread_pool.hpp>
+#include "test_common/schedulers.hpp"
+#include "test_common/receivers.hpp"
+
+#include <limits>
+#include <new>
+#include <thread>
+
+namespace ex = stdexec;
+using exec::arena_scope;
+using stdexec::sync_wait;
+
+namespace {
+  TEST_CASE("arena_scope advertises its allocator to nested senders", "[async_scope][arena_scope]") {
+    arena_scope scope;
+    auto snd = scope.nest(ex::read(ex::get_allocator));
+    auto [alloc] = sync_wait(std::move(snd)).value();
+    CHECK(alloc == scope.get_allocator());
+    sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE("arena_scope advertises its allocator to spawned senders", "[async_scope][arena_scope]") {
+    arena_scope scope;
+    bool same_allocator = false;
+    scope.spawn(ex::read(ex::get_allocator) | ex::then([&](auto alloc) {
+                  same_allocator = alloc == scope.get_allocator();
+                }));
+    CHECK(same_allocator);
+
+    auto fut = scope.spawn_future(ex::read(ex::get_allocator));
+    auto [alloc] = sync_wait(std::move(fut)).value();
+    CHECK(alloc == scope.get_allocator());
+    sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE("arena_scope spawn will execute its work", "[async_scope][arena_scope]") {
+    impulse_scheduler sch;
+    bool executed{false};
+    arena_scope scope;
+
+    scope.spawn(ex::on(sch, ex::just() | ex::then([&] { executed = true; })));
+    REQUIRE_FALSE(executed);
+    sch.start_next();
+    REQUIRE(executed);
+    sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE("arena_scope releases its memory when on_empty completes", "[async_scope][arena_scope]") {
+    arena_scope scope;
+    auto alloc = scope.get_allocator();
+    std::byte* first = alloc.allocate(16);
+    std::byte* second = alloc.allocate(16);
+    CHECK(first != second);
+    sync_wait(scope.on_empty());
+    CHECK(alloc.allocate(16) == first);
+  }
+
+  TEST_CASE(
+    "arena_scope keeps the memory of work nested from inside the scope while on_empty runs",
+    "[async_scope][arena_scope]") {
+    using int_allocator = std::allocator_traits<arena_scope::allocator_type>::rebind_alloc<int>;
+    impulse_scheduler sch;
+    arena_scope scope;
+    int* value = nullptr;
+    int seen = 0;
+    scope.spawn(ex::on(sch, ex::just() | ex::then([&] {
+                         value = int_allocator{scope.get_allocator()}.allocate(1);
+                         *value = 42;
+                         scope.spawn(ex::on(sch, ex::just() | ex::then([&] { seen = *value; })));
+                       })));
+
+    bool released{false};
+    auto op = ex::connect(scope.on_empty(), expect_void_receiver_ex{released});
+    ex::start(op);
+    sch.start_next();
+    REQUIRE_FALSE(released);
+    CHECK(int_allocator{scope.get_allocator()}.allocate(1) != value);
+    sch.start_next();
+    CHECK(released);
+    CHECK(seen == 42);
+  }
+
+  TEST_CASE(
+    "arena_scope is not released while a nested operation is alive",
+    "[async_scope][arena_scope]") {
+    arena_scope scope;
+    auto alloc = scope.get_allocator();
+    std::byte* first = alloc.allocate(16);
+    {
+      bool executed{false};
+      auto op = ex::connect(scope.nest(ex::just()), expect_void_receiver_ex{executed});
+      sync_wait(scope.on_empty());
+      CHECK(alloc.allocate(16) != first);
+    }
+    // The last user released the arena.
+    CHECK(alloc.allocate(16) == first);
+  }
+
+  TEST_CASE(
+    "arena_scope can be spawned into from another thread while on_empty runs",
+    "[async_scope][arena_scope]") {
+    using int_allocator = std::allocator_traits<arena_scope::allocator_type>::rebind_alloc<int>;
+    exec::static_thread_pool pool{2};
+    arena_scope scope{256};
+    std::atomic<int> corrupted{0};
+    std::atomic<bool> done{false};
+    std::thread spawner([&] {
+      for (int i = 0; i < 2000; ++i) {
+        scope.spawn(ex::on(
+          pool.get_scheduler(), ex::read(ex::get_allocator) | ex::then([&, i](auto alloc) {
+                                  int* value = int_allocator{alloc}.allocate(1);
+                                  *value = i;
+                                  std::this_thread::yield();
+                                  if (*value != i) {
+                                    ++corrupted;
+                                  }
+                                })));
+      }
+      done = true;
+    });
+    while (!done) {
+      sync_wait(scope.on_empty());
+    }
+    spawner.join();
+    sync_wait(scope.on_empty());
+    CHECK(corrupted == 0);
+  }
+
+  TEST_CASE("arena_allocator throws for sizes that overflow", "[async_scope][arena_scope]") {
+    arena_scope scope;
+    auto alloc = std::allocator_traits<arena_scope::allocator_type>::rebind_alloc<double>{
+      scope.get_allocator()};
+    CHECK_THROWS_AS(
+      alloc.allocate(std::numeric_limits<std::size_t>::max() / 4), std::bad_array_new_length);
+  }
+
+  TEST_CASE("arena_scope allocations respect alignment", "[async_scope][arena_scope]") {
+    arena_scope scope{128};
+    auto alloc = scope.get_allocator();
+    for (int i = 0; i < 64; ++i) {
+      struct alignas(64) overaligned {
+        char data[64];
+      };
+      typename std::allocator_traits<arena_scope::allocator_type>::template rebind_alloc<overaligned>
+        over_alloc{alloc};
+      overaligned* ptr = over_alloc.allocate(1);
+      CHECK(reinterpret_cast<std::uintptr_t>(ptr) % 64 == 0);
+      CHECK(alloc.allocate(3) != nullptr);
+    }
+    sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE("arena_scope can be spawned into from many threads", "[async_scope][arena_scope]") {
+    exec::static_thread_pool pool{4};
+    arena_scope scope{256};
+    std::atomic<int> count{0};
+    for (int i = 0; i < 1000; ++i) {
+      scope.spawn(ex::on(pool.get_scheduler(), ex::just() | ex::then([&] { ++count; })));
+    }
+    sync_wait(scope.on_empty());
+    CHECK(count == 1000);
+  }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/async_generator.hpp"
+
+#if !STDEXEC_STD_NO_COROUTINES_
+
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/sequence/transform_each.hpp"
+#include "exec/env.hpp"
+#include "exec/scope.hpp"
+#include "exec/single_thread_context.hpp"
+
+#include <catch2/catch.hpp>
+#include <test_common/allocators.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+  template <class Fn>
+  auto then_each(Fn fn) {
+    return exec::transform_each(stdexec::then(std::move(fn)));
+  }
+
+  exec::async_generator<int> count_to(int n) {
+    for (int i = 1; i <= n; ++i) {
+      co_yield i;
+    }
+  }
+
+  TEST_CASE("async_generator - is a sequence sender", "[sequence_senders][async_generator]") {
+    using generator = exec::async_generator<int>;
+    STATIC_REQUIRE(exec::sequence_sender_in<generator, stdexec::empty_env>);
+    STATIC_REQUIRE(!std::is_copy_constructible_v<generator>);
+  }
+
+  TEST_CASE("async_generator - yields all items", "[sequence_senders][async_generator]") {
+    int sum = 0;
+    auto sndr = count_to(10) | then_each([&](int i) noexcept { sum += i; })
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(sum == 55);
+  }
+
+  TEST_CASE("async_generator - yields copies of lvalues", "[sequence_senders][async_generator]") {
+    auto words = []() -> exec::async_generator<std::string> {
+      std::string word = "hello";
+      co_yield word;
+      co_yield word + ", world";
+      CHECK(word == "hello");
+    };
+    std::string result;
+    auto sndr = words() | then_each([&](std::string s) { result += s + ";"; })
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(result == "hello;hello, world;");
+  }
+
+  TEST_CASE("async_generator - is resumed when an item completes", "[sequence_senders][async_generator]") {
+    int produced = 0;
+    int consumed = 0;
+    auto producer = [&]() -> exec::async_generator<int> {
+      for (int i = 0; i < 5; ++i) {
+        ++produced;
+        co_yield i;
+      }
+    };
+    auto sndr = producer() | then_each([&](int) {
+                  ++consumed;
+                  CHECK(produced == consumed);
+                })
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(consumed == 5);
+  }
+
+  TEST_CASE("async_generator - can await senders", "[sequence_senders][async_generator]") {
+    exec::single_thread_context context;
+    auto producer = [](auto sched) -> exec::async_generator<std::thread::id> {
+      int x = co_await stdexec::just(1);
+      CHECK(x == 1);
+      co_yield std::this_thread::get_id();
+      co_await stdexec::schedule(sched);
+      co_yield std::this_thread::get_id();
+      co_yield std::this_thread::get_id();
+    };
+    std::vector<std::thread::id> ids;
+    auto sndr = producer(context.get_scheduler())
+              | then_each([&](std::thread::id id) { ids.push_back(id); })
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    REQUIRE(ids.size() == 3);
+    CHECK(ids[0] == std::this_thread::get_id());
+    CHECK(ids[1] == context.get_thread_id());
+    CHECK(ids[2] == context.get_thread_id());
+  }
+
+  TEST_CASE("async_generator - does not nest the items' stack frames", "[sequence_senders][async_generator]") {
+    long sum = 0;
+    auto sndr = count_to(100'000) | then_each([&](int i) noexcept { sum += i; })
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(sum == 5'000'050'000);
+  }
+
+  TEST_CASE("async_generator - forwards exceptions", "[sequence_senders][async_generator]") {
+    auto producer = []() -> exec::async_generator<int> {
+      co_yield 1;
+      throw std::runtime_error("oops");
+    };
+    int count = 0;
+    auto sndr = producer() | then_each([&](int) noexcept { ++count; })
+              | exec::ignore_all_values();
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+    CHECK(count == 1);
+  }
+
+  TEST_CASE("async_generator - stops when stop is requested", "[sequence_senders][async_generator]") {
+    stdexec::in_place_stop_source stop_source;
+    bool destroyed = false;
+    auto producer = [&]() -> exec::async_generator<int> {
+      exec::scope_guard guard{[&]() noexcept { destroyed = true; }};
+      for (int i = 0;; ++i) {
+        co_yield i;
+      }
+    };
+    int count = 0;
+    auto sndr = producer() | then_each([&](int) noexcept {
+                  if (++count == 3) {
+                    stop_source.request_stop();
+                  }
+                })
+              | exec::ignore_all_values()
+              | exec::write(exec::with(stdexec::get_stop_token, stop_source.get_token()));
+    CHECK_FALSE(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(count == 3);
+    CHECK(destroyed);
+  }
+
+  TEST_CASE("async_generator - stops when an awaited sender stops", "[sequence_senders][async_generator]") {
+    auto producer = []() -> exec::async_generator<int> {
+      co_yield 1;
+      co_await stdexec::just_stopped();
+      co_yield 2;
+    };
+    int count = 0;
+    auto sndr = producer() | then_each([&](int) noexcept { ++count; })
+              | exec::ignore_all_values();
+    CHECK_FALSE(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(count == 1);
+  }
+
+  exec::async_generator<int> allocated_count_to(
+    std::allocator_arg_t,
+    counting_allocator<int>,
+    int n) {
+    for (int i = 1; i <= n; ++i) {
+      co_yield i;
+    }
+  }
+
+  TEST_CASE("async_generator - allocates one frame per sequence", "[sequence_senders][async_generator]") {
+    allocation_counts counts;
+    int sum = 0;
+    auto sndr = allocated_count_to(std::allocator_arg, counting_allocator<int>{counts}, 10)
+              | then_each([&](int i) noexcept { sum += i; }) | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(sum == 55);
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
+}
+
+#endif // !STDEXEC_STD_NO_COROUTINES_
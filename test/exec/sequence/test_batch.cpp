@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/batch.hpp"
+
+#include "exec/sequence/channel.hpp"
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/sequence/iterate.hpp"
+#include "exec/sequence/transform_each.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <linux/version.h>
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 4, 0) && __has_include(<linux/io_uring.h>)
+#define STDEXEC_TEST_HAS_IO_URING 1
+#include "exec/linux/io_uring_context.hpp"
+#endif
+
+using namespace std::chrono_literals;
+
+namespace {
+
+  auto collect(std::vector<std::vector<int>>& out) {
+    return exec::transform_each(stdexec::then([&out](std::span<int> values) {
+      out.emplace_back(values.begin(), values.end());
+    }));
+  }
+
+#if STDEXEC_HAS_STD_RANGES()
+  TEST_CASE("window - passes on tumbling windows", "[sequence_senders][window][iterate]") {
+    std::vector<std::vector<int>> windows;
+    auto sndr = exec::iterate(std::views::iota(0, 7)) //
+              | exec::window(3)                        //
+              | collect(windows)                       //
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(windows == std::vector<std::vector<int>>{{0, 1, 2}, {3, 4, 5}});
+  }
+
+  TEST_CASE("window - passes on sliding windows", "[sequence_senders][window][iterate]") {
+    std::vector<std::vector<int>> windows;
+    auto sndr = exec::iterate(std::views::iota(0, 6)) //
+              | exec::window(3, 1)                     //
+              | collect(windows)                       //
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(windows == std::vector<std::vector<int>>{{0, 1, 2}, {1, 2, 3}, {2, 3, 4}, {3, 4, 5}});
+  }
+
+  TEST_CASE(
+    "window - skips values when the step exceeds the size",
+    "[sequence_senders][window][iterate]") {
+    std::vector<std::vector<int>> windows;
+    auto sndr = exec::iterate(std::views::iota(0, 10)) //
+              | exec::window(2, 4)                      //
+              | collect(windows)                        //
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(windows == std::vector<std::vector<int>>{{0, 1}, {4, 5}, {8, 9}});
+  }
+#endif
+
+#if STDEXEC_TEST_HAS_IO_URING
+  struct io_uring_fixture {
+    exec::io_uring_context context_;
+    std::thread thread_{[this] {
+      context_.run_until_stopped();
+    }};
+
+    ~io_uring_fixture() {
+      context_.request_stop();
+      thread_.join();
+    }
+  };
+
+#if STDEXEC_HAS_STD_RANGES()
+  TEST_CASE(
+    "batch - flushes full batches and the rest at the end",
+    "[sequence_senders][batch][iterate][io_uring]") {
+    io_uring_fixture io;
+    std::vector<std::vector<int>> batches;
+    auto sndr = exec::iterate(std::views::iota(0, 10))
+              | exec::batch(4, std::chrono::nanoseconds(1h), io.context_.get_scheduler())
+              | collect(batches) | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(batches == std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}});
+  }
+#endif
+
+  TEST_CASE(
+    "batch - flushes a partial batch after the delay",
+    "[sequence_senders][batch][channel][io_uring]") {
+    io_uring_fixture io;
+    exec::channel<int> ch{16};
+    std::vector<std::vector<int>> batches;
+    std::vector<std::chrono::steady_clock::time_point> times;
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+      stdexec::sync_wait(ch.send(1));
+      stdexec::sync_wait(ch.send(2));
+      std::this_thread::sleep_for(200ms);
+      ch.close();
+    });
+    auto sndr = ch.receive()
+              | exec::batch(100, std::chrono::nanoseconds(20ms), io.context_.get_scheduler())
+              | exec::transform_each(stdexec::then([&](std::span<int> values) {
+                  batches.emplace_back(values.begin(), values.end());
+                  times.push_back(std::chrono::steady_clock::now());
+                }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    producer.join();
+    REQUIRE(batches == std::vector<std::vector<int>>{{1, 2}});
+    // The batch was flushed by the timer rather than by close().
+    CHECK(times[0] - start < 150ms);
+  }
+
+  TEST_CASE(
+    "batch - passes on every value of concurrent producers",
+    "[sequence_senders][batch][channel][io_uring]") {
+    io_uring_fixture io;
+    constexpr int num_producers = 4;
+    constexpr int num_values = 5000;
+    exec::channel<int> ch{32};
+    std::atomic<long> total{0};
+    std::atomic<int> received{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+      producers.emplace_back([&ch] {
+        for (int i = 0; i < num_values; ++i) {
+          stdexec::sync_wait(ch.send(i));
+        }
+      });
+    }
+    std::thread closer([&] {
+      for (std::thread& t: producers) {
+        t.join();
+      }
+      ch.close();
+    });
+    auto sndr = ch.receive()
+              | exec::batch(64, std::chrono::nanoseconds(100us), io.context_.get_scheduler())
+              | exec::transform_each(stdexec::then([&](std::span<int> values) noexcept {
+                  for (int x: values) {
+                    total += x;
+                  }
+                  received += static_cast<int>(values.size());
+                }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    closer.join();
+    CHECK(received == num_producers * num_values);
+    CHECK(total == long{num_producers} * num_values * (num_values - 1) / 2);
+  }
+
+  TEST_CASE(
+    "batch - passes on one batch at a time and in order",
+    "[sequence_senders][batch][channel][io_uring]") {
+    io_uring_fixture io;
+    constexpr int num_values = 2000;
+    exec::channel<int> ch{32};
+    std::vector<int> values;
+    std::atomic<int> in_flight{0};
+    std::atomic<int> max_in_flight{0};
+    std::thread producer([&ch] {
+      for (int i = 0; i < num_values; ++i) {
+        stdexec::sync_wait(ch.send(i));
+        if (i % 64 == 0) {
+          std::this_thread::sleep_for(50us);
+        }
+      }
+      ch.close();
+    });
+    auto sndr = ch.receive()
+              | exec::batch(8, std::chrono::nanoseconds(20us), io.context_.get_scheduler())
+              | exec::transform_each(stdexec::then([&](std::span<int> batch) noexcept {
+                  int n = ++in_flight;
+                  int max = max_in_flight.load();
+                  while (n > max && !max_in_flight.compare_exchange_weak(max, n)) {
+                  }
+                  std::this_thread::sleep_for(10us);
+                  values.insert(values.end(), batch.begin(), batch.end());
+                  --in_flight;
+                }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    producer.join();
+    CHECK(max_in_flight == 1);
+    REQUIRE(values.size() == num_values);
+    CHECK(std::is_sorted(values.begin(), values.end()));
+  }
+#endif
+}
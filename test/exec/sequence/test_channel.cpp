@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/channel.hpp"
+
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/sequence/transform_each.hpp"
+#include "exec/async_scope.hpp"
+#include "exec/static_thread_pool.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  TEST_CASE("channel - receives the values that were sent", "[sequence_senders][channel]") {
+    exec::channel<int> ch{4};
+    CHECK(ch.capacity() == 4);
+    for (int i = 0; i < 4; ++i) {
+      CHECK(stdexec::sync_wait(ch.send(i)).has_value());
+    }
+    ch.close();
+    std::vector<int> values;
+    auto sndr = ch.receive()
+              | exec::transform_each(stdexec::then([&](int x) { values.push_back(x); }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(values == std::vector<int>{0, 1, 2, 3});
+  }
+
+  TEST_CASE("channel - moves values through the channel", "[sequence_senders][channel]") {
+    exec::channel<std::unique_ptr<int>> ch{1};
+    CHECK(stdexec::sync_wait(ch.send(std::make_unique<int>(42))).has_value());
+    ch.close();
+    int value = 0;
+    auto sndr = ch.receive()
+              | exec::transform_each(stdexec::then([&](std::unique_ptr<int> p) { value = *p; }))
+              | exec::ignore_all_values();
+    stdexec::sync_wait(std::move(sndr));
+    CHECK(value == 42);
+  }
+
+  TEST_CASE("channel - a send waits while the channel is full", "[sequence_senders][channel]") {
+    exec::channel<int> ch{1};
+    exec::async_scope scope;
+    bool sent = false;
+    stdexec::sync_wait(ch.send(1));
+    scope.spawn(ch.send(2) | stdexec::then([&] { sent = true; }));
+    CHECK_FALSE(sent);
+    std::vector<int> values;
+    scope.spawn(
+      ch.receive() //
+      | exec::transform_each(stdexec::then([&](int x) { values.push_back(x); }))
+      | exec::ignore_all_values());
+    CHECK(sent);
+    CHECK(values == std::vector<int>{1, 2});
+    ch.close();
+    stdexec::sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE(
+    "channel - close stops a send that waits for room",
+    "[sequence_senders][channel]") {
+    exec::channel<int> ch{1};
+    exec::async_scope scope;
+    bool stopped = false;
+    stdexec::sync_wait(ch.send(1));
+    scope.spawn(ch.send(2) | stdexec::upon_stopped([&] { stopped = true; }));
+    CHECK_FALSE(stopped);
+    ch.close();
+    CHECK(stopped);
+    stdexec::sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE(
+    "channel - a send that waits for room can be cancelled",
+    "[sequence_senders][channel]") {
+    exec::channel<int> ch{1};
+    exec::async_scope scope;
+    bool stopped = false;
+    stdexec::sync_wait(ch.send(1));
+    scope.spawn(ch.send(2) | stdexec::upon_stopped([&] { stopped = true; }));
+    CHECK_FALSE(stopped);
+    scope.request_stop();
+    CHECK(stopped);
+    stdexec::sync_wait(scope.on_empty());
+    ch.close();
+    int count = 0;
+    stdexec::sync_wait(
+      ch.receive() //
+      | exec::transform_each(stdexec::then([&](int) { ++count; })) | exec::ignore_all_values());
+    CHECK(count == 1);
+  }
+
+  TEST_CASE(
+    "channel - a waiting receive completes when the channel is closed",
+    "[sequence_senders][channel]") {
+    exec::channel<int> ch{2};
+    exec::async_scope scope;
+    bool done = false;
+    scope.spawn(ch.receive() | exec::ignore_all_values() | stdexec::then([&] { done = true; }));
+    CHECK_FALSE(done);
+    ch.close();
+    CHECK(done);
+    stdexec::sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE(
+    "channel - a waiting receive can be cancelled",
+    "[sequence_senders][channel]") {
+    exec::channel<int> ch{2};
+    exec::async_scope scope;
+    bool stopped = false;
+    scope.spawn(
+      ch.receive() | exec::ignore_all_values() | stdexec::upon_stopped([&] { stopped = true; }));
+    CHECK_FALSE(stopped);
+    scope.request_stop();
+    CHECK(stopped);
+    stdexec::sync_wait(scope.on_empty());
+  }
+
+  TEST_CASE(
+    "channel - many producers and consumers share the values",
+    "[sequence_senders][channel][static_thread_pool]") {
+    constexpr int num_producers = 4;
+    constexpr int num_consumers = 4;
+    constexpr int num_values = 10000;
+    exec::static_thread_pool pool{8};
+    exec::channel<int> ch{16};
+    std::atomic<long> total{0};
+    std::atomic<int> received{0};
+    exec::async_scope scope;
+    for (int c = 0; c < num_consumers; ++c) {
+      scope.spawn(stdexec::on(
+        pool.get_scheduler(),
+        ch.receive() //
+          | exec::transform_each(stdexec::then([&](int x) noexcept {
+              total += x;
+              ++received;
+            }))
+          | exec::ignore_all_values()));
+    }
+    std::vector<std::thread> producers;
+    for (int p = 0; p < num_producers; ++p) {
+      producers.emplace_back([&ch, p] {
+        for (int i = 0; i < num_values; ++i) {
+          stdexec::sync_wait(ch.send(p + i));
+        }
+      });
+    }
+    for (std::thread& t: producers) {
+      t.join();
+    }
+    ch.close();
+    stdexec::sync_wait(scope.on_empty());
+    long expected = 0;
+    for (int p = 0; p < num_producers; ++p) {
+      for (int i = 0; i < num_values; ++i) {
+        expected += p + i;
+      }
+    }
+    CHECK(received == num_producers * num_values);
+    CHECK(total == expected);
+  }
+}
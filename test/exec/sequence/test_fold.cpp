@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/fold.hpp"
+
+#include "exec/sequence/empty_sequence.hpp"
+#include "exec/sequence/iterate.hpp"
+#include "exec/sequence/merge.hpp"
+#include "exec/sequence/par_transform_each.hpp"
+#include "exec/static_thread_pool.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+  TEST_CASE("fold - of an empty sequence sends init", "[sequence_senders][fold][empty_sequence]") {
+    auto sndr = exec::fold(exec::empty_sequence(), 42, [](int acc, int x) { return acc + x; });
+    auto [result] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(result == 42);
+  }
+
+#if STDEXEC_HAS_STD_RANGES()
+  TEST_CASE("fold - folds the values in order", "[sequence_senders][fold][iterate]") {
+    auto sndr = exec::iterate(std::views::iota(0, 5))
+              | exec::fold(std::string{}, [](std::string acc, int x) {
+                  return acc + std::to_string(x);
+                });
+    auto [result] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(result == "01234");
+  }
+
+  TEST_CASE("fold - forwards an exception of the function", "[sequence_senders][fold][iterate]") {
+    int calls = 0;
+    auto sndr = exec::iterate(std::views::iota(0, 5)) | exec::fold(0, [&](int acc, int x) {
+                  ++calls;
+                  if (x == 2) {
+                    throw std::runtime_error("2");
+                  }
+                  return acc + x;
+                });
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+    CHECK(calls == 3);
+  }
+
+  TEST_CASE("fold - forwards an error of a sequence", "[sequence_senders][fold][merge]") {
+    auto sndr = exec::merge(
+                  exec::iterate(std::views::iota(0, 3)),
+                  stdexec::just_error(std::runtime_error("error")))
+              | exec::fold(0, [](int acc, int x) { return acc + x; });
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+  }
+
+  TEST_CASE(
+    "reduce_each - combines the partial results of all threads",
+    "[sequence_senders][reduce_each][iterate][static_thread_pool]") {
+    exec::static_thread_pool pool{4};
+    auto sched = pool.get_scheduler();
+    constexpr long n = 10000;
+    auto sndr = exec::iterate(std::views::iota(0L, n))
+              | exec::par_transform_each(sched, stdexec::then([](long x) { return 2 * x; }), 64)
+              | exec::reduce_each(0L, [](long acc, long x) { return acc + x; }, sched);
+    auto [result] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(result == n * (n - 1));
+  }
+
+  TEST_CASE(
+    "reduce_each - forwards an exception of the function",
+    "[sequence_senders][reduce_each][iterate][static_thread_pool]") {
+    exec::static_thread_pool pool{2};
+    auto sndr = exec::iterate(std::views::iota(0, 100))
+              | exec::reduce_each(
+                  0,
+                  [](int acc, int x) {
+                    if (x == 50) {
+                      throw std::runtime_error("50");
+                    }
+                    return acc + x;
+                  },
+                  pool.get_scheduler());
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+  }
+
+  // Counts the partial accumulators that were combined into the result.
+  struct counted_sum {
+    long value;
+    int partials;
+  };
+
+  struct add_counted {
+    counted_sum operator()(counted_sum acc, long x) const noexcept {
+      return {acc.value + x, 1};
+    }
+
+    counted_sum operator()(counted_sum acc, counted_sum partial) const noexcept {
+      return {acc.value + partial.value, acc.partials + partial.partials};
+    }
+  };
+
+  TEST_CASE(
+    "reduce_each - a thread keeps its partial result in operations that it alternates between",
+    "[sequence_senders][reduce_each][iterate][run_loop]") {
+    // The run loop runs the items of both operations in turn on this thread.
+    stdexec::run_loop loop;
+    auto sched = loop.get_scheduler();
+    constexpr long n = 1000;
+    auto reduce = [&] {
+      return exec::iterate(std::views::iota(0L, n))
+           | exec::reduce_each(counted_sum{0, 0}, add_counted{}, sched);
+    };
+    counted_sum a{}, b{};
+    stdexec::start_detached(
+      stdexec::when_all(reduce(), reduce()) | stdexec::then([&](counted_sum x, counted_sum y) {
+        a = x;
+        b = y;
+        loop.finish();
+      }));
+    loop.run();
+    CHECK(a.value == n * (n - 1) / 2);
+    CHECK(b.value == n * (n - 1) / 2);
+    CHECK(a.partials == 1);
+    CHECK(b.partials == 1);
+  }
+#endif
+
+  TEST_CASE(
+    "reduce_each - of an empty sequence sends the identity",
+    "[sequence_senders][reduce_each][empty_sequence]") {
+    exec::static_thread_pool pool{2};
+    auto sndr = exec::reduce_each(
+      exec::empty_sequence(), 1, [](int acc, int x) { return acc * x; }, pool.get_scheduler());
+    auto [result] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(result == 1);
+  }
+}
@@ -16,6 +16,9 @@
  */
 
 #include "exec/sequence/iterate.hpp"
+#include "exec/sequence/fold.hpp"
+#include "exec/sequence/par_transform_each.hpp"
+#include "exec/static_thread_pool.hpp"
 #include "stdexec/execution.hpp"
 
 #if STDEXEC_HAS_STD_RANGES()
@@ -23,6 +26,8 @@
 #include <array>
 #include <catch2/catch.hpp>
 #include <numeric>
+#include <span>
+#include <vector>
 
 namespace {
 
@@ -132,6 +137,47 @@ namespace {
     CHECK(sum == (42 + 43 + 44 + 1));
   }
 
+  TEST_CASE(
+    "iterate_chunks - passes on spans of a contiguous range",
+    "[sequence_senders][iterate]") {
+    std::vector<int> values(10);
+    std::iota(values.begin(), values.end(), 0);
+    auto sndr = exec::iterate_chunks(std::span{values}, 4)
+              | exec::fold(std::vector<std::vector<int>>{}, [](auto chunks, std::span<int> chunk) {
+                  chunks.emplace_back(chunk.begin(), chunk.end());
+                  return chunks;
+                });
+    auto [chunks] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(chunks == std::vector<std::vector<int>>{{0, 1, 2, 3}, {4, 5, 6, 7}, {8, 9}});
+  }
+
+  TEST_CASE(
+    "iterate_chunks - passes on subranges of a random access range",
+    "[sequence_senders][iterate]") {
+    auto sndr = exec::iterate_chunks(std::views::iota(0, 7), 3)
+              | exec::fold(std::vector<int>{}, [](std::vector<int> sums, auto chunk) {
+                  sums.push_back(std::accumulate(chunk.begin(), chunk.end(), 0));
+                  return sums;
+                });
+    auto [sums] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(sums == std::vector<int>{0 + 1 + 2, 3 + 4 + 5, 6});
+  }
+
+  TEST_CASE(
+    "iterate_chunks - chunks can be processed in parallel",
+    "[sequence_senders][iterate][par_transform_each][static_thread_pool]") {
+    exec::static_thread_pool pool{4};
+    std::vector<long> values(100000);
+    std::iota(values.begin(), values.end(), 0L);
+    auto sum_chunk = stdexec::then([](std::span<long> chunk) {
+      return std::accumulate(chunk.begin(), chunk.end(), 0L);
+    });
+    auto sndr = exec::iterate_chunks(std::span{values}, 1024)
+              | exec::par_transform_each(pool.get_scheduler(), sum_chunk, 8)
+              | exec::fold(0L, [](long acc, long x) { return acc + x; });
+    auto [sum] = stdexec::sync_wait(std::move(sndr)).value();
+    CHECK(sum == 100000L * 99999L / 2);
+  }
 }
 
 #endif // STDEXEC_HAS_STD_RANGES()
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/merge.hpp"
+
+#include "exec/sequence/channel.hpp"
+#include "exec/sequence/empty_sequence.hpp"
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/sequence/iterate.hpp"
+#include "exec/sequence/transform_each.hpp"
+#include "exec/env.hpp"
+#include "exec/static_thread_pool.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // A sequence receiver that accepts at most max_in_flight items at a time
+  // and records how many items it was passed at once.
+  struct limited_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    struct state {
+      std::size_t max_in_flight;
+      std::atomic<int> in_flight{0};
+      std::atomic<int> peak{0};
+      std::atomic<int> count{0};
+      std::atomic<bool> done{false};
+    };
+
+    state* state_;
+    exec::static_thread_pool::scheduler sched_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, limited_receiver& self, Item&& item) {
+      return stdexec::on(self.sched_, static_cast<Item&&>(item))
+           | stdexec::then([st = self.state_](auto&&...) noexcept {
+               int n = ++st->in_flight;
+               int peak = st->peak.load();
+               while (n > peak && !st->peak.compare_exchange_weak(peak, n)) {
+               }
+               std::this_thread::sleep_for(std::chrono::microseconds(200));
+               --st->in_flight;
+               ++st->count;
+             })
+           | stdexec::upon_error([](auto&&) noexcept {});
+    }
+
+    template <class Tag>
+      requires stdexec::__one_of<Tag, stdexec::set_value_t, stdexec::set_stopped_t>
+    friend void tag_invoke(Tag, limited_receiver&& self) noexcept {
+      self.state_->done = true;
+      self.state_->done.notify_one();
+    }
+
+    friend void tag_invoke(stdexec::set_error_t, limited_receiver&&, std::exception_ptr) noexcept {
+      std::terminate();
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t, const limited_receiver& self) noexcept {
+      return exec::make_env(exec::with(exec::get_max_in_flight, self.state_->max_in_flight));
+    }
+  };
+
+  // A sequence receiver that accepts one item at a time. The first item is
+  // held until release_first() is called, all others complete inline.
+  struct hold_first_receiver {
+    using receiver_concept = stdexec::receiver_t;
+
+    struct state {
+      void (*complete_)(void*) noexcept = nullptr;
+      void* op_ = nullptr;
+      int count = 0;
+      bool done = false;
+
+      void release_first() noexcept {
+        complete_(op_);
+      }
+    };
+
+    struct gate_sender {
+      using sender_concept = stdexec::sender_t;
+      using completion_signatures = stdexec::completion_signatures<stdexec::set_value_t()>;
+
+      template <class Receiver>
+      struct operation {
+        Receiver rcvr_;
+        state* state_;
+
+        friend void tag_invoke(stdexec::start_t, operation& self) noexcept {
+          if (self.state_->op_ != nullptr) {
+            stdexec::set_value(static_cast<Receiver&&>(self.rcvr_));
+            return;
+          }
+          self.state_->op_ = &self;
+          self.state_->complete_ = [](void* op) noexcept {
+            stdexec::set_value(static_cast<Receiver&&>(static_cast<operation*>(op)->rcvr_));
+          };
+        }
+      };
+
+      template <stdexec::receiver Receiver>
+      friend operation<Receiver> tag_invoke(stdexec::connect_t, gate_sender self, Receiver rcvr) {
+        return {static_cast<Receiver&&>(rcvr), self.state_};
+      }
+
+      state* state_;
+    };
+
+    state* state_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, hold_first_receiver& self, Item&& item) {
+      return stdexec::let_value(
+        gate_sender{self.state_},
+        [st = self.state_, item = static_cast<Item&&>(item)]() mutable {
+          ++st->count;
+          return static_cast<Item&&>(item);
+        })
+           | stdexec::then([](auto&&...) noexcept {})
+           | stdexec::upon_error([](auto&&) noexcept {});
+    }
+
+    template <class Tag>
+      requires stdexec::__one_of<Tag, stdexec::set_value_t, stdexec::set_stopped_t>
+    friend void tag_invoke(Tag, hold_first_receiver&& self) noexcept {
+      self.state_->done = true;
+    }
+
+    friend void
+      tag_invoke(stdexec::set_error_t, hold_first_receiver&&, std::exception_ptr) noexcept {
+      std::terminate();
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t, const hold_first_receiver&) noexcept {
+      return exec::make_env(exec::with(exec::get_max_in_flight, std::size_t{1}));
+    }
+  };
+
+  // A sequence of a single just() item that is passed on inline, without the
+  // trampoline that iterate() uses.
+  struct single_sequence {
+    using sender_concept = exec::sequence_sender_t;
+    using completion_signatures = stdexec::completion_signatures<stdexec::set_value_t()>;
+    using item_types = exec::item_types<decltype(stdexec::just())>;
+
+    template <class Receiver>
+    struct operation {
+      struct next_receiver {
+        using receiver_concept = stdexec::receiver_t;
+        operation* op_;
+
+        template <class Tag>
+          requires stdexec::__one_of<Tag, stdexec::set_value_t, stdexec::set_stopped_t>
+        friend void tag_invoke(Tag, next_receiver&& self) noexcept {
+          stdexec::set_value(static_cast<Receiver&&>(self.op_->rcvr_));
+        }
+
+        friend stdexec::env_of_t<Receiver>
+          tag_invoke(stdexec::get_env_t, const next_receiver& self) noexcept {
+          return stdexec::get_env(self.op_->rcvr_);
+        }
+      };
+
+      using next_t = exec::next_sender_of_t<Receiver, decltype(stdexec::just())>;
+
+      explicit operation(Receiver rcvr)
+        : rcvr_(static_cast<Receiver&&>(rcvr))
+        , op_(stdexec::connect(exec::set_next(rcvr_, stdexec::just()), next_receiver{this})) {
+      }
+
+      friend void tag_invoke(stdexec::start_t, operation& self) noexcept {
+        stdexec::start(self.op_);
+      }
+
+      Receiver rcvr_;
+      stdexec::connect_result_t<next_t, next_receiver> op_;
+    };
+
+    template <class Receiver>
+    friend operation<Receiver> tag_invoke(exec::subscribe_t, single_sequence, Receiver rcvr) {
+      return operation<Receiver>{static_cast<Receiver&&>(rcvr)};
+    }
+  };
+
+  TEST_CASE("merge - of empty sequences completes", "[sequence_senders][merge][empty_sequence]") {
+    auto sndr = exec::merge(exec::empty_sequence(), exec::empty_sequence())
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+  }
+
+#if STDEXEC_HAS_STD_RANGES()
+  TEST_CASE("merge - passes on the items of all sequences", "[sequence_senders][merge][iterate]") {
+    std::vector<int> values;
+    auto sndr = exec::merge(
+                  exec::iterate(std::views::iota(0, 3)), exec::iterate(std::views::iota(10, 13)))
+              | exec::transform_each(stdexec::then([&](int x) { values.push_back(x); }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    std::sort(values.begin(), values.end());
+    CHECK(values == std::vector<int>{0, 1, 2, 10, 11, 12});
+  }
+
+  TEST_CASE("merge - forwards an error of a sequence", "[sequence_senders][merge][iterate]") {
+    auto sndr = exec::merge(
+                  exec::iterate(std::views::iota(0, 3)),
+                  stdexec::just_error(std::runtime_error("error")))
+              | exec::ignore_all_values();
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+  }
+
+  TEST_CASE(
+    "merge_each - passes on the items of all inner sequences",
+    "[sequence_senders][merge_each][iterate]") {
+    using inner_t = decltype(exec::iterate(std::views::iota(0, 1)));
+    std::vector<inner_t> inner{
+      exec::iterate(std::views::iota(0, 3)),
+      exec::iterate(std::views::iota(10, 12)),
+      exec::iterate(std::views::iota(20, 21))};
+    std::vector<int> values;
+    auto sndr = exec::iterate(std::views::all(inner)) //
+              | exec::merge_each()
+              | exec::transform_each(stdexec::then([&](int x) { values.push_back(x); }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    std::sort(values.begin(), values.end());
+    CHECK(values == std::vector<int>{0, 1, 2, 10, 11, 20});
+  }
+
+  TEST_CASE(
+    "merge_each - hands a credit over to many waiting items without recursion",
+    "[sequence_senders][merge_each][iterate]") {
+    constexpr int num_sequences = 100000;
+    hold_first_receiver::state state;
+    std::vector<single_sequence> inner(num_sequences);
+    auto sndr = exec::iterate(std::views::all(inner)) | exec::merge_each();
+    auto op = exec::subscribe(std::move(sndr), hold_first_receiver{&state});
+    stdexec::start(op);
+    // The first item is held and all others wait for its credit.
+    CHECK(state.count == 0);
+    state.release_first();
+    CHECK(state.count == num_sequences);
+    CHECK(state.done);
+  }
+
+  TEST_CASE(
+    "merge_each - merges channels that are received concurrently",
+    "[sequence_senders][merge_each][channel]") {
+    constexpr int num_channels = 4;
+    constexpr int num_values = 10000;
+    std::vector<std::unique_ptr<exec::channel<int>>> channels;
+    std::vector<exec::channel<int>::receive_sender> receivers;
+    for (int c = 0; c < num_channels; ++c) {
+      channels.push_back(std::make_unique<exec::channel<int>>(8));
+      receivers.push_back(channels.back()->receive());
+    }
+    std::vector<std::thread> producers;
+    for (int c = 0; c < num_channels; ++c) {
+      producers.emplace_back([&ch = *channels[c]] {
+        for (int i = 0; i < num_values; ++i) {
+          stdexec::sync_wait(ch.send(1));
+        }
+        ch.close();
+      });
+    }
+    std::atomic<int> received{0};
+    auto sndr = exec::iterate(std::views::all(receivers)) //
+              | exec::merge_each()
+              | exec::transform_each(stdexec::then([&](int x) noexcept { received += x; }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    for (std::thread& t: producers) {
+      t.join();
+    }
+    CHECK(received == num_channels * num_values);
+  }
+
+  TEST_CASE(
+    "merge - passes on no more items at a time than downstream accepts",
+    "[sequence_senders][merge][iterate][static_thread_pool]") {
+    exec::static_thread_pool pool{4};
+    limited_receiver::state state{2};
+    auto sndr = exec::merge(
+      exec::iterate(std::views::iota(0, 20)),
+      exec::iterate(std::views::iota(0, 20)),
+      exec::iterate(std::views::iota(0, 20)),
+      exec::iterate(std::views::iota(0, 20)));
+    auto op = exec::subscribe(std::move(sndr), limited_receiver{&state, pool.get_scheduler()});
+    stdexec::start(op);
+    state.done.wait(false);
+    CHECK(state.count == 80);
+    CHECK(state.peak <= 2);
+  }
+#endif
+
+  TEST_CASE(
+    "merge - interleaves items that arrive concurrently",
+    "[sequence_senders][merge][channel]") {
+    constexpr int num_values = 20000;
+    std::array<exec::channel<int>, 3> channels{
+      exec::channel<int>{8}, exec::channel<int>{8}, exec::channel<int>{8}};
+    std::atomic<long> total{0};
+    std::atomic<int> received{0};
+    std::vector<std::thread> producers;
+    for (int c = 0; c < 3; ++c) {
+      producers.emplace_back([&ch = channels[c], c] {
+        for (int i = 0; i < num_values; ++i) {
+          stdexec::sync_wait(ch.send(c * num_values + i));
+        }
+        ch.close();
+      });
+    }
+    auto sndr = exec::merge(channels[0].receive(), channels[1].receive(), channels[2].receive())
+              | exec::transform_each(stdexec::then([&](int x) noexcept {
+                  total += x;
+                  ++received;
+                }))
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    for (std::thread& t: producers) {
+      t.join();
+    }
+    const long n = 3L * num_values;
+    CHECK(received == n);
+    CHECK(total == n * (n - 1) / 2);
+  }
+
+  TEST_CASE(
+    "merge - stops all sequences when downstream stops",
+    "[sequence_senders][merge][channel]") {
+    exec::channel<int> idle{1};
+    exec::channel<int> busy{4};
+    std::thread producer([&] {
+      for (int i = 0; i < 10; ++i) {
+        stdexec::sync_wait(busy.send(i));
+      }
+    });
+    auto sndr = exec::merge(idle.receive(), busy.receive())
+              | exec::transform_each(stdexec::then([](int x) {
+                  if (x == 5) {
+                    throw std::runtime_error("5");
+                  }
+                }))
+              | exec::ignore_all_values();
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+    busy.close();
+    producer.join();
+  }
+}
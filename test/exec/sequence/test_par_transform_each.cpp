@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "exec/sequence/par_transform_each.hpp"
+
+#include "exec/sequence/empty_sequence.hpp"
+#include "exec/sequence/ignore_all_values.hpp"
+#include "exec/sequence/iterate.hpp"
+#include "exec/sequence/transform_each.hpp"
+#include "exec/env.hpp"
+#include "exec/static_thread_pool.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+  // A sequence receiver that accepts at most max_in_flight items at a time.
+  struct limited_receiver {
+    using receiver_concept = stdexec::receiver_t;
+    std::size_t max_in_flight_;
+    std::atomic<bool>* done_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, limited_receiver&, Item&& item) {
+      return static_cast<Item&&>(item) | stdexec::upon_error([](auto&&) noexcept {});
+    }
+
+    template <class Tag>
+      requires stdexec::__one_of<Tag, stdexec::set_value_t, stdexec::set_stopped_t>
+    friend void tag_invoke(Tag, limited_receiver&& self) noexcept {
+      *self.done_ = true;
+      self.done_->notify_one();
+    }
+
+    friend void tag_invoke(stdexec::set_error_t, limited_receiver&&, std::exception_ptr) noexcept {
+      std::terminate();
+    }
+
+    friend auto tag_invoke(stdexec::get_env_t, const limited_receiver& self) noexcept {
+      return exec::make_env(exec::with(exec::get_max_in_flight, self.max_in_flight_));
+    }
+  };
+
+  TEST_CASE(
+    "par_transform_each - completes an empty sequence",
+    "[sequence_senders][par_transform_each][empty_sequence]") {
+    exec::static_thread_pool pool{2};
+    int counter = 0;
+    auto sndr = exec::empty_sequence()
+              | exec::par_transform_each(
+                  pool.get_scheduler(), stdexec::then([&counter]() noexcept { ++counter; }), 4)
+              | exec::ignore_all_values();
+    CHECK(stdexec::sync_wait(std::move(sndr)).has_value());
+    CHECK(counter == 0);
+  }
+
+#if STDEXEC_HAS_STD_RANGES()
+  TEST_CASE(
+    "par_transform_each - transforms every item on the scheduler",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    std::atomic<int> total{0};
+    std::atomic<int> on_main{0};
+    const auto main_id = std::this_thread::get_id();
+    auto sndr = exec::iterate(std::views::iota(0, 1000))
+              | exec::par_transform_each(
+                  pool.get_scheduler(),
+                  stdexec::then([&](int x) noexcept {
+                    if (std::this_thread::get_id() == main_id) {
+                      ++on_main;
+                    }
+                    total += x;
+                  }),
+                  8)
+              | exec::ignore_all_values();
+    stdexec::sync_wait(std::move(sndr));
+    CHECK(total == 499500);
+    CHECK(on_main == 0);
+  }
+
+  TEST_CASE(
+    "par_transform_each - runs at most max_in_flight items at a time",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::atomic<int> count{0};
+    auto sndr = exec::iterate(std::views::iota(0, 64))
+              | exec::par_transform_each(
+                  pool.get_scheduler(),
+                  stdexec::then([&](int) noexcept {
+                    int now = ++running;
+                    int prev = max_running.load();
+                    while (prev < now && !max_running.compare_exchange_weak(prev, now)) {
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    --running;
+                    ++count;
+                  }),
+                  2)
+              | exec::ignore_all_values();
+    stdexec::sync_wait(std::move(sndr));
+    CHECK(count == 64);
+    CHECK(max_running <= 2);
+  }
+
+  TEST_CASE(
+    "par_transform_each - runs no more items at a time than downstream accepts",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    std::atomic<int> running{0};
+    std::atomic<int> max_running{0};
+    std::atomic<int> count{0};
+    std::atomic<bool> done{false};
+    auto sndr = exec::iterate(std::views::iota(0, 64))
+              | exec::par_transform_each(
+                  pool.get_scheduler(),
+                  stdexec::then([&](int) noexcept {
+                    int now = ++running;
+                    int prev = max_running.load();
+                    while (prev < now && !max_running.compare_exchange_weak(prev, now)) {
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                    --running;
+                    ++count;
+                  }),
+                  8);
+    auto op = exec::subscribe(std::move(sndr), limited_receiver{2, &done});
+    stdexec::start(op);
+    done.wait(false);
+    CHECK(count == 64);
+    CHECK(max_running <= 2);
+  }
+
+  TEST_CASE(
+    "par_transform_each - forwards an error of a transformation",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    auto sndr = exec::iterate(std::views::iota(0, 100))
+              | exec::par_transform_each(
+                  pool.get_scheduler(),
+                  stdexec::then([](int x) {
+                    if (x == 42) {
+                      throw std::runtime_error("42");
+                    }
+                  }),
+                  4)
+              | exec::ignore_all_values();
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+  }
+
+  TEST_CASE(
+    "par_transform_each_ordered - passes results downstream in order",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    std::vector<int> results;
+    auto sndr = exec::iterate(std::views::iota(0, 200))
+              | exec::par_transform_each_ordered(
+                  pool.get_scheduler(),
+                  stdexec::then([](int x) noexcept {
+                    // Let later items overtake earlier ones.
+                    std::this_thread::sleep_for(std::chrono::microseconds((x * 37) % 50));
+                    return 2 * x;
+                  }),
+                  8)
+              | exec::transform_each(stdexec::then([&](int x) { results.push_back(x); }))
+              | exec::ignore_all_values();
+    stdexec::sync_wait(std::move(sndr));
+    REQUIRE(results.size() == 200);
+    for (int i = 0; i < 200; ++i) {
+      CHECK(results[i] == 2 * i);
+    }
+  }
+
+  TEST_CASE(
+    "par_transform_each_ordered - forwards an error of a transformation",
+    "[sequence_senders][par_transform_each][iterate]") {
+    exec::static_thread_pool pool{4};
+    auto sndr = exec::iterate(std::views::iota(0, 100))
+              | exec::par_transform_each_ordered(
+                  pool.get_scheduler(),
+                  stdexec::then([](int x) {
+                    if (x == 42) {
+                      throw std::runtime_error("42");
+                    }
+                    return x;
+                  }),
+                  4)
+              | exec::ignore_all_values();
+    CHECK_THROWS_AS(stdexec::sync_wait(std::move(sndr)), std::runtime_error);
+  }
+#endif
+}
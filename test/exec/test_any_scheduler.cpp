@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/any_scheduler.hpp>
+#include <exec/env.hpp>
+#include <exec/inline_scheduler.hpp>
+#include <exec/static_thread_pool.hpp>
+#include <test_common/receivers.hpp>
+#include <test_common/schedulers.hpp>
+#include <test_common/type_helpers.hpp>
+
+#if __has_include(<linux/io_uring.h>)
+#include <exec/linux/io_uring_context.hpp>
+#endif
+
+namespace ex = stdexec;
+
+namespace {
+  struct get_name_t : ex::__query<get_name_t> {
+    template <class T>
+      requires ex::tag_invocable<get_name_t, const T&>
+    auto operator()(const T& t) const noexcept -> ex::tag_invoke_result_t<get_name_t, const T&> {
+      return ex::tag_invoke(*this, t);
+    }
+  };
+
+  inline constexpr get_name_t get_name{};
+
+  // An inline scheduler that has a name.
+  struct named_scheduler {
+    template <class R>
+    struct operation {
+      R rcvr_;
+
+      friend void tag_invoke(ex::start_t, operation& self) noexcept {
+        ex::set_value(std::move(self.rcvr_));
+      }
+    };
+
+    struct sender {
+      using sender_concept = ex::sender_t;
+      using completion_signatures = ex::completion_signatures<ex::set_value_t()>;
+
+      template <class R>
+      friend operation<R> tag_invoke(ex::connect_t, sender, R rcvr) {
+        return {std::move(rcvr)};
+      }
+
+      friend scheduler_env<named_scheduler> tag_invoke(ex::get_env_t, const sender&) noexcept {
+        return {};
+      }
+    };
+
+    friend sender tag_invoke(ex::schedule_t, const named_scheduler&) noexcept {
+      return {};
+    }
+
+    friend int tag_invoke(get_name_t, const named_scheduler& self) noexcept {
+      return self.name_;
+    }
+
+    bool operator==(const named_scheduler&) const noexcept = default;
+
+    int name_ = 7;
+  };
+
+  template <class Scheduler>
+  constexpr bool schedules_inline =
+    exec::__any_sched::__fits_inline<exec::__any_sched::__schedule_op_t<Scheduler>>;
+
+  TEST_CASE("any_scheduler is a scheduler", "[types][any_scheduler]") {
+    STATIC_REQUIRE(ex::scheduler<exec::any_scheduler<>>);
+    exec::any_scheduler<> sched = exec::inline_scheduler{};
+    auto snd = ex::schedule(sched);
+    check_val_types<type_array<type_array<>>>(snd);
+    check_err_types<type_array<std::exception_ptr>>(snd);
+    check_sends_stopped<true>(snd);
+    CHECK(ex::get_completion_scheduler<ex::set_value_t>(ex::get_env(snd)) == sched);
+  }
+
+  TEST_CASE("any_scheduler compares the erased schedulers", "[types][any_scheduler]") {
+    ex::run_loop loop1;
+    ex::run_loop loop2;
+    exec::any_scheduler<> sched1 = loop1.get_scheduler();
+    exec::any_scheduler<> sched2 = loop1.get_scheduler();
+    exec::any_scheduler<> sched3 = loop2.get_scheduler();
+    exec::any_scheduler<> sched4 = exec::inline_scheduler{};
+    CHECK(sched1 == sched2);
+    CHECK(sched1 != sched3);
+    CHECK(sched1 != sched4);
+  }
+
+  TEST_CASE("any_scheduler stores and schedules common schedulers inline", "[types][any_scheduler]") {
+    STATIC_REQUIRE(sizeof(exec::static_thread_pool::scheduler) <= exec::__any_sched::__inline_size);
+    STATIC_REQUIRE(schedules_inline<exec::static_thread_pool::scheduler>);
+    STATIC_REQUIRE(schedules_inline<decltype(std::declval<ex::run_loop&>().get_scheduler())>);
+    STATIC_REQUIRE(schedules_inline<exec::inline_scheduler>);
+#if __has_include(<linux/io_uring.h>)
+    STATIC_REQUIRE(schedules_inline<exec::io_uring_scheduler>);
+#endif
+  }
+
+  TEST_CASE("any_scheduler schedules on a static_thread_pool", "[types][any_scheduler]") {
+    exec::static_thread_pool pool{2};
+    exec::any_scheduler<> sched = pool.get_scheduler();
+    auto [id] = ex::sync_wait(ex::schedule(sched) | ex::then([] {
+                                return std::this_thread::get_id();
+                              })).value();
+    CHECK(id != std::this_thread::get_id());
+    auto [value] = ex::sync_wait(ex::on(sched, ex::just(42))).value();
+    CHECK(value == 42);
+  }
+
+  TEST_CASE("any_scheduler schedules on a run_loop", "[types][any_scheduler]") {
+    ex::run_loop loop;
+    exec::any_scheduler<> sched = loop.get_scheduler();
+    bool called = false;
+    auto op = ex::connect(
+      ex::schedule(sched) | ex::then([&] { called = true; }), expect_void_receiver{});
+    ex::start(op);
+    CHECK_FALSE(called);
+    loop.finish();
+    loop.run();
+    CHECK(called);
+  }
+
+  TEST_CASE("any_scheduler forwards stop requests", "[types][any_scheduler]") {
+    exec::static_thread_pool pool{1};
+    exec::any_scheduler<> sched = pool.get_scheduler();
+    ex::in_place_stop_source stop_source;
+    stop_source.request_stop();
+    auto env = exec::make_env(exec::with(ex::get_stop_token, stop_source.get_token()));
+    CHECK_FALSE(ex::sync_wait(ex::schedule(sched) | ex::let_value([&] {
+                                 return ex::just();
+                               }) | exec::write(env))
+                  .has_value());
+  }
+
+  TEST_CASE("any_scheduler forwards errors as exception_ptr", "[types][any_scheduler]") {
+    exec::any_scheduler<> sched = error_scheduler<int>{42};
+    auto op = ex::connect(ex::schedule(sched), expect_error_receiver{});
+    ex::start(op);
+  }
+
+  TEST_CASE("any_scheduler forwards queries", "[types][any_scheduler]") {
+    ex::run_loop loop;
+    exec::any_scheduler<> sched = loop.get_scheduler();
+    CHECK(
+      ex::get_forward_progress_guarantee(sched)
+      == ex::get_forward_progress_guarantee(loop.get_scheduler()));
+
+    exec::any_scheduler<get_name.signature<int()>> named = named_scheduler{};
+    CHECK(get_name(named) == 7);
+  }
+}
@@ -15,15 +15,20 @@
  */
 
 #include <exec/any_sender_of.hpp>
+#include <exec/env.hpp>
 #include <exec/inline_scheduler.hpp>
 #include <exec/when_any.hpp>
 #include <exec/static_thread_pool.hpp>
 
+#include <test_common/allocators.hpp>
 #include <test_common/schedulers.hpp>
 #include <test_common/receivers.hpp>
 
 #include <catch2/catch.hpp>
 
+#include <optional>
+#include <thread>
+
 
 using namespace stdexec;
 using namespace exec;
@@ -298,6 +303,88 @@ namespace {
     CHECK_THROWS_AS(sync_wait(std::move(sender)), int);
   }
 
+  template <std::size_t InlineSize, class... Ts>
+  using sized_sender_of = typename any_receiver_ref<
+    completion_signatures<Ts...>>::template basic_any_sender<InlineSize>;
+
+  TEST_CASE("any_sender allocates operation states with the receiver's allocator", "[types][any_sender]") {
+    allocation_counts counts;
+    auto env = exec::make_env(exec::with(get_allocator, counting_allocator<std::byte>{counts}));
+    any_sender_of<set_value_t(int)> sender = just(21) | then([](int v) noexcept { return 2 * v; });
+    {
+      auto op = connect(std::move(sender), expect_value_receiver{env_tag{}, std::move(env), 42});
+      CHECK(counts.allocations == 1);
+      start(op);
+    }
+    CHECK(counts.deallocations == 1);
+  }
+
+  // Records the address of its operation state when it is started. The
+  // operation state is too large to be stored inline in an any_sender.
+  struct address_sender {
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = stdexec::completion_signatures<set_value_t()>;
+
+    template <class R>
+    struct operation {
+      R rcvr_;
+      const void** address_;
+      char padding_[64]{};
+
+      friend void tag_invoke(start_t, operation& self) noexcept {
+        *self.address_ = &self;
+        set_value(std::move(self.rcvr_));
+      }
+    };
+
+    template <class R>
+    friend operation<R> tag_invoke(connect_t, address_sender self, R rcvr) {
+      return {std::move(rcvr), self.address_};
+    }
+
+    const void** address_;
+  };
+
+  TEST_CASE(
+    "any_sender returns operation states freed on another thread to their owner",
+    "[types][any_sender]") {
+    using sender_t = any_sender_of<set_value_t()>;
+    using op_t = connect_result_t<sender_t, expect_void_receiver<>>;
+    const void* first = nullptr;
+    const void* second = nullptr;
+    // Run on a new thread, so that its cache of operation states starts out
+    // empty.
+    std::thread{[&] {
+      std::optional<op_t> op;
+      op.emplace(stdexec::__conv{[&] {
+        return connect(sender_t{address_sender{&first}}, expect_void_receiver{});
+      }});
+      start(*op);
+      std::thread{[&] {
+        op.reset();
+      }}.join();
+      op.emplace(stdexec::__conv{[&] {
+        return connect(sender_t{address_sender{&second}}, expect_void_receiver{});
+      }});
+      start(*op);
+    }}.join();
+    CHECK(first != nullptr);
+    CHECK(first == second);
+  }
+
+  TEST_CASE("any_sender with a larger inline size does not allocate", "[types][any_sender]") {
+    using sender_t = sized_sender_of<256, set_value_t(int)>;
+    STATIC_REQUIRE(sizeof(sender_t) >= 256);
+    allocation_counts counts;
+    auto env = exec::make_env(exec::with(get_allocator, counting_allocator<std::byte>{counts}));
+    sender_t sender = just(21) | then([](int v) noexcept { return 2 * v; });
+    auto op = connect(std::move(sender), expect_value_receiver{env_tag{}, std::move(env), 42});
+    start(op);
+    CHECK(counts.allocations == 0);
+    auto [value] = *sync_wait(sized_sender_of<256, set_value_t(int)>{just(42)});
+    CHECK(value == 42);
+  }
+
   TEST_CASE("any_sender is connectable with any_receiver_ref", "[types][any_sender]") {
     using Sigs = completion_signatures<set_value_t(int), set_stopped_t()>;
     using receiver_ref = any_receiver_ref<Sigs>;
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/numa_memory_resource.hpp>
+#include <exec/static_thread_pool.hpp>
+#include <exec/env.hpp>
+#include <exec/when_range.hpp>
+
+#if STDEXEC_HAS_STD_MEMORY_RESOURCE()
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ex = stdexec;
+
+namespace {
+  // Places the threads of a pool alternately on two emulated nodes.
+  struct two_node_policy : exec::numa_policy {
+    std::size_t num_nodes() override {
+      return 2;
+    }
+
+    std::size_t num_cpus(int) override {
+      return 2;
+    }
+
+    int bind_to_node(int) override {
+      return 0;
+    }
+
+    int thread_index_to_node(std::size_t index) override {
+      return static_cast<int>(index % 2);
+    }
+  };
+
+  // A sender that records the address of its operation state.
+  struct address_sender {
+    using sender_concept = ex::sender_t;
+    using completion_signatures = ex::completion_signatures<ex::set_value_t()>;
+
+    template <class Receiver>
+    struct operation {
+      Receiver rcvr_;
+      void** address_;
+
+      friend void tag_invoke(ex::start_t, operation& self) noexcept {
+        *self.address_ = &self;
+        ex::set_value(std::move(self.rcvr_));
+      }
+    };
+
+    template <ex::receiver Receiver>
+    friend operation<Receiver> tag_invoke(ex::connect_t, address_sender self, Receiver rcvr) {
+      return {std::move(rcvr), self.address_};
+    }
+
+    void** address_;
+  };
+
+  // Whether ptr points into a free block of one of the size classes of the
+  // resource. Blocks that were just deallocated are the first ones that the
+  // resource hands out again.
+  bool in_free_block(exec::numa_memory_resource& resource, void* ptr) {
+    bool found = false;
+    for (std::size_t size = 16; size <= exec::numa_memory_resource::max_pooled_size; size *= 2) {
+      auto* block = static_cast<std::byte*>(resource.allocate(size));
+      found = found || (block <= ptr && ptr < block + size);
+      resource.deallocate(block, size);
+    }
+    return found;
+  }
+
+  bool is_aligned(void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - allocates aligned blocks of any size",
+    "[numa][numa_memory_resource]") {
+    exec::numa_memory_resource resource{0};
+    CHECK(resource.node() == 0);
+    std::vector<std::pair<void*, std::size_t>> blocks;
+    for (std::size_t size: {1, 8, 24, 100, 4096, 5000, 1 << 20}) {
+      void* ptr = resource.allocate(size);
+      CHECK(is_aligned(ptr, alignof(std::max_align_t)));
+      std::memset(ptr, 0xff, size);
+      blocks.emplace_back(ptr, size);
+    }
+    void* over_aligned = resource.allocate(100, 256);
+    void* large_over_aligned = resource.allocate(10000, 8192);
+    CHECK(is_aligned(over_aligned, 256));
+    CHECK(is_aligned(large_over_aligned, 8192));
+    resource.deallocate(over_aligned, 100, 256);
+    resource.deallocate(large_over_aligned, 10000, 8192);
+    for (auto [ptr, size]: blocks) {
+      resource.deallocate(ptr, size);
+    }
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - reuses the blocks of a size class",
+    "[numa][numa_memory_resource]") {
+    exec::numa_memory_resource resource{0};
+    std::set<void*> blocks;
+    for (int i = 0; i < 10000; ++i) {
+      blocks.insert(resource.allocate(48));
+    }
+    CHECK(blocks.size() == 10000);
+    for (void* ptr: blocks) {
+      resource.deallocate(ptr, 48);
+    }
+    // 48 and 64 bytes are in the same size class.
+    std::size_t reused = 0;
+    for (int i = 0; i < 10000; ++i) {
+      reused += blocks.count(resource.allocate(64));
+    }
+    CHECK(reused == 10000);
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - returns a block to the resource it came from",
+    "[numa][numa_memory_resource]") {
+    exec::numa_memory_resource node0{0};
+    exec::numa_memory_resource node1{1};
+    void* ptr = node0.allocate(32);
+    node1.deallocate(ptr, 32);
+    CHECK(node0.allocate(32) == ptr);
+    CHECK(node1.allocate(32) != ptr);
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - may be used by many threads",
+    "[numa][numa_memory_resource]") {
+    exec::numa_memory_resource resource{0};
+    constexpr int num_threads = 4;
+    constexpr int num_blocks = 2000;
+    // Every thread deallocates the blocks of the previous one.
+    std::vector<std::vector<void*>> blocks(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      for (int i = 0; i < num_blocks; ++i) {
+        blocks[t].push_back(resource.allocate(16 << (i % 6)));
+      }
+    }
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        std::vector<void*>& mine = blocks[(t + 1) % num_threads];
+        for (int i = 0; i < num_blocks; ++i) {
+          resource.deallocate(mine[i], 16 << (i % 6));
+          mine[i] = resource.allocate(16 << (i % 6));
+        }
+      });
+    }
+    for (std::thread& t: threads) {
+      t.join();
+    }
+    std::set<void*> unique;
+    for (std::vector<void*>& mine: blocks) {
+      unique.insert(mine.begin(), mine.end());
+    }
+    CHECK(unique.size() == num_threads * num_blocks);
+    for (std::vector<void*>& mine: blocks) {
+      for (int i = 0; i < num_blocks; ++i) {
+        resource.deallocate(mine[i], 16 << (i % 6));
+      }
+    }
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - a thread returns its blocks when it exits",
+    "[numa][numa_memory_resource]") {
+    exec::numa_memory_resource resource{0};
+    std::set<void*> blocks;
+    std::thread([&] {
+      for (int i = 0; i < 1000; ++i) {
+        blocks.insert(resource.allocate(64));
+      }
+      for (void* ptr: blocks) {
+        resource.deallocate(ptr, 64);
+      }
+    }).join();
+    std::size_t reused = 0;
+    std::vector<void*> again;
+    for (int i = 0; i < 1000; ++i) {
+      again.push_back(resource.allocate(64));
+      reused += blocks.count(again.back());
+    }
+    CHECK(reused == 1000);
+    for (void* ptr: again) {
+      resource.deallocate(ptr, 64);
+    }
+  }
+
+  TEST_CASE(
+    "numa_memory_resource - may be destroyed while a thread holds some of its blocks",
+    "[numa][numa_memory_resource]") {
+    std::optional<exec::numa_memory_resource> first{std::in_place, 0};
+    std::optional<exec::numa_memory_resource> second;
+    first->deallocate(first->allocate(32), 32);
+    std::thread other([&] { first->deallocate(first->allocate(128), 128); });
+    other.join();
+    first.reset();
+    // The next resource may have the same address, but does not use the free
+    // lists that this thread kept for the first one.
+    second.emplace(0);
+    std::set<void*> blocks;
+    for (int i = 0; i < 100; ++i) {
+      void* block = second->allocate(32);
+      std::memset(block, 0xff, 32);
+      blocks.insert(block);
+    }
+    CHECK(blocks.size() == 100);
+    for (void* block: blocks) {
+      second->deallocate(block, 32);
+    }
+  }
+
+  TEST_CASE(
+    "static_thread_pool - the env of a scheduler allocates from the current node",
+    "[static_thread_pool][numa][numa_memory_resource]") {
+    two_node_policy policy;
+    exec::static_thread_pool pool{2, {}, &policy};
+    auto alloc = ex::get_allocator(ex::get_env(ex::schedule(pool.get_scheduler())));
+    STATIC_REQUIRE(std::same_as<decltype(alloc), std::pmr::polymorphic_allocator<std::byte>>);
+    CHECK(alloc == pool.get_allocator());
+
+    // A block that was allocated on a thread of node 1 is reused by the
+    // resource of node 1.
+    std::byte* ptr = nullptr;
+    ex::sync_wait(
+      ex::schedule(pool.get_scheduler_on_thread(1)) //
+      | ex::then([&] { ptr = alloc.allocate(40); }));
+    alloc.deallocate(ptr, 40);
+    CHECK(pool.get_numa_memory_resource(1)->allocate(40) == ptr);
+    pool.get_numa_memory_resource(1)->deallocate(ptr, 40);
+
+    // Off the pool, the memory comes from the node of the first thread.
+    ptr = alloc.allocate(40);
+    alloc.deallocate(ptr, 40);
+    CHECK(pool.get_numa_memory_resource(0)->allocate(40) == ptr);
+    pool.get_numa_memory_resource(0)->deallocate(ptr, 40);
+  }
+
+  TEST_CASE(
+    "static_thread_pool - algorithms allocate from the node when given the pool allocator",
+    "[static_thread_pool][numa][numa_memory_resource]") {
+    two_node_policy policy;
+    exec::static_thread_pool pool{2, {}, &policy};
+    void* op = nullptr;
+    std::vector<address_sender> children(3, address_sender{&op});
+
+    // when_all_range allocates the operation states of its children with the
+    // allocator of its receiver's env.
+    ex::sync_wait(ex::on(
+      pool.get_scheduler_on_thread(1),
+      exec::when_all_range(children)
+        | exec::write(exec::with(ex::get_allocator, pool.get_allocator()))));
+    REQUIRE(op != nullptr);
+    CHECK(in_free_block(*pool.get_numa_memory_resource(1), op));
+    CHECK_FALSE(in_free_block(*pool.get_numa_memory_resource(0), op));
+
+    // Started on the pool without it, it uses the recycling allocator.
+    op = nullptr;
+    ex::sync_wait(ex::on(pool.get_scheduler_on_thread(1), exec::when_all_range(children)));
+    REQUIRE(op != nullptr);
+    CHECK_FALSE(in_free_block(*pool.get_numa_memory_resource(1), op));
+  }
+}
+
+#endif
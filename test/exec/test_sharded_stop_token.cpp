@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/sharded_stop_token.hpp>
+
+#include <atomic>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ex = stdexec;
+
+namespace {
+  struct count_calls {
+    std::atomic<int>* calls_;
+
+    void operator()() const noexcept {
+      ++*calls_;
+    }
+  };
+
+  using callback_t = exec::sharded_stop_token::callback_type<count_calls>;
+
+  static_assert(ex::stoppable_token<exec::sharded_stop_token>);
+  static_assert(ex::stoppable_token_for<exec::sharded_stop_token, count_calls>);
+
+  TEST_CASE("sharded_stop_source - runs the registered callbacks", "[sharded_stop_token]") {
+    exec::sharded_stop_source source;
+    exec::sharded_stop_token token = source.get_token();
+    CHECK(token.stop_possible());
+    CHECK_FALSE(token.stop_requested());
+    std::atomic<int> calls{0};
+    {
+      callback_t cb1{token, count_calls{&calls}};
+      callback_t cb2{token, count_calls{&calls}};
+      std::optional<callback_t> cb3{std::in_place, token, count_calls{&calls}};
+      cb3.reset();
+      source.request_stop();
+    }
+    CHECK(token.stop_requested());
+    CHECK(calls == 2);
+  }
+
+  TEST_CASE(
+    "sharded_stop_source - runs a callback inline after a stop request",
+    "[sharded_stop_token]") {
+    exec::sharded_stop_source source;
+    source.request_stop();
+    std::atomic<int> calls{0};
+    callback_t cb{source.get_token(), count_calls{&calls}};
+    CHECK(calls == 1);
+  }
+
+  TEST_CASE(
+    "sharded_stop_source - a callback can deregister itself",
+    "[sharded_stop_token]") {
+    exec::sharded_stop_source source;
+    struct reset_self {
+      std::optional<exec::sharded_stop_callback<reset_self>>* self_;
+
+      void operator()() const noexcept {
+        self_->reset();
+      }
+    };
+
+    std::optional<exec::sharded_stop_callback<reset_self>> cb;
+    cb.emplace(source.get_token(), reset_self{&cb});
+    source.request_stop();
+    CHECK_FALSE(cb.has_value());
+  }
+
+  TEST_CASE(
+    "sharded_stop_source - runs the callbacks of many threads exactly once",
+    "[sharded_stop_token]") {
+    constexpr int num_threads = 8;
+    constexpr int num_callbacks = 1000;
+    exec::sharded_stop_source source;
+    std::vector<std::atomic<int>> calls(num_threads * num_callbacks);
+    std::atomic<int> started{0};
+    std::atomic<bool> stopped{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        // Some of the callbacks are registered before the stop request, and
+        // some while it is being processed or after it.
+        std::vector<std::optional<callback_t>> callbacks(num_callbacks);
+        ++started;
+        for (int i = 0; i < num_callbacks; ++i) {
+          callbacks[i].emplace(source.get_token(), count_calls{&calls[t * num_callbacks + i]});
+        }
+        while (!stopped) {
+          std::this_thread::yield();
+        }
+      });
+    }
+    while (started < num_threads) {
+      std::this_thread::yield();
+    }
+    source.request_stop();
+    stopped = true;
+    for (std::thread& t: threads) {
+      t.join();
+    }
+    int runs_once = 0;
+    for (const std::atomic<int>& c: calls) {
+      runs_once += c == 1;
+    }
+    CHECK(runs_once == num_threads * num_callbacks);
+  }
+}
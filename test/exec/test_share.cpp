@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/share.hpp>
+#include <exec/static_thread_pool.hpp>
+#include <test_common/receivers.hpp>
+#include <test_common/schedulers.hpp>
+#include <test_common/type_helpers.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace ex = stdexec;
+
+namespace {
+  struct copy_counted {
+    explicit copy_counted(int* copies) noexcept
+      : copies_(copies) {
+    }
+
+    copy_counted(const copy_counted& other) noexcept
+      : copies_(other.copies_) {
+      ++*copies_;
+    }
+
+    copy_counted(copy_counted&&) noexcept = default;
+    copy_counted& operator=(const copy_counted&) = delete;
+    copy_counted& operator=(copy_counted&&) noexcept = default;
+
+    int* copies_;
+  };
+
+  // Takes ownership of the value it is completed with.
+  struct owning_receiver {
+    using receiver_concept = ex::receiver_t;
+
+    std::optional<copy_counted>* result_;
+
+    friend void tag_invoke(ex::set_value_t, owning_receiver&& self, copy_counted&& value) noexcept {
+      self.result_->emplace(std::move(value));
+    }
+
+    friend void tag_invoke(ex::set_error_t, owning_receiver&&, std::exception_ptr) noexcept {
+      FAIL_CHECK("set_error called on owning_receiver");
+    }
+
+    friend void tag_invoke(ex::set_stopped_t, owning_receiver&&) noexcept {
+      FAIL_CHECK("set_stopped called on owning_receiver");
+    }
+
+    friend ex::empty_env tag_invoke(ex::get_env_t, const owning_receiver&) noexcept {
+      return {};
+    }
+  };
+
+  TEST_CASE("share returns a sender", "[adaptors][share]") {
+    auto snd = exec::share(ex::just(19));
+    static_assert(ex::sender<decltype(snd)>);
+    (void) snd;
+  }
+
+  TEST_CASE("share sends its results by rvalue reference", "[adaptors][share]") {
+    auto snd = ex::just(19) | exec::share();
+    check_val_types<type_array<type_array<int&&>>>(snd);
+    check_err_types<type_array<std::exception_ptr&&>>(snd);
+    check_sends_stopped<true>(snd);
+  }
+
+  TEST_CASE("share simple example", "[adaptors][share]") {
+    auto snd = exec::share(ex::just(19));
+    auto [v1] = ex::sync_wait(snd).value();
+    auto [v2] = ex::sync_wait(std::move(snd)).value();
+    CHECK(v1 == 19);
+    CHECK(v2 == 19);
+  }
+
+  TEST_CASE("share does not copy the result into a single consumer", "[adaptors][share]") {
+    int copies = 0;
+    std::optional<copy_counted> result;
+    auto snd = exec::share(ex::just(copy_counted{&copies}));
+    auto op = ex::connect(std::move(snd), owning_receiver{&result});
+    ex::start(op);
+    CHECK(result.has_value());
+    CHECK(copies == 0);
+  }
+
+  TEST_CASE("share moves the result into the last consumer", "[adaptors][share]") {
+    int copies = 0;
+    std::optional<copy_counted> r1, r2, r3;
+    auto snd = exec::share(ex::just(copy_counted{&copies}));
+    auto op1 = ex::connect(snd, owning_receiver{&r1});
+    auto op2 = ex::connect(snd, owning_receiver{&r2});
+    auto op3 = ex::connect(std::move(snd), owning_receiver{&r3});
+    ex::start(op1);
+    ex::start(op2);
+    ex::start(op3);
+    CHECK(r1.has_value());
+    CHECK(r2.has_value());
+    CHECK(r3.has_value());
+    CHECK(copies == 2);
+  }
+
+  TEST_CASE("share copies the result while a share sender is alive", "[adaptors][share]") {
+    int copies = 0;
+    std::optional<copy_counted> r1, r2;
+    auto snd = exec::share(ex::just(copy_counted{&copies}));
+    {
+      auto op1 = ex::connect(snd, owning_receiver{&r1});
+      ex::start(op1);
+    }
+    CHECK(copies == 1);
+    auto op2 = ex::connect(std::move(snd), owning_receiver{&r2});
+    ex::start(op2);
+    CHECK(r2.has_value());
+    CHECK(copies == 1);
+  }
+
+  TEST_CASE("share moves the result into the last waiting consumer", "[adaptors][share]") {
+    int copies = 0;
+    std::optional<copy_counted> r1, r2;
+    impulse_scheduler sched;
+    auto snd = exec::share(ex::on(sched, ex::just(copy_counted{&copies})));
+    auto op1 = ex::connect(snd, owning_receiver{&r1});
+    auto op2 = ex::connect(std::move(snd), owning_receiver{&r2});
+    ex::start(op1);
+    ex::start(op2);
+    CHECK_FALSE(r1.has_value());
+    sched.start_next();
+    CHECK(r1.has_value());
+    CHECK(r2.has_value());
+    CHECK(copies == 1);
+  }
+
+  TEST_CASE("share forwards errors and stopped", "[adaptors][share]") {
+    auto snd1 = exec::share(ex::just_error(42));
+    auto op1 = ex::connect(snd1, expect_error_receiver{42});
+    auto op2 = ex::connect(std::move(snd1), expect_error_receiver{42});
+    ex::start(op1);
+    ex::start(op2);
+
+    auto snd2 = exec::share(ex::just_stopped());
+    auto op3 = ex::connect(snd2, expect_stopped_receiver{});
+    auto op4 = ex::connect(std::move(snd2), expect_stopped_receiver{});
+    ex::start(op3);
+    ex::start(op4);
+  }
+
+  TEST_CASE("share is thread-safe", "[adaptors][share]") {
+    exec::static_thread_pool pool{2};
+    const unsigned n_threads = 8;
+    auto snd = ex::schedule(pool.get_scheduler())
+             | ex::then([] { return std::vector<int>(1000, 42); }) | exec::share();
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> sums(n_threads, 0);
+    auto consume = [&sums](unsigned tid, auto snd) {
+      auto [vec] = ex::sync_wait(std::move(snd)).value();
+      for (int v: vec) {
+        sums[tid] += v;
+      }
+    };
+    for (unsigned tid = 0; tid < n_threads; tid++) {
+      // The last thread is given the last share sender.
+      threads.emplace_back(consume, tid, tid + 1 < n_threads ? snd : std::move(snd));
+    }
+    for (unsigned tid = 0; tid < n_threads; tid++) {
+      threads[tid].join();
+      CHECK(sums[tid] == 42000);
+    }
+  }
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/env.hpp>
+#include <exec/numa_partitioned_buffer.hpp>
+#include <exec/sequence/ignore_all_values.hpp>
+#include <exec/sequence/transform_each.hpp>
+#include <exec/static_thread_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ex = stdexec;
+
+namespace {
+  // Places the threads of a pool alternately on two emulated nodes.
+  struct two_node_policy : exec::numa_policy {
+    std::size_t num_nodes() override {
+      return 2;
+    }
+
+    std::size_t num_cpus(int) override {
+      return 2;
+    }
+
+    int bind_to_node(int node) override {
+      current_node = node;
+      return 0;
+    }
+
+    int thread_index_to_node(std::size_t index) override {
+      return static_cast<int>(index % 2);
+    }
+
+    static thread_local int current_node;
+  };
+
+  thread_local int two_node_policy::current_node = -1;
+
+  TEST_CASE(
+    "static_thread_pool - numa_partition splits by the threads per node",
+    "[static_thread_pool][numa]") {
+    two_node_policy policy;
+    exec::static_thread_pool pool{5, {}, &policy};
+    CHECK(pool.num_numa_nodes() == 2);
+    // Three threads are on node 0 and two are on node 1.
+    CHECK(pool.numa_partition(10, 0) == std::pair{0, 6});
+    CHECK(pool.numa_partition(10, 1) == std::pair{6, 10});
+    CHECK(pool.numa_partition(10, 2) == std::pair{10, 10});
+  }
+
+  TEST_CASE(
+    "static_thread_pool - a numa partitioned bulk runs the slices on their nodes",
+    "[static_thread_pool][numa]") {
+    two_node_policy policy;
+    exec::static_thread_pool pool{5, {}, &policy};
+    constexpr int n = 100;
+    std::vector<std::atomic<int>> calls(n);
+    std::vector<int> nodes(n, -1);
+    auto snd = ex::schedule(pool.get_numa_partitioned_scheduler()) //
+             | ex::bulk(n, [&](int i) {
+                 ++calls[i];
+                 nodes[i] = two_node_policy::current_node;
+               });
+    ex::sync_wait(std::move(snd));
+    auto [begin, end] = pool.numa_partition(n, 1);
+    for (int i = 0; i < n; ++i) {
+      CHECK(calls[i] == 1);
+      CHECK(nodes[i] == (begin <= i && i < end ? 1 : 0));
+    }
+  }
+
+  TEST_CASE(
+    "static_thread_pool - a numa partitioned bulk with fewer indices than threads",
+    "[static_thread_pool][numa]") {
+    exec::static_thread_pool pool{4};
+    std::vector<std::atomic<int>> calls(3);
+    auto snd = ex::schedule(pool.get_numa_partitioned_scheduler()) //
+             | ex::bulk(3, [&](int i) { ++calls[i]; });
+    ex::sync_wait(std::move(snd));
+    for (std::atomic<int>& c: calls) {
+      CHECK(c == 1);
+    }
+  }
+
+  TEST_CASE(
+    "numa_partitioned_buffer - has a slice for every node",
+    "[static_thread_pool][numa][numa_partitioned_buffer]") {
+    two_node_policy policy;
+    exec::static_thread_pool pool{5, {}, &policy};
+    exec::numa_partitioned_buffer<int> buffer{pool, 10};
+    CHECK(buffer.size() == 10);
+    CHECK(buffer.node_slice(0).size() == 6);
+    CHECK(buffer.node_slice(1).size() == 4);
+    CHECK(buffer.node_slice(2).empty());
+    auto snd = ex::schedule(pool.get_numa_partitioned_scheduler()) //
+             | ex::bulk(10, [&](std::size_t i) { buffer[i] = static_cast<int>(i); });
+    ex::sync_wait(std::move(snd));
+    CHECK(buffer.node_slice(0)[5] == 5);
+    CHECK(buffer.node_slice(1)[0] == 6);
+    CHECK(buffer[9] == 9);
+  }
+
+#if STDEXEC_HAS_STD_RANGES()
+  // A sequence receiver that is slow to take items, accepts at most max_in_flight of them at a
+  // time and records how many items it was passed at once.
+  struct slow_receiver {
+    using receiver_concept = ex::receiver_t;
+
+    struct state {
+      std::size_t max_in_flight;
+      std::atomic<int> in_flight{0};
+      std::atomic<int> peak{0};
+      std::atomic<int> count{0};
+      std::atomic<bool> done{false};
+    };
+
+    state* state_;
+
+    template <class Item>
+    friend auto tag_invoke(exec::set_next_t, slow_receiver& self, Item&& item) {
+      return static_cast<Item&&>(item) //
+           | ex::then([st = self.state_](auto&&...) noexcept {
+               int n = ++st->in_flight;
+               int peak = st->peak.load();
+               while (n > peak && !st->peak.compare_exchange_weak(peak, n)) {
+               }
+               std::this_thread::sleep_for(std::chrono::microseconds(200));
+               --st->in_flight;
+               ++st->count;
+             });
+    }
+
+    template <class Tag>
+      requires ex::__one_of<Tag, ex::set_value_t, ex::set_stopped_t>
+    friend void tag_invoke(Tag, slow_receiver&& self) noexcept {
+      state* st = self.state_;
+      st->done = true;
+      st->done.notify_one();
+    }
+
+    friend void tag_invoke(ex::set_error_t, slow_receiver&&, std::exception_ptr) noexcept {
+      std::terminate();
+    }
+
+    friend auto tag_invoke(ex::get_env_t, const slow_receiver& self) noexcept {
+      return exec::make_env(exec::with(exec::get_max_in_flight, self.state_->max_in_flight));
+    }
+  };
+
+  TEST_CASE(
+    "schedule_all - starts no more items at a time than the receiver accepts",
+    "[static_thread_pool][schedule_all]") {
+    exec::static_thread_pool pool{4};
+    std::array<slow_receiver::state, 3> states{{{1}, {2}, {3}}};
+    for (slow_receiver::state& state: states) {
+      std::size_t max_in_flight = state.max_in_flight;
+      auto op = exec::subscribe(
+        exec::schedule_all(pool, std::views::iota(0, 40)), slow_receiver{&state});
+      ex::start(op);
+      state.done.wait(false);
+      CHECK(state.count == 40);
+      CHECK(state.peak >= 1);
+      CHECK(state.peak <= static_cast<int>(max_in_flight));
+    }
+  }
+
+  TEST_CASE(
+    "schedule_all - starts all items at once without a limit",
+    "[static_thread_pool][schedule_all]") {
+    exec::static_thread_pool pool{4};
+    slow_receiver::state state{std::numeric_limits<std::size_t>::max()};
+    auto op = exec::subscribe(
+      exec::schedule_all(pool, std::views::iota(0, 40)), slow_receiver{&state});
+    ex::start(op);
+    state.done.wait(false);
+    CHECK(state.count == 40);
+  }
+
+  TEST_CASE(
+    "schedule_all - sends a span for every chunk of a contiguous range",
+    "[static_thread_pool][schedule_all]") {
+    exec::static_thread_pool pool{4};
+    std::vector<long> values(100000);
+    std::iota(values.begin(), values.end(), 0L);
+    std::atomic<long> sum{0};
+    std::atomic<int> chunks{0};
+    std::atomic<int> on_pool{0};
+    const std::thread::id main_thread = std::this_thread::get_id();
+    auto sndr = exec::schedule_all(pool, std::span{values}, 1000)
+              | exec::transform_each(ex::then([&](std::span<long> chunk) {
+                  on_pool += std::this_thread::get_id() != main_thread;
+                  ++chunks;
+                  sum += std::accumulate(chunk.begin(), chunk.end(), 0L);
+                }))
+              | exec::ignore_all_values();
+    ex::sync_wait(std::move(sndr));
+    CHECK(chunks == 100);
+    CHECK(on_pool == 100);
+    CHECK(sum == 99999L * 100000L / 2);
+  }
+
+  TEST_CASE(
+    "schedule_all - sends a subrange for every chunk of a random access range",
+    "[static_thread_pool][schedule_all]") {
+    exec::static_thread_pool pool{4};
+    std::vector<std::atomic<int>> sums(4);
+    auto sndr = exec::schedule_all(pool, std::views::iota(0, 10), 3)
+              | exec::transform_each(ex::then([&](auto chunk) {
+                  sums[*chunk.begin() / 3] = std::accumulate(chunk.begin(), chunk.end(), 0);
+                }))
+              | exec::ignore_all_values();
+    ex::sync_wait(std::move(sndr));
+    CHECK(sums[0] == 0 + 1 + 2);
+    CHECK(sums[1] == 3 + 4 + 5);
+    CHECK(sums[2] == 6 + 7 + 8);
+    CHECK(sums[3] == 9);
+  }
+#endif
+}
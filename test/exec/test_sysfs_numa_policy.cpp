@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/linux/sysfs_numa_policy.hpp>
+#include <exec/static_thread_pool.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+  // A node directory tree in the layout of /sys/devices/system/node, with
+  // four cpus on node 0, three on node 1, none on node 2 and one on node 4.
+  struct fake_topology {
+    fake_topology()
+      : root_{fs::temp_directory_path() / ("stdexec_numa_" + std::to_string(::getpid()))} {
+      fs::remove_all(root_);
+      write_node(0, "0-3\n");
+      write_node(1, "4-5,7\n");
+      write_node(2, "\n");
+      write_node(4, "8\n");
+      fs::create_directories(root_ / "power");
+      std::ofstream{root_ / "online"} << "0-2,4\n";
+    }
+
+    ~fake_topology() {
+      fs::remove_all(root_);
+    }
+
+    void write_node(int node, const char* cpulist) {
+      fs::path dir = root_ / ("node" + std::to_string(node));
+      fs::create_directories(dir);
+      std::ofstream{dir / "cpulist"} << cpulist;
+    }
+
+    fs::path root_;
+  };
+
+  std::vector<int> nodes_of_threads(exec::numa_policy& policy, std::size_t count) {
+    std::vector<int> nodes;
+    for (std::size_t i = 0; i < count; ++i) {
+      nodes.push_back(policy.thread_index_to_node(i));
+    }
+    return nodes;
+  }
+
+  TEST_CASE("sysfs_numa_policy - reads the nodes and their cpus", "[numa][sysfs_numa_policy]") {
+    fake_topology topology;
+    exec::sysfs_numa_policy policy{exec::numa_placement::compact, topology.root_};
+    CHECK(policy.num_nodes() == 5);
+    CHECK(policy.num_cpus(0) == 4);
+    CHECK(policy.num_cpus(1) == 3);
+    CHECK(policy.num_cpus(2) == 0);
+    CHECK(policy.num_cpus(3) == 0);
+    CHECK(policy.num_cpus(4) == 1);
+    CHECK(policy.num_cpus(5) == 0);
+    CHECK(policy.cpus(1) == std::vector{4, 5, 7});
+  }
+
+  TEST_CASE(
+    "sysfs_numa_policy - places threads by the strategy",
+    "[numa][sysfs_numa_policy]") {
+    fake_topology topology;
+    SECTION("compact") {
+      exec::sysfs_numa_policy policy{exec::numa_placement::compact, topology.root_};
+      CHECK(nodes_of_threads(policy, 10) == std::vector{0, 0, 0, 0, 1, 1, 1, 4, 0, 0});
+    }
+    SECTION("scatter") {
+      exec::sysfs_numa_policy policy{exec::numa_placement::scatter, topology.root_};
+      CHECK(nodes_of_threads(policy, 5) == std::vector{0, 1, 4, 0, 1});
+    }
+    SECTION("explicit") {
+      exec::sysfs_numa_policy policy{std::vector{4, 1}, topology.root_};
+      CHECK(nodes_of_threads(policy, 3) == std::vector{4, 1, 4});
+    }
+  }
+
+  TEST_CASE(
+    "sysfs_numa_policy - without nodes it behaves like no_numa_policy",
+    "[numa][sysfs_numa_policy]") {
+    exec::sysfs_numa_policy policy{
+      exec::numa_placement::scatter, fs::temp_directory_path() / "stdexec_no_such_dir"};
+    CHECK(policy.num_nodes() == 1);
+    CHECK(policy.num_cpus(0) == std::thread::hardware_concurrency());
+    CHECK(policy.thread_index_to_node(3) == 0);
+    CHECK(policy.bind_to_node(0) == 0);
+  }
+
+  TEST_CASE(
+    "sysfs_numa_policy - a static_thread_pool uses the placement",
+    "[numa][sysfs_numa_policy]") {
+    fake_topology topology;
+    exec::sysfs_numa_policy policy{exec::numa_placement::scatter, topology.root_};
+    exec::static_thread_pool pool{6, {}, &policy};
+    CHECK(pool.num_numa_nodes() == 5);
+    CHECK(pool.numa_partition(6, 0) == std::pair{0, 2});
+    CHECK(pool.numa_partition(6, 1) == std::pair{2, 4});
+    CHECK(pool.numa_partition(6, 2) == std::pair{4, 4});
+    CHECK(pool.numa_partition(6, 4) == std::pair{4, 6});
+  }
+
+  TEST_CASE(
+    "sysfs_numa_policy - binds a thread to the cpus of a node",
+    "[numa][sysfs_numa_policy]") {
+    exec::sysfs_numa_policy policy{};
+    int node = policy.thread_index_to_node(0);
+    if (policy.cpus(node).empty()) {
+      return; // There is no node directory in sysfs.
+    }
+    int rc = -1;
+    ::cpu_set_t cpu_set;
+    // Bind a thread of our own, to leave the affinity of the test runner as is.
+    std::thread{[&] {
+      rc = policy.bind_to_node(node);
+      ::sched_getaffinity(0, sizeof(cpu_set), &cpu_set);
+    }}.join();
+    CHECK(rc == 0);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpu_set)) {
+        CHECK(std::find(policy.cpus(node).begin(), policy.cpus(node).end(), cpu)
+              != policy.cpus(node).end());
+      }
+    }
+  }
+}
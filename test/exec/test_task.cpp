@@ -23,6 +23,7 @@
 #include <exec/async_scope.hpp>
 
 #include <catch2/catch.hpp>
+#include <test_common/allocators.hpp>
 
 #include <thread>
 
@@ -274,6 +275,197 @@ namespace {
     CHECK(count == 3);
   }
 
+  using frame_allocator = counting_allocator<std::byte>;
+
+  exec::task<int> child_task(int i) {
+    co_return i;
+  }
+
+  exec::task<int> allocated_task(std::allocator_arg_t, frame_allocator, int i) {
+    co_return i;
+  }
+
+  exec::task<int> allocating_parent(std::allocator_arg_t, frame_allocator alloc) {
+    int sum = co_await child_task(1);
+    sum += co_await allocated_task(std::allocator_arg, alloc, 2);
+    co_return sum;
+  }
+
+  exec::task<void> spawned_task(int& value) {
+    value = 42;
+    co_return;
+  }
+
+  exec::task<void>
+    spawning_parent(std::allocator_arg_t, frame_allocator, exec::async_scope& scope, int& value) {
+    scope.spawn(stdexec::on(exec::inline_scheduler{}, spawned_task(value)));
+    co_return;
+  }
+
+  struct task_factory {
+    exec::task<int> make(std::allocator_arg_t, frame_allocator, int i) const {
+      co_return i + offset_;
+    }
+
+    int offset_;
+  };
+
+  TEST_CASE("task - frame is allocated with the given allocator", "[types][task][allocator]") {
+    allocation_counts counts;
+    auto [value] =
+      stdexec::sync_wait(allocated_task(std::allocator_arg, frame_allocator{counts}, 42)).value();
+    CHECK(value == 42);
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
+
+  TEST_CASE("task - member coroutine frame is allocated with the given allocator", "[types][task][allocator]") {
+    allocation_counts counts;
+    task_factory factory{1};
+    auto [value] =
+      stdexec::sync_wait(factory.make(std::allocator_arg, frame_allocator{counts}, 41)).value();
+    CHECK(value == 42);
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
+
+  TEST_CASE("task - child frames only use an allocator that is passed to them", "[types][task][allocator]") {
+    allocation_counts counts;
+    auto [value] =
+      stdexec::sync_wait(allocating_parent(std::allocator_arg, frame_allocator{counts})).value();
+    CHECK(value == 3);
+    CHECK(counts.allocations == 2);
+    CHECK(counts.deallocations == 2);
+  }
+
+  TEST_CASE(
+    "task - tasks spawned by a task with an allocator do not use it",
+    "[types][task][allocator]") {
+    allocation_counts counts;
+    exec::async_scope scope;
+    int value = 0;
+    stdexec::sync_wait(spawning_parent(std::allocator_arg, frame_allocator{counts}, scope, value));
+    CHECK(stdexec::sync_wait(scope.on_empty()));
+    CHECK(value == 42);
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
+
+  struct hop_counting_scheduler;
+
+  struct hop_counting_env {
+    int* hops_;
+    bool current_;
+
+    friend hop_counting_scheduler
+      tag_invoke(get_completion_scheduler_t<set_value_t>, const hop_counting_env& self) noexcept;
+  };
+
+  template <class R>
+  struct hop_counting_operation {
+    R rcvr_;
+    int* hops_;
+
+    friend void tag_invoke(start_t, hop_counting_operation& self) noexcept {
+      ++*self.hops_;
+      set_value(std::move(self.rcvr_));
+    }
+  };
+
+  struct hop_counting_sender {
+    using sender_concept = sender_t;
+    using completion_signatures = stdexec::completion_signatures<set_value_t()>;
+
+    template <class R>
+    friend hop_counting_operation<R> tag_invoke(connect_t, hop_counting_sender self, R rcvr) {
+      return {std::move(rcvr), self.env_.hops_};
+    }
+
+    friend hop_counting_env tag_invoke(get_env_t, const hop_counting_sender& self) noexcept {
+      return self.env_;
+    }
+
+    hop_counting_env env_;
+  };
+
+  // An inline scheduler that counts how often it is scheduled on, and that
+  // can claim to be the current scheduler.
+  struct hop_counting_scheduler {
+    friend hop_counting_sender tag_invoke(schedule_t, hop_counting_scheduler self) noexcept {
+      return {{self.hops_, self.current_}};
+    }
+
+    friend bool
+      tag_invoke(exec::__current_sched::__is_current_t, const hop_counting_scheduler& self) noexcept {
+      return self.current_;
+    }
+
+    bool operator==(const hop_counting_scheduler&) const noexcept = default;
+
+    int* hops_;
+    bool current_ = false;
+  };
+
+  hop_counting_scheduler
+    tag_invoke(get_completion_scheduler_t<set_value_t>, const hop_counting_env& self) noexcept {
+    return {self.hops_, self.current_};
+  }
+
+  template <class Task>
+  Task await_schedule(hop_counting_scheduler sched) {
+    co_await schedule(sched);
+  }
+
+  template <class Task>
+  Task await_just() {
+    co_await just();
+  }
+
+  template <class Task>
+  Task await_child() {
+    co_await await_just<Task>();
+  }
+
+  TEST_CASE("task - can stick to a concrete scheduler type", "[types][task][scheduler]") {
+    using counting_task = exec::scheduler_task<void, hop_counting_scheduler>;
+    int hops = 0;
+    hop_counting_scheduler sched{&hops};
+    CHECK(stdexec::sync_wait(on(sched, await_just<counting_task>())));
+    // One hop for on, and one to return to the scheduler after just().
+    CHECK(hops == 2);
+  }
+
+  TEST_CASE("task - skips the reschedule when a sender completes on its scheduler", "[types][task][scheduler]") {
+    int hops = 0;
+    hop_counting_scheduler sched{&hops};
+    CHECK(stdexec::sync_wait(on(sched, await_schedule<exec::task<void>>(sched))));
+    CHECK(hops == 2);
+
+    hops = 0;
+    using counting_task = exec::scheduler_task<void, hop_counting_scheduler>;
+    CHECK(stdexec::sync_wait(on(sched, await_schedule<counting_task>(sched))));
+    CHECK(hops == 2);
+  }
+
+  TEST_CASE("task - skips the reschedule after awaiting a child task", "[types][task][scheduler]") {
+    int hops = 0;
+    hop_counting_scheduler sched{&hops};
+    CHECK(stdexec::sync_wait(on(sched, await_child<exec::task<void>>())));
+    // One hop for on, and one for the child to return after just().
+    CHECK(hops == 2);
+  }
+
+  TEST_CASE("task - skips the reschedule when its scheduler is current", "[types][task][scheduler]") {
+    int hops = 0;
+    hop_counting_scheduler sched{&hops, true};
+    CHECK(stdexec::sync_wait(on(sched, await_just<exec::task<void>>())));
+    CHECK(hops == 1);
+
+    hops = 0;
+    using counting_task = exec::scheduler_task<void, hop_counting_scheduler>;
+    CHECK(stdexec::sync_wait(on(sched, await_just<counting_task>())));
+    CHECK(hops == 1);
+  }
 }
 
 #endif
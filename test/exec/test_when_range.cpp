@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <catch2/catch.hpp>
+#include <exec/when_range.hpp>
+#include <exec/env.hpp>
+#include <exec/static_thread_pool.hpp>
+#include <test_common/allocators.hpp>
+#include <test_common/receivers.hpp>
+#include <test_common/schedulers.hpp>
+#include <test_common/type_helpers.hpp>
+
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+namespace ex = stdexec;
+
+namespace {
+  struct throw_on_two {
+    int operator()(int i) const {
+      if (i == 2) {
+        throw std::runtime_error("two");
+      }
+      return i;
+    }
+  };
+
+  struct plus_one {
+    int operator()(int i) const noexcept {
+      return i + 1;
+    }
+  };
+
+  using just_int_t = decltype(ex::just(0));
+
+  std::vector<just_int_t> iota_senders(int n) {
+    std::vector<just_int_t> senders;
+    for (int i = 0; i < n; ++i) {
+      senders.push_back(ex::just(i));
+    }
+    return senders;
+  }
+
+  TEST_CASE("when_all_range sends a vector of the values", "[adaptors][when_all_range]") {
+    auto snd = exec::when_all_range(iota_senders(5));
+    check_val_types<type_array<type_array<std::vector<int>&&>>>(snd);
+    auto [values] = ex::sync_wait(std::move(snd)).value();
+    CHECK(values == std::vector<int>{0, 1, 2, 3, 4});
+  }
+
+  TEST_CASE("when_all_range of an empty range sends nothing", "[adaptors][when_all_range]") {
+    auto [values] = ex::sync_wait(exec::when_all_range(std::vector<just_int_t>{})).value();
+    CHECK(values.empty());
+  }
+
+  TEST_CASE("when_all_range of void and multi-value senders", "[adaptors][when_all_range]") {
+    std::vector<decltype(ex::just())> voids(3, ex::just());
+    auto snd1 = exec::when_all_range(voids);
+    check_val_types<type_array<type_array<>>>(snd1);
+    CHECK(ex::sync_wait(snd1).has_value());
+
+    std::vector<decltype(ex::just(0, 'a'))> pairs{ex::just(1, 'a'), ex::just(2, 'b')};
+    auto [values] = ex::sync_wait(exec::when_all_range(pairs)).value();
+    CHECK(values == std::vector<std::tuple<int, char>>{{1, 'a'}, {2, 'b'}});
+  }
+
+  TEST_CASE("when_all_range forwards the first error", "[adaptors][when_all_range]") {
+    std::vector<decltype(ex::just(0) | ex::then(throw_on_two{}))> senders;
+    for (int i = 0; i < 4; ++i) {
+      senders.push_back(ex::just(i) | ex::then(throw_on_two{}));
+    }
+    CHECK_THROWS_AS(ex::sync_wait(exec::when_all_range(senders)), std::runtime_error);
+  }
+
+  TEST_CASE("when_all_range can be stopped before it starts", "[adaptors][when_all_range]") {
+    ex::in_place_stop_source stop_source;
+    stop_source.request_stop();
+    auto env = exec::make_env(exec::with(ex::get_stop_token, stop_source.get_token()));
+    auto op = ex::connect(
+      exec::when_all_range(iota_senders(3)), expect_stopped_receiver{std::move(env)});
+    ex::start(op);
+  }
+
+  TEST_CASE("when_all_range allocates its children in one block", "[adaptors][when_all_range]") {
+    allocation_counts counts;
+    auto env = exec::make_env(exec::with(ex::get_allocator, counting_allocator<std::byte>{counts}));
+    {
+      auto op = ex::connect(
+        exec::when_all_range(iota_senders(100)),
+        expect_value_receiver{env_tag{}, std::move(env), [] {
+                                std::vector<int> values(100);
+                                std::iota(values.begin(), values.end(), 0);
+                                return values;
+                              }()});
+      CHECK(counts.allocations == 1);
+      ex::start(op);
+    }
+    CHECK(counts.deallocations == 1);
+  }
+
+  TEST_CASE("when_all_range runs children on a static_thread_pool", "[adaptors][when_all_range]") {
+    exec::static_thread_pool pool{4};
+    auto sched = pool.get_scheduler();
+    std::vector<decltype(ex::transfer_just(sched, 0) | ex::then(plus_one{}))> senders;
+    for (int i = 0; i < 1000; ++i) {
+      senders.push_back(ex::transfer_just(sched, i) | ex::then(plus_one{}));
+    }
+    auto [values] = ex::sync_wait(exec::when_all_range(std::move(senders))).value();
+    REQUIRE(values.size() == 1000);
+    for (int i = 0; i < 1000; ++i) {
+      CHECK(values[i] == i + 1);
+    }
+  }
+
+  TEST_CASE(
+    "when_all_range children can block on work that they start on a static_thread_pool",
+    "[adaptors][when_all_range]") {
+    exec::static_thread_pool pool{2};
+    auto sched = pool.get_scheduler();
+    auto wait_on_pool = [sched](int i) {
+      return std::get<0>(ex::sync_wait(ex::transfer_just(sched, i) | ex::then(plus_one{})).value());
+    };
+    std::vector<decltype(ex::just(0) | ex::then(wait_on_pool))> senders;
+    for (int i = 0; i < 4; ++i) {
+      senders.push_back(ex::just(i) | ex::then(wait_on_pool));
+    }
+    auto [values] = ex::sync_wait(exec::when_all_range(senders)).value();
+    CHECK(values == std::vector<int>{1, 2, 3, 4});
+  }
+
+  TEST_CASE("when_all_range iterates a lazy range", "[adaptors][when_all_range]") {
+    auto senders = std::views::iota(0, 5)
+                 | std::views::transform([](int i) { return ex::just(i); });
+    auto [values] = ex::sync_wait(exec::when_all_range(senders)).value();
+    CHECK(values == std::vector<int>{0, 1, 2, 3, 4});
+  }
+
+  TEST_CASE("when_any_range sends the first result", "[adaptors][when_any_range]") {
+    auto snd = exec::when_any_range(iota_senders(3));
+    check_val_types<type_array<type_array<int&&>>>(snd);
+    auto [value] = ex::sync_wait(std::move(snd)).value();
+    CHECK(value == 0);
+  }
+
+  TEST_CASE("when_any_range of an empty range is stopped", "[adaptors][when_any_range]") {
+    auto op = ex::connect(
+      exec::when_any_range(std::vector<just_int_t>{}), expect_stopped_receiver{});
+    ex::start(op);
+  }
+
+  TEST_CASE("when_any_range stops the other children", "[adaptors][when_any_range]") {
+    impulse_scheduler sched;
+    std::vector<decltype(ex::on(sched, ex::just(0)))> senders;
+    for (int i = 0; i < 3; ++i) {
+      senders.push_back(ex::on(sched, ex::just(i)));
+    }
+    auto op = ex::connect(exec::when_any_range(std::move(senders)), expect_value_receiver{0});
+    ex::start(op);
+    // The first child wins, and the others observe the stop request when
+    // they are resumed.
+    sched.start_next();
+    sched.start_next();
+    sched.start_next();
+  }
+}
@@ -23,6 +23,7 @@
 #include <test_common/schedulers.hpp>
 #include <test_common/receivers.hpp>
 #include <test_common/type_helpers.hpp>
+#include <test_common/allocators.hpp>
 
 namespace ex = stdexec;
 using exec::async_scope;
@@ -308,4 +309,20 @@ namespace {
     auto op = ex::connect(std::move(snd), expect_void_receiver{});
     ex::start(op);
   }
+
+  TEST_CASE(
+    "ensure_started uses the allocator of the environment it is given",
+    "[adaptors][ensure_started]") {
+    allocation_counts counts;
+    {
+      auto env = exec::make_env(
+        exec::with(ex::get_allocator, counting_allocator<std::byte>{counts}));
+      auto snd = ex::ensure_started(ex::just(42), env);
+      CHECK(counts.allocations == 1);
+      auto [v] = stdexec::sync_wait(std::move(snd)).value();
+      CHECK(v == 42);
+    }
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
 }
@@ -21,6 +21,7 @@
 #include <test_common/senders.hpp>
 #include <test_common/receivers.hpp>
 #include <test_common/type_helpers.hpp>
+#include <test_common/allocators.hpp>
 #include <exec/env.hpp>
 #include <exec/static_thread_pool.hpp>
 
@@ -503,4 +504,45 @@ namespace {
       !stdexec::__callable<stdexec::get_completion_scheduler_t<ex::set_stopped_t>, snd_t>);
     (void) snd;
   }
+
+  TEST_CASE("split uses the allocator of the environment it is given", "[adaptors][split]") {
+    allocation_counts counts;
+    {
+      auto env = exec::make_env(
+        exec::with(ex::get_allocator, counting_allocator<std::byte>{counts}));
+      auto snd = ex::split(ex::just(42), env);
+      CHECK(counts.allocations == 1);
+      auto [v1] = stdexec::sync_wait(snd).value();
+      auto [v2] = stdexec::sync_wait(snd).value();
+      CHECK(v1 == 42);
+      CHECK(v2 == 42);
+      CHECK(counts.deallocations == 0);
+    }
+    CHECK(counts.allocations == 1);
+    CHECK(counts.deallocations == 1);
+  }
+
+  TEST_CASE("split with a single consumer forwards the result directly", "[adaptors][split]") {
+    exec::static_thread_pool pool{2};
+    auto snd = ex::split(
+      ex::schedule(pool.get_scheduler()) | ex::then([] { return std::string(100, 'x'); }));
+    auto [str] = stdexec::sync_wait(std::move(snd)).value();
+    CHECK(str == std::string(100, 'x'));
+  }
+
+  TEST_CASE("split with a single consumer forwards errors and stopped", "[adaptors][split]") {
+    auto snd1 = ex::split(ex::just_error(42));
+    auto op1 = ex::connect(std::move(snd1), expect_error_receiver{42});
+    ex::start(op1);
+
+    auto snd2 = ex::split(ex::just_stopped());
+    auto op2 = ex::connect(std::move(snd2), expect_stopped_receiver{});
+    ex::start(op2);
+
+    impulse_scheduler sched;
+    auto snd3 = ex::split(ex::on(sched, ex::just(1)));
+    auto op = ex::connect(std::move(snd3), expect_value_receiver{1});
+    ex::start(op);
+    sched.start_next();
+  }
 }
@@ -16,8 +16,10 @@
 
 #include <catch2/catch.hpp>
 #include <stdexec/execution.hpp>
+#include <exec/env.hpp>
 #include <test_common/schedulers.hpp>
 #include <test_common/receivers.hpp>
+#include <test_common/senders.hpp>
 #include <test_common/type_helpers.hpp>
 
 namespace ex = stdexec;
@@ -528,4 +530,71 @@ namespace {
       wait_for_value(std::move(snd), std::string{"hello world"});
     }
   }
+
+  // An in_place_stop_token that counts the stop callbacks registered with it
+  struct counting_stop_token {
+    template <class Fun>
+    struct callback_type : ex::in_place_stop_callback<Fun> {
+      template <class Fun2>
+      callback_type(counting_stop_token token, Fun2&& fun)
+        : ex::in_place_stop_callback<Fun>(token.token_, (Fun2&&) fun) {
+        ++*token.registrations_;
+      }
+    };
+
+    bool stop_requested() const noexcept {
+      return token_.stop_requested();
+    }
+
+    bool stop_possible() const noexcept {
+      return token_.stop_possible();
+    }
+
+    bool operator==(const counting_stop_token&) const noexcept = default;
+
+    ex::in_place_stop_token token_;
+    int* registrations_;
+  };
+
+  TEST_CASE(
+    "when_all shares the stop token with children that cannot fail",
+    "[adaptors][when_all]") {
+    ex::in_place_stop_source stop_source;
+    int registrations = 0;
+    counting_stop_token token{stop_source.get_token(), &registrations};
+    auto env = exec::make_env(exec::with(ex::get_stop_token, token));
+    auto snd = ex::when_all(                                     //
+      ex::when_all(ex::just(1), ex::read(ex::get_stop_token)), //
+      ex::just(2));
+    auto op = ex::connect(std::move(snd), expect_value_receiver{env_tag{}, env, 1, token, 2});
+    ex::start(op);
+    CHECK(registrations == 0);
+  }
+
+  TEST_CASE(
+    "when_all with a shared stop token can be stopped before it starts",
+    "[adaptors][when_all]") {
+    ex::in_place_stop_source stop_source;
+    int registrations = 0;
+    auto env = exec::make_env(
+      exec::with(ex::get_stop_token, counting_stop_token{stop_source.get_token(), &registrations}));
+    stop_source.request_stop();
+    auto snd = ex::when_all(ex::when_all(ex::just(1)), ex::just(2));
+    auto op = ex::connect(std::move(snd), expect_stopped_receiver{env});
+    ex::start(op);
+    CHECK(registrations == 0);
+  }
+
+  TEST_CASE(
+    "when_all registers a stop callback for children that can stop",
+    "[adaptors][when_all]") {
+    ex::in_place_stop_source stop_source;
+    int registrations = 0;
+    auto env = exec::make_env(
+      exec::with(ex::get_stop_token, counting_stop_token{stop_source.get_token(), &registrations}));
+    auto snd = ex::when_all(ex::just(1), completes_if{true});
+    auto op = ex::connect(std::move(snd), expect_value_receiver{env_tag{}, env, 1});
+    ex::start(op);
+    CHECK(registrations == 1);
+  }
 }
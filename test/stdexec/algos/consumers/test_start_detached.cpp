@@ -164,6 +164,41 @@ namespace {
     CHECK_FALSE(called);
   }
 
+  // Records the address of its operation state when it is started.
+  struct address_sender {
+    using sender_concept = ex::sender_t;
+    using completion_signatures = ex::completion_signatures<ex::set_value_t()>;
+
+    template <class R>
+    struct operation {
+      R rcvr_;
+      const void** address_;
+
+      friend void tag_invoke(ex::start_t, operation& self) noexcept {
+        *self.address_ = &self;
+        ex::set_value(std::move(self.rcvr_));
+      }
+    };
+
+    template <class R>
+    friend operation<R> tag_invoke(ex::connect_t, address_sender self, R rcvr) {
+      return {std::move(rcvr), self.address_};
+    }
+
+    const void** address_;
+  };
+
+  TEST_CASE(
+    "start_detached recycles operation states on the same thread",
+    "[consumers][start_detached]") {
+    const void* first = nullptr;
+    const void* second = nullptr;
+    ex::start_detached(address_sender{&first});
+    ex::start_detached(address_sender{&second});
+    CHECK(first != nullptr);
+    CHECK(first == second);
+  }
+
 #if STDEXEC_HAS_STD_MEMORY_RESOURCE() \
   && (defined(__cpp_lib_polymorphic_allocator) && __cpp_lib_polymorphic_allocator >= 201902L)
 
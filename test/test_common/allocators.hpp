@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023 NVIDIA Corporation
+ *
+ * Licensed under the Apache License Version 2.0 with LLVM Exceptions
+ * (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ *
+ *   https://llvm.org/LICENSE.txt
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace {
+
+  //! Counts of the allocations made through a counting_allocator
+  struct allocation_counts {
+    int allocations = 0;
+    int deallocations = 0;
+  };
+
+  //! An allocator that forwards to std::allocator and counts its calls
+  template <class T>
+  struct counting_allocator {
+    using value_type = T;
+
+    explicit counting_allocator(allocation_counts& counts) noexcept
+      : counts_(&counts) {
+    }
+
+    template <class U>
+    counting_allocator(const counting_allocator<U>& other) noexcept
+      : counts_(other.counts_) {
+    }
+
+    T* allocate(std::size_t n) {
+      ++counts_->allocations;
+      return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+      ++counts_->deallocations;
+      std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(const counting_allocator<U>& other) const noexcept {
+      return counts_ == other.counts_;
+    }
+
+    allocation_counts* counts_;
+  };
+}